@@ -6,6 +6,8 @@
 -keep class com.swmansion.enriched.markdown.parser.MarkdownASTNode { *; }
 -keep class com.swmansion.enriched.markdown.parser.MarkdownASTNode$NodeType { *; }
 -keep class com.swmansion.enriched.markdown.parser.Md4cFlags { *; }
+-keep class com.swmansion.enriched.markdown.parser.NodeAttributes { *; }
+-keep class com.swmansion.enriched.markdown.parser.DocumentIndex { *; }
 
 # Reflection: Math classes loaded via Class.forName when enableMath=true.
 -keep class com.swmansion.enriched.markdown.spans.MathInlineSpan { *; }
@@ -1,7 +1,20 @@
+#include "CodeLineIndex.hpp"
+#include "DocumentIndex.hpp"
 #include "MD4CParser.hpp"
+#include "ParseCache.hpp"
+#include "ParseControl.hpp"
+#include "ParseStats.hpp"
+#include "StreamingParseSession.hpp"
+#include "Utf16OffsetMap.hpp"
 #include <android/log.h>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <jni.h>
+#include <new>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace Markdown;
 
@@ -70,121 +83,397 @@ static jint nodeTypeToJavaOrdinal(NodeType type) {
       return 27;
     case NodeType::Subscript:
       return 28;
+    case NodeType::Mention:
+      return 29;
+    case NodeType::Hashtag:
+      return 30;
+    case NodeType::EmojiShortcode:
+      return 31;
     default:
       return 0;
   }
 }
 
-// Helper function to create a Kotlin MarkdownASTNode object from C++ AST node
-static jobject createJavaNode(JNIEnv *env, std::shared_ptr<MarkdownASTNode> node) {
-  if (!node) {
-    return nullptr;
-  }
+// JNI classes and method IDs needed to build Kotlin MarkdownASTNode objects.
+// Resolved once per parse instead of once per node.
+struct JavaNodeFactory {
+  JNIEnv *env = nullptr;
+  jclass nodeClass = nullptr;
+  jmethodID nodeConstructor = nullptr;
+  jfieldID lineStartsField = nullptr;
+  jobjectArray nodeTypeValues = nullptr;
+  jclass attributesClass = nullptr;
+  jmethodID attributesConstructor = nullptr;
+  jobject emptyAttributes = nullptr;
+  jclass listClass = nullptr;
+  jmethodID listInit = nullptr;
+  jmethodID listAdd = nullptr;
+  // Maps byte offsets to java.lang.String indices; null if the AST has no source.
+  const Utf16OffsetMap *offsets = nullptr;
+  // The streaming session the AST belongs to, if any; it keeps the line index of a code block that is still
+  // streaming in from one update to the next.
+  StreamingParseSession *session = nullptr;
 
-  // Find the MarkdownASTNode class
-  jclass nodeClass = env->FindClass("com/swmansion/enriched/markdown/parser/MarkdownASTNode");
-  if (!nodeClass) {
-    LOGE("Failed to find MarkdownASTNode class");
-    return nullptr;
+  explicit JavaNodeFactory(JNIEnv *env) : env(env) {}
+
+  ~JavaNodeFactory() {
+    if (nodeClass)
+      env->DeleteLocalRef(nodeClass);
+    if (nodeTypeValues)
+      env->DeleteLocalRef(nodeTypeValues);
+    if (attributesClass)
+      env->DeleteLocalRef(attributesClass);
+    if (emptyAttributes)
+      env->DeleteLocalRef(emptyAttributes);
+    if (listClass)
+      env->DeleteLocalRef(listClass);
   }
 
-  // Find the NodeType enum class
-  jclass nodeTypeClass = env->FindClass("com/swmansion/enriched/markdown/parser/MarkdownASTNode$NodeType");
-  if (!nodeTypeClass) {
-    LOGE("Failed to find NodeType enum class");
-    return nullptr;
+  bool init() {
+    // Find the MarkdownASTNode class
+    nodeClass = env->FindClass("com/swmansion/enriched/markdown/parser/MarkdownASTNode");
+    if (!nodeClass) {
+      LOGE("Failed to find MarkdownASTNode class");
+      return false;
+    }
+
+    // Find the MarkdownASTNode constructor
+    // Constructor signature: (Lcom/swmansion/enriched/markdown/parser/MarkdownASTNode$NodeType;Ljava/lang/String;Ljava/util/Map;Ljava/util/List;IIJ)V
+    nodeConstructor = env->GetMethodID(nodeClass, "<init>",
+                                       "(Lcom/swmansion/enriched/markdown/parser/MarkdownASTNode$NodeType;Ljava/"
+                                       "lang/String;Ljava/util/Map;Ljava/util/List;IIJ)V");
+    if (!nodeConstructor) {
+      LOGE("Failed to find MarkdownASTNode constructor");
+      return false;
+    }
+
+    lineStartsField = env->GetFieldID(nodeClass, "lineStarts", "[I");
+    if (!lineStartsField) {
+      LOGE("Failed to find MarkdownASTNode.lineStarts field");
+      return false;
+    }
+
+    // Find the NodeType enum class
+    jclass nodeTypeClass = env->FindClass("com/swmansion/enriched/markdown/parser/MarkdownASTNode$NodeType");
+    if (!nodeTypeClass) {
+      LOGE("Failed to find NodeType enum class");
+      return false;
+    }
+
+    // Get the enum values array
+    jmethodID valuesMethod = env->GetStaticMethodID(
+        nodeTypeClass, "values", "()[Lcom/swmansion/enriched/markdown/parser/MarkdownASTNode$NodeType;");
+    if (!valuesMethod) {
+      LOGE("Failed to find NodeType.values() method");
+      env->DeleteLocalRef(nodeTypeClass);
+      return false;
+    }
+
+    nodeTypeValues = (jobjectArray)env->CallStaticObjectMethod(nodeTypeClass, valuesMethod);
+    env->DeleteLocalRef(nodeTypeClass);
+    if (!nodeTypeValues) {
+      LOGE("Failed to get NodeType enum values");
+      return false;
+    }
+
+    // Typed attribute block: (presentMask, level, url, title, language, fenceChar, isTask, taskChecked, align,
+    // colCount, headRowCount, bodyRowCount, taskIndex, isInline)
+    attributesClass = env->FindClass("com/swmansion/enriched/markdown/parser/NodeAttributes");
+    if (!attributesClass) {
+      LOGE("Failed to find NodeAttributes class");
+      return false;
+    }
+    attributesConstructor = env->GetMethodID(attributesClass, "<init>",
+                                             "(IILjava/lang/String;Ljava/lang/String;Ljava/lang/String;CZZIIIIIZ)V");
+    jfieldID emptyField =
+        env->GetStaticFieldID(attributesClass, "EMPTY", "Lcom/swmansion/enriched/markdown/parser/NodeAttributes;");
+    if (!attributesConstructor || !emptyField) {
+      LOGE("Failed to find NodeAttributes constructor or EMPTY instance");
+      return false;
+    }
+    emptyAttributes = env->GetStaticObjectField(attributesClass, emptyField);
+
+    listClass = env->FindClass("java/util/ArrayList");
+    listInit = env->GetMethodID(listClass, "<init>", "(I)V");
+    listAdd = env->GetMethodID(listClass, "add", "(Ljava/lang/Object;)Z");
+
+    return emptyAttributes && listInit && listAdd;
   }
 
-  // Get the enum values array
-  jmethodID valuesMethod = env->GetStaticMethodID(
-      nodeTypeClass, "values", "()[Lcom/swmansion/enriched/markdown/parser/MarkdownASTNode$NodeType;");
-  if (!valuesMethod) {
-    LOGE("Failed to find NodeType.values() method");
-    return nullptr;
+  jstring newString(const FlatMarkdownAST &ast, TextRange range) {
+    // NewStringUTF needs a null-terminated buffer; payloads in the arena are not.
+    std::string value(ast.text(range));
+    return env->NewStringUTF(value.c_str());
   }
 
-  jobjectArray enumValues = (jobjectArray)env->CallStaticObjectMethod(nodeTypeClass, valuesMethod);
-  if (!enumValues) {
-    LOGE("Failed to get NodeType enum values");
-    return nullptr;
+  jstring newOptionalString(const FlatMarkdownAST &ast, const NodeAttributes &attrs, AttributeKey key,
+                            TextRange range) {
+    return attrs.has(key) ? newString(ast, range) : nullptr;
   }
 
-  // Get the enum value for this node type
-  jint ordinal = nodeTypeToJavaOrdinal(node->type);
-  jobject nodeTypeEnum = env->GetObjectArrayElement(enumValues, ordinal);
-  if (!nodeTypeEnum) {
-    LOGE("Failed to get NodeType enum value at index %d", ordinal);
-    return nullptr;
+  // Returns a new local reference, or the shared EMPTY instance (not to be deleted) for nodes without attributes.
+  jobject createAttributes(const FlatMarkdownAST &ast, NodeIndex index) {
+    const NodeAttributes *attrs = ast.attributesOf(index);
+    if (!attrs || attrs->empty()) {
+      return emptyAttributes;
+    }
+
+    jstring url = newOptionalString(ast, *attrs, AttributeKey::Url, attrs->url);
+    jstring title = newOptionalString(ast, *attrs, AttributeKey::Title, attrs->title);
+    jstring language = newOptionalString(ast, *attrs, AttributeKey::Language, attrs->language);
+
+    jobject result = env->NewObject(
+        attributesClass, attributesConstructor, static_cast<jint>(attrs->presentMask), static_cast<jint>(attrs->level),
+        url, title, language, static_cast<jchar>(static_cast<unsigned char>(attrs->fenceChar)),
+        static_cast<jboolean>(attrs->isTask), static_cast<jboolean>(attrs->taskChecked),
+        static_cast<jint>(attrs->align), static_cast<jint>(attrs->colCount), static_cast<jint>(attrs->headRowCount),
+        static_cast<jint>(attrs->bodyRowCount), static_cast<jint>(attrs->taskIndex),
+        static_cast<jboolean>(attrs->isInline));
+
+    if (url)
+      env->DeleteLocalRef(url);
+    if (title)
+      env->DeleteLocalRef(title);
+    if (language)
+      env->DeleteLocalRef(language);
+
+    return result;
   }
 
-  // Create content string
-  jstring contentStr = env->NewStringUTF(node->content.c_str());
-  if (!contentStr && !node->content.empty()) {
-    LOGE("Failed to create content string");
-    return nullptr;
+  // Gives a Kotlin CodeBlock node the UTF-16 offsets at which the lines of its text start.
+  void setLineStarts(jobject javaNode, const FlatMarkdownAST &ast, NodeIndex index) {
+    NodeIndex text = ast.nodes[index].firstChild;
+    CodeLineIndex built(session || text == kInvalidNodeIndex ? std::string_view() : ast.content(text),
+                        CodeLineIndex::Unit::Utf16);
+    const CodeLineIndex &lines = session ? session->codeLines(index, CodeLineIndex::Unit::Utf16) : built;
+    jintArray starts = env->NewIntArray(static_cast<jsize>(lines.lineCount()));
+    if (!starts) {
+      return;
+    }
+    env->SetIntArrayRegion(starts, 0, static_cast<jsize>(lines.lineCount()),
+                           reinterpret_cast<const jint *>(lines.starts().data()));
+    env->SetObjectField(javaNode, lineStartsField, starts);
+    env->DeleteLocalRef(starts);
   }
 
-  // Create attributes HashMap
-  jclass mapClass = env->FindClass("java/util/HashMap");
-  jmethodID mapInit = env->GetMethodID(mapClass, "<init>", "(I)V");
-  jmethodID mapPut = env->GetMethodID(mapClass, "put", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
+  // Creates a Kotlin MarkdownASTNode object from a flat AST node, leaving out its first `skipChildren` children
+  jobject createNode(const FlatMarkdownAST &ast, NodeIndex index, size_t skipChildren = 0) {
+    const FlatNode &node = ast.nodes[index];
 
-  jobject attributesMap = env->NewObject(mapClass, mapInit, static_cast<jint>(node->attributes.size()));
+    // Get the enum value for this node type
+    jint ordinal = nodeTypeToJavaOrdinal(node.type);
+    jobject nodeTypeEnum = env->GetObjectArrayElement(nodeTypeValues, ordinal);
+    if (!nodeTypeEnum) {
+      LOGE("Failed to get NodeType enum value at index %d", ordinal);
+      return nullptr;
+    }
 
-  for (const auto &pair : node->attributes) {
-    jstring key = env->NewStringUTF(pair.first.c_str());
-    jstring value = env->NewStringUTF(pair.second.c_str());
-    env->CallObjectMethod(attributesMap, mapPut, key, value);
-    env->DeleteLocalRef(key);
-    env->DeleteLocalRef(value);
-  }
+    // Create content string
+    jstring contentStr = newString(ast, node.content);
+    if (!contentStr && node.content.length > 0) {
+      LOGE("Failed to create content string");
+      env->DeleteLocalRef(nodeTypeEnum);
+      return nullptr;
+    }
+
+    // Create typed attributes (a Map<String, String> on the Kotlin side)
+    jobject attributesMap = createAttributes(ast, index);
+
+    // Create children ArrayList
+    NodeIndex firstChild = node.firstChild;
+    for (size_t skipped = 0; skipped < skipChildren && firstChild != kInvalidNodeIndex; ++skipped) {
+      firstChild = ast.nodes[firstChild].nextSibling;
+    }
+    jobject childrenList = env->NewObject(listClass, listInit, static_cast<jint>(node.childCount));
 
-  // Create children ArrayList
-  jclass listClass = env->FindClass("java/util/ArrayList");
-  jmethodID listInit = env->GetMethodID(listClass, "<init>", "(I)V");
-  jmethodID listAdd = env->GetMethodID(listClass, "add", "(Ljava/lang/Object;)Z");
+    for (NodeIndex child = firstChild; child != kInvalidNodeIndex; child = ast.nodes[child].nextSibling) {
+      jobject childObj = createNode(ast, child);
+      if (childObj) {
+        env->CallBooleanMethod(childrenList, listAdd, childObj);
+        env->DeleteLocalRef(childObj);
+      }
+    }
+
+    // Source range in UTF-16 units, so Kotlin can slice the original String directly
+    jint sourceStart = -1;
+    jint sourceEnd = -1;
+    if (offsets) {
+      sourceStart = static_cast<jint>(offsets->toUtf16(node.sourceRange.begin));
+      sourceEnd = static_cast<jint>(offsets->toUtf16(node.sourceRange.end));
+    }
 
-  jobject childrenList = env->NewObject(listClass, listInit, static_cast<jint>(node->children.size()));
+    // A root with children left out no longer matches the hash of the whole document; 0 makes Kotlin hash it itself.
+    auto subtreeHash = static_cast<jlong>(skipChildren == 0 ? node.hash : 0);
 
-  for (const auto &child : node->children) {
-    jobject childObj = createJavaNode(env, child);
-    if (childObj) {
-      env->CallBooleanMethod(childrenList, listAdd, childObj);
-      env->DeleteLocalRef(childObj);
+    // Create the Kotlin MarkdownASTNode object
+    jobject javaNode = env->NewObject(nodeClass, nodeConstructor, nodeTypeEnum, contentStr, attributesMap, childrenList,
+                                      sourceStart, sourceEnd, subtreeHash);
+
+    if (javaNode && node.type == NodeType::CodeBlock) {
+      setLineStarts(javaNode, ast, index);
     }
+
+    // Clean up local references
+    env->DeleteLocalRef(nodeTypeEnum);
+    if (contentStr)
+      env->DeleteLocalRef(contentStr);
+    if (attributesMap != emptyAttributes)
+      env->DeleteLocalRef(attributesMap);
+    env->DeleteLocalRef(childrenList);
+
+    return javaNode;
   }
+};
 
-  // Find the MarkdownASTNode constructor
-  // Constructor signature: (Lcom/swmansion/enriched/markdown/parser/MarkdownASTNode$NodeType;Ljava/lang/String;Ljava/util/Map;Ljava/util/List;)V
-  jmethodID constructor = env->GetMethodID(nodeClass, "<init>",
-                                           "(Lcom/swmansion/enriched/markdown/parser/MarkdownASTNode$NodeType;Ljava/"
-                                           "lang/String;Ljava/util/Map;Ljava/util/List;)V");
-  if (!constructor) {
-    LOGE("Failed to find MarkdownASTNode constructor");
-    return nullptr;
+// Extract flags from Kotlin Md4cFlags data class
+static Md4cFlags readMd4cFlags(JNIEnv *env, jobject flags) {
+  Md4cFlags md4cFlags;
+  if (flags) {
+    jclass flagsClass = env->GetObjectClass(flags);
+    if (flagsClass) {
+      jfieldID underlineField = env->GetFieldID(flagsClass, "underline", "Z");
+      if (underlineField) {
+        md4cFlags.underline = env->GetBooleanField(flags, underlineField) == JNI_TRUE;
+      }
+      jfieldID latexMathField = env->GetFieldID(flagsClass, "latexMath", "Z");
+      if (latexMathField) {
+        md4cFlags.latexMath = env->GetBooleanField(flags, latexMathField) == JNI_TRUE;
+      }
+      jfieldID superscriptField = env->GetFieldID(flagsClass, "superscript", "Z");
+      if (superscriptField) {
+        md4cFlags.superscript = env->GetBooleanField(flags, superscriptField) == JNI_TRUE;
+      }
+      jfieldID subscriptField = env->GetFieldID(flagsClass, "subscript", "Z");
+      if (subscriptField) {
+        md4cFlags.subscript = env->GetBooleanField(flags, subscriptField) == JNI_TRUE;
+      }
+      jfieldID mentionsField = env->GetFieldID(flagsClass, "mentions", "Z");
+      if (mentionsField) {
+        md4cFlags.mentions = env->GetBooleanField(flags, mentionsField) == JNI_TRUE;
+      }
+      jfieldID hashtagsField = env->GetFieldID(flagsClass, "hashtags", "Z");
+      if (hashtagsField) {
+        md4cFlags.hashtags = env->GetBooleanField(flags, hashtagsField) == JNI_TRUE;
+      }
+      jfieldID emojiShortcodesField = env->GetFieldID(flagsClass, "emojiShortcodes", "Z");
+      if (emojiShortcodesField) {
+        md4cFlags.emojiShortcodes = env->GetBooleanField(flags, emojiShortcodesField) == JNI_TRUE;
+      }
+      jfieldID permissiveAutolinksField = env->GetFieldID(flagsClass, "permissiveAutolinks", "Z");
+      if (permissiveAutolinksField) {
+        md4cFlags.permissiveAutolinks = env->GetBooleanField(flags, permissiveAutolinksField) == JNI_TRUE;
+      }
+      jfieldID maxBlocksField = env->GetFieldID(flagsClass, "maxBlocks", "I");
+      if (maxBlocksField) {
+        md4cFlags.maxBlocks = static_cast<uint32_t>(std::max<jint>(env->GetIntField(flags, maxBlocksField), 0));
+      }
+      jfieldID maxSourceBytesField = env->GetFieldID(flagsClass, "maxSourceBytes", "I");
+      if (maxSourceBytesField) {
+        md4cFlags.maxSourceBytes =
+            static_cast<uint32_t>(std::max<jint>(env->GetIntField(flags, maxSourceBytesField), 0));
+      }
+      env->DeleteLocalRef(flagsClass);
+    }
   }
+  return md4cFlags;
+}
 
-  // Create the Kotlin MarkdownASTNode object
-  jobject javaNode = env->NewObject(nodeClass, constructor, nodeTypeEnum, contentStr, attributesMap, childrenList);
+// Copies `stats` into the LongArray behind a Kotlin ParseStats, in the layout of its constants.
+static void writeParseStats(JNIEnv *env, jlongArray target, const ParseStats &stats) {
+  constexpr jsize kNodeCounts = 13;
+  jlong values[kNodeCounts + kNodeTypeCount] = {
+      static_cast<jlong>(stats.inputBytes),
+      stats.cacheHit ? 1 : 0,
+      static_cast<jlong>(stats.nodeCount),
+      static_cast<jlong>(stats.maxDepth),
+      static_cast<jlong>(stats.textBytes),
+      static_cast<jlong>(stats.residentBytes),
+      static_cast<jlong>(stats.residentBlocks),
+      static_cast<jlong>(stats.allocations),
+      static_cast<jlong>(stats.allocatedBytes),
+      static_cast<jlong>(stats.md4cTime.count()),
+      static_cast<jlong>(stats.treeBuildTime.count()),
+      static_cast<jlong>(stats.postProcessTime.count()),
+      static_cast<jlong>(stats.totalTime.count()),
+  };
+  for (size_t i = 0; i < kNodeTypeCount; ++i) {
+    auto type = static_cast<NodeType>(i);
+    values[kNodeCounts + nodeTypeToJavaOrdinal(type)] = stats.count(type);
+  }
+  jsize length = std::min(env->GetArrayLength(target), static_cast<jsize>(std::size(values)));
+  env->SetLongArrayRegion(target, 0, length, values);
+}
 
-  // Clean up local references
-  env->DeleteLocalRef(nodeTypeClass);
-  env->DeleteLocalRef(enumValues);
-  env->DeleteLocalRef(nodeTypeEnum);
-  if (contentStr)
-    env->DeleteLocalRef(contentStr);
-  env->DeleteLocalRef(attributesMap);
-  env->DeleteLocalRef(childrenList);
+// Stores the index of `ast` in the `values` and `strings` fields of a Kotlin DocumentIndex, in the layout described
+// there, with source ranges in UTF-16 code units.
+static void writeDocumentIndex(JNIEnv *env, jobject target, const FlatMarkdownAST &ast,
+                               const Utf16OffsetMap &offsets) {
+  std::shared_ptr<const DocumentIndex> index = ast.index();
+  std::vector<jint> values = {
+      static_cast<jint>(index->wordCount),
+      static_cast<jint>(index->characterCount),
+      static_cast<jint>(index->headings.size()),
+      static_cast<jint>(index->links.size()),
+      static_cast<jint>(index->images.size()),
+      static_cast<jint>(index->tasks.size()),
+  };
+  values.reserve(values.size() + (index->headings.size() + index->tasks.size()) * 3);
+  auto appendRange = [&](NodeIndex node) {
+    values.push_back(static_cast<jint>(offsets.toUtf16(ast.nodes[node].sourceRange.begin)));
+    values.push_back(static_cast<jint>(offsets.toUtf16(ast.nodes[node].sourceRange.end)));
+  };
+  for (const DocumentIndex::Heading &heading : index->headings) {
+    values.push_back(heading.level);
+    appendRange(heading.node);
+  }
+  for (const DocumentIndex::Task &task : index->tasks) {
+    values.push_back(task.checked ? 1 : 0);
+    appendRange(task.node);
+  }
+
+  jclass stringClass = env->FindClass("java/lang/String");
+  auto stringCount = static_cast<jsize>(index->headings.size() * 2 + index->links.size() + index->images.size());
+  jobjectArray strings = env->NewObjectArray(stringCount, stringClass, nullptr);
+  env->DeleteLocalRef(stringClass);
+  jintArray valueArray = env->NewIntArray(static_cast<jsize>(values.size()));
+  if (!strings || !valueArray) {
+    return;
+  }
+  env->SetIntArrayRegion(valueArray, 0, static_cast<jsize>(values.size()), values.data());
+  jsize next = 0;
+  auto appendString = [&](const std::string &value) {
+    jstring string = env->NewStringUTF(value.c_str());
+    env->SetObjectArrayElement(strings, next++, string);
+    env->DeleteLocalRef(string);
+  };
+  for (const DocumentIndex::Heading &heading : index->headings) {
+    appendString(heading.text);
+    appendString(heading.slug);
+  }
+  for (const DocumentIndex::Target &link : index->links) {
+    appendString(link.url);
+  }
+  for (const DocumentIndex::Target &image : index->images) {
+    appendString(image.url);
+  }
 
-  return javaNode;
+  jclass indexClass = env->GetObjectClass(target);
+  env->SetObjectField(target, env->GetFieldID(indexClass, "values", "[I"), valueArray);
+  env->SetObjectField(target, env->GetFieldID(indexClass, "strings", "[Ljava/lang/String;"), strings);
+  env->DeleteLocalRef(indexClass);
+  env->DeleteLocalRef(valueArray);
+  env->DeleteLocalRef(strings);
 }
 
 extern "C" {
 
-JNIEXPORT jobject JNICALL Java_com_swmansion_enriched_markdown_parser_Parser_nativeParseMarkdown(JNIEnv *env,
-                                                                                                 jobject /* this */,
-                                                                                                 jstring markdown,
-                                                                                                 jobject flags) {
+// `controlHandle` is a ParseControl from nativeCreateParseControl, or 0. A parse it stops returns null. `statsArray`,
+// if not null, is the storage of a Kotlin ParseStats to fill in, and `indexObject` a Kotlin DocumentIndex.
+JNIEXPORT jobject JNICALL Java_com_swmansion_enriched_markdown_parser_Parser_nativeParseMarkdown(
+    JNIEnv *env, jobject /* this */, jstring markdown, jobject flags, jlong controlHandle, jlongArray statsArray,
+    jobject indexObject) {
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point start = Clock::now();
   if (!markdown) {
     LOGE("Markdown string is null");
     return nullptr;
@@ -197,62 +486,165 @@ JNIEXPORT jobject JNICALL Java_com_swmansion_enriched_markdown_parser_Parser_nat
   }
 
   try {
-    // Extract flags from Kotlin Md4cFlags data class
-    Md4cFlags md4cFlags;
-    if (flags) {
-      jclass flagsClass = env->GetObjectClass(flags);
-      if (flagsClass) {
-        jfieldID underlineField = env->GetFieldID(flagsClass, "underline", "Z");
-        if (underlineField) {
-          md4cFlags.underline = env->GetBooleanField(flags, underlineField) == JNI_TRUE;
-        }
-        jfieldID latexMathField = env->GetFieldID(flagsClass, "latexMath", "Z");
-        if (latexMathField) {
-          md4cFlags.latexMath = env->GetBooleanField(flags, latexMathField) == JNI_TRUE;
-        }
-        jfieldID superscriptField = env->GetFieldID(flagsClass, "superscript", "Z");
-        if (superscriptField) {
-          md4cFlags.superscript = env->GetBooleanField(flags, superscriptField) == JNI_TRUE;
-        }
-        jfieldID subscriptField = env->GetFieldID(flagsClass, "subscript", "Z");
-        if (subscriptField) {
-          md4cFlags.subscript = env->GetBooleanField(flags, subscriptField) == JNI_TRUE;
-        }
-        jfieldID permissiveAutolinksField = env->GetFieldID(flagsClass, "permissiveAutolinks", "Z");
-        if (permissiveAutolinksField) {
-          md4cFlags.permissiveAutolinks = env->GetBooleanField(flags, permissiveAutolinksField) == JNI_TRUE;
+    Md4cFlags md4cFlags = readMd4cFlags(env, flags);
+
+    // Measurement and rendering parse the same markdown, so most calls after the first are cache hits.
+    ParseCache &cache = ParseCache::shared();
+    std::shared_ptr<const FlatMarkdownAST> ast = cache.find(markdownStr, md4cFlags);
+    std::shared_ptr<const std::string> source;
+    ParseStats stats;
+    if (ast) {
+      source = ast->source;
+      stats.recordCacheHit(*ast);
+    } else {
+      // The AST keeps text as views into this buffer instead of copying it again.
+      source = std::make_shared<const std::string>(markdownStr);
+    }
+    env->ReleaseStringUTFChars(markdown, markdownStr);
+    markdownStr = nullptr;
+
+    if (!ast) {
+      MD4CParser parser;
+      parser.setParallelParsing(std::thread::hardware_concurrency());
+      if (statsArray) {
+        parser.setStats(&stats);
+      }
+      parser.setDocumentIndexEnabled(indexObject != nullptr);
+      if (auto *control = reinterpret_cast<const ParseControl *>(controlHandle)) {
+        ParseStatus status;
+        ast = parser.parseFlat(source, md4cFlags, *control, status);
+        if (status == ParseStatus::Cancelled || status == ParseStatus::DeadlineExceeded) {
+          return nullptr;
         }
-        env->DeleteLocalRef(flagsClass);
+      } else {
+        ast = parser.parseFlat(source, md4cFlags);
       }
+      cache.insert(source, md4cFlags, ast);
     }
 
-    MD4CParser parser;
-    auto ast = parser.parse(std::string(markdownStr), md4cFlags);
-
-    env->ReleaseStringUTFChars(markdown, markdownStr);
-
     if (!ast) {
       LOGE("Parser returned null AST");
       return nullptr;
     }
 
     // Convert C++ AST to Kotlin MarkdownASTNode object
-    jobject javaNode = createJavaNode(env, ast);
+    Clock::time_point conversionStart = Clock::now();
+    Utf16OffsetMap offsets(*source);
+    JavaNodeFactory factory(env);
+    factory.offsets = &offsets;
+    jobject javaNode = factory.init() ? factory.createNode(*ast, FlatMarkdownAST::root()) : nullptr;
 
     if (!javaNode) {
       LOGE("Failed to create Java node from AST");
+    } else {
+      if (indexObject) {
+        writeDocumentIndex(env, indexObject, *ast, offsets);
+      }
+      if (statsArray) {
+        Clock::time_point end = Clock::now();
+        stats.treeBuildTime = end - conversionStart;
+        stats.totalTime = end - start;
+        writeParseStats(env, statsArray, stats);
+      }
     }
 
     return javaNode;
   } catch (const std::exception &e) {
-    env->ReleaseStringUTFChars(markdown, markdownStr);
+    if (markdownStr)
+      env->ReleaseStringUTFChars(markdown, markdownStr);
     LOGE("Exception during parsing: %s", e.what());
     return nullptr;
   } catch (...) {
-    env->ReleaseStringUTFChars(markdown, markdownStr);
+    if (markdownStr)
+      env->ReleaseStringUTFChars(markdown, markdownStr);
     LOGE("Unknown exception during parsing");
     return nullptr;
   }
 }
 
+JNIEXPORT jlong JNICALL Java_com_swmansion_enriched_markdown_parser_Parser_nativeCreateParseControl(
+    JNIEnv * /* env */, jobject /* this */) {
+  return reinterpret_cast<jlong>(new (std::nothrow) ParseControl());
+}
+
+// Safe to call from any thread while a parse is using the control.
+JNIEXPORT void JNICALL Java_com_swmansion_enriched_markdown_parser_Parser_nativeCancelParseControl(JNIEnv * /* env */,
+                                                                                                   jobject /* this */,
+                                                                                                   jlong handle) {
+  reinterpret_cast<ParseControl *>(handle)->cancel();
+}
+
+JNIEXPORT void JNICALL Java_com_swmansion_enriched_markdown_parser_Parser_nativeDestroyParseControl(JNIEnv * /* env */,
+                                                                                                    jobject /* this */,
+                                                                                                    jlong handle) {
+  delete reinterpret_cast<ParseControl *>(handle);
+}
+
+JNIEXPORT jlong JNICALL Java_com_swmansion_enriched_markdown_parser_Parser_nativeCreateSession(JNIEnv * /* env */,
+                                                                                                jobject /* this */) {
+  return reinterpret_cast<jlong>(new (std::nothrow) StreamingParseSession());
+}
+
+JNIEXPORT void JNICALL Java_com_swmansion_enriched_markdown_parser_Parser_nativeDestroySession(JNIEnv * /* env */,
+                                                                                               jobject /* this */,
+                                                                                               jlong handle) {
+  delete reinterpret_cast<StreamingParseSession *>(handle);
+}
+
+// Runs the next version of a streamed document through the session. Returns a Document node holding the top-level
+// blocks from index blockCounts[0] on; the caller already has Kotlin nodes for the blocks before it. blockCounts
+// receives (blocks carried over from the previous call, blocks that will not change any more).
+JNIEXPORT jobject JNICALL Java_com_swmansion_enriched_markdown_parser_Parser_nativeUpdateSession(
+    JNIEnv *env, jobject /* this */, jlong handle, jstring markdown, jobject flags, jint cachedBlocks,
+    jintArray blockCounts) {
+  auto *session = reinterpret_cast<StreamingParseSession *>(handle);
+  if (!session || !markdown || !blockCounts) {
+    LOGE("Invalid streaming session arguments");
+    return nullptr;
+  }
+
+  const char *markdownStr = env->GetStringUTFChars(markdown, nullptr);
+  if (!markdownStr) {
+    LOGE("Failed to get UTF-8 chars from markdown string");
+    return nullptr;
+  }
+
+  try {
+    Md4cFlags md4cFlags = readMd4cFlags(env, flags);
+
+    // The session copies what it has not seen yet, so the chars can go right away.
+    const FlatMarkdownAST &ast =
+        session->update(std::string_view(markdownStr, static_cast<size_t>(env->GetStringUTFLength(markdown))),
+                        md4cFlags);
+    env->ReleaseStringUTFChars(markdown, markdownStr);
+    markdownStr = nullptr;
+
+    size_t reused = std::min(session->reusedBlockCount(), static_cast<size_t>(std::max(cachedBlocks, 0)));
+    jint counts[2] = {static_cast<jint>(reused), static_cast<jint>(session->stableBlockCount())};
+    env->SetIntArrayRegion(blockCounts, 0, 2, counts);
+
+    Utf16OffsetMap offsets(session->text());
+    JavaNodeFactory factory(env);
+    factory.offsets = &offsets;
+    factory.session = session;
+    jobject javaNode = factory.init() ? factory.createNode(ast, FlatMarkdownAST::root(), reused) : nullptr;
+
+    if (!javaNode) {
+      LOGE("Failed to create Java node from AST");
+    }
+
+    return javaNode;
+  } catch (const std::exception &e) {
+    if (markdownStr)
+      env->ReleaseStringUTFChars(markdown, markdownStr);
+    LOGE("Exception during streaming parse: %s", e.what());
+    return nullptr;
+  } catch (...) {
+    if (markdownStr)
+      env->ReleaseStringUTFChars(markdown, markdownStr);
+    LOGE("Unknown exception during streaming parse");
+    return nullptr;
+  }
+}
+
 } // extern "C"
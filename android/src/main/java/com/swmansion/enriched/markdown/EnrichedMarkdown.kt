@@ -10,8 +10,11 @@ import android.util.Log
 import android.view.View
 import android.widget.FrameLayout
 import com.facebook.react.bridge.ReadableMap
+import com.swmansion.enriched.markdown.parser.MarkdownASTNode
 import com.swmansion.enriched.markdown.parser.Md4cFlags
+import com.swmansion.enriched.markdown.parser.ParseCancellationToken
 import com.swmansion.enriched.markdown.parser.Parser
+import com.swmansion.enriched.markdown.parser.StreamingParser
 import com.swmansion.enriched.markdown.spoiler.SpoilerOverlay
 import com.swmansion.enriched.markdown.styles.StyleConfig
 import com.swmansion.enriched.markdown.utils.common.FeatureFlags
@@ -44,6 +47,7 @@ class EnrichedMarkdown
     }
 
     private val parser = Parser.shared
+    private val streamingParser = lazy { StreamingParser() }
     private val mainHandler = Handler(Looper.getMainLooper())
     private val executor: ExecutorService = Executors.newSingleThreadExecutor()
     private val mathContainerClass: Class<*>? by lazy {
@@ -55,6 +59,7 @@ class EnrichedMarkdown
     }
 
     private var currentRenderId = 0L
+    private var renderCancellation: ParseCancellationToken? = null
     private val segmentViews = mutableListOf<View>()
     private val segmentSignatures = mutableListOf<Long>()
     private val dirtyFlags = EnumSet.noneOf(DirtyFlag::class.java)
@@ -237,6 +242,17 @@ class EnrichedMarkdown
       if (currentMarkdown.isNotEmpty()) scheduleRender()
     }
 
+    private fun parseMarkdown(
+      markdown: String,
+      isStreaming: Boolean,
+      cancellation: ParseCancellationToken,
+    ): MarkdownASTNode? =
+      if (isStreaming) {
+        streamingParser.value.parseMarkdown(markdown, md4cFlags)
+      } else {
+        parser.parseMarkdown(markdown, md4cFlags, cancellation)
+      }
+
     private fun scheduleRender() {
       val style = markdownStyle ?: return
       val markdown = currentMarkdown.takeIf { it.isNotEmpty() } ?: return
@@ -244,9 +260,14 @@ class EnrichedMarkdown
       val tableMode = tableStreamingMode
 
       val renderId = ++currentRenderId
+      // The render still in flight can no longer be applied; stop its parse.
+      renderCancellation?.cancel()
+      val cancellation = ParseCancellationToken()
+      renderCancellation = cancellation
 
       executor.execute {
         try {
+          if (cancellation.isCancelled) return@execute
           val renderableMarkdown =
             if (isStreaming) {
               StreamingMarkdownFilter.renderableMarkdownForStreaming(markdown, tableMode)
@@ -260,7 +281,7 @@ class EnrichedMarkdown
           }
 
           val ast =
-            parser.parseMarkdown(renderableMarkdown, md4cFlags) ?: run {
+            parseMarkdown(renderableMarkdown, isStreaming, cancellation) ?: run {
               postToMain(renderId) { applyRenderedSegments(emptyList(), style) }
               return@execute
             }
@@ -279,6 +300,8 @@ class EnrichedMarkdown
         } catch (e: Exception) {
           Log.e(TAG, "Render failed", e)
           postToMain(renderId) { applyRenderedSegments(emptyList(), style) }
+        } finally {
+          cancellation.close()
         }
       }
     }
@@ -524,7 +547,11 @@ class EnrichedMarkdown
     }
 
     fun cleanup() {
+      renderCancellation?.cancel()
       executor.shutdownNow()
+      if (streamingParser.isInitialized()) {
+        streamingParser.value.close()
+      }
     }
 
     companion object {
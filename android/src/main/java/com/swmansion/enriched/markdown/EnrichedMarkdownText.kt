@@ -12,8 +12,11 @@ import android.util.Log
 import android.view.MotionEvent
 import com.facebook.react.bridge.ReadableMap
 import com.swmansion.enriched.markdown.accessibility.AccessibleMarkdownTextView
+import com.swmansion.enriched.markdown.parser.MarkdownASTNode
 import com.swmansion.enriched.markdown.parser.Md4cFlags
+import com.swmansion.enriched.markdown.parser.ParseCancellationToken
 import com.swmansion.enriched.markdown.parser.Parser
+import com.swmansion.enriched.markdown.parser.StreamingParser
 import com.swmansion.enriched.markdown.renderer.Renderer
 import com.swmansion.enriched.markdown.spoiler.SpoilerCapable
 import com.swmansion.enriched.markdown.spoiler.SpoilerOverlay
@@ -46,6 +49,7 @@ class EnrichedMarkdownText
   ) : AccessibleMarkdownTextView(context, attrs, defStyleAttr),
     SpoilerCapable {
     private val parser = Parser.shared
+    private val streamingParser = lazy { StreamingParser() }
     private val renderer = Renderer()
     private var onLinkPressCallback: ((String) -> Unit)? = null
     private var onLinkLongPressCallback: ((String) -> Unit)? = null
@@ -54,6 +58,7 @@ class EnrichedMarkdownText
     private val mainHandler = Handler(Looper.getMainLooper())
     private val executor = Executors.newSingleThreadExecutor()
     private var currentRenderId = 0L
+    private var renderCancellation: ParseCancellationToken? = null
 
     val layoutManager = EnrichedMarkdownTextLayoutManager(this)
 
@@ -200,17 +205,35 @@ class EnrichedMarkdownText
       }
     }
 
+    private fun parseMarkdown(
+      markdown: String,
+      isStreaming: Boolean,
+      cancellation: ParseCancellationToken,
+    ): MarkdownASTNode? =
+      if (isStreaming) {
+        streamingParser.value.parseMarkdown(markdown, md4cFlags)
+      } else {
+        parser.parseMarkdown(markdown, md4cFlags, cancellation)
+      }
+
     private fun scheduleRender() {
       val style = markdownStyle ?: return
       val markdown = currentMarkdown
       if (markdown.isEmpty()) return
 
+      val isStreaming = streamingAnimation
+
       val renderId = ++currentRenderId
+      // The render still in flight can no longer be applied; stop its parse.
+      renderCancellation?.cancel()
+      val cancellation = ParseCancellationToken()
+      renderCancellation = cancellation
 
       executor.execute {
         try {
+          if (cancellation.isCancelled) return@execute
           val ast =
-            parser.parseMarkdown(markdown, md4cFlags) ?: run {
+            parseMarkdown(markdown, isStreaming, cancellation) ?: run {
               mainHandler.post { if (renderId == currentRenderId) text = "" }
               return@execute
             }
@@ -226,6 +249,8 @@ class EnrichedMarkdownText
         } catch (e: Exception) {
           Log.e(TAG, "Render failed: ${e.message}", e)
           mainHandler.post { if (renderId == currentRenderId) text = "" }
+        } finally {
+          cancellation.close()
         }
       }
     }
@@ -284,6 +309,13 @@ class EnrichedMarkdownText
       applySelectionColors(selectionColor, selectionHandleColor)
     }
 
+    fun cleanup() {
+      renderCancellation?.cancel()
+      if (streamingParser.isInitialized()) {
+        streamingParser.value.close()
+      }
+    }
+
     fun emitOnLinkPress(url: String) {
       emitLinkPressEvent(url)
     }
@@ -43,6 +43,7 @@ class EnrichedMarkdownTextManager :
 
   override fun onDropViewInstance(view: EnrichedMarkdownText) {
     super.onDropViewInstance(view)
+    view.cleanup()
     MeasurementStore.clearFontScalingSettings(view.id)
     view.layoutManager.releaseMeasurementStore()
   }
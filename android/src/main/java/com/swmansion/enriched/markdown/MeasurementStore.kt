@@ -25,6 +25,7 @@ import com.swmansion.enriched.markdown.utils.common.RenderedSegment
 import com.swmansion.enriched.markdown.utils.common.StreamingMarkdownFilter
 import com.swmansion.enriched.markdown.utils.common.TableStreamingMode
 import com.swmansion.enriched.markdown.utils.common.getBooleanOrDefault
+import com.swmansion.enriched.markdown.utils.common.getIntOrDefault
 import com.swmansion.enriched.markdown.utils.common.getMapOrNull
 import com.swmansion.enriched.markdown.utils.common.getStringOrDefault
 import com.swmansion.enriched.markdown.utils.common.splitASTIntoSegments
@@ -276,6 +277,11 @@ object MeasurementStore {
         latexMath = FeatureFlags.IS_MATH_ENABLED && props.getMapOrNull("md4cFlags").getBooleanOrDefault("latexMath", true),
         superscript = props.getMapOrNull("md4cFlags").getBooleanOrDefault("superscript", false),
         subscript = props.getMapOrNull("md4cFlags").getBooleanOrDefault("subscript", false),
+        mentions = props.getMapOrNull("md4cFlags").getBooleanOrDefault("mentions", false),
+        hashtags = props.getMapOrNull("md4cFlags").getBooleanOrDefault("hashtags", false),
+        emojiShortcodes = props.getMapOrNull("md4cFlags").getBooleanOrDefault("emojiShortcodes", false),
+        maxBlocks = props.getMapOrNull("md4cFlags").getIntOrDefault("maxBlocks", 0),
+        maxSourceBytes = props.getMapOrNull("md4cFlags").getIntOrDefault("maxSourceBytes", 0),
       )
 
     val fontSize = getInitialFontSize(styleMap, context, allowFontScaling, fontScale, maxFontSizeMultiplier)
@@ -355,6 +361,11 @@ object MeasurementStore {
         latexMath = FeatureFlags.IS_MATH_ENABLED && props.getMapOrNull("md4cFlags").getBooleanOrDefault("latexMath", true),
         superscript = props.getMapOrNull("md4cFlags").getBooleanOrDefault("superscript", false),
         subscript = props.getMapOrNull("md4cFlags").getBooleanOrDefault("subscript", false),
+        mentions = props.getMapOrNull("md4cFlags").getBooleanOrDefault("mentions", false),
+        hashtags = props.getMapOrNull("md4cFlags").getBooleanOrDefault("hashtags", false),
+        emojiShortcodes = props.getMapOrNull("md4cFlags").getBooleanOrDefault("emojiShortcodes", false),
+        maxBlocks = props.getMapOrNull("md4cFlags").getIntOrDefault("maxBlocks", 0),
+        maxSourceBytes = props.getMapOrNull("md4cFlags").getIntOrDefault("maxSourceBytes", 0),
       )
     val allowTrailingMargin = props.getBooleanOrDefault("allowTrailingMargin", false)
     val fontSize = getInitialFontSize(styleMap, context, allowFontScaling, fontScale, maxFontSizeMultiplier)
@@ -0,0 +1,75 @@
+package com.swmansion.enriched.markdown.parser
+
+/**
+ * Outline, link and image URLs, task items and counts of a document, collected by the native
+ * parser in one walk and shared by every parse of the same markdown.
+ *
+ * Pass an instance to [Parser.parseMarkdown] and read it once the call returns; every call it is
+ * passed to overwrites it. Source offsets are UTF-16 indices into the parsed string, like
+ * [MarkdownASTNode.sourceStart] and [MarkdownASTNode.sourceEnd].
+ */
+class DocumentIndex {
+  data class Heading(
+    val level: Int,
+    /** The heading's text without formatting. */
+    val text: String,
+    /** GitHub-style anchor for the heading, unique within the document ("intro", "intro-1", ...). */
+    val slug: String,
+    val sourceStart: Int,
+    val sourceEnd: Int,
+  )
+
+  data class Task(
+    val checked: Boolean,
+    val sourceStart: Int,
+    val sourceEnd: Int,
+  )
+
+  // Written by the native parser in one go; the layout matches writeDocumentIndex in jni-adapter.cpp.
+  internal var values = IntArray(COUNTS)
+  internal var strings = emptyArray<String>()
+
+  /** Words are runs of non-whitespace in the document's text, also across formatting. */
+  val wordCount: Int get() = values[WORD_COUNT]
+
+  /** In code points. */
+  val characterCount: Int get() = values[CHARACTER_COUNT]
+
+  val headings: List<Heading>
+    get() =
+      List(values[HEADING_COUNT]) { i ->
+        val at = COUNTS + i * 3
+        Heading(values[at], strings[i * 2], strings[i * 2 + 1], values[at + 1], values[at + 2])
+      }
+
+  val linkUrls: List<String>
+    get() = strings.asList().subList(values[HEADING_COUNT] * 2, values[HEADING_COUNT] * 2 + values[LINK_COUNT])
+
+  val imageUrls: List<String>
+    get() = strings.asList().subList(strings.size - values[IMAGE_COUNT], strings.size)
+
+  /** In document order, so `tasks[i]` is the item with task index `i`. */
+  val tasks: List<Task>
+    get() =
+      List(values[TASK_COUNT]) { i ->
+        val at = COUNTS + values[HEADING_COUNT] * 3 + i * 3
+        Task(values[at] != 0, values[at + 1], values[at + 2])
+      }
+
+  override fun toString(): String =
+    "DocumentIndex(headings=${values[HEADING_COUNT]}, links=${values[LINK_COUNT]}, " +
+      "images=${values[IMAGE_COUNT]}, tasks=${values[TASK_COUNT]}, wordCount=$wordCount, " +
+      "characterCount=$characterCount)"
+
+  // values: the counts below, then level, start and end of every heading, then checked, start and
+  // end of every task. strings: text and slug of every heading, then link URLs, then image URLs.
+  private companion object {
+    const val WORD_COUNT = 0
+    const val CHARACTER_COUNT = 1
+    const val HEADING_COUNT = 2
+    const val LINK_COUNT = 3
+    const val IMAGE_COUNT = 4
+    const val TASK_COUNT = 5
+    const val COUNTS = 6
+  }
+}
@@ -5,6 +5,17 @@ data class MarkdownASTNode(
   val content: String = "",
   val attributes: Map<String, String> = emptyMap(),
   val children: List<MarkdownASTNode> = emptyList(),
+  /**
+   * Start and end (exclusive) of this node in the parsed markdown String, including its syntax
+   * delimiters, or -1 for nodes that were not produced by the native parser.
+   */
+  val sourceStart: Int = -1,
+  val sourceEnd: Int = -1,
+  /**
+   * Structural hash of this node and its subtree, computed by the native parser while parsing, or 0
+   * if unknown. Copies that change the subtree must leave it at 0.
+   */
+  val subtreeHash: Long = 0L,
 ) {
   enum class NodeType {
     Document,
@@ -36,7 +47,47 @@ data class MarkdownASTNode(
     Spoiler,
     Superscript,
     Subscript,
+    Mention,
+    Hashtag,
+    EmojiShortcode,
+  }
+
+  /**
+   * For a [NodeType.CodeBlock] from the native parser, the index in [codeText] at which each line
+   * starts, so a renderer can lay out or copy only some of the lines; null otherwise. Not part of
+   * [equals] or [copy].
+   */
+  var lineStarts: IntArray? = null
+    internal set
+
+  /** The text of a code block, every line ending with a line feed. */
+  val codeText: String
+    get() = children.firstOrNull()?.content ?: ""
+
+  val lineCount: Int
+    get() = lineStarts?.size ?: 0
+
+  /** Lines [first, first + count) of a code block, line feeds included, or "" without [lineStarts]. */
+  fun codeLines(
+    first: Int,
+    count: Int,
+  ): String {
+    val starts = lineStarts ?: return ""
+    val text = codeText
+    val end = (first.toLong() + count).coerceAtMost(starts.size.toLong()).toInt()
+    if (first < 0 || first >= end) return ""
+    return text.substring(starts[first], if (end < starts.size) starts[end] else text.length)
   }
 
   fun getAttribute(key: String): String? = attributes[key]
+
+  val hasSourceRange: Boolean
+    get() = sourceStart >= 0 && sourceEnd >= sourceStart
+
+  /** The markdown this node was parsed from, sliced out of [source] without re-serializing. */
+  fun sourceText(source: String): String? = if (hasSourceRange) source.substring(sourceStart, sourceEnd) else null
+
+  /** Typed view of [attributes] when the node came from the native parser. */
+  val typedAttributes: NodeAttributes?
+    get() = attributes as? NodeAttributes
 }
@@ -0,0 +1,97 @@
+package com.swmansion.enriched.markdown.parser
+
+import java.util.AbstractMap.SimpleImmutableEntry
+
+/**
+ * Typed attribute block produced by the native parser. Numbers and flags arrive as
+ * primitives instead of decimal strings, and string-keyed lookups keep working because
+ * this class is also a read-only `Map<String, String>` that formats values on demand.
+ *
+ * The bit positions in [presentMask] mirror `Markdown::AttributeKey` in
+ * cpp/parser/NodeAttributes.hpp.
+ */
+class NodeAttributes(
+  private val presentMask: Int,
+  val level: Int,
+  val url: String?,
+  val title: String?,
+  val language: String?,
+  val fenceChar: Char,
+  val isTask: Boolean,
+  val taskChecked: Boolean,
+  val align: Int,
+  val colCount: Int,
+  val headRowCount: Int,
+  val bodyRowCount: Int,
+  /** Position of a task item among all task items of the document. */
+  val taskIndex: Int,
+  /** An image that shares its paragraph with other content. */
+  val isInline: Boolean,
+) : AbstractMap<String, String>() {
+  enum class Key(
+    val attributeName: String,
+  ) {
+    LEVEL("level"),
+    URL("url"),
+    TITLE("title"),
+    FENCE_CHAR("fenceChar"),
+    LANGUAGE("language"),
+    IS_TASK("isTask"),
+    TASK_CHECKED("taskChecked"),
+    ALIGN("align"),
+    COL_COUNT("colCount"),
+    HEAD_ROW_COUNT("headRowCount"),
+    BODY_ROW_COUNT("bodyRowCount"),
+    TASK_INDEX("taskIndex"),
+    IS_INLINE("isInline"),
+    ;
+
+    companion object {
+      private val byName = values().associateBy { it.attributeName }
+
+      fun fromName(name: String): Key? = byName[name]
+    }
+  }
+
+  fun has(key: Key): Boolean = presentMask and (1 shl key.ordinal) != 0
+
+  fun format(key: Key): String? {
+    if (!has(key)) return null
+    return when (key) {
+      Key.LEVEL -> level.toString()
+      Key.URL -> url
+      Key.TITLE -> title
+      Key.FENCE_CHAR -> fenceChar.toString()
+      Key.LANGUAGE -> language
+      Key.IS_TASK -> isTask.toString()
+      Key.TASK_CHECKED -> taskChecked.toString()
+      Key.ALIGN -> ALIGN_NAMES.getOrElse(align) { ALIGN_NAMES[0] }
+      Key.COL_COUNT -> colCount.toString()
+      Key.HEAD_ROW_COUNT -> headRowCount.toString()
+      Key.BODY_ROW_COUNT -> bodyRowCount.toString()
+      Key.TASK_INDEX -> taskIndex.toString()
+      Key.IS_INLINE -> isInline.toString()
+    }
+  }
+
+  override fun get(key: String): String? = Key.fromName(key)?.let { format(it) }
+
+  override fun containsKey(key: String): Boolean = Key.fromName(key)?.let { has(it) } ?: false
+
+  override fun isEmpty(): Boolean = presentMask == 0
+
+  override val entries: Set<Map.Entry<String, String>> by lazy {
+    Key.values().mapNotNullTo(LinkedHashSet()) { key ->
+      format(key)?.let { SimpleImmutableEntry(key.attributeName, it) }
+    }
+  }
+
+  companion object {
+    /** Order matches `Markdown::CellAlign`. */
+    private val ALIGN_NAMES = arrayOf("default", "left", "center", "right")
+
+    /** Shared instance handed out by the JNI layer for nodes without attributes. */
+    @JvmField
+    val EMPTY = NodeAttributes(0, 0, null, null, null, '\u0000', false, false, 0, 0, 0, 0, 0, false)
+  }
+}
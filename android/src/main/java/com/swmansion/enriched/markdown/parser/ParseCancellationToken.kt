@@ -0,0 +1,47 @@
+package com.swmansion.enriched.markdown.parser
+
+/**
+ * Lets a render stop the parse it started once a newer render makes the result useless.
+ *
+ * [cancel] may be called from any thread; the native parse notices within a few hundred md4c
+ * callbacks and [Parser.parseMarkdown] returns null. The native control is only created when a
+ * parse actually runs, so tokens of renders that never start cost nothing. The thread that ran the
+ * parse [close]s the token once it is done with it.
+ */
+class ParseCancellationToken : AutoCloseable {
+  @Volatile
+  var isCancelled: Boolean = false
+    private set
+
+  private var handle: Long = 0L
+  private var closed = false
+
+  @Synchronized
+  fun cancel() {
+    isCancelled = true
+    if (handle != 0L) {
+      Parser.cancelParseControl(handle)
+    }
+  }
+
+  /** Returns the native control for the parse about to run, or 0 once the token is closed. */
+  @Synchronized
+  internal fun acquireHandle(): Long {
+    if (handle == 0L && !closed) {
+      handle = Parser.createParseControl()
+      if (isCancelled && handle != 0L) {
+        Parser.cancelParseControl(handle)
+      }
+    }
+    return handle
+  }
+
+  @Synchronized
+  override fun close() {
+    closed = true
+    if (handle != 0L) {
+      Parser.destroyParseControl(handle)
+      handle = 0L
+    }
+  }
+}
@@ -0,0 +1,68 @@
+package com.swmansion.enriched.markdown.parser
+
+import com.swmansion.enriched.markdown.parser.MarkdownASTNode.NodeType
+
+/**
+ * What one [Parser.parseMarkdown] call cost and what it produced, for logging slow renders.
+ *
+ * Pass an instance to parseMarkdown and read it once the call returns; every call it is passed to
+ * overwrites it. Times are in nanoseconds and split the call into the md4c parse, post-processing
+ * of the native AST and building the Kotlin [MarkdownASTNode] tree from it.
+ */
+class ParseStats {
+  // Written by the native parser in one go; the layout matches writeParseStats in jni-adapter.cpp.
+  internal val values = LongArray(NODE_COUNTS + NodeType.entries.size)
+
+  val inputBytes: Long get() = values[INPUT_BYTES]
+
+  /** The AST came from the native parse cache, so nothing was parsed. */
+  val cacheHit: Boolean get() = values[CACHE_HIT] != 0L
+
+  val nodeCount: Long get() = values[NODE_COUNT]
+
+  /** Nesting depth of the deepest node; top-level blocks are at depth 1. */
+  val maxDepth: Long get() = values[MAX_DEPTH]
+
+  /** Text the native AST had to copy rather than reference in the input. */
+  val textBytes: Long get() = values[TEXT_BYTES]
+
+  /** Native heap memory held by the parsed AST, and the number of blocks it is spread over. */
+  val residentBytes: Long get() = values[RESIDENT_BYTES]
+  val residentBlocks: Long get() = values[RESIDENT_BLOCKS]
+
+  /** Working memory md4c took from the system allocator instead of its per-thread pool. */
+  val allocations: Long get() = values[ALLOCATIONS]
+  val allocatedBytes: Long get() = values[ALLOCATED_BYTES]
+
+  val md4cNanos: Long get() = values[MD4C_NANOS]
+  val treeBuildNanos: Long get() = values[TREE_BUILD_NANOS]
+  val postProcessNanos: Long get() = values[POST_PROCESS_NANOS]
+
+  /** The whole native call, including cache lookups and anything not covered by the other times. */
+  val totalNanos: Long get() = values[TOTAL_NANOS]
+
+  fun nodeCount(type: NodeType): Long = values[NODE_COUNTS + type.ordinal]
+
+  override fun toString(): String =
+    "ParseStats(inputBytes=$inputBytes, cacheHit=$cacheHit, nodeCount=$nodeCount, maxDepth=$maxDepth, " +
+      "textBytes=$textBytes, residentBytes=$residentBytes, residentBlocks=$residentBlocks, " +
+      "allocations=$allocations, allocatedBytes=$allocatedBytes, md4cNanos=$md4cNanos, " +
+      "treeBuildNanos=$treeBuildNanos, postProcessNanos=$postProcessNanos, totalNanos=$totalNanos)"
+
+  private companion object {
+    const val INPUT_BYTES = 0
+    const val CACHE_HIT = 1
+    const val NODE_COUNT = 2
+    const val MAX_DEPTH = 3
+    const val TEXT_BYTES = 4
+    const val RESIDENT_BYTES = 5
+    const val RESIDENT_BLOCKS = 6
+    const val ALLOCATIONS = 7
+    const val ALLOCATED_BYTES = 8
+    const val MD4C_NANOS = 9
+    const val TREE_BUILD_NANOS = 10
+    const val POST_PROCESS_NANOS = 11
+    const val TOTAL_NANOS = 12
+    const val NODE_COUNTS = 13
+  }
+}
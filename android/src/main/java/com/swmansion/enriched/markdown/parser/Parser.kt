@@ -9,6 +9,17 @@ data class Md4cFlags(
   val superscript: Boolean = false,
   val subscript: Boolean = false,
   val permissiveAutolinks: Boolean = true,
+  /** `@name` mentions, `#name` hashtags and `:name:` emoji shortcodes, recognized by md4c. */
+  val mentions: Boolean = false,
+  val hashtags: Boolean = false,
+  val emojiShortcodes: Boolean = false,
+  /**
+   * Parse only the first [maxBlocks] top-level blocks, or the blocks that start within the first
+   * [maxSourceBytes] UTF-8 bytes, for collapsed messages. 0 disables a limit; streaming parses
+   * ignore both.
+   */
+  val maxBlocks: Int = 0,
+  val maxSourceBytes: Int = 0,
 ) {
   companion object {
     val DEFAULT = Md4cFlags()
@@ -33,8 +44,55 @@ class Parser {
     private external fun nativeParseMarkdown(
       markdown: String,
       flags: Md4cFlags,
+      controlHandle: Long,
+      stats: LongArray?,
+      index: DocumentIndex?,
     ): MarkdownASTNode?
 
+    @JvmStatic
+    private external fun nativeCreateParseControl(): Long
+
+    @JvmStatic
+    private external fun nativeCancelParseControl(handle: Long)
+
+    @JvmStatic
+    private external fun nativeDestroyParseControl(handle: Long)
+
+    // Kotlin mangles the JVM names of internal members, so the natives stay private to keep the
+    // names jni-adapter.cpp binds to.
+    internal fun createParseControl(): Long = nativeCreateParseControl()
+
+    internal fun cancelParseControl(handle: Long) = nativeCancelParseControl(handle)
+
+    internal fun destroyParseControl(handle: Long) = nativeDestroyParseControl(handle)
+
+    @JvmStatic
+    private external fun nativeCreateSession(): Long
+
+    @JvmStatic
+    private external fun nativeDestroySession(handle: Long)
+
+    @JvmStatic
+    private external fun nativeUpdateSession(
+      handle: Long,
+      markdown: String,
+      flags: Md4cFlags,
+      cachedBlocks: Int,
+      blockCounts: IntArray,
+    ): MarkdownASTNode?
+
+    internal fun createSession(): Long = nativeCreateSession()
+
+    internal fun destroySession(handle: Long) = nativeDestroySession(handle)
+
+    internal fun updateSession(
+      handle: Long,
+      markdown: String,
+      flags: Md4cFlags,
+      cachedBlocks: Int,
+      blockCounts: IntArray,
+    ): MarkdownASTNode? = nativeUpdateSession(handle, markdown, flags, cachedBlocks, blockCounts)
+
     /**
      * Shared parser instance. Parser is stateless and thread-safe, so it can be reused
      * across all EnrichedMarkdownText instances to avoid unnecessary allocations.
@@ -42,21 +100,33 @@ class Parser {
     val shared: Parser = Parser()
   }
 
+  /**
+   * Parses [markdown] into an AST. Returns null if the text is blank, parsing fails, or
+   * [cancellationToken] was cancelled before the parse finished. If [stats] is given, it is filled
+   * in with what the parse cost, and [index] with the document's outline, links, images, tasks and
+   * counts; both are left untouched for blank text.
+   */
   fun parseMarkdown(
     markdown: String,
     flags: Md4cFlags = Md4cFlags.DEFAULT,
+    cancellationToken: ParseCancellationToken? = null,
+    stats: ParseStats? = null,
+    index: DocumentIndex? = null,
   ): MarkdownASTNode? {
     if (markdown.isBlank()) {
       return null
     }
 
     try {
-      val ast = nativeParseMarkdown(markdown, flags)
+      val ast =
+        nativeParseMarkdown(markdown, flags, cancellationToken?.acquireHandle() ?: 0L, stats?.values, index)
 
       if (ast != null) {
         return ast
       } else {
-        Log.w("MarkdownParser", "Native parser returned null")
+        if (cancellationToken?.isCancelled != true) {
+          Log.w("MarkdownParser", "Native parser returned null")
+        }
         return null
       }
     } catch (e: Exception) {
@@ -0,0 +1,63 @@
+package com.swmansion.enriched.markdown.parser
+
+import android.util.Log
+
+/**
+ * Parser for markdown that grows at the end between calls, such as a streamed LLM response.
+ *
+ * Top-level blocks that can no longer change are parsed once by a native session and returned as
+ * the same [MarkdownASTNode] instances on later calls, so only the open tail is re-parsed and
+ * converted. Any other change to the text falls back to parsing it from the first affected block.
+ *
+ * Unlike [Parser], an instance holds per-document state: use one per view and [close] it when the
+ * view is dropped.
+ */
+class StreamingParser : AutoCloseable {
+  private var handle: Long = Parser.createSession()
+  private val stableBlocks = ArrayList<MarkdownASTNode>()
+  private val blockCounts = IntArray(2)
+
+  @Synchronized
+  fun parseMarkdown(
+    markdown: String,
+    flags: Md4cFlags = Md4cFlags.DEFAULT,
+  ): MarkdownASTNode? {
+    if (markdown.isBlank() || handle == 0L) {
+      return null
+    }
+
+    try {
+      val tail =
+        Parser.updateSession(handle, markdown, flags, stableBlocks.size, blockCounts) ?: run {
+          Log.w("MarkdownParser", "Native streaming parser returned null")
+          return null
+        }
+
+      val reused = blockCounts[0]
+      val stable = blockCounts[1]
+      stableBlocks.subList(reused, stableBlocks.size).clear()
+
+      val children = ArrayList<MarkdownASTNode>(reused + tail.children.size)
+      children.addAll(stableBlocks)
+      tail.children.forEachIndexed { index, block ->
+        if (reused + index < stable) {
+          stableBlocks.add(block)
+        }
+        children.add(block)
+      }
+      return tail.copy(children = children)
+    } catch (e: Exception) {
+      Log.e("MarkdownParser", "MD4C streaming parse failed: ${e.message}", e)
+      return null
+    }
+  }
+
+  @Synchronized
+  override fun close() {
+    if (handle != 0L) {
+      Parser.destroySession(handle)
+      handle = 0L
+      stableBlocks.clear()
+    }
+  }
+}
@@ -19,7 +19,7 @@ class HeadingRenderer(
     onLinkLongPress: ((String) -> Unit)?,
     factory: RendererFactory,
   ) {
-    val level = node.getAttribute("level")?.toIntOrNull() ?: 1
+    val level = node.typedAttributes?.level?.takeIf { it > 0 } ?: node.getAttribute("level")?.toIntOrNull() ?: 1
     val start = builder.length
 
     val headingStyle = config.style.headingStyles[level]!!
@@ -4,6 +4,7 @@ import android.text.SpannableStringBuilder
 import android.text.style.ForegroundColorSpan
 import android.text.style.StrikethroughSpan
 import com.swmansion.enriched.markdown.parser.MarkdownASTNode
+import com.swmansion.enriched.markdown.parser.NodeAttributes
 import com.swmansion.enriched.markdown.spans.BaseListSpan
 import com.swmansion.enriched.markdown.spans.OrderedListSpan
 import com.swmansion.enriched.markdown.spans.TaskListSpan
@@ -24,14 +25,17 @@ class ListItemRenderer(
     val start = builder.length
     val listType = styleContext.listType ?: return
 
-    val isTask = node.attributes["isTask"] == "true"
-    val isChecked = isTask && node.attributes["taskChecked"] == "true"
+    val typedAttributes = node.typedAttributes
+    val isTask = typedAttributes?.isTask ?: (node.attributes["isTask"] == "true")
+    val isChecked = isTask && (typedAttributes?.taskChecked ?: (node.attributes["taskChecked"] == "true"))
 
     if (listType == BlockStyleContext.ListType.ORDERED) {
       styleContext.incrementListItemNumber()
     }
 
-    val taskIndex = if (isTask) styleContext.taskItemCount++ else -1
+    // The parser numbers task items across the whole document; count them here only for nodes built without it.
+    val parsedTaskIndex = typedAttributes?.takeIf { it.has(NodeAttributes.Key.TASK_INDEX) }?.taskIndex
+    val taskIndex = if (isTask) parsedTaskIndex ?: styleContext.taskItemCount++ else -1
 
     factory.renderChildren(node, builder, onLinkPress, onLinkLongPress)
 
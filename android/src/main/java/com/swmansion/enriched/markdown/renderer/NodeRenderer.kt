@@ -93,6 +93,11 @@ class RendererFactory(
       put(MarkdownASTNode.NodeType.ListItem, ListItemRenderer(config))
       put(MarkdownASTNode.NodeType.Text, textRenderer)
       put(MarkdownASTNode.NodeType.Link, LinkRenderer(config))
+      // Tapping a mention or hashtag calls onLinkPress with its "mention:" or "hashtag:" url.
+      put(MarkdownASTNode.NodeType.Mention, LinkRenderer(config))
+      put(MarkdownASTNode.NodeType.Hashtag, LinkRenderer(config))
+      // The emoji is the child text.
+      put(MarkdownASTNode.NodeType.EmojiShortcode, DocumentRenderer())
       put(MarkdownASTNode.NodeType.Strong, StrongRenderer(config))
       put(MarkdownASTNode.NodeType.Emphasis, EmphasisRenderer(config))
       put(MarkdownASTNode.NodeType.Strikethrough, StrikethroughRenderer(config))
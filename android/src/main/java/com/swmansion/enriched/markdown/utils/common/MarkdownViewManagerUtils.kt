@@ -85,6 +85,11 @@ fun parseMd4cFlags(flags: ReadableMap?): Md4cFlags =
     latexMath = FeatureFlags.IS_MATH_ENABLED && (flags?.getBoolean("latexMath") ?: true),
     superscript = flags?.getBoolean("superscript") ?: false,
     subscript = flags?.getBoolean("subscript") ?: false,
+    mentions = flags?.getBoolean("mentions") ?: false,
+    hashtags = flags?.getBoolean("hashtags") ?: false,
+    emojiShortcodes = flags?.getBoolean("emojiShortcodes") ?: false,
+    maxBlocks = flags.getIntOrDefault("maxBlocks", 0),
+    maxSourceBytes = flags.getIntOrDefault("maxSourceBytes", 0),
   )
 
 fun parseContextMenuItems(value: ReadableArray?): List<String> =
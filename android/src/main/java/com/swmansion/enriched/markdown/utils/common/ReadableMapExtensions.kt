@@ -7,6 +7,11 @@ fun ReadableMap?.getBooleanOrDefault(
   default: Boolean,
 ): Boolean = if (this?.hasKey(key) == true) getBoolean(key) else default
 
+fun ReadableMap?.getIntOrDefault(
+  key: String,
+  default: Int,
+): Int = if (this?.hasKey(key) == true) getInt(key) else default
+
 fun ReadableMap?.getFloatOrDefault(
   key: String,
   default: Float,
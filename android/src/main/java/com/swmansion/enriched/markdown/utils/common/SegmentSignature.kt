@@ -49,6 +49,8 @@ object SegmentSignature {
 
   fun signatureForNode(node: MarkdownASTNode?): Long {
     if (node == null) return FNV_OFFSET_BASIS
+    // The native parser hashed the subtree already; only nodes built in Kotlin are walked.
+    if (node.subtreeHash != 0L) return node.subtreeHash
 
     var hash = FNV_OFFSET_BASIS
     hash = fnvMixLong(hash, node.type.ordinal.toLong())
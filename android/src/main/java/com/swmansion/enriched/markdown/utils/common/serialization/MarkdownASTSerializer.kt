@@ -82,6 +82,11 @@ object MarkdownASTSerializer {
         buffer.append(")")
       }
 
+      NodeType.EmojiShortcode -> {
+        val shortcode = node.getAttribute("title")
+        if (shortcode != null) buffer.append(shortcode) else appendChildren(node, buffer)
+      }
+
       NodeType.Image -> {
         val alt = node.getAttribute("alt") ?: ""
         val url = node.getAttribute("url") ?: ""
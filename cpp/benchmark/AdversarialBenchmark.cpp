@@ -0,0 +1,141 @@
+// Guards against superlinear parse times on hostile input: deeply nested
+// brackets, emphasis runs, backtick runs, block quotes and lists, very wide
+// tables and the like. Each pattern is parsed at two sizes, kSizeFactor
+// apart, and the benchmark fails if the larger one takes more than
+// kMaxGrowth times as long as linear scaling predicts. Cache and allocator
+// effects alone stay well below that; a quadratic pass does not.
+//
+// Usage:
+//   bash cpp/benchmark/run.sh Adversarial [size]
+// `size` is the smaller input size in bytes (64 KiB by default). The same
+// shapes, at fuzzing sizes, are checked in as the seed corpus in cpp/fuzz.
+
+#include "../parser/MD4CParser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace Markdown;
+
+namespace {
+
+constexpr size_t kSizeFactor = 8;
+// Allowed slowdown per byte of the larger input; quadratic would be kSizeFactor.
+constexpr double kMaxGrowth = 3.0;
+
+std::string repeat(const std::string &unit, size_t bytes) {
+  std::string markdown;
+  markdown.reserve(bytes + unit.size());
+  while (markdown.size() < bytes) {
+    markdown += unit;
+  }
+  return markdown;
+}
+
+std::string nested(const std::string &open, const std::string &middle, const std::string &close, size_t bytes) {
+  size_t count = bytes / (open.size() + close.size());
+  return repeat(open, count * open.size()) + middle + repeat(close, count * close.size());
+}
+
+std::string staircase(const std::string &unit, size_t maxDepth, const std::string &line, size_t bytes) {
+  std::string markdown;
+  for (size_t depth = 0; markdown.size() < bytes; depth = (depth + 1) % maxDepth) {
+    for (size_t i = 0; i < depth; ++i) {
+      markdown += unit;
+    }
+    markdown += line;
+  }
+  return markdown;
+}
+
+std::string wideTable(size_t columns, size_t bytes) {
+  std::string markdown = repeat("|a", 2 * columns) + "|\n" + repeat("|-", 2 * columns) + "|\n";
+  std::string row = repeat("|b", 2 * columns) + "|\n";
+  while (markdown.size() < bytes) {
+    markdown += row;
+  }
+  return markdown;
+}
+
+std::string backtickRuns(size_t bytes) {
+  std::string markdown;
+  for (size_t length = 1; markdown.size() < bytes; length = length % 30 + 1) {
+    markdown.append(length, '`');
+    markdown += 'a';
+  }
+  return markdown;
+}
+
+struct Pattern {
+  const char *name;
+  std::string (*generate)(size_t bytes);
+};
+
+const Pattern kPatterns[] = {
+    {"open brackets", [](size_t n) { return repeat("[", n); }},
+    {"nested links", [](size_t n) { return nested("[", "a", "](b)", n); }},
+    {"nested images", [](size_t n) { return nested("![", "a", "]", n); }},
+    {"unclosed links", [](size_t n) { return repeat("[a](", n); }},
+    {"unclosed destinations", [](size_t n) { return repeat("[a](<", n); }},
+    {"emphasis run", [](size_t n) { return repeat("*a", n); }},
+    {"mixed emphasis", [](size_t n) { return nested("*_", "x", "_", n); }},
+    {"unmatched strong", [](size_t n) { return repeat("a**b ", n / 2) + repeat("a*b ", n / 2); }},
+    {"strikethrough", [](size_t n) { return repeat("~~a ", n); }},
+    {"backtick runs", [](size_t n) { return backtickRuns(n); }},
+    {"math spans", [](size_t n) { return repeat("$$a", n); }},
+    {"spoilers", [](size_t n) { return repeat("||a", n); }},
+    {"entities", [](size_t n) { return repeat("&#", n); }},
+    {"autolinks", [](size_t n) { return repeat("<a", n); }},
+    {"www autolinks", [](size_t n) { return repeat("www.", n); }},
+    {"e-mails", [](size_t n) { return repeat("a@", n); }},
+    {"raw html", [](size_t n) { return repeat("<a ", n); }},
+    {"backslashes", [](size_t n) { return repeat("\\", n); }},
+    {"deep quote", [](size_t n) { return repeat(">", n) + "a\n"; }},
+    {"deep list", [](size_t n) { return repeat("- ", n) + "a\n"; }},
+    {"quotes and lists", [](size_t n) { return repeat("> - ", n) + "a\n"; }},
+    {"quote staircase", [](size_t n) { return staircase(">", 200, "a\n", n); }},
+    {"list staircase", [](size_t n) { return staircase("  ", 100, "- a\n", n); }},
+    {"wide table", [](size_t n) { return wideTable(1000, n); }},
+    {"empty fences", [](size_t n) { return repeat("```\n", n); }},
+    {"setext heading", [](size_t n) { return repeat("a\n", n) + "=\n"; }},
+};
+
+// Best of `runs`, in milliseconds, for the zero-copy parse plus the tree
+// conversion the platform renderers start from.
+double parseTime(const std::string &markdown, int runs) {
+  auto source = std::make_shared<const std::string>(markdown);
+  Md4cFlags flags;
+  flags.underline = true;
+  flags.superscript = true;
+  flags.subscript = true;
+  double best = 1e300;
+  for (int i = 0; i < runs; ++i) {
+    MD4CParser parser;
+    auto start = std::chrono::steady_clock::now();
+    auto ast = parser.parseFlat(source, flags);
+    ast->toTree();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  size_t size = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64 * 1024;
+
+  int failures = 0;
+  for (const Pattern &pattern : kPatterns) {
+    double small = parseTime(pattern.generate(size), 5);
+    double large = parseTime(pattern.generate(kSizeFactor * size), 5);
+    // Sub-millisecond timings are mostly noise; only judge the growth above that.
+    bool superlinear = large > 1.0 && large > kMaxGrowth * kSizeFactor * small;
+    failures += superlinear;
+    std::printf("%-24s %9.2f ms %9.2f ms  x%-5.1f %s\n", pattern.name, small, large, large / small,
+                superlinear ? "SUPERLINEAR" : "");
+  }
+  return failures > 0 ? 1 : 0;
+}
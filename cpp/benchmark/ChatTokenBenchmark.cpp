@@ -0,0 +1,113 @@
+// Measures what recognizing @mentions, #hashtags and :shortcodes: costs on
+// chat messages: a parse with the md4c token flags on against a parse without
+// them followed by the regex pass over the text that apps used to run instead.
+// Checks that both find the same tokens. Most of what the token flags add is
+// building the span nodes, which costs what it does for emphasis or links.
+//
+// Usage: bash cpp/benchmark/run.sh ChatToken
+
+#include "../parser/EmojiShortcodes.hpp"
+#include "../parser/MD4CParser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <regex>
+#include <string>
+
+using namespace Markdown;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char *const kWords[] = {"the", "build", "is", "green", "again", "after", "we", "merged", "that", "fix", "for",
+                              "review", "please", "thanks", "see", "**this**", "*later*", "today"};
+const char *const kTokens[] = {"@alice", "@bob.smith", "#general", "#release-2", ":tada:", ":+1:", ":eyes:",
+                               ":white_check_mark:", ":not_an_emoji:", "@carol"};
+
+// Short messages of words and tokens, as in a chat history.
+std::string chatDocument(size_t targetSize) {
+  std::mt19937 random(11);
+  std::string markdown;
+  while (markdown.size() < targetSize) {
+    size_t words = 4 + random() % 20;
+    for (size_t i = 0; i < words; ++i) {
+      markdown += random() % 5 == 0 ? kTokens[random() % (sizeof(kTokens) / sizeof(kTokens[0]))]
+                                    : kWords[random() % (sizeof(kWords) / sizeof(kWords[0]))];
+      markdown += ' ';
+    }
+    markdown += "\n\n";
+  }
+  return markdown;
+}
+
+size_t countTokenNodes(const FlatMarkdownAST &ast) {
+  return std::count_if(ast.nodes.begin(), ast.nodes.end(), [](const FlatNode &node) {
+    return node.type == NodeType::Mention || node.type == NodeType::Hashtag || node.type == NodeType::EmojiShortcode;
+  });
+}
+
+// What the apps did: a regex over every text node, with a table lookup for
+// shortcode candidates.
+size_t countTokensWithRegex(const FlatMarkdownAST &ast) {
+  static const std::regex kToken(
+      R"((^|\s)(@[A-Za-z0-9_.-]*[A-Za-z0-9_]|#[A-Za-z0-9_-]*[A-Za-z_][A-Za-z0-9_-]*|:[a-z0-9_+-]+:))");
+  size_t count = 0;
+  for (NodeIndex node = 0; node < ast.nodes.size(); ++node) {
+    if (ast.nodes[node].type != NodeType::Text) {
+      continue;
+    }
+    std::string_view text = ast.content(node);
+    for (std::cregex_iterator it(text.data(), text.data() + text.size(), kToken), end; it != end; ++it) {
+      std::string token = (*it)[2].str();
+      if (token[0] != ':' || !emojiForShortcode(std::string_view(token).substr(1, token.size() - 2)).empty()) {
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+double millisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+} // anonymous namespace
+
+int main() {
+  auto markdown = std::make_shared<const std::string>(chatDocument(1024 * 1024));
+  constexpr int kRuns = 5;
+
+  Md4cFlags plainFlags;
+  Md4cFlags tokenFlags;
+  tokenFlags.mentions = true;
+  tokenFlags.hashtags = true;
+  tokenFlags.emojiShortcodes = true;
+
+  MD4CParser parser;
+  double plainTime = 1e300;
+  double regexTime = 1e300;
+  double tokenTime = 1e300;
+  size_t regexTokens = 0;
+  size_t parsedTokens = 0;
+  for (int i = 0; i < kRuns; ++i) {
+    auto start = Clock::now();
+    auto plain = parser.parseFlat(markdown, plainFlags);
+    plainTime = std::min(plainTime, millisecondsSince(start));
+    regexTokens = countTokensWithRegex(*plain);
+    regexTime = std::min(regexTime, millisecondsSince(start));
+
+    start = Clock::now();
+    auto tokens = parser.parseFlat(markdown, tokenFlags);
+    tokenTime = std::min(tokenTime, millisecondsSince(start));
+    parsedTokens = countTokenNodes(*tokens);
+  }
+
+  bool identical = regexTokens == parsedTokens;
+  std::printf("input: %.2f MB, %zu tokens\n", markdown->size() / (1024.0 * 1024.0), parsedTokens);
+  std::printf("parse:               %9.2f ms\n", plainTime);
+  std::printf("parse + regex pass:  %9.2f ms (%zu tokens)\n", regexTime, regexTokens);
+  std::printf("parse with tokens:   %9.2f ms%s\n", tokenTime, identical ? "" : "  MISMATCH");
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+// Measures md_parse throughput on whole corpora, for changes to md4c's
+// per-character and per-line work (character classification, autolink and
+// entity scanning, line splitting) that the prose benchmarks barely exercise.
+//
+// Usage:
+//   bash cpp/benchmark/run.sh Corpus [file.md...]
+// With files, each one is measured, e.g. the CommonMark spec.txt from
+// https://github.com/commonmark/commonmark-spec. Without, synthetic
+// corpora are used: a mix of every block and inline construct, chat
+// messages full of permissive autolinks and e-mail addresses, and the long
+// code blocks and tables typical of LLM answers. To compare two md4c
+// revisions, run it at each one.
+
+#include "../md4c/md4c.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace {
+
+const char *const kMixedSnippets[] = {
+    "# Heading with `code` and *emphasis*\n\n",
+    "Setext heading\n---\n\n",
+    "A paragraph with **strong**, _emphasis_, ~~strike~~ and a [reference][ref].\n\n",
+    "[ref]: https://example.com/reference \"Title\"\n\n",
+    "- item one\n- item two with [a link](https://example.com/path?x=1&y=2)\n  - nested item\n\n",
+    "1. first\n2. second\n3) third\n\n",
+    "- [x] done task\n- [ ] open task\n\n",
+    "> quoted text with &amp; entities &#169; &#x1F600; and &copy;\n\n",
+    "```cpp\nint main() { return 0; }\n```\n\n",
+    "    indented code block\n\n",
+    "| a | b |\n|---|:-:|\n| 1 | 2 |\n\n",
+    "***\n\n",
+    "<div class=\"note\" data-x='y'>raw html</div>\n\n",
+    "Inline <span title=\"t\">html</span>, <https://autolink.example> and $x^2$.\n\n",
+};
+
+const char *const kLinkSnippets[] = {
+    "see https://example.com/a/b/c?query=1&other=two#frag ",
+    "or www.example.org/path_with-dashes.html ",
+    "mail someone.name+tag@mail.example.com ",
+    "(www.in-parens.example.com) ",
+    "ping http://localhost:8080/api/v1/items?id=42 ",
+    "ok, ",
+    "thanks! ",
+    "\n\n",
+};
+
+const char *const kCodeSnippets[] = {
+    "Here is the updated implementation:\n\n",
+    "```typescript\nexport function parse(input: string): Result {\n  const lines = input.split('\\n');\n"
+    "  for (const line of lines) {\n    if (line.startsWith('#')) {\n      continue;\n    }\n"
+    "    const [key, value] = line.split('=');\n    result.set(key.trim(), value?.trim() ?? '');\n  }\n"
+    "  return result;\n}\n```\n\n",
+    "```python\nclass Cache:\n    def __init__(self, capacity):\n        self.capacity = capacity\n"
+    "        self.entries = OrderedDict()\n\n    def get(self, key):\n        if key not in self.entries:\n"
+    "            return None\n        self.entries.move_to_end(key)\n        return self.entries[key]\n```\n\n",
+    "    $ npm install --save react-native-enriched-markdown\n    $ cd ios && pod install\n\n",
+};
+
+const char *const kTableSnippets[] = {
+    "| Option | Type | Default | Description |\n|--------|------|---------|-------------|\n",
+    "| `flags` | `Md4cFlags` | `{}` | Parser extensions to enable for this document |\n",
+    "| `maxWidth` | number | 320 | Maximum width of the rendered table in points |\n",
+    "| **bold** | *italic* | [link](https://example.com) | Cells with inline content |\n",
+    "\n",
+};
+
+template <size_t N> std::string corpus(const char *const (&snippets)[N], size_t targetSize) {
+  std::mt19937 random(42);
+  std::string markdown;
+  while (markdown.size() < targetSize) {
+    markdown += snippets[random() % N];
+  }
+  return markdown;
+}
+
+int onBlock(MD_BLOCKTYPE, void *, void *) {
+  return 0;
+}
+int onSpan(MD_SPANTYPE, void *, void *) {
+  return 0;
+}
+int onText(MD_TEXTTYPE, const MD_CHAR *, MD_SIZE, void *) {
+  return 0;
+}
+
+// Best of `runs`, in MB/s. Raw HTML is allowed so the HTML scanners are
+// measured too.
+double throughput(const std::string &markdown, int runs) {
+  const unsigned flags = MD_FLAG_STRIKETHROUGH | MD_FLAG_TABLES | MD_FLAG_TASKLISTS | MD_FLAG_SPOILERS |
+                         MD_FLAG_PERMISSIVEAUTOLINKS | MD_FLAG_LATEXMATHSPANS;
+  MD_PARSER parser = {0, flags, onBlock, onBlock, onSpan, onSpan, onText, nullptr, nullptr, nullptr, nullptr, 0,
+                      nullptr};
+  double best = 1e300;
+  for (int i = 0; i < runs; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    md_parse(markdown.data(), static_cast<MD_SIZE>(markdown.size()), &parser, nullptr);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return markdown.size() / (1024.0 * 1024.0) / best;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    for (int i = 1; i < argc; ++i) {
+      std::ifstream file(argv[i], std::ios::binary);
+      if (!file) {
+        std::fprintf(stderr, "Cannot read %s\n", argv[i]);
+        return 1;
+      }
+      std::string markdown((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+      std::printf("%-24s %8.1f MB/s\n", argv[i], throughput(markdown, 15));
+    }
+    return 0;
+  }
+
+  const size_t size = 4 * 1024 * 1024;
+  std::printf("%-24s %8.1f MB/s\n", "mixed constructs", throughput(corpus(kMixedSnippets, size), 7));
+  std::printf("%-24s %8.1f MB/s\n", "links and e-mails", throughput(corpus(kLinkSnippets, size), 7));
+  std::printf("%-24s %8.1f MB/s\n", "code blocks", throughput(corpus(kCodeSnippets, size), 7));
+  std::printf("%-24s %8.1f MB/s\n", "tables", throughput(corpus(kTableSnippets, size), 7));
+  return 0;
+}
@@ -0,0 +1,117 @@
+// Measures what the DocumentIndex adds to a parse: collected in the post-parse
+// pass (MD4CParser::setDocumentIndexEnabled) against the walk index() does over
+// a finished AST, for a serial parse, a parallel one and a block cache re-parse
+// after a one-character edit. Checks that both ways find the same index.
+//
+// Usage: bash cpp/benchmark/run.sh DocumentIndex
+
+#include "../parser/DocumentIndex.hpp"
+#include "../parser/MD4CParser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+using namespace Markdown;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char *const kSnippets[] = {
+    "# Overview of the *release*\n\n",
+    "## Changes\n\n",
+    "A paragraph with **strong**, _emphasis_ and a [link](https://example.com/a?b=c) to the docs, long enough "
+    "to hold a few dozen words the way an answer would.\n\n",
+    "- [x] migrate the store\n- [ ] update the docs\n  - [ ] nested task\n\n",
+    "![diagram](https://example.com/diagram.png)\n\n",
+    "Text with an inline ![icon](icon.png) image.\n\n",
+    "| name | value | notes |\n|:---|---:|:---:|\n| alpha | 1 | first |\n| beta | 22 | second |\n\n",
+    "```ts\nconst answer = 42;\n```\n\n",
+    "> Quoted text with `code`.\n\n",
+};
+
+std::string document(size_t size) {
+  std::mt19937 random(11);
+  std::string markdown;
+  while (markdown.size() < size) {
+    markdown += kSnippets[random() % (sizeof(kSnippets) / sizeof(kSnippets[0]))];
+  }
+  return markdown;
+}
+
+bool sameIndex(const DocumentIndex &a, const DocumentIndex &b) {
+  auto sameHeadings = std::equal(a.headings.begin(), a.headings.end(), b.headings.begin(), b.headings.end(),
+                                 [](const DocumentIndex::Heading &x, const DocumentIndex::Heading &y) {
+                                   return x.node == y.node && x.text == y.text && x.slug == y.slug;
+                                 });
+  auto sameTables = std::equal(a.tables.begin(), a.tables.end(), b.tables.begin(), b.tables.end(),
+                               [](const TableModel &x, const TableModel &y) {
+                                 return x.table == y.table && x.cells == y.cells &&
+                                        x.columnMaxLength == y.columnMaxLength;
+                               });
+  return sameHeadings && sameTables && a.links.size() == b.links.size() && a.images.size() == b.images.size() &&
+         a.tasks.size() == b.tasks.size() && a.wordCount == b.wordCount && a.characterCount == b.characterCount;
+}
+
+double millisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Best time of parsing and taking the index of `markdown`, with `parser` set up
+// by the caller. With a block cache, `previous` is parsed first so `markdown`
+// can reuse its blocks.
+double timeParse(MD4CParser &parser, const std::shared_ptr<const std::string> &markdown,
+                 const std::shared_ptr<const std::string> &previous, bool index, bool &identical) {
+  constexpr int kRuns = 7;
+  double best = 1e300;
+  for (int i = 0; i < kRuns; ++i) {
+    if (previous) {
+      parser.parseFlat(previous);
+    }
+    auto start = Clock::now();
+    auto ast = parser.parseFlat(markdown);
+    if (index) {
+      ast->index();
+    }
+    best = std::min(best, millisecondsSince(start));
+    if (index) {
+      identical &= sameIndex(*ast->index(), DocumentIndex::build(*ast));
+    }
+  }
+  return best;
+}
+
+} // anonymous namespace
+
+int main() {
+  auto markdown = std::make_shared<const std::string>(document(4 * 1024 * 1024));
+  std::string editedText = *markdown;
+  editedText[editedText.size() / 2] = editedText[editedText.size() / 2] == 'a' ? 'b' : 'a';
+  auto edited = std::make_shared<const std::string>(std::move(editedText));
+
+  std::printf("input: %.2f MB\n", markdown->size() / (1024.0 * 1024.0));
+  std::printf("%-22s %12s %12s %12s\n", "", "no index", "walk", "collected");
+  bool identical = true;
+  struct Setup {
+    const char *name;
+    unsigned threads;
+    bool blockCache;
+  };
+  for (Setup setup : {Setup{"serial", 1, false}, Setup{"4 threads", 4, false}, Setup{"block cache, 1 edit", 1, true}}) {
+    double times[3];
+    for (int mode = 0; mode < 3; ++mode) {
+      MD4CParser parser;
+      parser.setParallelParsing(setup.threads, 0);
+      parser.setBlockCacheEnabled(setup.blockCache);
+      parser.setDocumentIndexEnabled(mode == 2);
+      times[mode] = timeParse(parser, markdown, setup.blockCache ? edited : nullptr, mode != 0, identical);
+    }
+    std::printf("%-22s %9.2f ms %9.2f ms %9.2f ms\n", setup.name, times[0], times[1], times[2]);
+  }
+  if (!identical) {
+    std::printf("MISMATCH\n");
+  }
+  return identical ? 0 : 1;
+}
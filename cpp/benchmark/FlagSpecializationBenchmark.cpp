@@ -0,0 +1,90 @@
+// Times md_parse for each combination of the flags the app toggles, to
+// compare md4c's flag-specialized mark collection with the generic one.
+//
+// Usage:
+//   bash cpp/benchmark/run.sh FlagSpecialization [file.md]
+//   MD4C_CFLAGS=-DMD4C_NO_FLAG_SPECIALIZATION bash cpp/benchmark/run.sh FlagSpecialization [file.md]
+// The second run is the baseline without specialization.
+
+#include "../md4c/md4c.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+
+// Inline-heavy prose: md_collect_marks dominates parsing it.
+std::string syntheticDocument(size_t targetSize) {
+  std::string markdown;
+  for (size_t i = 0; markdown.size() < targetSize; ++i) {
+    markdown += "Paragraph " + std::to_string(i) +
+                " has **bold**, *italic*, `code`, ~~strike~~, a [link](https://example.com), "
+                "E = mc^2^ and H~2~O, a ||spoiler||, some $x$ math and plain words: the quick brown fox "
+                "jumps over the lazy dog, again and again, until the line is long enough.\n\n";
+  }
+  return markdown;
+}
+
+int onBlock(MD_BLOCKTYPE, void *, void *) {
+  return 0;
+}
+int onSpan(MD_SPANTYPE, void *, void *) {
+  return 0;
+}
+int onText(MD_TEXTTYPE, const MD_CHAR *, MD_SIZE, void *) {
+  return 0;
+}
+
+// Best of `runs`, in milliseconds.
+double timeParse(const std::string &markdown, unsigned flags, int runs) {
+  MD_PARSER parser = {0, flags, onBlock, onBlock, onSpan, onSpan, onText, nullptr, nullptr, nullptr, nullptr, 0,
+                      nullptr};
+  double best = 1e300;
+  for (int i = 0; i < runs; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    md_parse(markdown.data(), static_cast<MD_SIZE>(markdown.size()), &parser, nullptr);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  std::string markdown;
+  if (argc > 1) {
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+      std::fprintf(stderr, "Cannot read %s\n", argv[1]);
+      return 1;
+    }
+    markdown.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  } else {
+    markdown = syntheticDocument(4 * 1024 * 1024);
+  }
+
+  // The flags MD4CParser always passes, see md4cParserFlags().
+  const unsigned base = MD_FLAG_NOHTML | MD_FLAG_STRIKETHROUGH | MD_FLAG_TABLES | MD_FLAG_TASKLISTS |
+                        MD_FLAG_SPOILERS | MD_FLAG_PERMISSIVEAUTOLINKS | MD_FLAG_LATEXMATHSPANS;
+  struct Configuration {
+    const char *name;
+    unsigned flags;
+  } configurations[] = {
+      {"default", base},
+      {"superscript", base | MD_FLAG_SUPERSCRIPTS},
+      {"subscript", base | MD_FLAG_SUBSCRIPTS},
+      {"superscript+subscript", base | MD_FLAG_SUPERSCRIPTS | MD_FLAG_SUBSCRIPTS},
+      {"underline", base | MD_FLAG_UNDERLINE},
+  };
+
+  std::printf("input: %.2f MB\n", markdown.size() / (1024.0 * 1024.0));
+  std::printf("%-24s %10s %10s\n", "configuration", "time (ms)", "MB/s");
+  for (const Configuration &configuration : configurations) {
+    double time = timeParse(markdown, configuration.flags, 7);
+    std::printf("%-24s %10.2f %10.1f\n", configuration.name, time, markdown.size() / (1024.0 * 1024.0) / (time / 1000));
+  }
+  return 0;
+}
@@ -0,0 +1,209 @@
+// Measures what the arena-backed FlatMarkdownAST saves over the MarkdownASTNode
+// tree: parse time, heap allocations and peak heap per parse, and the time of a
+// walk over every node. The tree is what parse() hands out, one shared_ptr node
+// with its own children vector per block, span and text run; parse() builds it
+// from a flat AST, so its parse time and peak heap include that one. Checks
+// that both walks visit the same nodes with the same text.
+//
+// Usage: bash cpp/benchmark/run.sh FlatAST [file.md]
+// Without a file, a 200 KB chat transcript and a 4 MB document are used.
+
+#include "../parser/MD4CParser.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string>
+
+using namespace Markdown;
+
+namespace {
+
+std::atomic<size_t> allocationCount{0};
+std::atomic<size_t> liveBytes{0};
+std::atomic<size_t> peakBytes{0};
+
+// Every block keeps its size in front of the pointer it hands out, so the
+// live total can be kept without asking the C allocator.
+constexpr size_t kHeader = alignof(std::max_align_t);
+
+void *countedAllocation(size_t size) {
+  auto *block = static_cast<unsigned char *>(std::malloc(size + kHeader));
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<size_t *>(block) = size;
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  size_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+  size_t peak = peakBytes.load(std::memory_order_relaxed);
+  while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+  }
+  return block + kHeader;
+}
+
+void countedFree(void *pointer) {
+  if (!pointer) {
+    return;
+  }
+  auto *block = static_cast<unsigned char *>(pointer) - kHeader;
+  liveBytes.fetch_sub(*reinterpret_cast<size_t *>(block), std::memory_order_relaxed);
+  std::free(block);
+}
+
+} // anonymous namespace
+
+void *operator new(size_t size) {
+  return countedAllocation(size);
+}
+void *operator new[](size_t size) {
+  return countedAllocation(size);
+}
+void operator delete(void *pointer) noexcept {
+  countedFree(pointer);
+}
+void operator delete[](void *pointer) noexcept {
+  countedFree(pointer);
+}
+void operator delete(void *pointer, size_t) noexcept {
+  countedFree(pointer);
+}
+void operator delete[](void *pointer, size_t) noexcept {
+  countedFree(pointer);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char *const kSnippets[] = {
+    "## Summary\n\n",
+    "Sure! Here is **what changed** in the _new_ version, with a [link](https://example.com/docs?page=2) to the "
+    "docs and some `inline code`.\n\n",
+    "- first point with *emphasis*\n- second point\n  - nested ~~old~~ new\n\n",
+    "1. install the package\n2. run `npm test`\n\n",
+    "```ts\nexport function add(a: number, b: number): number {\n  return a + b;\n}\n```\n\n",
+    "> A quote  \nwith a hard break.\n\n",
+    "| key | value |\n|:---|---:|\n| alpha | 1 |\n| beta | 2 |\n\n",
+    "Thanks, that fixed it.\n\n",
+};
+
+std::string document(size_t size) {
+  std::mt19937 random(5);
+  std::string markdown;
+  while (markdown.size() < size) {
+    markdown += kSnippets[random() % (sizeof(kSnippets) / sizeof(kSnippets[0]))];
+  }
+  return markdown;
+}
+
+// What a bridge does with each node: look at its type and read its text.
+struct Walk {
+  size_t nodes = 0;
+  uint64_t hash = 1469598103934665603ull;
+
+  void visit(NodeType type, std::string_view content) {
+    ++nodes;
+    hash = (hash ^ static_cast<uint64_t>(type)) * 1099511628211ull;
+    for (char c : content) {
+      hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+  }
+};
+
+void walkTree(const MarkdownASTNode &node, Walk &walk) {
+  walk.visit(node.type, node.content);
+  for (const auto &child : node.children) {
+    walkTree(*child, walk);
+  }
+}
+
+void walkFlat(const FlatMarkdownAST &ast, NodeIndex node, Walk &walk) {
+  walk.visit(ast.nodes[node].type, ast.content(node));
+  for (NodeIndex child = ast.nodes[node].firstChild; child != kInvalidNodeIndex;
+       child = ast.nodes[child].nextSibling) {
+    walkFlat(ast, child, walk);
+  }
+}
+
+struct Result {
+  double parseTime = 1e300;
+  double walkTime = 1e300;
+  double allocations = 0;
+  double peakKilobytes = 0;
+  Walk walk;
+};
+
+double millisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Best of `runs` parses of `markdown` into the tree (`flat` false) or the flat
+// AST, with the allocations and peak heap of the last one, counted from the
+// call until the result has been walked.
+Result measure(const std::string &markdown, bool flat, int runs) {
+  MD4CParser parser;
+  Result result;
+  for (int i = 0; i < runs; ++i) {
+    size_t allocationsBefore = allocationCount.load();
+    size_t liveBefore = liveBytes.load();
+    peakBytes.store(liveBefore);
+    Walk walk;
+    if (flat) {
+      auto start = Clock::now();
+      auto ast = parser.parseFlat(markdown);
+      result.parseTime = std::min(result.parseTime, millisecondsSince(start));
+      start = Clock::now();
+      walkFlat(*ast, FlatMarkdownAST::root(), walk);
+      result.walkTime = std::min(result.walkTime, millisecondsSince(start));
+    } else {
+      auto start = Clock::now();
+      auto tree = parser.parse(markdown);
+      result.parseTime = std::min(result.parseTime, millisecondsSince(start));
+      start = Clock::now();
+      walkTree(*tree, walk);
+      result.walkTime = std::min(result.walkTime, millisecondsSince(start));
+    }
+    result.allocations = static_cast<double>(allocationCount.load() - allocationsBefore);
+    result.peakKilobytes = static_cast<double>(peakBytes.load() - liveBefore) / 1024.0;
+    result.walk = walk;
+  }
+  return result;
+}
+
+bool compare(const char *name, const std::string &markdown, int runs) {
+  Result tree = measure(markdown, false, runs);
+  Result flat = measure(markdown, true, runs);
+  bool identical = tree.walk.nodes == flat.walk.nodes && tree.walk.hash == flat.walk.hash;
+  std::printf("%s: %.2f MB, %zu nodes%s\n", name, markdown.size() / (1024.0 * 1024.0), flat.walk.nodes,
+              identical ? "" : "  MISMATCH");
+  std::printf("  %-6s %10s %10s %14s %12s\n", "", "parse", "walk", "allocations", "peak heap");
+  for (auto [label, result] : {std::pair<const char *, const Result &>{"tree", tree}, {"flat", flat}}) {
+    std::printf("  %-6s %7.2f ms %7.2f ms %14.0f %9.0f KB\n", label, result.parseTime, result.walkTime,
+                result.allocations, result.peakKilobytes);
+  }
+  return identical;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  bool identical = true;
+  if (argc > 1) {
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+      std::fprintf(stderr, "Cannot read %s\n", argv[1]);
+      return 1;
+    }
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    identical &= compare(argv[1], text, 5);
+  } else {
+    identical &= compare("chat transcript", document(200 * 1024), 20);
+    identical &= compare("large document", document(4 * 1024 * 1024), 5);
+  }
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+// Measures what decoding HTML character references costs on entity-dense,
+// HTML-ish output: the parse of a document full of references against the same
+// document with the references already decoded, and decodeHtmlEntity on its
+// own. Checks that both documents come out as the same text.
+//
+// Usage: bash cpp/benchmark/run.sh HtmlEntity
+
+#include "../parser/HtmlEntities.hpp"
+#include "../parser/MD4CParser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+using namespace Markdown;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Reference {
+  const char *entity;
+  const char *text;
+};
+
+// None of these decode to markdown syntax, so both documents parse alike.
+const Reference kReferences[] = {
+    {"&amp;", "&"},
+    {"&nbsp;", "\xC2\xA0"},
+    {"&mdash;", "\xE2\x80\x94"},
+    {"&hellip;", "\xE2\x80\xA6"},
+    {"&copy;", "\xC2\xA9"},
+    {"&rarr;", "\xE2\x86\x92"},
+    {"&eacute;", "\xC3\xA9"},
+    {"&quot;", "\""},
+    {"&CounterClockwiseContourIntegral;", "\xE2\x88\xB3"},
+    {"&#8217;", "\xE2\x80\x99"},
+    {"&#x1F600;", "\xF0\x9F\x98\x80"},
+    {"&#169;", "\xC2\xA9"},
+};
+constexpr size_t kReferenceCount = sizeof(kReferences) / sizeof(kReferences[0]);
+
+const char *const kWords[] = {"the", "result", "of", "running", "query", "is", "shown", "below", "with", "rows"};
+
+// A reference every other word, as in text an LLM escaped for HTML.
+void entityDocuments(size_t targetSize, std::string &encoded, std::string &decoded) {
+  std::mt19937 random(7);
+  while (encoded.size() < targetSize) {
+    for (int i = 0; i < 16; ++i) {
+      const char *word = kWords[random() % (sizeof(kWords) / sizeof(kWords[0]))];
+      const Reference &reference = kReferences[random() % kReferenceCount];
+      encoded += word;
+      encoded += ' ';
+      encoded += reference.entity;
+      encoded += ' ';
+      decoded += word;
+      decoded += ' ';
+      decoded += reference.text;
+      decoded += ' ';
+    }
+    encoded += "\n\n";
+    decoded += "\n\n";
+  }
+}
+
+std::string textOf(const FlatMarkdownAST &ast) {
+  std::string text;
+  for (NodeIndex node = 0; node < ast.nodes.size(); ++node) {
+    if (ast.nodes[node].type == NodeType::Text) {
+      text += ast.content(node);
+      text += '\n';
+    }
+  }
+  return text;
+}
+
+double millisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double bestParseTime(const std::shared_ptr<const std::string> &markdown, int runs) {
+  MD4CParser parser;
+  double best = 1e300;
+  for (int i = 0; i < runs; ++i) {
+    auto start = Clock::now();
+    parser.parseFlat(markdown);
+    best = std::min(best, millisecondsSince(start));
+  }
+  return best;
+}
+
+} // anonymous namespace
+
+int main() {
+  std::string encodedText;
+  std::string decodedText;
+  entityDocuments(1024 * 1024, encodedText, decodedText);
+  auto encoded = std::make_shared<const std::string>(std::move(encodedText));
+  auto decoded = std::make_shared<const std::string>(std::move(decodedText));
+  constexpr int kRuns = 5;
+
+  MD4CParser parser;
+  bool identical = textOf(*parser.parseFlat(encoded)) == textOf(*parser.parseFlat(decoded));
+  double encodedTime = bestParseTime(encoded, kRuns);
+  double decodedTime = bestParseTime(decoded, kRuns);
+
+  // Every reference of the list, over and over.
+  constexpr size_t kLookups = 10 * 1000 * 1000;
+  size_t decodedBytes = 0;
+  char buffer[4];
+  auto start = Clock::now();
+  for (size_t i = 0; i < kLookups; ++i) {
+    decodedBytes += decodeHtmlEntity(kReferences[i % kReferenceCount].entity, buffer).size();
+  }
+  double lookupTime = millisecondsSince(start);
+
+  std::printf("input: %.2f MB with references, %.2f MB decoded\n", encoded->size() / (1024.0 * 1024.0),
+              decoded->size() / (1024.0 * 1024.0));
+  std::printf("parse, references:   %9.2f ms\n", encodedTime);
+  std::printf("parse, decoded:      %9.2f ms%s\n", decodedTime, identical ? "" : "  MISMATCH");
+  std::printf("decodeHtmlEntity:    %9.2f ns per reference (%zu bytes)\n", lookupTime * 1e6 / kLookups,
+              decodedBytes);
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+// Measures the time to first render with LazyParseSession against a full
+// parse of the same document: the block scan plus the blocks of the first
+// screen, then the rest in background-sized batches. Checks that the lazily
+// parsed blocks match the full parse.
+//
+// Usage: lazy_parse_benchmark [file.md]
+// Without a file, a synthetic ~1 MB document mixing every block type is used.
+
+#include "../parser/LazyParseSession.hpp"
+#include "../parser/MD4CParser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace Markdown;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// About what fits on a phone screen.
+constexpr uint32_t kFirstScreenBytes = 4 * 1024;
+constexpr size_t kBackgroundBatch = 64;
+
+std::string syntheticDocument(size_t targetSize) {
+  std::string markdown = "[docs]: https://example.com/docs \"Docs\"\n\n";
+  for (size_t section = 0; markdown.size() < targetSize; ++section) {
+    std::string n = std::to_string(section);
+    markdown += "## Section " + n + "\n\n";
+    markdown += "Some **bold** and *italic* text with `code`, a [link](https://example.com/" + n +
+                ") and a [reference][docs]. Lorem ipsum dolor sit amet, consectetur adipiscing elit.\n\n";
+    markdown += "- [ ] first task\n- [x] second task with ~~strike~~\n  - nested item\n\n";
+    markdown += "> A quote that spans\n> two lines.\n\n";
+    markdown += "```cpp\nint main() {\n  return " + n + ";\n}\n```\n\n";
+    markdown += "| Name | Value |\n|------|------:|\n| a | " + n + " |\n| b | 2 |\n\n";
+    markdown += "Text right before math\n$$\\int_0^1 x\\,dx$$\n\n";
+  }
+  return markdown;
+}
+
+// Compares everything but task indices, which the lazy blocks count from the
+// start of their own run.
+bool sameNode(const FlatMarkdownAST &a, NodeIndex x, const FlatMarkdownAST &b, NodeIndex y) {
+  const FlatNode &nx = a.nodes[x];
+  const FlatNode &ny = b.nodes[y];
+  if (nx.type != ny.type || nx.childCount != ny.childCount || nx.sourceRange.begin != ny.sourceRange.begin ||
+      nx.sourceRange.end != ny.sourceRange.end || a.content(x) != b.content(y)) {
+    return false;
+  }
+  std::ostringstream ax, bx;
+  auto dump = [](std::ostringstream &out) {
+    return [&out](AttributeKey key, const char *name, std::string_view value) {
+      if (key != AttributeKey::TaskIndex) {
+        out << name << '=' << value << ';';
+      }
+    };
+  };
+  if (const NodeAttributes *attrs = a.attributesOf(x)) {
+    attrs->forEach(a.strings, dump(ax));
+  }
+  if (const NodeAttributes *attrs = b.attributesOf(y)) {
+    attrs->forEach(b.strings, dump(bx));
+  }
+  if (ax.str() != bx.str()) {
+    return false;
+  }
+  for (NodeIndex cx = nx.firstChild, cy = ny.firstChild; cx != kInvalidNodeIndex;
+       cx = a.nodes[cx].nextSibling, cy = b.nodes[cy].nextSibling) {
+    if (!sameNode(a, cx, b, cy)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Walks the full parse and the lazy blocks side by side.
+bool matchesFullParse(const LazyParseSession &session, const FlatMarkdownAST &expected) {
+  NodeIndex node = expected.nodes[FlatMarkdownAST::root()].firstChild;
+  for (size_t i = 0; i < session.blockCount(); ++i) {
+    LazyParseSession::ParsedBlock block = session.block(i);
+    if (!block.ast) {
+      return false;
+    }
+    NodeIndex lazy = block.firstTopLevel;
+    for (uint32_t j = 0; j < block.topLevelCount; ++j, lazy = block.ast->nodes[lazy].nextSibling) {
+      if (node == kInvalidNodeIndex || !sameNode(expected, node, *block.ast, lazy)) {
+        return false;
+      }
+      node = expected.nodes[node].nextSibling;
+    }
+  }
+  return node == kInvalidNodeIndex;
+}
+
+double millisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  std::string text;
+  if (argc > 1) {
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+      std::fprintf(stderr, "Cannot read %s\n", argv[1]);
+      return 1;
+    }
+    text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  } else {
+    text = syntheticDocument(1024 * 1024);
+  }
+  auto markdown = std::make_shared<const std::string>(std::move(text));
+  constexpr int kRuns = 5;
+
+  MD4CParser parser;
+  std::shared_ptr<const FlatMarkdownAST> expected;
+  double fullTime = 1e300;
+  for (int i = 0; i < kRuns; ++i) {
+    auto start = Clock::now();
+    expected = parser.parseFlat(markdown);
+    fullTime = std::min(fullTime, millisecondsSince(start));
+  }
+
+  double scanTime = 1e300;
+  double firstScreenTime = 1e300;
+  double restTime = 1e300;
+  size_t blockCount = 0;
+  bool identical = true;
+  for (int i = 0; i < kRuns; ++i) {
+    auto start = Clock::now();
+    LazyParseSession session(markdown);
+    scanTime = std::min(scanTime, millisecondsSince(start));
+    session.parse(0, session.blockAt(kFirstScreenBytes) + 1);
+    firstScreenTime = std::min(firstScreenTime, millisecondsSince(start));
+
+    auto restStart = Clock::now();
+    while (session.parseNext(kBackgroundBatch) > 0) {
+    }
+    restTime = std::min(restTime, millisecondsSince(restStart));
+    blockCount = session.blockCount();
+    identical = identical && matchesFullParse(session, *expected);
+  }
+
+  std::printf("input: %.2f MB, %zu blocks, %zu nodes\n", markdown->size() / (1024.0 * 1024.0), blockCount,
+              expected->size());
+  std::printf("full parse:          %9.2f ms\n", fullTime);
+  std::printf("block scan:          %9.2f ms\n", scanTime);
+  std::printf("first screen (lazy): %9.2f ms  %6.1fx faster\n", firstScreenTime, fullTime / firstScreenTime);
+  std::printf("remaining blocks:    %9.2f ms in batches of %zu%s\n", restTime, kBackgroundBatch,
+              identical ? "" : "  MISMATCH");
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// Measures MD4CParser::setParallelParsing against a serial parse of the same
+// document and checks that both produce the same AST.
+//
+// Usage: parallel_parse_benchmark [file.md]
+// Without a file, a synthetic ~8 MB document mixing every block type is used.
+
+#include "../parser/MD4CParser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace Markdown;
+
+namespace {
+
+std::string syntheticDocument(size_t targetSize) {
+  std::string markdown = "[docs]: https://example.com/docs \"Docs\"\n\n";
+  for (size_t section = 0; markdown.size() < targetSize; ++section) {
+    std::string n = std::to_string(section);
+    markdown += "## Section " + n + "\n\n";
+    markdown += "Some **bold** and *italic* text with `code`, a [link](https://example.com/" + n +
+                ") and a [reference][docs]. Lorem ipsum dolor sit amet, consectetur adipiscing elit.\n\n";
+    markdown += "- first item\n- second item with ~~strike~~\n  - nested item\n\n";
+    markdown += "> A quote that spans\n> two lines.\n\n";
+    markdown += "```cpp\nint main() {\n  return " + n + ";\n}\n```\n\n";
+    markdown += "| Name | Value |\n|------|------:|\n| a | " + n + " |\n| b | 2 |\n\n";
+    markdown += "$$\\int_0^1 x\\,dx$$\n\n";
+    // Lines BlockScanner has to end and tell blank the way md4c does.
+    markdown += "Windows line endings\r\nin a paragraph.\r\n\r\nA lone\rcarriage return\r```\rfenced\r```\r\r";
+    markdown += "A form feed\n\f\ndoes not end a paragraph.\n\n";
+  }
+  return markdown;
+}
+
+bool sameNode(const FlatMarkdownAST &a, NodeIndex x, const FlatMarkdownAST &b, NodeIndex y) {
+  const FlatNode &nx = a.nodes[x];
+  const FlatNode &ny = b.nodes[y];
+  if (nx.type != ny.type || nx.childCount != ny.childCount || nx.sourceRange.begin != ny.sourceRange.begin ||
+      nx.sourceRange.end != ny.sourceRange.end || a.content(x) != b.content(y)) {
+    return false;
+  }
+  std::ostringstream ax, bx;
+  auto dump = [](std::ostringstream &out) {
+    return [&out](AttributeKey, const char *name, std::string_view value) { out << name << '=' << value << ';'; };
+  };
+  if (const NodeAttributes *attrs = a.attributesOf(x)) {
+    attrs->forEach(a.strings, dump(ax));
+  }
+  if (const NodeAttributes *attrs = b.attributesOf(y)) {
+    attrs->forEach(b.strings, dump(bx));
+  }
+  if (ax.str() != bx.str()) {
+    return false;
+  }
+  for (NodeIndex cx = nx.firstChild, cy = ny.firstChild; cx != kInvalidNodeIndex;
+       cx = a.nodes[cx].nextSibling, cy = b.nodes[cy].nextSibling) {
+    if (!sameNode(a, cx, b, cy)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Best of `runs` wall-clock times, in milliseconds.
+double timeParse(MD4CParser &parser, const std::shared_ptr<const std::string> &markdown, int runs,
+                 std::shared_ptr<const FlatMarkdownAST> &result) {
+  double best = 1e300;
+  for (int i = 0; i < runs; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    result = parser.parseFlat(markdown);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  std::string text;
+  if (argc > 1) {
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+      std::fprintf(stderr, "Cannot read %s\n", argv[1]);
+      return 1;
+    }
+    text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  } else {
+    text = syntheticDocument(8 * 1024 * 1024);
+  }
+  auto markdown = std::make_shared<const std::string>(std::move(text));
+  constexpr int kRuns = 5;
+
+  MD4CParser serial;
+  std::shared_ptr<const FlatMarkdownAST> expected;
+  double serialTime = timeParse(serial, markdown, kRuns, expected);
+  std::printf("input: %.2f MB, %zu nodes\n", markdown->size() / (1024.0 * 1024.0), expected->size());
+  std::printf("threads  time (ms)  speedup\n");
+  std::printf("%7d  %9.2f  %6.2fx\n", 1, serialTime, 1.0);
+
+  bool identical = true;
+  for (unsigned threads : {2u, 4u, 8u}) {
+    MD4CParser parallel;
+    parallel.setParallelParsing(threads, 0);
+    std::shared_ptr<const FlatMarkdownAST> result;
+    double time = timeParse(parallel, markdown, kRuns, result);
+    bool same = result->size() == expected->size() &&
+                sameNode(*expected, FlatMarkdownAST::root(), *result, FlatMarkdownAST::root());
+    identical = identical && same;
+    std::printf("%7u  %9.2f  %6.2fx%s\n", threads, time, serialTime / time, same ? "" : "  MISMATCH");
+  }
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+// Measures md_parse throughput on prose, where md_collect_marks spends most
+// of its time skipping plain text between mark characters.
+//
+// Usage:
+//   bash cpp/benchmark/run.sh PlainTextScan [file.md]
+// md4c picks its vector code path from the target, so compare builds with
+// e.g. MD4C_CFLAGS=-DMD4C_NO_SIMD (scalar), -mssse3 or -mavx2. ARM64 builds
+// use NEON unconditionally.
+
+#include "../md4c/md4c.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace {
+
+const char *const kWords[] = {"the",   "message", "about", "tomorrow", "meeting", "we",      "should", "probably",
+                              "move",  "it",      "to",    "later",    "because", "everyone", "is",     "still",
+                              "busy",  "with",    "release", "work",   "and",     "i",        "think",  "that",
+                              "makes", "sense",   "for",   "now",      "thanks",  "ok",       "sounds", "good"};
+
+// Chat-like prose. `markEvery` controls how many words pass between two
+// inline constructs; 0 means none at all.
+std::string proseDocument(size_t targetSize, unsigned markEvery) {
+  const char *const marks[] = {"**bold**", "*it*", "`code`", "[link](https://example.com)", "~~old~~"};
+  std::mt19937 random(42);
+  std::string markdown;
+  unsigned words = 0;
+  while (markdown.size() < targetSize) {
+    unsigned sentenceLength = 8 + random() % 16;
+    for (unsigned i = 0; i < sentenceLength; ++i) {
+      if (markEvery != 0 && ++words % markEvery == 0) {
+        markdown += marks[random() % (sizeof(marks) / sizeof(marks[0]))];
+      } else {
+        markdown += kWords[random() % (sizeof(kWords) / sizeof(kWords[0]))];
+      }
+      markdown += i + 1 < sentenceLength ? " " : ". ";
+    }
+    if (random() % 4 == 0) {
+      markdown += "\n\n";
+    }
+  }
+  return markdown;
+}
+
+int onBlock(MD_BLOCKTYPE, void *, void *) {
+  return 0;
+}
+int onSpan(MD_SPANTYPE, void *, void *) {
+  return 0;
+}
+int onText(MD_TEXTTYPE, const MD_CHAR *, MD_SIZE, void *) {
+  return 0;
+}
+
+// Best of `runs`, in MB/s.
+double throughput(const std::string &markdown, int runs) {
+  const unsigned flags = MD_FLAG_NOHTML | MD_FLAG_STRIKETHROUGH | MD_FLAG_TABLES | MD_FLAG_TASKLISTS |
+                         MD_FLAG_SPOILERS | MD_FLAG_PERMISSIVEAUTOLINKS | MD_FLAG_LATEXMATHSPANS;
+  MD_PARSER parser = {0, flags, onBlock, onBlock, onSpan, onSpan, onText, nullptr, nullptr, nullptr, nullptr, 0,
+                      nullptr};
+  double best = 1e300;
+  for (int i = 0; i < runs; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    md_parse(markdown.data(), static_cast<MD_SIZE>(markdown.size()), &parser, nullptr);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return markdown.size() / (1024.0 * 1024.0) / best;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  const size_t size = 8 * 1024 * 1024;
+  if (argc > 1) {
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+      std::fprintf(stderr, "Cannot read %s\n", argv[1]);
+      return 1;
+    }
+    std::string markdown((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::printf("%-28s %8.1f MB/s\n", argv[1], throughput(markdown, 7));
+    return 0;
+  }
+
+  struct Input {
+    const char *name;
+    unsigned markEvery;
+  } inputs[] = {{"plain prose", 0}, {"prose, mark every 40 words", 40}, {"prose, mark every 8 words", 8}};
+  for (const Input &input : inputs) {
+    std::printf("%-28s %8.1f MB/s\n", input.name, throughput(proseDocument(size, input.markEvery), 7));
+  }
+  return 0;
+}
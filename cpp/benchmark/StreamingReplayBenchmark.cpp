@@ -0,0 +1,139 @@
+// Replays an LLM response arriving ten tokens at a time, with
+// StreamingParseSession against re-parsing the whole text on every update as
+// the views did. Responses of 7.5, 15 and 30 KB are replayed; the session's
+// total should about double with the length, the full re-parse's about
+// quadruple. Checks after every update that the session's blocks match a full
+// parse.
+//
+// Usage: bash cpp/benchmark/run.sh StreamingReplay [file.md]
+// With a file, only that text is replayed.
+
+#include "../parser/MD4CParser.hpp"
+#include "../parser/StreamingParseSession.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+using namespace Markdown;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Ten tokens of about four bytes each.
+constexpr size_t kChunk = 40;
+
+const char *const kSnippets[] = {
+    "## Step {n}\n\n",
+    "To get this working, first update the **configuration** so the _client_ picks up the new endpoint, then "
+    "restart the service. See the [migration guide](https://example.com/migrate?from=1&to=2) for `v2`.\n\n",
+    "- check that the cache is cleared\n- run the tests again\n  - including the slow ones\n\n",
+    "1. open the settings\n2. pick **Advanced**\n3. enable the flag\n\n",
+    "```python\ndef retry(call, attempts=3):\n    for attempt in range(attempts):\n        try:\n"
+    "            return call()\n        except TimeoutError:\n            continue\n    raise\n```\n\n",
+    "> **Note:** this only applies to\n> installs older than 2.0.\n\n",
+    "| option | default | meaning |\n|:---|:---:|---|\n| timeout | 30 | seconds |\n| retries | 3 | attempts |\n\n",
+    "Let me know if anything is unclear.\n\n",
+};
+
+std::string response(size_t size) {
+  std::mt19937 random(9);
+  std::string markdown;
+  for (int step = 1; markdown.size() < size; ++step) {
+    std::string snippet = kSnippets[random() % (sizeof(kSnippets) / sizeof(kSnippets[0]))];
+    if (auto n = snippet.find("{n}"); n != std::string::npos) {
+      snippet.replace(n, 3, std::to_string(step));
+    }
+    markdown += snippet;
+  }
+  markdown.resize(size);
+  return markdown;
+}
+
+// Top-level blocks compared by their subtree hashes, which cover types, text
+// and attributes but not source positions.
+bool sameBlocks(const FlatMarkdownAST &a, const FlatMarkdownAST &b) {
+  NodeIndex x = a.nodes[FlatMarkdownAST::root()].firstChild;
+  NodeIndex y = b.nodes[FlatMarkdownAST::root()].firstChild;
+  for (; x != kInvalidNodeIndex && y != kInvalidNodeIndex; x = a.nodes[x].nextSibling, y = b.nodes[y].nextSibling) {
+    if (a.nodes[x].type != b.nodes[y].type || a.nodes[x].hash != b.nodes[y].hash) {
+      return false;
+    }
+  }
+  return x == kInvalidNodeIndex && y == kInvalidNodeIndex;
+}
+
+double millisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double replayWithSession(const std::string &text) {
+  StreamingParseSession session;
+  auto start = Clock::now();
+  for (size_t offset = 0; offset < text.size(); offset += kChunk) {
+    session.append(std::string_view(text).substr(offset, kChunk));
+  }
+  return millisecondsSince(start);
+}
+
+double replayWithFullParse(const std::string &text) {
+  auto start = Clock::now();
+  for (size_t offset = 0; offset < text.size(); offset += kChunk) {
+    MD4CParser parser;
+    parser.parseFlat(std::make_shared<const std::string>(text, 0, std::min(offset + kChunk, text.size())));
+  }
+  return millisecondsSince(start);
+}
+
+bool matchesFullParse(const std::string &text) {
+  StreamingParseSession session;
+  MD4CParser parser;
+  for (size_t offset = 0; offset < text.size(); offset += kChunk) {
+    size_t length = std::min(offset + kChunk, text.size());
+    const FlatMarkdownAST &ast = session.append(std::string_view(text).substr(offset, kChunk));
+    auto expected = parser.parseFlat(std::make_shared<const std::string>(text, 0, length));
+    if (!sameBlocks(ast, *expected)) {
+      std::printf("MISMATCH after %zu bytes\n", length);
+      return false;
+    }
+  }
+  return true;
+}
+
+void replay(const char *name, const std::string &text) {
+  constexpr int kRuns = 5;
+  double session = 1e300;
+  double full = 1e300;
+  for (int i = 0; i < kRuns; ++i) {
+    session = std::min(session, replayWithSession(text));
+    full = std::min(full, replayWithFullParse(text));
+  }
+  std::printf("%-12s %6.1f KB %7zu %12.2f ms %12.2f ms\n", name, text.size() / 1024.0,
+              (text.size() + kChunk - 1) / kChunk, session, full);
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) {
+  std::printf("%-12s %9s %7s %15s %15s\n", "", "size", "updates", "session", "full re-parse");
+  std::string longest;
+  if (argc > 1) {
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file) {
+      std::fprintf(stderr, "Cannot read %s\n", argv[1]);
+      return 1;
+    }
+    longest.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    replay(argv[1], longest);
+  } else {
+    longest = response(30 * 1024);
+    for (size_t size : {30 * 1024 / 4, 30 * 1024 / 2}) {
+      replay("response", longest.substr(0, size));
+    }
+    replay("response", longest);
+  }
+  return matchesFullParse(longest) ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+// Measures what laying out a large table costs: a CSV dump of 5,000 rows
+// turned into a markdown table, with the table model of DocumentIndex against
+// the walk the renderers did over the materialized Table > section > row >
+// cell tree, collecting each cell's plain text to size the columns. Checks
+// that both find the same column widths.
+//
+// Usage: bash cpp/benchmark/run.sh TableModel
+
+#include "../parser/DocumentIndex.hpp"
+#include "../parser/MD4CParser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+using namespace Markdown;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char *const kValues[] = {"42", "3.14159", "Alice", "Bob", "**overdue**", "`ERR_TIMEOUT`", "2024-01-15",
+                               "Zürich", "n/a", "a somewhat longer description of the row"};
+
+// A table of `rows` rows and eight columns, as LLMs print query results.
+std::string csvTable(size_t rows) {
+  std::mt19937 random(3);
+  std::string markdown = "| id | name | city | status | code | date | score | notes |\n";
+  markdown += "|---:|:---|:---:|---|---|---|---:|---|\n";
+  for (size_t row = 0; row < rows; ++row) {
+    markdown += "| " + std::to_string(row);
+    for (int column = 1; column < 8; ++column) {
+      markdown += " | ";
+      markdown += kValues[random() % (sizeof(kValues) / sizeof(kValues[0]))];
+    }
+    markdown += " |\n";
+  }
+  return markdown;
+}
+
+size_t codePoints(const std::string &text) {
+  return std::count_if(text.begin(), text.end(), [](char c) { return (static_cast<unsigned char>(c) & 0xC0) != 0x80; });
+}
+
+std::string plainText(const MarkdownASTNode &node) {
+  std::string text = node.content;
+  for (const auto &child : node.children) {
+    text += plainText(*child);
+  }
+  return text;
+}
+
+// What the renderers did with the tree the bridges handed them.
+std::vector<uint32_t> columnWidthsFromTree(const MarkdownASTNode &document) {
+  std::vector<uint32_t> widths;
+  for (const auto &table : document.children) {
+    for (const auto &section : table->children) {
+      for (const auto &row : section->children) {
+        for (size_t column = 0; column < row->children.size(); ++column) {
+          if (widths.size() <= column) {
+            widths.resize(column + 1);
+          }
+          auto length = static_cast<uint32_t>(codePoints(plainText(*row->children[column])));
+          widths[column] = std::max(widths[column], length);
+        }
+      }
+    }
+  }
+  return widths;
+}
+
+double millisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+} // anonymous namespace
+
+int main() {
+  auto markdown = std::make_shared<const std::string>(csvTable(5000));
+  constexpr int kRuns = 5;
+
+  MD4CParser parser;
+  double parseTime = 1e300;
+  double treeTime = 1e300;
+  double modelTime = 1e300;
+  std::vector<uint32_t> treeWidths;
+  std::vector<uint32_t> modelWidths;
+  size_t cells = 0;
+  for (int i = 0; i < kRuns; ++i) {
+    auto start = Clock::now();
+    auto ast = parser.parseFlat(markdown);
+    parseTime = std::min(parseTime, millisecondsSince(start));
+
+    start = Clock::now();
+    treeWidths = columnWidthsFromTree(*ast->toTree());
+    treeTime = std::min(treeTime, millisecondsSince(start));
+
+    start = Clock::now();
+    const TableModel &table = ast->index()->tables.front();
+    modelWidths = table.columnMaxLength;
+    cells = table.cells.size();
+    modelTime = std::min(modelTime, millisecondsSince(start));
+  }
+
+  bool identical = treeWidths == modelWidths;
+  std::printf("input: %.2f MB, %zu cells\n", markdown->size() / (1024.0 * 1024.0), cells);
+  std::printf("parse:               %9.2f ms\n", parseTime);
+  std::printf("tree walk:           %9.2f ms\n", treeTime);
+  std::printf("table model:         %9.2f ms%s\n", modelTime, identical ? "" : "  MISMATCH");
+  return identical ? 0 : 1;
+}
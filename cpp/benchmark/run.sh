@@ -0,0 +1,61 @@
+#!/usr/bin/env bash
+# Build and run the native parser benchmarks with the host compiler.
+#
+# Usage:
+#   bash cpp/benchmark/run.sh                        # every benchmark
+#   bash cpp/benchmark/run.sh ParallelParse [file.md]
+#
+# Each <Name>Benchmark.cpp in this directory is one benchmark. Timings are
+# only meaningful on an otherwise idle machine. Extra compiler flags for md4c
+# can be passed in MD4C_CFLAGS, e.g. to build a baseline without one of its
+# optimizations.
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+REPO_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
+OUT_DIR="$(mktemp -d)"
+trap 'rm -rf "$OUT_DIR"' EXIT
+
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+
+"$CC" -O2 ${MD4C_CFLAGS:-} -c "$REPO_ROOT/cpp/md4c/md4c.c" -o "$OUT_DIR/md4c.o"
+
+build() {
+  "$CXX" \
+    "$SCRIPT_DIR/$1Benchmark.cpp" \
+    "$REPO_ROOT/cpp/parser/MD4CParser.cpp" \
+    "$REPO_ROOT/cpp/parser/FlatMarkdownAST.cpp" \
+    "$REPO_ROOT/cpp/parser/BlockScanner.cpp" \
+    "$REPO_ROOT/cpp/parser/DocumentIndex.cpp" \
+    "$REPO_ROOT/cpp/parser/EmojiShortcodes.cpp" \
+    "$REPO_ROOT/cpp/parser/HtmlEntities.cpp" \
+    "$REPO_ROOT/cpp/parser/LazyParseSession.cpp" \
+    "$REPO_ROOT/cpp/parser/ParseCache.cpp" \
+    "$REPO_ROOT/cpp/parser/ParserMemoryPool.cpp" \
+    "$REPO_ROOT/cpp/parser/ParseStats.cpp" \
+    "$REPO_ROOT/cpp/parser/PostParsePipeline.cpp" \
+    "$REPO_ROOT/cpp/parser/StreamingParseSession.cpp" \
+    "$OUT_DIR/md4c.o" \
+    -I "$REPO_ROOT/cpp" \
+    -O2 \
+    -std=c++17 \
+    -pthread \
+    -o "$OUT_DIR/$1"
+}
+
+if [ $# -gt 0 ]; then
+  name="$1"
+  shift
+  build "$name"
+  "$OUT_DIR/$name" "$@"
+  exit
+fi
+
+for source in "$SCRIPT_DIR"/*Benchmark.cpp; do
+  name="$(basename "$source" Benchmark.cpp)"
+  echo "== $name"
+  build "$name"
+  "$OUT_DIR/$name"
+done
@@ -0,0 +1,297 @@
+// libFuzzer entry point for the native parser. Besides crashes and sanitizer
+// reports it treats slow inputs as findings: each input has to parse (and
+// convert to the tree the renderers start from) within a time budget that
+// grows linearly with its size, so any superlinear path aborts with the input
+// that triggered it.
+//
+// Small inputs are also parsed the ways that split a document at the top-level
+// block boundaries BlockScanner finds: in parallel, lazily, truncated, streamed
+// and through the block cache. Each result has to match the serial parse node
+// for node; a mismatch means a boundary md4c would not have put there. The
+// DocumentIndex those parses collect has to match a walk over their result,
+// and the line index the streaming session keeps for a code block one built
+// from scratch.
+//
+// The first two bytes of an input select the Md4cFlags; the rest is the
+// markdown.
+// See run.sh for building and running it.
+
+#include "parser/DocumentIndex.hpp"
+#include "parser/LazyParseSession.hpp"
+#include "parser/MD4CParser.hpp"
+#include "parser/StreamingParseSession.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#ifndef PARSER_FUZZER_BASE_BUDGET_MS
+#define PARSER_FUZZER_BASE_BUDGET_MS 50
+#endif
+
+// Sanitizers slow parsing down by an order of magnitude; the per-byte budget
+// leaves room for that.
+#ifndef PARSER_FUZZER_BUDGET_NS_PER_BYTE
+#define PARSER_FUZZER_BUDGET_NS_PER_BYTE 2000
+#endif
+
+// Streaming re-parses the open tail on every chunk, which is quadratic in the
+// size of a document without boundaries.
+#ifndef PARSER_FUZZER_DIFFERENTIAL_MAX_SIZE
+#define PARSER_FUZZER_DIFFERENTIAL_MAX_SIZE 4096
+#endif
+
+using namespace Markdown;
+
+namespace {
+
+// Lazily parsed blocks count task indices from the start of their own run, so
+// those can be left out.
+bool sameNode(const FlatMarkdownAST &a, NodeIndex x, const FlatMarkdownAST &b, NodeIndex y,
+              bool taskIndices = true) {
+  const FlatNode &nx = a.nodes[x];
+  const FlatNode &ny = b.nodes[y];
+  if (nx.type != ny.type || nx.childCount != ny.childCount || nx.sourceRange.begin != ny.sourceRange.begin ||
+      nx.sourceRange.end != ny.sourceRange.end || a.content(x) != b.content(y)) {
+    return false;
+  }
+  std::ostringstream ax, bx;
+  auto dump = [taskIndices](std::ostringstream &out) {
+    return [&out, taskIndices](AttributeKey key, const char *name, std::string_view value) {
+      if (taskIndices || key != AttributeKey::TaskIndex) {
+        out << name << '=' << value << ';';
+      }
+    };
+  };
+  if (const NodeAttributes *attrs = a.attributesOf(x)) {
+    attrs->forEach(a.strings, dump(ax));
+  }
+  if (const NodeAttributes *attrs = b.attributesOf(y)) {
+    attrs->forEach(b.strings, dump(bx));
+  }
+  if (ax.str() != bx.str()) {
+    return false;
+  }
+  for (NodeIndex cx = nx.firstChild, cy = ny.firstChild; cx != kInvalidNodeIndex;
+       cx = a.nodes[cx].nextSibling, cy = b.nodes[cy].nextSibling) {
+    if (!sameNode(a, cx, b, cy, taskIndices)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+[[noreturn]] void mismatch(const char *what) {
+  std::fprintf(stderr, "%s does not match the serial parse\n", what);
+  std::abort();
+}
+
+void checkSame(const char *what, const FlatMarkdownAST &expected, const FlatMarkdownAST &actual) {
+  if (!sameNode(expected, FlatMarkdownAST::root(), actual, FlatMarkdownAST::root())) {
+    mismatch(what);
+  }
+}
+
+bool sameIndex(const DocumentIndex &a, const DocumentIndex &b) {
+  auto sameHeading = [](const DocumentIndex::Heading &x, const DocumentIndex::Heading &y) {
+    return x.node == y.node && x.level == y.level && x.text == y.text && x.slug == y.slug;
+  };
+  auto sameTarget = [](const DocumentIndex::Target &x, const DocumentIndex::Target &y) {
+    return x.node == y.node && x.url == y.url;
+  };
+  auto sameTask = [](const DocumentIndex::Task &x, const DocumentIndex::Task &y) {
+    return x.node == y.node && x.checked == y.checked;
+  };
+  auto sameTable = [](const TableModel &x, const TableModel &y) {
+    return x.table == y.table && x.columnCount == y.columnCount && x.headRowCount == y.headRowCount &&
+           x.alignments == y.alignments && x.rows == y.rows && x.cells == y.cells &&
+           x.columnMaxLength == y.columnMaxLength;
+  };
+  auto same = [](const auto &x, const auto &y, auto equal) {
+    return std::equal(x.begin(), x.end(), y.begin(), y.end(), equal);
+  };
+  return a.wordCount == b.wordCount && a.characterCount == b.characterCount &&
+         same(a.headings, b.headings, sameHeading) && same(a.links, b.links, sameTarget) &&
+         same(a.images, b.images, sameTarget) && same(a.tasks, b.tasks, sameTask) &&
+         same(a.tables, b.tables, sameTable);
+}
+
+// The index a parse collected has to be the one a walk over its result finds.
+void checkIndex(const char *what, const FlatMarkdownAST &ast) {
+  if (!sameIndex(*ast.index(), DocumentIndex::build(ast))) {
+    std::fprintf(stderr, "%s collected a different DocumentIndex than a walk finds\n", what);
+    std::abort();
+  }
+}
+
+void checkParallel(const std::shared_ptr<const std::string> &markdown, const Md4cFlags &flags,
+                   const FlatMarkdownAST &expected) {
+  MD4CParser parallel;
+  parallel.setParallelParsing(4, 0);
+  parallel.setDocumentIndexEnabled(true);
+  auto ast = parallel.parseFlat(markdown, flags);
+  checkSame("The parallel parse", expected, *ast);
+  checkIndex("The parallel parse", *ast);
+}
+
+// Parses the blocks last to first, each on its own, and walks them side by side
+// with the top-level nodes of the serial parse.
+void checkLazy(const std::shared_ptr<const std::string> &markdown, const Md4cFlags &flags,
+               const FlatMarkdownAST &expected) {
+  LazyParseSession session(markdown, flags);
+  for (size_t i = session.blockCount(); i-- > 0;) {
+    session.parse(i, i + 1);
+  }
+  NodeIndex node = expected.nodes[FlatMarkdownAST::root()].firstChild;
+  for (size_t i = 0; i < session.blockCount(); ++i) {
+    LazyParseSession::ParsedBlock block = session.block(i);
+    if (!block.ast) {
+      mismatch("A lazily parsed block");
+    }
+    NodeIndex lazy = block.firstTopLevel;
+    for (uint32_t j = 0; j < block.topLevelCount; ++j, lazy = block.ast->nodes[lazy].nextSibling) {
+      if (node == kInvalidNodeIndex || !sameNode(expected, node, *block.ast, lazy, false)) {
+        mismatch("A lazily parsed block");
+      }
+      node = expected.nodes[node].nextSibling;
+    }
+  }
+  if (node != kInvalidNodeIndex) {
+    mismatch("The lazily parsed blocks");
+  }
+}
+
+// The top-level nodes a truncated parse keeps have to be the first ones of the
+// serial parse, and the ones it drops have to start at or after truncatedAt.
+void checkTruncated(const std::shared_ptr<const std::string> &markdown, const Md4cFlags &flags,
+                    const FlatMarkdownAST &expected) {
+  MD4CParser parser;
+  parser.setDocumentIndexEnabled(true);
+  auto truncated = parser.parseFlat(markdown, flags);
+  checkIndex("A truncated parse", *truncated);
+  NodeIndex node = expected.nodes[FlatMarkdownAST::root()].firstChild;
+  for (NodeIndex kept = truncated->nodes[FlatMarkdownAST::root()].firstChild; kept != kInvalidNodeIndex;
+       kept = truncated->nodes[kept].nextSibling, node = expected.nodes[node].nextSibling) {
+    if (node == kInvalidNodeIndex || !sameNode(expected, node, *truncated, kept)) {
+      mismatch("A truncated parse");
+    }
+  }
+  uint32_t keptCount = truncated->nodes[FlatMarkdownAST::root()].childCount;
+  bool dropped = node != kInvalidNodeIndex;
+  if ((flags.maxBlocks != 0 && keptCount > flags.maxBlocks) || (dropped && !truncated->truncated) ||
+      (dropped && expected.nodes[node].sourceRange.begin < truncated->truncatedAt)) {
+    mismatch("A truncated parse");
+  }
+}
+
+// The line index the session carries over for a code block still streaming
+// in has to match one built from scratch.
+void checkCodeLines(StreamingParseSession &session, NodeIndex node) {
+  const FlatMarkdownAST &ast = session.ast();
+  for (NodeIndex child = ast.nodes[node].firstChild; child != kInvalidNodeIndex; child = ast.nodes[child].nextSibling) {
+    checkCodeLines(session, child);
+  }
+  if (ast.nodes[node].type != NodeType::CodeBlock) {
+    return;
+  }
+  NodeIndex text = ast.nodes[node].firstChild;
+  CodeLineIndex expected(text == kInvalidNodeIndex ? std::string_view() : ast.content(text),
+                         CodeLineIndex::Unit::Utf16);
+  const CodeLineIndex &lines = session.codeLines(node, CodeLineIndex::Unit::Utf16);
+  if (lines.starts() != expected.starts() || lines.range(0, UINT32_MAX) != expected.range(0, UINT32_MAX)) {
+    std::fprintf(stderr, "The streaming session kept a code line index that does not match its code block\n");
+    std::abort();
+  }
+}
+
+// Feeds the markdown in chunks of 1 to 8 bytes, so chunks end between a "\r"
+// and its "\n" as well.
+void checkStreaming(const std::string &markdown, const Md4cFlags &flags, const FlatMarkdownAST &expected) {
+  StreamingParseSession session(flags);
+  for (size_t offset = 0, chunk = 1; offset < markdown.size(); offset += chunk, chunk = chunk % 8 + 1) {
+    session.append(std::string_view(markdown).substr(offset, chunk));
+    checkCodeLines(session, FlatMarkdownAST::root());
+  }
+  checkSame("Streaming", expected, session.ast());
+}
+
+// Parses an edited copy first, so the parse of the input itself reuses the
+// blocks the edit left alone, and the other way round.
+void checkBlockCache(const std::shared_ptr<const std::string> &markdown, const Md4cFlags &flags,
+                     const FlatMarkdownAST &expected) {
+  MD4CParser cached;
+  cached.setBlockCacheEnabled(true);
+  cached.setDocumentIndexEnabled(true);
+  MD4CParser serial;
+  size_t third = markdown->size() / 3;
+  const std::string edits[] = {
+      markdown->substr(0, third) + markdown->substr(2 * third),
+      markdown->substr(0, third) + "\n\n" + markdown->substr(third),
+  };
+  for (const std::string &edit : edits) {
+    auto edited = std::make_shared<const std::string>(edit);
+    auto ast = cached.parseFlat(edited, flags);
+    checkSame("The block cache", *serial.parseFlat(edited, flags), *ast);
+    checkIndex("The block cache", *ast);
+    ast = cached.parseFlat(markdown, flags);
+    checkSame("The block cache", expected, *ast);
+    checkIndex("The block cache", *ast);
+  }
+}
+
+} // anonymous namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  if (size < 2) {
+    return 0;
+  }
+
+  Md4cFlags flags;
+  flags.underline = data[0] & 0x01;
+  flags.latexMath = data[0] & 0x02;
+  flags.superscript = data[0] & 0x04;
+  flags.subscript = data[0] & 0x08;
+  flags.permissiveAutolinks = data[0] & 0x10;
+  flags.mentions = data[1] & 0x01;
+  flags.hashtags = data[1] & 0x02;
+  flags.emojiShortcodes = data[1] & 0x04;
+  auto markdown = std::make_shared<const std::string>(reinterpret_cast<const char *>(data) + 2, size - 2);
+
+  auto start = std::chrono::steady_clock::now();
+  MD4CParser parser;
+  parser.setDocumentIndexEnabled(true);
+  auto ast = parser.parseFlat(markdown, flags);
+  if (ast) {
+    ast->toTree();
+    ast->index();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  auto budget = std::chrono::milliseconds(PARSER_FUZZER_BASE_BUDGET_MS) +
+                std::chrono::nanoseconds(PARSER_FUZZER_BUDGET_NS_PER_BYTE) * static_cast<int64_t>(size);
+  if (elapsed > budget) {
+    std::fprintf(stderr, "Parsing %zu bytes took %lld ms, over the %lld ms budget\n", size,
+                 static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()),
+                 static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(budget).count()));
+    std::abort();
+  }
+
+  if (ast && markdown->size() <= PARSER_FUZZER_DIFFERENTIAL_MAX_SIZE) {
+    checkIndex("The serial parse", *ast);
+    checkParallel(markdown, flags, *ast);
+    checkLazy(markdown, flags, *ast);
+    Md4cFlags truncated = flags;
+    truncated.maxBlocks = 1 + (data[0] >> 5);
+    checkTruncated(markdown, truncated, *ast);
+    truncated.maxBlocks = 0;
+    truncated.maxSourceBytes = static_cast<uint32_t>(markdown->size() / 2);
+    checkTruncated(markdown, truncated, *ast);
+    checkStreaming(*markdown, flags, *ast);
+    checkBlockCache(markdown, flags, *ast);
+  }
+  return 0;
+}
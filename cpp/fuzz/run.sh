@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+# Build the parser fuzzer with libFuzzer and AddressSanitizer and run it on
+# the seed corpus of adversarial inputs.
+#
+# Prerequisites: a clang with libFuzzer (Apple's Xcode clang does not ship
+# it; use Homebrew's llvm or a Linux clang).
+#
+# Usage:
+#   bash cpp/fuzz/run.sh                   # fuzz until stopped
+#   bash cpp/fuzz/run.sh -max_total_time=300
+#   bash cpp/fuzz/run.sh crash-<hash>      # reproduce a finding
+#
+# Arguments are passed to libFuzzer. New inputs go to FUZZ_OUT_DIR (under
+# $TMPDIR by default), so the checked-in corpus only changes when seeds are
+# added by hand. Besides the parser's own per-input budget, libFuzzer's
+# -timeout catches hangs.
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+REPO_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
+OUT_DIR="${FUZZ_OUT_DIR:-${TMPDIR:-/tmp}/enriched-markdown-fuzz}"
+
+CC="${CC:-clang}"
+CXX="${CXX:-clang++}"
+
+mkdir -p "$OUT_DIR/corpus"
+
+"$CC" -O1 -g -fsanitize=fuzzer-no-link,address,undefined \
+  -c "$REPO_ROOT/cpp/md4c/md4c.c" -o "$OUT_DIR/md4c.o"
+
+"$CXX" \
+  "$SCRIPT_DIR/ParserFuzzer.cpp" \
+  "$REPO_ROOT/cpp/parser/MD4CParser.cpp" \
+  "$REPO_ROOT/cpp/parser/FlatMarkdownAST.cpp" \
+  "$REPO_ROOT/cpp/parser/BlockScanner.cpp" \
+  "$REPO_ROOT/cpp/parser/DocumentIndex.cpp" \
+  "$REPO_ROOT/cpp/parser/EmojiShortcodes.cpp" \
+  "$REPO_ROOT/cpp/parser/HtmlEntities.cpp" \
+  "$REPO_ROOT/cpp/parser/LazyParseSession.cpp" \
+  "$REPO_ROOT/cpp/parser/ParserMemoryPool.cpp" \
+  "$REPO_ROOT/cpp/parser/ParseStats.cpp" \
+  "$REPO_ROOT/cpp/parser/PostParsePipeline.cpp" \
+  "$REPO_ROOT/cpp/parser/StreamingParseSession.cpp" \
+  "$OUT_DIR/md4c.o" \
+  -I "$REPO_ROOT/cpp" \
+  -O1 \
+  -g \
+  -std=c++17 \
+  -pthread \
+  -fsanitize=fuzzer,address,undefined \
+  -o "$OUT_DIR/ParserFuzzer"
+
+if [ $# -gt 0 ] && [ -f "$1" ]; then
+  exec "$OUT_DIR/ParserFuzzer" "$@"
+fi
+
+exec "$OUT_DIR/ParserFuzzer" -timeout=10 -max_len=262144 "$@" "$OUT_DIR/corpus" "$SCRIPT_DIR/corpus"
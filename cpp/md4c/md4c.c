@@ -47,6 +47,46 @@
     #endif
 #endif
 
+#if defined __GNUC__
+    #define MD_FORCE_INLINE     inline __attribute__((always_inline))
+#elif defined _MSC_VER
+    #define MD_FORCE_INLINE     __forceinline
+#else
+    #define MD_FORCE_INLINE     inline
+#endif
+
+/* Vector instruction sets used by the scanners of md4c. Chosen at build time
+ * from what the compiler targets; define MD4C_NO_SIMD to force the portable
+ * scalar loops. Searching for single characters needs just SSE2, while
+ * md_skip_plain_text() also needs a byte shuffle (SSSE3 or NEON). */
+#if !defined MD4C_NO_SIMD  &&  !defined MD4C_USE_UTF16
+    #if defined __AVX2__
+        #include <immintrin.h>
+        #define MD_SIMD_AVX2
+        #define MD_SIMD_SSSE3
+        #define MD_SIMD_SSE2
+    #elif defined __SSSE3__
+        #include <tmmintrin.h>
+        #define MD_SIMD_SSSE3
+        #define MD_SIMD_SSE2
+    #elif defined __SSE2__  ||  defined _M_X64
+        #include <emmintrin.h>
+        #define MD_SIMD_SSE2
+    #elif defined __aarch64__  ||  defined _M_ARM64
+        #include <arm_neon.h>
+        #define MD_SIMD_NEON
+    #endif
+#endif
+#if defined MD_SIMD_SSE2  ||  defined MD_SIMD_NEON
+    #define MD_SIMD
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#endif
+#if defined MD_SIMD_SSSE3  ||  defined MD_SIMD_NEON
+    #define MD_SIMD_SHUFFLE
+#endif
+
 /* Make the UTF-8 support the default. */
 #if !defined MD4C_USE_ASCII && !defined MD4C_USE_UTF8 && !defined MD4C_USE_UTF16
     #define MD4C_USE_UTF8
@@ -161,6 +201,7 @@ struct MD_MARKSTACK_tag {
 
 /* Context propagated through all the parsing. */
 typedef struct MD_CTX_tag MD_CTX;
+typedef struct MD_LINE_tag MD_LINE;
 struct MD_CTX_tag {
     /* Immutable stuff (parameters of md_parse()). */
     const CHAR* text;
@@ -168,6 +209,9 @@ struct MD_CTX_tag {
     MD_PARSER parser;
     void* userdata;
 
+    /* md_collect_marks() specialized for parser.flags. */
+    int (*collect_marks)(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_mode);
+
     /* When this is true, it allows some optimizations. */
     int doc_ends_with_newline;
 
@@ -190,12 +234,21 @@ struct MD_CTX_tag {
     MD_MARK* marks;
     int n_marks;
     int alloc_marks;
+    /* md_collect_marks() stops collecting at this many marks per block
+     * (MD_PARSER::max_inline_marks); the rest of the block is plain text. */
+    int max_marks;
 
 #if defined MD4C_USE_UTF16
     char mark_char_map[128];
 #else
     char mark_char_map[256];
 #endif
+#ifdef MD_SIMD_SHUFFLE
+    /* mark_char_map[] as two 16-entry nibble tables, see md_build_mark_scan_tables(). */
+    unsigned char mark_scan_lo[16];
+    unsigned char mark_scan_hi[16];
+    int mark_scan_usable;
+#endif
 
     /* For resolving of inline spans. */
     MD_MARKSTACK opener_stacks[18];
@@ -249,6 +302,9 @@ struct MD_CTX_tag {
     MD_BLOCK* current_block;
     int n_block_bytes;
     int alloc_block_bytes;
+    /* n_block_bytes right after the last MD_BLOCK_LI opener was pushed; while
+     * the two are equal, the list item holds nothing yet. */
+    int li_opener_block_bytes;
 
     /* For container block analysis. */
     MD_CONTAINER* containers;
@@ -263,6 +319,9 @@ struct MD_CTX_tag {
     int html_block_type;    /* For checking closing raw HTML condition. */
     int last_line_has_list_loosening_effect;
     int last_list_item_starts_with_two_blank_lines;
+
+    /* End of the last non-blank line seen; closes container source ranges. */
+    OFF last_content_end;
 };
 
 enum MD_LINETYPE_tag {
@@ -288,9 +347,10 @@ struct MD_LINE_ANALYSIS_tag {
     OFF beg;
     OFF end;
     unsigned indent;        /* Indentation level. */
+    OFF syntax_beg;         /* Start of the leaf block syntax (after any container marks). */
+    OFF syntax_end;         /* End of the raw line, before trimming and the new line. */
 };
 
-typedef struct MD_LINE_tag MD_LINE;
 struct MD_LINE_tag {
     OFF beg;
     OFF end;
@@ -308,30 +368,228 @@ struct MD_VERBATIMLINE_tag {
  ***  Helpers  ***
  *****************/
 
+/* Memory management. All working memory goes through MD_PARSER::allocator
+ * when the application provides one. */
+static void*
+md_realloc(MD_CTX* ctx, void* ptr, size_t size)
+{
+    const MD_ALLOCATOR* allocator = ctx->parser.allocator;
+    if(allocator != NULL)
+        return allocator->reallocate(ptr, size, allocator->userdata);
+    return realloc(ptr, size);
+}
+
+static void*
+md_malloc(MD_CTX* ctx, size_t size)
+{
+    return md_realloc(ctx, NULL, size);
+}
+
+static void
+md_free(MD_CTX* ctx, void* ptr)
+{
+    const MD_ALLOCATOR* allocator = ctx->parser.allocator;
+    if(allocator != NULL)
+        allocator->release(ptr, allocator->userdata);
+    else
+        free(ptr);
+}
+
 /* Character accessors. */
 #define CH(off)                 (ctx->text[(off)])
 #define STR(off)                (ctx->text + (off))
 
+/* Character classes for md_char_class[]. The first ones back the ISxxx()
+ * predicates below; the others are the fixed palettes some of the analyzers
+ * test characters against, so each of those tests is a single lookup rather
+ * than a strchr() over the palette. */
+#define MD_CHAR_WHITESPACE          0x000001
+#define MD_CHAR_PUNCT               0x000002
+#define MD_CHAR_ALPHA               0x000004
+#define MD_CHAR_DIGIT               0x000008
+#define MD_CHAR_XDIGIT              0x000010
+#define MD_CHAR_HTMLATTR_DELIM      0x000020    /* "\"'=<>`" */
+#define MD_CHAR_HTMLATTR_NAME       0x000040    /* "_.:-" */
+#define MD_CHAR_EMAIL_LOCAL         0x000080    /* ".!#$%&'*+/=?^_`{|}~-" */
+#define MD_CHAR_EMAIL_USER          0x000100    /* ".-_+" */
+#define MD_CHAR_AUTOLINK_BEFORE     0x000200    /* "({[" */
+#define MD_CHAR_AUTOLINK_AFTER      0x000400    /* ")}].!?,;" */
+#define MD_CHAR_AUTOLINK_NESTED     0x000800    /* "@:." */
+#define MD_CHAR_URL_HOST            0x001000    /* ".-_" */
+#define MD_CHAR_URL_PATH            0x002000    /* "/._" */
+#define MD_CHAR_URL_PATH_ANYWHERE   0x004000    /* "+-" */
+#define MD_CHAR_URL_QUERY           0x008000    /* "&.-+_=()" */
+#define MD_CHAR_URL_FRAGMENT        0x010000    /* ".-+_" */
+#define MD_CHAR_LIST_BULLET         0x020000    /* "-+*" */
+#define MD_CHAR_HR                  0x040000    /* "-_*" */
+#define MD_CHAR_LIST_MARK           0x080000    /* "-+*.)" */
+#define MD_CHAR_TASK_CHECK          0x100000    /* "xX " */
+
+/* Classes of the ASCII characters; everything above is classless. */
+static const uint32_t md_char_class[128] = {
+    /* 0x00   */  0,
+    /* 0x01   */  0,
+    /* 0x02   */  0,
+    /* 0x03   */  0,
+    /* 0x04   */  0,
+    /* 0x05   */  0,
+    /* 0x06   */  0,
+    /* 0x07   */  0,
+    /* 0x08   */  0,
+    /* 0x09   */  MD_CHAR_WHITESPACE,
+    /* 0x0a   */  0,
+    /* 0x0b   */  MD_CHAR_WHITESPACE,
+    /* 0x0c   */  MD_CHAR_WHITESPACE,
+    /* 0x0d   */  0,
+    /* 0x0e   */  0,
+    /* 0x0f   */  0,
+    /* 0x10   */  0,
+    /* 0x11   */  0,
+    /* 0x12   */  0,
+    /* 0x13   */  0,
+    /* 0x14   */  0,
+    /* 0x15   */  0,
+    /* 0x16   */  0,
+    /* 0x17   */  0,
+    /* 0x18   */  0,
+    /* 0x19   */  0,
+    /* 0x1a   */  0,
+    /* 0x1b   */  0,
+    /* 0x1c   */  0,
+    /* 0x1d   */  0,
+    /* 0x1e   */  0,
+    /* 0x1f   */  0,
+    /* ' '    */  MD_CHAR_WHITESPACE | MD_CHAR_TASK_CHECK,
+    /* '!'    */  MD_CHAR_PUNCT | MD_CHAR_EMAIL_LOCAL | MD_CHAR_AUTOLINK_AFTER,
+    /* '"'    */  MD_CHAR_PUNCT | MD_CHAR_HTMLATTR_DELIM,
+    /* '#'    */  MD_CHAR_PUNCT | MD_CHAR_EMAIL_LOCAL,
+    /* '$'    */  MD_CHAR_PUNCT | MD_CHAR_EMAIL_LOCAL,
+    /* '%'    */  MD_CHAR_PUNCT | MD_CHAR_EMAIL_LOCAL,
+    /* '&'    */  MD_CHAR_PUNCT | MD_CHAR_EMAIL_LOCAL | MD_CHAR_URL_QUERY,
+    /* '\''   */  MD_CHAR_PUNCT | MD_CHAR_HTMLATTR_DELIM | MD_CHAR_EMAIL_LOCAL,
+    /* '('    */  MD_CHAR_PUNCT | MD_CHAR_AUTOLINK_BEFORE | MD_CHAR_URL_QUERY,
+    /* ')'    */  MD_CHAR_PUNCT | MD_CHAR_AUTOLINK_AFTER | MD_CHAR_URL_QUERY | MD_CHAR_LIST_MARK,
+    /* '*'    */  MD_CHAR_PUNCT | MD_CHAR_EMAIL_LOCAL | MD_CHAR_LIST_BULLET | MD_CHAR_HR |
+                  MD_CHAR_LIST_MARK,
+    /* '+'    */  MD_CHAR_PUNCT | MD_CHAR_EMAIL_LOCAL | MD_CHAR_EMAIL_USER |
+                  MD_CHAR_URL_PATH_ANYWHERE | MD_CHAR_URL_QUERY | MD_CHAR_URL_FRAGMENT |
+                  MD_CHAR_LIST_BULLET | MD_CHAR_LIST_MARK,
+    /* ','    */  MD_CHAR_PUNCT | MD_CHAR_AUTOLINK_AFTER,
+    /* '-'    */  MD_CHAR_PUNCT | MD_CHAR_HTMLATTR_NAME | MD_CHAR_EMAIL_LOCAL |
+                  MD_CHAR_EMAIL_USER | MD_CHAR_URL_HOST | MD_CHAR_URL_PATH_ANYWHERE |
+                  MD_CHAR_URL_QUERY | MD_CHAR_URL_FRAGMENT | MD_CHAR_LIST_BULLET | MD_CHAR_HR |
+                  MD_CHAR_LIST_MARK,
+    /* '.'    */  MD_CHAR_PUNCT | MD_CHAR_HTMLATTR_NAME | MD_CHAR_EMAIL_LOCAL |
+                  MD_CHAR_EMAIL_USER | MD_CHAR_AUTOLINK_AFTER | MD_CHAR_AUTOLINK_NESTED |
+                  MD_CHAR_URL_HOST | MD_CHAR_URL_PATH | MD_CHAR_URL_QUERY | MD_CHAR_URL_FRAGMENT |
+                  MD_CHAR_LIST_MARK,
+    /* '/'    */  MD_CHAR_PUNCT | MD_CHAR_EMAIL_LOCAL | MD_CHAR_URL_PATH,
+    /* '0'    */  MD_CHAR_DIGIT | MD_CHAR_XDIGIT,
+    /* '1'    */  MD_CHAR_DIGIT | MD_CHAR_XDIGIT,
+    /* '2'    */  MD_CHAR_DIGIT | MD_CHAR_XDIGIT,
+    /* '3'    */  MD_CHAR_DIGIT | MD_CHAR_XDIGIT,
+    /* '4'    */  MD_CHAR_DIGIT | MD_CHAR_XDIGIT,
+    /* '5'    */  MD_CHAR_DIGIT | MD_CHAR_XDIGIT,
+    /* '6'    */  MD_CHAR_DIGIT | MD_CHAR_XDIGIT,
+    /* '7'    */  MD_CHAR_DIGIT | MD_CHAR_XDIGIT,
+    /* '8'    */  MD_CHAR_DIGIT | MD_CHAR_XDIGIT,
+    /* '9'    */  MD_CHAR_DIGIT | MD_CHAR_XDIGIT,
+    /* ':'    */  MD_CHAR_PUNCT | MD_CHAR_HTMLATTR_NAME | MD_CHAR_AUTOLINK_NESTED,
+    /* ';'    */  MD_CHAR_PUNCT | MD_CHAR_AUTOLINK_AFTER,
+    /* '<'    */  MD_CHAR_PUNCT | MD_CHAR_HTMLATTR_DELIM,
+    /* '='    */  MD_CHAR_PUNCT | MD_CHAR_HTMLATTR_DELIM | MD_CHAR_EMAIL_LOCAL | MD_CHAR_URL_QUERY,
+    /* '>'    */  MD_CHAR_PUNCT | MD_CHAR_HTMLATTR_DELIM,
+    /* '?'    */  MD_CHAR_PUNCT | MD_CHAR_EMAIL_LOCAL | MD_CHAR_AUTOLINK_AFTER,
+    /* '@'    */  MD_CHAR_PUNCT | MD_CHAR_AUTOLINK_NESTED,
+    /* 'A'    */  MD_CHAR_ALPHA | MD_CHAR_XDIGIT,
+    /* 'B'    */  MD_CHAR_ALPHA | MD_CHAR_XDIGIT,
+    /* 'C'    */  MD_CHAR_ALPHA | MD_CHAR_XDIGIT,
+    /* 'D'    */  MD_CHAR_ALPHA | MD_CHAR_XDIGIT,
+    /* 'E'    */  MD_CHAR_ALPHA | MD_CHAR_XDIGIT,
+    /* 'F'    */  MD_CHAR_ALPHA | MD_CHAR_XDIGIT,
+    /* 'G'    */  MD_CHAR_ALPHA,
+    /* 'H'    */  MD_CHAR_ALPHA,
+    /* 'I'    */  MD_CHAR_ALPHA,
+    /* 'J'    */  MD_CHAR_ALPHA,
+    /* 'K'    */  MD_CHAR_ALPHA,
+    /* 'L'    */  MD_CHAR_ALPHA,
+    /* 'M'    */  MD_CHAR_ALPHA,
+    /* 'N'    */  MD_CHAR_ALPHA,
+    /* 'O'    */  MD_CHAR_ALPHA,
+    /* 'P'    */  MD_CHAR_ALPHA,
+    /* 'Q'    */  MD_CHAR_ALPHA,
+    /* 'R'    */  MD_CHAR_ALPHA,
+    /* 'S'    */  MD_CHAR_ALPHA,
+    /* 'T'    */  MD_CHAR_ALPHA,
+    /* 'U'    */  MD_CHAR_ALPHA,
+    /* 'V'    */  MD_CHAR_ALPHA,
+    /* 'W'    */  MD_CHAR_ALPHA,
+    /* 'X'    */  MD_CHAR_ALPHA | MD_CHAR_TASK_CHECK,
+    /* 'Y'    */  MD_CHAR_ALPHA,
+    /* 'Z'    */  MD_CHAR_ALPHA,
+    /* '['    */  MD_CHAR_PUNCT | MD_CHAR_AUTOLINK_BEFORE,
+    /* '\\'   */  MD_CHAR_PUNCT,
+    /* ']'    */  MD_CHAR_PUNCT | MD_CHAR_AUTOLINK_AFTER,
+    /* '^'    */  MD_CHAR_PUNCT | MD_CHAR_EMAIL_LOCAL,
+    /* '_'    */  MD_CHAR_PUNCT | MD_CHAR_HTMLATTR_NAME | MD_CHAR_EMAIL_LOCAL |
+                  MD_CHAR_EMAIL_USER | MD_CHAR_URL_HOST | MD_CHAR_URL_PATH | MD_CHAR_URL_QUERY |
+                  MD_CHAR_URL_FRAGMENT | MD_CHAR_HR,
+    /* '`'    */  MD_CHAR_PUNCT | MD_CHAR_HTMLATTR_DELIM | MD_CHAR_EMAIL_LOCAL,
+    /* 'a'    */  MD_CHAR_ALPHA | MD_CHAR_XDIGIT,
+    /* 'b'    */  MD_CHAR_ALPHA | MD_CHAR_XDIGIT,
+    /* 'c'    */  MD_CHAR_ALPHA | MD_CHAR_XDIGIT,
+    /* 'd'    */  MD_CHAR_ALPHA | MD_CHAR_XDIGIT,
+    /* 'e'    */  MD_CHAR_ALPHA | MD_CHAR_XDIGIT,
+    /* 'f'    */  MD_CHAR_ALPHA | MD_CHAR_XDIGIT,
+    /* 'g'    */  MD_CHAR_ALPHA,
+    /* 'h'    */  MD_CHAR_ALPHA,
+    /* 'i'    */  MD_CHAR_ALPHA,
+    /* 'j'    */  MD_CHAR_ALPHA,
+    /* 'k'    */  MD_CHAR_ALPHA,
+    /* 'l'    */  MD_CHAR_ALPHA,
+    /* 'm'    */  MD_CHAR_ALPHA,
+    /* 'n'    */  MD_CHAR_ALPHA,
+    /* 'o'    */  MD_CHAR_ALPHA,
+    /* 'p'    */  MD_CHAR_ALPHA,
+    /* 'q'    */  MD_CHAR_ALPHA,
+    /* 'r'    */  MD_CHAR_ALPHA,
+    /* 's'    */  MD_CHAR_ALPHA,
+    /* 't'    */  MD_CHAR_ALPHA,
+    /* 'u'    */  MD_CHAR_ALPHA,
+    /* 'v'    */  MD_CHAR_ALPHA,
+    /* 'w'    */  MD_CHAR_ALPHA,
+    /* 'x'    */  MD_CHAR_ALPHA | MD_CHAR_TASK_CHECK,
+    /* 'y'    */  MD_CHAR_ALPHA,
+    /* 'z'    */  MD_CHAR_ALPHA,
+    /* '{'    */  MD_CHAR_PUNCT | MD_CHAR_EMAIL_LOCAL | MD_CHAR_AUTOLINK_BEFORE,
+    /* '|'    */  MD_CHAR_PUNCT | MD_CHAR_EMAIL_LOCAL,
+    /* '}'    */  MD_CHAR_PUNCT | MD_CHAR_EMAIL_LOCAL | MD_CHAR_AUTOLINK_AFTER,
+    /* '~'    */  MD_CHAR_PUNCT | MD_CHAR_EMAIL_LOCAL,
+    /* 0x7f   */  0,
+};
+
 /* Character classification.
  * Note we assume ASCII compatibility of code points < 128 here. */
 #define ISIN_(ch, ch_min, ch_max)       ((ch_min) <= (unsigned)(ch) && (unsigned)(ch) <= (ch_max))
 #define ISANYOF_(ch, palette)           ((ch) != _T('\0')  &&  md_strchr((palette), (ch)) != NULL)
+#define ISCLASS_(ch, classes)           ((unsigned)(ch) < 128  &&  (md_char_class[(unsigned)(ch)] & (classes)) != 0)
 #define ISANYOF2_(ch, ch1, ch2)         ((ch) == (ch1) || (ch) == (ch2))
 #define ISANYOF3_(ch, ch1, ch2, ch3)    ((ch) == (ch1) || (ch) == (ch2) || (ch) == (ch3))
 #define ISASCII_(ch)                    ((unsigned)(ch) <= 127)
 #define ISBLANK_(ch)                    (ISANYOF2_((ch), _T(' '), _T('\t')))
 #define ISNEWLINE_(ch)                  (ISANYOF2_((ch), _T('\r'), _T('\n')))
-#define ISWHITESPACE_(ch)               (ISBLANK_(ch) || ISANYOF2_((ch), _T('\v'), _T('\f')))
+#define ISWHITESPACE_(ch)               ISCLASS_((ch), MD_CHAR_WHITESPACE)
 #define ISCNTRL_(ch)                    ((unsigned)(ch) <= 31 || (unsigned)(ch) == 127)
-#define ISPUNCT_(ch)                    (ISIN_(ch, 33, 47) || ISIN_(ch, 58, 64) || ISIN_(ch, 91, 96) || ISIN_(ch, 123, 126))
+#define ISPUNCT_(ch)                    ISCLASS_((ch), MD_CHAR_PUNCT)
 #define ISUPPER_(ch)                    (ISIN_(ch, _T('A'), _T('Z')))
 #define ISLOWER_(ch)                    (ISIN_(ch, _T('a'), _T('z')))
-#define ISALPHA_(ch)                    (ISUPPER_(ch) || ISLOWER_(ch))
+#define ISALPHA_(ch)                    ISCLASS_((ch), MD_CHAR_ALPHA)
 #define ISDIGIT_(ch)                    (ISIN_(ch, _T('0'), _T('9')))
-#define ISXDIGIT_(ch)                   (ISDIGIT_(ch) || ISIN_(ch, _T('A'), _T('F')) || ISIN_(ch, _T('a'), _T('f')))
-#define ISALNUM_(ch)                    (ISALPHA_(ch) || ISDIGIT_(ch))
+#define ISXDIGIT_(ch)                   ISCLASS_((ch), MD_CHAR_XDIGIT)
+#define ISALNUM_(ch)                    ISCLASS_((ch), MD_CHAR_ALPHA | MD_CHAR_DIGIT)
 
 #define ISANYOF(off, palette)           ISANYOF_(CH(off), (palette))
+#define ISCLASS(off, classes)           ISCLASS_(CH(off), (classes))
 #define ISANYOF2(off, ch1, ch2)         ISANYOF2_(CH(off), (ch1), (ch2))
 #define ISANYOF3(off, ch1, ch2, ch3)    ISANYOF3_(CH(off), (ch1), (ch2), (ch3))
 #define ISASCII(off)                    ISASCII_(CH(off))
@@ -425,7 +683,7 @@ md_text_with_null_replacement(MD_CTX* ctx, MD_TEXTTYPE type, const CHAR* str, SZ
             CHAR* new_buffer;                                               \
             SZ new_size = ((sz) + (sz) / 2 + 128) & ~127;                   \
                                                                             \
-            new_buffer = realloc(ctx->buffer, new_size);                    \
+            new_buffer = md_realloc(ctx, ctx->buffer, new_size);            \
             if(new_buffer == NULL) {                                        \
                 MD_LOG("realloc() failed.");                                \
                 ret = -1;                                                   \
@@ -474,6 +732,12 @@ md_text_with_null_replacement(MD_CTX* ctx, MD_TEXTTYPE type, const CHAR* str, SZ
         }                                                                   \
     } while(0)
 
+#define MD_SOURCE_OFFSET(off)                                               \
+    do {                                                                    \
+        if(ctx->parser.source_offset != NULL)                               \
+            ctx->parser.source_offset((MD_OFFSET)(off), ctx->userdata);     \
+    } while(0)
+
 #define MD_TEXT(type, str, size)                                            \
     do {                                                                    \
         if(size > 0) {                                                      \
@@ -1039,7 +1303,7 @@ md_merge_lines_alloc(MD_CTX* ctx, OFF beg, OFF end, const MD_LINE* lines, MD_SIZ
 {
     CHAR* buffer;
 
-    buffer = (CHAR*) malloc(sizeof(CHAR) * (end - beg));
+    buffer = (CHAR*) md_malloc(ctx, sizeof(CHAR) * (end - beg));
     if(buffer == NULL) {
         MD_LOG("malloc() failed.");
         return -1;
@@ -1124,7 +1388,7 @@ md_is_html_tag(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, OFF beg, OFF
     while(1) {
         while(off < line_end  &&  !ISNEWLINE(off)) {
             if(attr_state > 40) {
-                if(attr_state == 41 && (ISBLANK(off) || ISANYOF(off, _T("\"'=<>`")))) {
+                if(attr_state == 41 && (ISBLANK(off) || ISCLASS(off, MD_CHAR_HTMLATTR_DELIM))) {
                     attr_state = 0;
                     off--;  /* Put the char back for re-inspection in the new state. */
                 } else if(attr_state == 42 && CH(off) == _T('\'')) {
@@ -1147,7 +1411,7 @@ md_is_html_tag(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, OFF beg, OFF
             } else if((attr_state == 1 || attr_state == 2) && (ISALPHA(off) || CH(off) == _T('_') || CH(off) == _T(':'))) {
                 off++;
                 /* Attribute name */
-                while(off < line_end && (ISALNUM(off) || ISANYOF(off, _T("_.:-"))))
+                while(off < line_end && (ISALNUM(off) || ISCLASS(off, MD_CHAR_HTMLATTR_NAME)))
                     off++;
                 attr_state = 2;
             } else if(attr_state == 2 && CH(off) == _T('=')) {
@@ -1160,7 +1424,7 @@ md_is_html_tag(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, OFF beg, OFF
                     attr_state = 43;
                 else if(CH(off) == _T('\''))
                     attr_state = 42;
-                else if(!ISANYOF(off, _T("\"'=<>`"))  &&  !ISNEWLINE(off))
+                else if(!ISCLASS(off, MD_CHAR_HTMLATTR_DELIM)  &&  !ISNEWLINE(off))
                     attr_state = 41;
                 else
                     return FALSE;
@@ -1441,18 +1705,18 @@ md_build_attr_append_substr(MD_CTX* ctx, MD_ATTRIBUTE_BUILD* build,
         build->substr_alloc = (build->substr_alloc > 0
                 ? build->substr_alloc + build->substr_alloc / 2
                 : 8);
-        new_substr_types = (MD_TEXTTYPE*) realloc(build->substr_types,
+        new_substr_types = (MD_TEXTTYPE*) md_realloc(ctx, build->substr_types,
                                     build->substr_alloc * sizeof(MD_TEXTTYPE));
         if(new_substr_types == NULL) {
             MD_LOG("realloc() failed.");
             return -1;
         }
         /* Note +1 to reserve space for final offset (== raw_size). */
-        new_substr_offsets = (OFF*) realloc(build->substr_offsets,
+        new_substr_offsets = (OFF*) md_realloc(ctx, build->substr_offsets,
                                     (build->substr_alloc+1) * sizeof(OFF));
         if(new_substr_offsets == NULL) {
             MD_LOG("realloc() failed.");
-            free(new_substr_types);
+            md_free(ctx, new_substr_types);
             return -1;
         }
 
@@ -1472,9 +1736,9 @@ md_free_attribute(MD_CTX* ctx, MD_ATTRIBUTE_BUILD* build)
     MD_UNUSED(ctx);
 
     if(build->substr_alloc > 0) {
-        free(build->text);
-        free(build->substr_types);
-        free(build->substr_offsets);
+        md_free(ctx, build->text);
+        md_free(ctx, build->substr_types);
+        md_free(ctx, build->substr_offsets);
     }
 }
 
@@ -1509,7 +1773,7 @@ md_build_attribute(MD_CTX* ctx, const CHAR* raw_text, SZ raw_size,
         build->trivial_offsets[1] = raw_size;
         off = raw_size;
     } else {
-        build->text = (CHAR*) malloc(raw_size * sizeof(CHAR));
+        build->text = (CHAR*) md_malloc(ctx, raw_size * sizeof(CHAR));
         if(build->text == NULL) {
             MD_LOG("malloc() failed.");
             goto abort;
@@ -1753,7 +2017,7 @@ md_build_ref_def_hashtable(MD_CTX* ctx)
         return 0;
 
     ctx->ref_def_hashtable_size = (ctx->n_ref_defs * 5) / 4;
-    ctx->ref_def_hashtable = malloc(ctx->ref_def_hashtable_size * sizeof(void*));
+    ctx->ref_def_hashtable = md_malloc(ctx, ctx->ref_def_hashtable_size * sizeof(void*));
     if(ctx->ref_def_hashtable == NULL) {
         MD_LOG("malloc() failed.");
         goto abort;
@@ -1792,7 +2056,7 @@ md_build_ref_def_hashtable(MD_CTX* ctx)
             }
 
             /* Make the bucket complex, i.e. able to hold more ref. defs. */
-            list = (MD_REF_DEF_LIST*) malloc(sizeof(MD_REF_DEF_LIST) + 2 * sizeof(MD_REF_DEF*));
+            list = (MD_REF_DEF_LIST*) md_malloc(ctx, sizeof(MD_REF_DEF_LIST) + 2 * sizeof(MD_REF_DEF*));
             if(list == NULL) {
                 MD_LOG("malloc() failed.");
                 goto abort;
@@ -1814,7 +2078,7 @@ md_build_ref_def_hashtable(MD_CTX* ctx)
         list = (MD_REF_DEF_LIST*) bucket;
         if(list->n_ref_defs >= list->alloc_ref_defs) {
             int alloc_ref_defs = list->alloc_ref_defs + list->alloc_ref_defs / 2;
-            MD_REF_DEF_LIST* list_tmp = (MD_REF_DEF_LIST*) realloc(list,
+            MD_REF_DEF_LIST* list_tmp = (MD_REF_DEF_LIST*) md_realloc(ctx, list,
                         sizeof(MD_REF_DEF_LIST) + alloc_ref_defs * sizeof(MD_REF_DEF*));
             if(list_tmp == NULL) {
                 MD_LOG("realloc() failed.");
@@ -1870,10 +2134,10 @@ md_free_ref_def_hashtable(MD_CTX* ctx)
                 continue;
             if(ctx->ref_defs <= (MD_REF_DEF*) bucket  &&  (MD_REF_DEF*) bucket < ctx->ref_defs + ctx->n_ref_defs)
                 continue;
-            free(bucket);
+            md_free(ctx, bucket);
         }
 
-        free(ctx->ref_def_hashtable);
+        md_free(ctx, ctx->ref_def_hashtable);
     }
 }
 
@@ -2239,7 +2503,7 @@ md_is_link_reference_definition(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lin
         ctx->alloc_ref_defs = (ctx->alloc_ref_defs > 0
                 ? ctx->alloc_ref_defs + ctx->alloc_ref_defs / 2
                 : 16);
-        new_defs = (MD_REF_DEF*) realloc(ctx->ref_defs, ctx->alloc_ref_defs * sizeof(MD_REF_DEF));
+        new_defs = (MD_REF_DEF*) md_realloc(ctx, ctx->ref_defs, ctx->alloc_ref_defs * sizeof(MD_REF_DEF));
         if(new_defs == NULL) {
             MD_LOG("realloc() failed.");
             goto abort;
@@ -2280,9 +2544,9 @@ md_is_link_reference_definition(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lin
 abort:
     /* Failure. */
     if(def != NULL  &&  def->label_needs_free)
-        free(def->label);
+        md_free(ctx, def->label);
     if(def != NULL  &&  def->title_needs_free)
-        free(def->title);
+        md_free(ctx, def->title);
     return ret;
 }
 
@@ -2328,7 +2592,7 @@ md_is_link_reference(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines,
     }
 
     if(is_multiline)
-        free(label);
+        md_free(ctx, label);
 
     if(def != NULL) {
         /* See https://github.com/mity/md4c/issues/238 */
@@ -2451,12 +2715,12 @@ md_free_ref_defs(MD_CTX* ctx)
         MD_REF_DEF* def = &ctx->ref_defs[i];
 
         if(def->label_needs_free)
-            free(def->label);
+            md_free(ctx, def->label);
         if(def->title_needs_free)
-            free(def->title);
+            md_free(ctx, def->title);
     }
 
-    free(ctx->ref_defs);
+    md_free(ctx, ctx->ref_defs);
 }
 
 
@@ -2515,6 +2779,8 @@ md_free_ref_defs(MD_CTX* ctx)
  *  '@': Maybe permissive e-mail auto-link (needs MD_FLAG_PERMISSIVEEMAILAUTOLINKS).
  *  ':': Maybe permissive URL auto-link (needs MD_FLAG_PERMISSIVEURLAUTOLINKS).
  *  '.': Maybe permissive WWW auto-link (needs MD_FLAG_PERMISSIVEWWWAUTOLINKS).
+ *  '@', '#', ':' with MD_MARK_TOKEN: Mention, hashtag or emoji shortcode
+ *       (needs MD_FLAG_MENTIONS, MD_FLAG_HASHTAGS, MD_FLAG_EMOJISHORTCODES).
  *  'D': Dummy mark, it reserves a space for splitting a previous mark
  *       (e.g. emphasis) or to make more space for storing some special data
  *       related to the preceding mark (e.g. link).
@@ -2564,6 +2830,7 @@ struct MD_MARK_tag {
 #define MD_MARK_AUTOLINK_MISSING_MAILTO     0x40
 #define MD_MARK_VALIDPERMISSIVEAUTOLINK     0x20  /* For permissive autolinks. */
 #define MD_MARK_HASNESTEDBRACKETS           0x20  /* For '[' to rule out invalid link labels early */
+#define MD_MARK_TOKEN                       0x40  /* For '@', '#', ':': a mention, hashtag or shortcode. */
 
 static MD_MARKSTACK*
 md_emph_stack(MD_CTX* ctx, MD_CHAR ch, unsigned flags)
@@ -2616,7 +2883,7 @@ md_add_mark(MD_CTX* ctx)
         ctx->alloc_marks = (ctx->alloc_marks > 0
                 ? ctx->alloc_marks + ctx->alloc_marks / 2
                 : 64);
-        new_marks = realloc(ctx->marks, ctx->alloc_marks * sizeof(MD_MARK));
+        new_marks = md_realloc(ctx, ctx->marks, ctx->alloc_marks * sizeof(MD_MARK));
         if(new_marks == NULL) {
             MD_LOG("realloc() failed.");
             return NULL;
@@ -2720,6 +2987,70 @@ md_disable_marks(MD_CTX* ctx, int mark_index0, int mark_index1)
     }
 }
 
+#ifdef MD_SIMD
+static inline unsigned
+md_count_trailing_zeros(uint64_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (unsigned) index;
+#else
+    return (unsigned) __builtin_ctzll(mask);
+#endif
+}
+
+  #ifdef MD_SIMD_NEON
+/* Index of the first set byte of a NEON comparison result, or 16 if none. */
+static inline unsigned
+md_neon_first_set(uint8x16_t cmp)
+{
+    /* Narrow to 4 bits per byte to get a scalar mask. */
+    uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0);
+    return (mask != 0) ? md_count_trailing_zeros(mask) >> 2 : 16;
+}
+  #endif
+#endif
+
+#ifdef MD_SIMD_SHUFFLE
+/* Build the tables for the vectorized plain text skip.
+ *
+ * Every high nibble having any mark character gets one of 8 bucket bits.
+ * mark_scan_hi[] maps a high nibble to its bucket, and mark_scan_lo[] maps a
+ * low nibble to the buckets in which it completes a mark character. So byte
+ * b is a mark character iff (mark_scan_lo[b & 0xf] & mark_scan_hi[b >> 4]) != 0,
+ * which takes two byte shuffles per vector. With more than 8 distinct high
+ * nibbles the set is not representable and the scalar loop is used. */
+static void
+md_build_mark_scan_tables(MD_CTX* ctx)
+{
+    int n_buckets = 0;
+    int hi, lo;
+
+    memset(ctx->mark_scan_lo, 0, sizeof(ctx->mark_scan_lo));
+    memset(ctx->mark_scan_hi, 0, sizeof(ctx->mark_scan_hi));
+    ctx->mark_scan_usable = FALSE;
+
+    for(hi = 0; hi < 16; hi++) {
+        unsigned char bucket = 0;
+
+        for(lo = 0; lo < 16; lo++) {
+            if(!ctx->mark_char_map[(hi << 4) | lo])
+                continue;
+            if(bucket == 0) {
+                if(n_buckets == 8)
+                    return;
+                bucket = (unsigned char) (1u << n_buckets++);
+            }
+            ctx->mark_scan_lo[lo] |= bucket;
+        }
+        ctx->mark_scan_hi[hi] = bucket;
+    }
+
+    ctx->mark_scan_usable = TRUE;
+}
+#endif  /* MD_SIMD_SHUFFLE */
+
 static void
 md_build_mark_char_map(MD_CTX* ctx)
 {
@@ -2747,10 +3078,14 @@ md_build_mark_char_map(MD_CTX* ctx)
     if(ctx->parser.flags & MD_FLAG_LATEXMATHSPANS)
         ctx->mark_char_map['$'] = 1;
 
-    if(ctx->parser.flags & MD_FLAG_PERMISSIVEEMAILAUTOLINKS)
+    if(ctx->parser.flags & (MD_FLAG_PERMISSIVEEMAILAUTOLINKS | MD_FLAG_MENTIONS))
         ctx->mark_char_map['@'] = 1;
 
-    if(ctx->parser.flags & MD_FLAG_PERMISSIVEURLAUTOLINKS)
+    if(ctx->parser.flags & MD_FLAG_HASHTAGS)
+        ctx->mark_char_map['#'] = 1;
+
+    if((ctx->parser.flags & MD_FLAG_PERMISSIVEURLAUTOLINKS)  ||
+       ((ctx->parser.flags & MD_FLAG_EMOJISHORTCODES)  &&  ctx->parser.emoji_shortcode != NULL))
         ctx->mark_char_map[':'] = 1;
 
     if(ctx->parser.flags & MD_FLAG_PERMISSIVEWWWAUTOLINKS)
@@ -2768,6 +3103,91 @@ md_build_mark_char_map(MD_CTX* ctx)
                 ctx->mark_char_map[i] = 1;
         }
     }
+
+#ifdef MD_SIMD_SHUFFLE
+    md_build_mark_scan_tables(ctx);
+#endif
+}
+
+#ifdef MD4C_USE_UTF16
+    /* For UTF-16, mark_char_map[] covers only ASCII. */
+    #define IS_MARK_CHAR(off)   ((CH(off) < SIZEOF_ARRAY(ctx->mark_char_map))  &&  \
+                                (ctx->mark_char_map[(unsigned char) CH(off)]))
+#else
+    /* For 8-bit encodings, mark_char_map[] covers all 256 elements. */
+    #define IS_MARK_CHAR(off)   (ctx->mark_char_map[(unsigned char) CH(off)])
+#endif
+
+/* Return the offset of the first mark character in [off, end), or end if
+ * there is none. Most of a typical paragraph is plain text, so this is
+ * where md_collect_marks() spends much of its time. */
+static MD_FORCE_INLINE OFF
+md_skip_plain_text(MD_CTX* ctx, OFF off, OFF end)
+{
+#ifdef MD_SIMD_SHUFFLE
+    if(ctx->mark_scan_usable) {
+        const unsigned char* text = (const unsigned char*) ctx->text;
+
+  #if defined MD_SIMD_SSSE3
+        const __m128i lo_table = _mm_loadu_si128((const __m128i*) ctx->mark_scan_lo);
+        const __m128i hi_table = _mm_loadu_si128((const __m128i*) ctx->mark_scan_hi);
+        const __m128i nibble = _mm_set1_epi8(0x0f);
+    #ifdef MD_SIMD_AVX2
+        const __m256i lo_table2 = _mm256_broadcastsi128_si256(lo_table);
+        const __m256i hi_table2 = _mm256_broadcastsi128_si256(hi_table);
+        const __m256i nibble2 = _mm256_set1_epi8(0x0f);
+
+        while(off + 32 <= end) {
+            __m256i v = _mm256_loadu_si256((const __m256i*) (text + off));
+            __m256i lo = _mm256_shuffle_epi8(lo_table2, _mm256_and_si256(v, nibble2));
+            __m256i hi = _mm256_shuffle_epi8(hi_table2, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble2));
+            __m256i plain = _mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256());
+            uint32_t marks = ~(uint32_t) _mm256_movemask_epi8(plain);
+
+            if(marks != 0)
+                return off + md_count_trailing_zeros(marks);
+            off += 32;
+        }
+    #endif
+
+        while(off + 16 <= end) {
+            __m128i v = _mm_loadu_si128((const __m128i*) (text + off));
+            __m128i lo = _mm_shuffle_epi8(lo_table, _mm_and_si128(v, nibble));
+            __m128i hi = _mm_shuffle_epi8(hi_table, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+            __m128i plain = _mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128());
+            uint32_t marks = ~(uint32_t) _mm_movemask_epi8(plain) & 0xffff;
+
+            if(marks != 0)
+                return off + md_count_trailing_zeros(marks);
+            off += 16;
+        }
+  #elif defined MD_SIMD_NEON
+        const uint8x16_t lo_table = vld1q_u8(ctx->mark_scan_lo);
+        const uint8x16_t hi_table = vld1q_u8(ctx->mark_scan_hi);
+        const uint8x16_t nibble = vdupq_n_u8(0x0f);
+
+        while(off + 16 <= end) {
+            uint8x16_t v = vld1q_u8(text + off);
+            uint8x16_t lo = vqtbl1q_u8(lo_table, vandq_u8(v, nibble));
+            uint8x16_t hi = vqtbl1q_u8(hi_table, vshrq_n_u8(v, 4));
+            unsigned i = md_neon_first_set(vtstq_u8(lo, hi));
+
+            if(i < 16)
+                return off + i;
+            off += 16;
+        }
+  #endif
+    }
+#endif  /* MD_SIMD_SHUFFLE */
+
+    /* Optimization: Use some loop unrolling. */
+    while(off + 3 < end  &&  !IS_MARK_CHAR(off+0)  &&  !IS_MARK_CHAR(off+1)
+                         &&  !IS_MARK_CHAR(off+2)  &&  !IS_MARK_CHAR(off+3))
+        off += 4;
+    while(off < end  &&  !IS_MARK_CHAR(off+0))
+        off++;
+
+    return off;
 }
 
 static int
@@ -2945,7 +3365,7 @@ md_is_autolink_email(MD_CTX* ctx, OFF beg, OFF max_end, OFF* p_end)
      */
 
     /* Username (before '@'). */
-    while(off < max_end  &&  (ISALNUM(off) || ISANYOF(off, _T(".!#$%&'*+/=?^_`{|}~-"))))
+    while(off < max_end  &&  (ISALNUM(off) || ISCLASS(off, MD_CHAR_EMAIL_LOCAL)))
         off++;
     if(off <= beg+1)
         return FALSE;
@@ -2997,8 +3417,98 @@ md_is_autolink(MD_CTX* ctx, OFF beg, OFF max_end, OFF* p_end, int* p_missing_mai
     return FALSE;
 }
 
+/* Mentions (@name), hashtags (#name) and emoji shortcodes (:name:) are
+ * recognized and resolved right in md_collect_marks(), like "<...>" autolinks,
+ * so they cost no pass of their own. A token has to start a word: it follows
+ * the line start, whitespace, or an opening bracket, quote or emphasis
+ * delimiter. Anything else ("a@b.c", "C#", "10:30:") is left alone. */
+static int
+md_is_token_start(MD_CTX* ctx, const MD_LINE* line, OFF off)
+{
+    return (off == line->beg  ||  ISUNICODEWHITESPACEBEFORE(off)  ||
+            ISANYOF(off-1, _T("([{\"'*_~|^")));
+}
+
+/* Scans the name of a mention or hashtag from 'beg': letters (any non-ASCII
+ * character that is neither whitespace nor punctuation counts as one), digits
+ * and '_', with single '.' or '-' between them. Returns the end of the name,
+ * which is 'beg' if there is none, and whether it has other than digits. */
+static OFF
+md_scan_token_name(MD_CTX* ctx, OFF beg, OFF max_end, int* p_has_letter)
+{
+    OFF off = beg;
+    OFF end = beg;
+
+    *p_has_letter = FALSE;
+    while(off < max_end) {
+        if(ISALNUM(off)  ||  CH(off) == _T('_')) {
+            if(!ISDIGIT(off))
+                *p_has_letter = TRUE;
+            off++;
+            end = off;
+        } else if(ISANYOF2(off, _T('.'), _T('-'))  &&  end == off  &&  end > beg) {
+            off++;
+        } else if(!ISASCII(off)  &&  !ISUNICODEWHITESPACE(off)  &&  !ISUNICODEPUNCT(off)) {
+            SZ char_size;
+
+            md_decode_unicode(ctx->text, off, ctx->size, &char_size);
+            if(off + char_size > max_end)
+                break;
+            *p_has_letter = TRUE;
+            off += char_size;
+            end = off;
+        } else {
+            break;
+        }
+    }
+
+    return end;
+}
+
+/* Checks for an emoji shortcode at 'beg' (the opening colon) and returns the
+ * end past its closing colon, or 'beg' if it is none. Names are lowercase
+ * ASCII letters, digits, '_', '+' and '-', as on GitHub and Slack, and must be
+ * known to MD_PARSER::emoji_shortcode(). */
+static OFF
+md_scan_emoji_shortcode(MD_CTX* ctx, OFF beg, OFF max_end)
+{
+    OFF off = beg + 1;
+    MD_SIZE emoji_size;
+
+    while(off < max_end  &&  off - beg <= 64  &&
+          (ISLOWER(off)  ||  ISDIGIT(off)  ||  ISANYOF3(off, _T('_'), _T('+'), _T('-'))))
+        off++;
+
+    if(off == beg + 1  ||  off >= max_end  ||  CH(off) != _T(':'))
+        return beg;
+    if(ctx->parser.emoji_shortcode(STR(beg+1), off - (beg+1), &emoji_size, ctx->userdata) == NULL)
+        return beg;
+    return off + 1;
+}
+
+/* Adds the resolved opener and closer of a token. Mentions and hashtags get
+ * empty marks around the token, so it stays the text of its span; a
+ * shortcode's closer covers it, as its text is the emoji instead. (Not the
+ * opener: md_process_inlines() would be done with a block ending in the
+ * shortcode before it saw the closer.) */
 static int
-md_collect_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_mode)
+md_add_token_marks(MD_CTX* ctx, CHAR ch, OFF beg, OFF end)
+{
+    MD_MARK* mark;
+    int ret = 0;
+
+    ADD_MARK(ch, beg, beg, MD_MARK_OPENER | MD_MARK_RESOLVED | MD_MARK_TOKEN);
+    ADD_MARK(ch, (ch == _T(':') ? beg : end), end, MD_MARK_CLOSER | MD_MARK_RESOLVED | MD_MARK_TOKEN);
+    ctx->marks[ctx->n_marks-2].next = ctx->n_marks-1;
+    ctx->marks[ctx->n_marks-1].prev = ctx->n_marks-2;
+
+abort:
+    return ret;
+}
+
+static MD_FORCE_INLINE int
+md_collect_marks_(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_mode,
+                  unsigned parser_flags)
 {
     MD_SIZE line_index;
     int ret = 0;
@@ -3013,25 +3523,15 @@ md_collect_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_m
         while(TRUE) {
             CHAR ch;
 
-#ifdef MD4C_USE_UTF16
-    /* For UTF-16, mark_char_map[] covers only ASCII. */
-    #define IS_MARK_CHAR(off)   ((CH(off) < SIZEOF_ARRAY(ctx->mark_char_map))  &&  \
-                                (ctx->mark_char_map[(unsigned char) CH(off)]))
-#else
-    /* For 8-bit encodings, mark_char_map[] covers all 256 elements. */
-    #define IS_MARK_CHAR(off)   (ctx->mark_char_map[(unsigned char) CH(off)])
-#endif
-
-            /* Optimization: Use some loop unrolling. */
-            while(off + 3 < line->end  &&  !IS_MARK_CHAR(off+0)  &&  !IS_MARK_CHAR(off+1)
-                                       &&  !IS_MARK_CHAR(off+2)  &&  !IS_MARK_CHAR(off+3))
-                off += 4;
-            while(off < line->end  &&  !IS_MARK_CHAR(off+0))
-                off++;
+            off = md_skip_plain_text(ctx, off, line->end);
 
             if(off >= line->end)
                 break;
 
+            /* Past the limit, the rest of the block is taken literally. */
+            if(ctx->n_marks >= ctx->max_marks)
+                goto done;
+
             ch = CH(off);
 
             /* A backslash escape.
@@ -3160,7 +3660,7 @@ md_collect_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_m
                 OFF autolink_end;
                 int missing_mailto;
 
-                if(!(ctx->parser.flags & MD_FLAG_NOHTMLSPANS)) {
+                if(!(parser_flags & MD_FLAG_NOHTMLSPANS)) {
                     int is_html;
                     OFF html_end;
 
@@ -3219,9 +3719,42 @@ md_collect_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_m
                 continue;
             }
 
-            /* A potential permissive e-mail autolink. */
+            /* A potential mention. */
+            if(ch == _T('@')  &&  (parser_flags & MD_FLAG_MENTIONS)  &&  md_is_token_start(ctx, line, off)) {
+                int has_letter;
+                OFF tmp = md_scan_token_name(ctx, off+1, line->end, &has_letter);
+
+                if(tmp > off+1) {
+                    MD_CHECK(md_add_token_marks(ctx, ch, off, tmp));
+                    off = tmp;
+                    continue;
+                }
+            }
+
+            /* A potential hashtag. Unlike mentions, names of only digits
+             * ("#1") are no hashtags. */
+            if(ch == _T('#')  &&  (parser_flags & MD_FLAG_HASHTAGS)) {
+                int has_letter;
+                OFF tmp;
+
+                if(md_is_token_start(ctx, line, off)) {
+                    tmp = md_scan_token_name(ctx, off+1, line->end, &has_letter);
+                    if(tmp > off+1  &&  has_letter) {
+                        MD_CHECK(md_add_token_marks(ctx, ch, off, tmp));
+                        off = tmp;
+                        continue;
+                    }
+                }
+
+                off++;
+                continue;
+            }
+
+            /* A potential permissive e-mail autolink. The '@' may be a mark
+             * character for mentions only. */
             if(ch == _T('@')) {
-                if(line->beg + 1 <= off  &&  ISALNUM(off-1)  &&
+                if((!(parser_flags & MD_FLAG_MENTIONS)  ||  (ctx->parser.flags & MD_FLAG_PERMISSIVEEMAILAUTOLINKS))  &&
+                    line->beg + 1 <= off  &&  ISALNUM(off-1)  &&
                     off + 3 < line->end  &&  ISALNUM(off+1))
                 {
                     ADD_MARK(ch, off, off+1, MD_MARK_POTENTIAL_OPENER);
@@ -3233,7 +3766,8 @@ md_collect_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_m
                 continue;
             }
 
-            /* A potential permissive URL autolink. */
+            /* A potential permissive URL autolink or emoji shortcode. The ':'
+             * may be a mark character for shortcodes only. */
             if(ch == _T(':')) {
                 static const struct {
                     const CHAR* scheme;
@@ -3246,9 +3780,12 @@ md_collect_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_m
                     { _T("https"), 5,   _T("//"), 2 },
                     { _T("ftp"), 3,     _T("//"), 2 }
                 };
-                int scheme_index;
+                int scheme_index = 0;
+
+                if((parser_flags & MD_FLAG_EMOJISHORTCODES)  &&  !(ctx->parser.flags & MD_FLAG_PERMISSIVEURLAUTOLINKS))
+                    scheme_index = (int) SIZEOF_ARRAY(scheme_map);
 
-                for(scheme_index = 0; scheme_index < (int) SIZEOF_ARRAY(scheme_map); scheme_index++) {
+                for(; scheme_index < (int) SIZEOF_ARRAY(scheme_map); scheme_index++) {
                     const CHAR* scheme = scheme_map[scheme_index].scheme;
                     const SZ scheme_size = scheme_map[scheme_index].scheme_size;
                     const CHAR* suffix = scheme_map[scheme_index].suffix;
@@ -3265,6 +3802,22 @@ md_collect_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_m
                     }
                 }
 
+                /* Shortcodes may also follow each other, as in ":tada::tada:". */
+                if(scheme_index == (int) SIZEOF_ARRAY(scheme_map)  &&  (parser_flags & MD_FLAG_EMOJISHORTCODES)  &&
+                   ctx->parser.emoji_shortcode != NULL  &&
+                   (md_is_token_start(ctx, line, off)  ||
+                    (ctx->n_marks > 0  &&  ctx->marks[ctx->n_marks-1].ch == _T(':')  &&
+                     (ctx->marks[ctx->n_marks-1].flags & MD_MARK_TOKEN)  &&  ctx->marks[ctx->n_marks-1].end == off)))
+                {
+                    OFF tmp = md_scan_emoji_shortcode(ctx, off, line->end);
+
+                    if(tmp > off) {
+                        MD_CHECK(md_add_token_marks(ctx, ch, off, tmp));
+                        off = tmp;
+                        continue;
+                    }
+                }
+
                 off++;
                 continue;
             }
@@ -3288,7 +3841,7 @@ md_collect_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_m
             /* A potential spoiler delimiter: || ... ||
              * Checked before the single-| handler so a double pipe is consumed
              * as one mark and does not become two cell boundaries. */
-            if(ch == _T('|') && (ctx->parser.flags & MD_FLAG_SPOILERS)) {
+            if(ch == _T('|') && (parser_flags & MD_FLAG_SPOILERS)) {
                 if(off + 1 < line->end && CH(off+1) == _T('|')) {
                     ADD_MARK(ch, off, off+2, MD_MARK_POTENTIAL_OPENER | MD_MARK_POTENTIAL_CLOSER);
                     off += 2;
@@ -3297,14 +3850,14 @@ md_collect_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_m
             }
 
             /* A potential table cell boundary or wiki link label delimiter. */
-            if((table_mode || (ctx->parser.flags & MD_FLAG_WIKILINKS)) && ch == _T('|')) {
+            if((table_mode || (parser_flags & MD_FLAG_WIKILINKS)) && ch == _T('|')) {
                 ADD_MARK(ch, off, off+1, 0);
                 off++;
                 continue;
             }
 
             /* A potential superscript start/end: ^text^ */
-            if(ch == _T('^') && (ctx->parser.flags & MD_FLAG_SUPERSCRIPTS)) {
+            if(ch == _T('^') && (parser_flags & MD_FLAG_SUPERSCRIPTS)) {
                 OFF tmp = off + 1;
 
                 while(tmp < line->end && CH(tmp) == _T('^'))
@@ -3334,7 +3887,7 @@ md_collect_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_m
                 while(tmp < line->end && CH(tmp) == _T('~'))
                     tmp++;
 
-                if(tmp - off == 1  &&  (ctx->parser.flags & MD_FLAG_SUBSCRIPTS)) {
+                if(tmp - off == 1  &&  (parser_flags & MD_FLAG_SUBSCRIPTS)) {
                     /* Subscript: can open after any non-whitespace, cannot open
                      * before whitespace; cannot close after whitespace. */
                     unsigned flags = MD_MARK_POTENTIAL_OPENER | MD_MARK_POTENTIAL_CLOSER;
@@ -3345,7 +3898,7 @@ md_collect_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_m
                         flags &= ~MD_MARK_POTENTIAL_CLOSER;
                     if(flags != 0)
                         ADD_MARK(ch, off, off + 1, flags);
-                } else if(tmp - off <= 2  &&  (ctx->parser.flags & MD_FLAG_STRIKETHROUGH)) {
+                } else if(tmp - off <= 2  &&  (parser_flags & MD_FLAG_STRIKETHROUGH)) {
                     /* Strikethrough: standard GFM left/right-flanking rules. */
                     unsigned flags = MD_MARK_POTENTIAL_OPENER | MD_MARK_POTENTIAL_CLOSER;
 
@@ -3408,6 +3961,7 @@ md_collect_marks(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_m
         }
     }
 
+done:
     /* Add a dummy mark at the end of the mark vector to simplify
      * process_inlines(). */
     ADD_MARK(127, ctx->size, ctx->size, MD_MARK_RESOLVED);
@@ -3416,6 +3970,64 @@ abort:
     return ret;
 }
 
+/* md_collect_marks() dispatches on the parser flags for every mark character
+ * it meets. It is instantiated for the flag combinations MD4CParser uses, so
+ * that these tests fold into constants and disabled extensions cost nothing;
+ * any other combination goes through the generic instance. Define
+ * MD4C_NO_FLAG_SPECIALIZATION to always use the generic one. */
+#define MD_COLLECT_MARKS_FLAGS                                              \
+    (MD_FLAG_NOHTMLSPANS | MD_FLAG_SPOILERS | MD_FLAG_WIKILINKS |           \
+     MD_FLAG_SUPERSCRIPTS | MD_FLAG_SUBSCRIPTS | MD_FLAG_STRIKETHROUGH |    \
+     MD_FLAG_MENTIONS | MD_FLAG_HASHTAGS | MD_FLAG_EMOJISHORTCODES)
+
+#define MD_COLLECT_MARKS_INSTANCE(name, parser_flags)                       \
+    static int                                                              \
+    name(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table_mode)\
+    {                                                                       \
+        return md_collect_marks_(ctx, lines, n_lines, table_mode,           \
+                                 (parser_flags));                           \
+    }
+
+MD_COLLECT_MARKS_INSTANCE(md_collect_marks_generic, ctx->parser.flags)
+
+#ifndef MD4C_NO_FLAG_SPECIALIZATION
+#define MD_COLLECT_MARKS_BASE_FLAGS                                         \
+    (MD_FLAG_NOHTMLSPANS | MD_FLAG_SPOILERS | MD_FLAG_STRIKETHROUGH)
+
+MD_COLLECT_MARKS_INSTANCE(md_collect_marks_base, MD_COLLECT_MARKS_BASE_FLAGS)
+MD_COLLECT_MARKS_INSTANCE(md_collect_marks_sup,
+            MD_COLLECT_MARKS_BASE_FLAGS | MD_FLAG_SUPERSCRIPTS)
+MD_COLLECT_MARKS_INSTANCE(md_collect_marks_sub,
+            MD_COLLECT_MARKS_BASE_FLAGS | MD_FLAG_SUBSCRIPTS)
+MD_COLLECT_MARKS_INSTANCE(md_collect_marks_sup_sub,
+            MD_COLLECT_MARKS_BASE_FLAGS | MD_FLAG_SUPERSCRIPTS | MD_FLAG_SUBSCRIPTS)
+#endif
+
+static void
+md_select_collect_marks(MD_CTX* ctx)
+{
+    ctx->collect_marks = md_collect_marks_generic;
+
+#ifndef MD4C_NO_FLAG_SPECIALIZATION
+    switch(ctx->parser.flags & MD_COLLECT_MARKS_FLAGS) {
+        case MD_COLLECT_MARKS_BASE_FLAGS:
+            ctx->collect_marks = md_collect_marks_base;
+            break;
+        case MD_COLLECT_MARKS_BASE_FLAGS | MD_FLAG_SUPERSCRIPTS:
+            ctx->collect_marks = md_collect_marks_sup;
+            break;
+        case MD_COLLECT_MARKS_BASE_FLAGS | MD_FLAG_SUBSCRIPTS:
+            ctx->collect_marks = md_collect_marks_sub;
+            break;
+        case MD_COLLECT_MARKS_BASE_FLAGS | MD_FLAG_SUPERSCRIPTS | MD_FLAG_SUBSCRIPTS:
+            ctx->collect_marks = md_collect_marks_sup_sub;
+            break;
+        default:
+            break;
+    }
+#endif
+}
+
 static void
 md_analyze_bracket(MD_CTX* ctx, int mark_index)
 {
@@ -3641,7 +4253,7 @@ md_resolve_links(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                             if(ctx->marks[mark->next].beg >= inline_link_end) {
                                 /* Cancel the link status. */
                                 if(attr.title_needs_free)
-                                    free(attr.title);
+                                    md_free(ctx, attr.title);
                                 is_link = FALSE;
                                 break;
                             }
@@ -3714,7 +4326,7 @@ md_resolve_links(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
 
                 if((first_nested->flags & MD_MARK_RESOLVED)  &&
                    first_nested->beg == opener->end  &&
-                   ISANYOF_(first_nested->ch, _T("@:."))  &&
+                   ISCLASS_(first_nested->ch, MD_CHAR_AUTOLINK_NESTED)  &&
                    first_nested->next == (last_nested - ctx->marks)  &&
                    last_nested->end == closer->beg)
                 {
@@ -3724,6 +4336,17 @@ md_resolve_links(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                     last_nested->flags &= ~MD_MARK_RESOLVED;
                 }
             }
+
+            /* Mentions and hashtags would be links within the link (or
+             * image), so keep them its text. */
+            if(ctx->parser.flags & (MD_FLAG_MENTIONS | MD_FLAG_HASHTAGS)) {
+                int j;
+
+                for(j = opener_index+1; j < closer_index; j++) {
+                    if(ISANYOF2_(ctx->marks[j].ch, '@', '#')  &&  (ctx->marks[j].flags & MD_MARK_TOKEN))
+                        md_disable_marks(ctx, j, j+1);
+                }
+            }
         }
 
         opener_index = next_index;
@@ -4001,15 +4624,15 @@ md_analyze_permissive_autolink(MD_CTX* ctx, int mark_index)
     static const struct {
         const MD_CHAR start_char;
         const MD_CHAR delim_char;
-        const MD_CHAR* allowed_nonalnum_chars_inside;
-        const MD_CHAR* allowed_nonalnum_chars_anywhere;
+        uint32_t allowed_nonalnum_inside;      /* MD_CHAR_xxx classes */
+        uint32_t allowed_nonalnum_anywhere;
         int min_components;
         const MD_CHAR optional_end_char;
     } URL_MAP[] = {
-        { _T('\0'), _T('.'),  _T(".-_"),      _T(""),   2, _T('\0') },    /* host, mandatory */
-        { _T('/'),  _T('/'),  _T("/._"),      _T("+-"), 0, _T('/') },     /* path */
-        { _T('?'),  _T('&'),  _T("&.-+_=()"), _T(""),   1, _T('\0') },    /* query */
-        { _T('#'),  _T('\0'), _T(".-+_") ,    _T(""),   1, _T('\0') }     /* fragment */
+        { _T('\0'), _T('.'),  MD_CHAR_URL_HOST,     0,                         2, _T('\0') },  /* host, mandatory */
+        { _T('/'),  _T('/'),  MD_CHAR_URL_PATH,     MD_CHAR_URL_PATH_ANYWHERE, 0, _T('/') },   /* path */
+        { _T('?'),  _T('&'),  MD_CHAR_URL_QUERY,    0,                         1, _T('\0') },  /* query */
+        { _T('#'),  _T('\0'), MD_CHAR_URL_FRAGMENT, 0,                         1, _T('\0') }   /* fragment */
     };
 
     MD_MARK* opener = &ctx->marks[mark_index];
@@ -4034,7 +4657,7 @@ md_analyze_permissive_autolink(MD_CTX* ctx, int mark_index)
             if(ISALNUM(beg-1))
                 beg--;
             else if(beg >= line_beg+2  &&  ISALNUM(beg-2)  &&
-                        ISANYOF(beg-1, _T(".-_+"))  &&
+                        ISCLASS(beg-1, MD_CHAR_EMAIL_USER)  &&
                         md_scan_left_for_resolved_mark(ctx, left_cursor, beg-1, &left_cursor) == NULL  &&
                         ISALNUM(beg))
                 beg--;
@@ -4047,7 +4670,7 @@ md_analyze_permissive_autolink(MD_CTX* ctx, int mark_index)
 
     /* Verify there's line boundary, whitespace, allowed punctuation or
      * resolved opener mark just before the suspected autolink. */
-    if(beg == line_beg  ||  ISUNICODEWHITESPACEBEFORE(beg)  ||  ISANYOF(beg-1, _T("({["))) {
+    if(beg == line_beg  ||  ISUNICODEWHITESPACEBEFORE(beg)  ||  ISCLASS(beg-1, MD_CHAR_AUTOLINK_BEFORE)) {
         left_boundary_ok = TRUE;
     } else {
         MD_MARK* left_mark;
@@ -4073,17 +4696,17 @@ md_analyze_permissive_autolink(MD_CTX* ctx, int mark_index)
         }
 
         while(end < line_end) {
-            if(ISALNUM(end)  ||  ISANYOF(end, URL_MAP[i].allowed_nonalnum_chars_anywhere)) {
+            if(ISALNUM(end)  ||  ISCLASS(end, URL_MAP[i].allowed_nonalnum_anywhere)) {
                 if(n_components == 0)
                     n_components++;
                 component_len++;
                 end++;
             } else if(component_len > 0  &&  CH(end) == URL_MAP[i].delim_char  &&  end+1 < line_end  &&
-                      (ISALNUM(end+1)  ||  ISANYOF(end+1, URL_MAP[i].allowed_nonalnum_chars_anywhere))) {
+                      (ISALNUM(end+1)  ||  ISCLASS(end+1, URL_MAP[i].allowed_nonalnum_anywhere))) {
                 n_components++;
                 component_len = 0;
                 end++;
-            } else if(ISANYOF(end, URL_MAP[i].allowed_nonalnum_chars_inside)  &&
+            } else if(ISCLASS(end, URL_MAP[i].allowed_nonalnum_inside)  &&
                       md_scan_right_for_resolved_mark(ctx, right_cursor, end, &right_cursor) == NULL  &&
                       ((end > line_beg && (ISALNUM(end-1) || CH(end-1) == _T(')')))  ||  CH(end) == _T('('))  &&
                       ((end+1 < line_end && (ISALNUM(end+1) || CH(end+1) == _T('(')))  ||  CH(end) == _T(')')))
@@ -4117,7 +4740,7 @@ md_analyze_permissive_autolink(MD_CTX* ctx, int mark_index)
 
     /* Verify there's line boundary, whitespace, allowed punctuation or
      * resolved closer mark just after the suspected autolink. */
-    if(end == line_end  ||  ISUNICODEWHITESPACE(end)  ||  ISANYOF(end, _T(")}].!?,;"))) {
+    if(end == line_end  ||  ISUNICODEWHITESPACE(end)  ||  ISCLASS(end, MD_CHAR_AUTOLINK_AFTER)) {
         right_boundary_ok = TRUE;
     } else {
         MD_MARK* right_mark;
@@ -4217,7 +4840,7 @@ md_analyze_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines, int table
     ctx->n_marks = 0;
 
     /* Collect all marks. */
-    MD_CHECK(md_collect_marks(ctx, lines, n_lines, table_mode));
+    MD_CHECK(ctx->collect_marks(ctx, lines, n_lines, table_mode));
 
     /* (1) Links. */
     md_analyze_marks(ctx, lines, n_lines, 0, ctx->n_marks, _T("[]!"), NULL);
@@ -4339,6 +4962,41 @@ abort:
 }
 
 
+static int
+md_enter_leave_span_token(MD_CTX* ctx, const MD_MARK* mark)
+{
+    const MD_MARK* opener = ((mark->flags & MD_MARK_OPENER) ? mark : &ctx->marks[mark->prev]);
+    const MD_MARK* closer = &ctx->marks[opener->next];
+    MD_SPANTYPE type;
+    MD_SPAN_TOKEN_DETAIL det;
+    int ret = 0;
+
+    switch(opener->ch) {
+        case '@':   type = MD_SPAN_MENTION; break;
+        case '#':   type = MD_SPAN_HASHTAG; break;
+        default:    type = MD_SPAN_EMOJI_SHORTCODE; break;
+    }
+    det.name = STR(opener->beg + 1);
+    det.name_size = closer->end - (opener->beg + 1) - (type == MD_SPAN_EMOJI_SHORTCODE ? 1 : 0);
+
+    if(mark->flags & MD_MARK_OPENER) {
+        MD_SOURCE_OFFSET(opener->beg);
+        MD_ENTER_SPAN(type, &det);
+        if(type == MD_SPAN_EMOJI_SHORTCODE) {
+            MD_SIZE emoji_size = 0;
+            const MD_CHAR* emoji = ctx->parser.emoji_shortcode(det.name, det.name_size, &emoji_size, ctx->userdata);
+            if(emoji != NULL)
+                MD_TEXT(MD_TEXT_NORMAL, emoji, emoji_size);
+        }
+    } else {
+        MD_SOURCE_OFFSET(closer->end);
+        MD_LEAVE_SPAN(type, &det);
+    }
+
+abort:
+    return ret;
+}
+
 /* Render the output, accordingly to the analyzed ctx->marks. */
 static int
 md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
@@ -4387,9 +5045,11 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
 
                 case '`':       /* Code span. */
                     if(mark->flags & MD_MARK_OPENER) {
+                        MD_SOURCE_OFFSET(mark->beg);
                         MD_ENTER_SPAN(MD_SPAN_CODE, NULL);
                         text_type = MD_TEXT_CODE;
                     } else {
+                        MD_SOURCE_OFFSET(mark->end);
                         MD_LEAVE_SPAN(MD_SPAN_CODE, NULL);
                         text_type = MD_TEXT_NORMAL;
                     }
@@ -4399,11 +5059,13 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                     if(ctx->parser.flags & MD_FLAG_UNDERLINE) {
                         if(mark->flags & MD_MARK_OPENER) {
                             while(off < mark->end) {
+                                MD_SOURCE_OFFSET(off);
                                 MD_ENTER_SPAN(MD_SPAN_U, NULL);
                                 off++;
                             }
                         } else {
                             while(off < mark->end) {
+                                MD_SOURCE_OFFSET(off + 1);
                                 MD_LEAVE_SPAN(MD_SPAN_U, NULL);
                                 off++;
                             }
@@ -4415,19 +5077,23 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                 case '*':       /* Emphasis, strong emphasis. */
                     if(mark->flags & MD_MARK_OPENER) {
                         if((mark->end - off) % 2) {
+                            MD_SOURCE_OFFSET(off);
                             MD_ENTER_SPAN(MD_SPAN_EM, NULL);
                             off++;
                         }
                         while(off + 1 < mark->end) {
+                            MD_SOURCE_OFFSET(off);
                             MD_ENTER_SPAN(MD_SPAN_STRONG, NULL);
                             off += 2;
                         }
                     } else {
                         while(off + 1 < mark->end) {
+                            MD_SOURCE_OFFSET(off + 2);
                             MD_LEAVE_SPAN(MD_SPAN_STRONG, NULL);
                             off += 2;
                         }
                         if((mark->end - off) % 2) {
+                            MD_SOURCE_OFFSET(off + 1);
                             MD_LEAVE_SPAN(MD_SPAN_EM, NULL);
                             off++;
                         }
@@ -4435,6 +5101,7 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                     break;
 
                 case '~':
+                    MD_SOURCE_OFFSET((mark->flags & MD_MARK_OPENER) ? mark->beg : mark->end);
                     if(mark->end - mark->beg == 1  &&  (ctx->parser.flags & MD_FLAG_SUBSCRIPTS)) {
                         if(mark->flags & MD_MARK_OPENER)
                             MD_ENTER_SPAN(MD_SPAN_SUBSCRIPT, NULL);
@@ -4449,6 +5116,7 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                     break;
 
                 case '^':
+                    MD_SOURCE_OFFSET((mark->flags & MD_MARK_OPENER) ? mark->beg : mark->end);
                     if(mark->flags & MD_MARK_OPENER)
                         MD_ENTER_SPAN(MD_SPAN_SUPERSCRIPT, NULL);
                     else
@@ -4457,6 +5125,7 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
 
                 case '|':
                     if(mark->end - mark->beg == 2) {
+                        MD_SOURCE_OFFSET((mark->flags & MD_MARK_OPENER) ? mark->beg : mark->end);
                         if(mark->flags & MD_MARK_OPENER)
                             MD_ENTER_SPAN(MD_SPAN_SPOILER, NULL);
                         else
@@ -4465,6 +5134,7 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                     break;
 
                 case '$':
+                    MD_SOURCE_OFFSET((mark->flags & MD_MARK_OPENER) ? mark->beg : mark->end);
                     if(mark->flags & MD_MARK_OPENER) {
                         MD_ENTER_SPAN((mark->end - off) % 2 ? MD_SPAN_LATEXMATH : MD_SPAN_LATEXMATH_DISPLAY, NULL);
                         text_type = MD_TEXT_LATEXMATH;
@@ -4495,6 +5165,7 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                         else
                             target_sz = closer->beg - opener->end;
 
+                        MD_SOURCE_OFFSET(mark->ch != ']' ? opener->beg : closer->end);
                         MD_CHECK(md_enter_leave_span_wikilink(ctx, (mark->ch != ']'),
                                  has_label ? STR(opener->beg+2) : STR(opener->end),
                                  target_sz));
@@ -4507,6 +5178,7 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                     title_mark = opener+2;
                     MD_ASSERT(title_mark->ch == 'D');
 
+                    MD_SOURCE_OFFSET(mark->ch != ']' ? opener->beg : closer->end);
                     MD_CHECK(md_enter_leave_span_a(ctx, (mark->ch != ']'),
                                 (opener->ch == '!' ? MD_SPAN_IMG : MD_SPAN_A),
                                 STR(dest_mark->beg), dest_mark->end - dest_mark->beg, FALSE,
@@ -4522,6 +5194,10 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                     break;
                 }
 
+                case '#':       /* Hashtag. */
+                    MD_CHECK(md_enter_leave_span_token(ctx, mark));
+                    break;
+
                 case '<':
                 case '>':       /* Autolink or raw HTML. */
                     if(!(mark->flags & MD_MARK_AUTOLINK)) {
@@ -4544,6 +5220,12 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                     const CHAR* dest = STR(opener->end);
                     SZ dest_size = closer->beg - opener->end;
 
+                    /* Or a mention or emoji shortcode. */
+                    if(ISANYOF2_(mark->ch, '@', ':')  &&  (mark->flags & MD_MARK_TOKEN)) {
+                        MD_CHECK(md_enter_leave_span_token(ctx, mark));
+                        break;
+                    }
+
                     /* For permissive auto-links we do not know closer mark
                      * position at the time of md_collect_marks(), therefore
                      * it can be out-of-order in ctx->marks[].
@@ -4565,9 +5247,11 @@ md_process_inlines(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_lines)
                         dest = ctx->buffer;
                     }
 
-                    if(closer->flags & MD_MARK_VALIDPERMISSIVEAUTOLINK)
+                    if(closer->flags & MD_MARK_VALIDPERMISSIVEAUTOLINK) {
+                        MD_SOURCE_OFFSET((mark->flags & MD_MARK_OPENER) ? opener->beg : closer->end);
                         MD_CHECK(md_enter_leave_span_a(ctx, (mark->flags & MD_MARK_OPENER),
                                     MD_SPAN_A, dest, dest_size, TRUE, NULL, 0));
+                    }
                     break;
                 }
 
@@ -4691,6 +5375,8 @@ md_process_table_cell(MD_CTX* ctx, MD_BLOCKTYPE cell_type, MD_ALIGN align, OFF b
 {
     MD_LINE line;
     MD_BLOCK_TD_DETAIL det;
+    OFF source_beg = beg;
+    OFF source_end = end;
     int ret = 0;
 
     while(beg < end  &&  ISWHITESPACE(beg))
@@ -4702,8 +5388,10 @@ md_process_table_cell(MD_CTX* ctx, MD_BLOCKTYPE cell_type, MD_ALIGN align, OFF b
     line.beg = beg;
     line.end = end;
 
+    MD_SOURCE_OFFSET(source_beg);
     MD_ENTER_BLOCK(cell_type, &det);
     MD_CHECK(md_process_normal_block_contents(ctx, &line, 1));
+    MD_SOURCE_OFFSET(source_end);
     MD_LEAVE_BLOCK(cell_type, &det);
 
 abort:
@@ -4729,7 +5417,7 @@ md_process_table_row(MD_CTX* ctx, MD_BLOCKTYPE cell_type, OFF beg, OFF end,
     /* We have to remember the cell boundaries in local buffer because
      * ctx->marks[] shall be reused during cell contents processing. */
     n = ctx->n_table_cell_boundaries + 2;
-    pipe_offs = (OFF*) malloc(n * sizeof(OFF));
+    pipe_offs = (OFF*) md_malloc(ctx, n * sizeof(OFF));
     if(pipe_offs == NULL) {
         MD_LOG("malloc() failed.");
         ret = -1;
@@ -4744,6 +5432,7 @@ md_process_table_row(MD_CTX* ctx, MD_BLOCKTYPE cell_type, OFF beg, OFF end,
     pipe_offs[j++] = end+1;
 
     /* Process cells. */
+    MD_SOURCE_OFFSET(beg);
     MD_ENTER_BLOCK(MD_BLOCK_TR, NULL);
     k = 0;
     for(i = 0; i < j-1  &&  k < col_count; i++) {
@@ -4753,11 +5442,12 @@ md_process_table_row(MD_CTX* ctx, MD_BLOCKTYPE cell_type, OFF beg, OFF end,
     /* Make sure we call enough table cells even if the current table contains
      * too few of them. */
     while(k < col_count)
-        MD_CHECK(md_process_table_cell(ctx, cell_type, align[k++], 0, 0));
+        MD_CHECK(md_process_table_cell(ctx, cell_type, align[k++], end, end));
+    MD_SOURCE_OFFSET(end);
     MD_LEAVE_BLOCK(MD_BLOCK_TR, NULL);
 
 abort:
-    free(pipe_offs);
+    md_free(ctx, pipe_offs);
 
     ctx->table_cell_boundaries_head = -1;
     ctx->table_cell_boundaries_tail = -1;
@@ -4776,7 +5466,7 @@ md_process_table_block_contents(MD_CTX* ctx, int col_count, const MD_LINE* lines
      * with the underlines. */
     MD_ASSERT(n_lines >= 2);
 
-    align = malloc(col_count * sizeof(MD_ALIGN));
+    align = md_malloc(ctx, col_count * sizeof(MD_ALIGN));
     if(align == NULL) {
         MD_LOG("malloc() failed.");
         ret = -1;
@@ -4785,22 +5475,27 @@ md_process_table_block_contents(MD_CTX* ctx, int col_count, const MD_LINE* lines
 
     md_analyze_table_alignment(ctx, lines[1].beg, lines[1].end, align, col_count);
 
+    /* The head includes the underline. */
+    MD_SOURCE_OFFSET(lines[0].beg);
     MD_ENTER_BLOCK(MD_BLOCK_THEAD, NULL);
     MD_CHECK(md_process_table_row(ctx, MD_BLOCK_TH,
                         lines[0].beg, lines[0].end, align, col_count));
+    MD_SOURCE_OFFSET(lines[1].end);
     MD_LEAVE_BLOCK(MD_BLOCK_THEAD, NULL);
 
     if(n_lines > 2) {
+        MD_SOURCE_OFFSET(lines[2].beg);
         MD_ENTER_BLOCK(MD_BLOCK_TBODY, NULL);
         for(line_index = 2; line_index < n_lines; line_index++) {
             MD_CHECK(md_process_table_row(ctx, MD_BLOCK_TD,
                      lines[line_index].beg, lines[line_index].end, align, col_count));
         }
+        MD_SOURCE_OFFSET(lines[n_lines-1].end);
         MD_LEAVE_BLOCK(MD_BLOCK_TBODY, NULL);
     }
 
 abort:
-    free(align);
+    md_free(ctx, align);
     return ret;
 }
 
@@ -4831,6 +5526,11 @@ struct MD_BLOCK_tag {
      * MD_BLOCK_OL:     Start item number.
      */
     MD_SIZE n_lines;
+
+    /* Source range. Leaf blocks carry both ends; container openers carry
+     * the offset of their mark and container closers the end offset. */
+    OFF beg;
+    OFF end;
 };
 
 struct MD_CONTAINER_tag {
@@ -4842,6 +5542,7 @@ struct MD_CONTAINER_tag {
     unsigned contents_indent;
     OFF block_byte_off;
     OFF task_mark_off;
+    OFF mark_beg;
 };
 
 
@@ -4857,7 +5558,7 @@ md_process_normal_block_contents(MD_CTX* ctx, const MD_LINE* lines, MD_SIZE n_li
 abort:
     /* Free any temporary memory blocks stored within some dummy marks. */
     for(i = ctx->ptr_stack.top; i >= 0; i = ctx->marks[i].next)
-        free(md_mark_get_ptr(ctx, i));
+        md_free(ctx, md_mark_get_ptr(ctx, i));
     ctx->ptr_stack.top = -1;
 
     return ret;
@@ -5005,8 +5706,10 @@ md_process_leaf_block(MD_CTX* ctx, const MD_BLOCK* block)
             break;
     }
 
-    if(!is_in_tight_list  ||  block->type != MD_BLOCK_P)
+    if(!is_in_tight_list  ||  block->type != MD_BLOCK_P) {
+        MD_SOURCE_OFFSET(block->beg);
         MD_ENTER_BLOCK(block->type, (void*) &det);
+    }
 
     /* Process the block contents accordingly to is type. */
     switch(block->type) {
@@ -5035,8 +5738,10 @@ md_process_leaf_block(MD_CTX* ctx, const MD_BLOCK* block)
             break;
     }
 
-    if(!is_in_tight_list  ||  block->type != MD_BLOCK_P)
+    if(!is_in_tight_list  ||  block->type != MD_BLOCK_P) {
+        MD_SOURCE_OFFSET(block->end);
         MD_LEAVE_BLOCK(block->type, (void*) &det);
+    }
 
 abort:
     if(clean_fence_code_detail) {
@@ -5091,6 +5796,7 @@ md_process_all_blocks(MD_CTX* ctx)
 
         if(block->flags & MD_BLOCK_CONTAINER) {
             if(block->flags & MD_BLOCK_CONTAINER_CLOSER) {
+                MD_SOURCE_OFFSET(block->end);
                 MD_LEAVE_BLOCK(block->type, &det);
 
                 if(block->type == MD_BLOCK_UL || block->type == MD_BLOCK_OL || block->type == MD_BLOCK_QUOTE)
@@ -5098,6 +5804,7 @@ md_process_all_blocks(MD_CTX* ctx)
             }
 
             if(block->flags & MD_BLOCK_CONTAINER_OPENER) {
+                MD_SOURCE_OFFSET(block->beg);
                 MD_ENTER_BLOCK(block->type, &det);
 
                 if(block->type == MD_BLOCK_UL || block->type == MD_BLOCK_OL) {
@@ -5124,6 +5831,7 @@ md_process_all_blocks(MD_CTX* ctx)
     }
 
     ctx->n_block_bytes = 0;
+    ctx->li_opener_block_bytes = 0;
 
 abort:
     return ret;
@@ -5145,7 +5853,7 @@ md_push_block_bytes(MD_CTX* ctx, int n_bytes)
         ctx->alloc_block_bytes = (ctx->alloc_block_bytes > 0
                 ? ctx->alloc_block_bytes + ctx->alloc_block_bytes / 2
                 : 512);
-        new_block_bytes = realloc(ctx->block_bytes, ctx->alloc_block_bytes);
+        new_block_bytes = md_realloc(ctx, ctx->block_bytes, ctx->alloc_block_bytes);
         if(new_block_bytes == NULL) {
             MD_LOG("realloc() failed.");
             return NULL;
@@ -5210,6 +5918,8 @@ md_start_new_block(MD_CTX* ctx, const MD_LINE_ANALYSIS* line)
     block->flags = 0;
     block->data = line->data;
     block->n_lines = 0;
+    block->beg = line->syntax_beg;
+    block->end = line->syntax_end;
 
     ctx->current_block = block;
     return 0;
@@ -5259,6 +5969,7 @@ md_consume_link_reference_definitions(MD_CTX* ctx)
             /* Remove just some initial lines from the block. */
             memmove(lines, lines + n, (n_lines - n) * sizeof(MD_LINE));
             ctx->current_block->n_lines -= n;
+            ctx->current_block->beg = lines[0].beg;
             ctx->n_block_bytes -= n * sizeof(MD_LINE);
         }
     }
@@ -5337,12 +6048,17 @@ md_add_line_into_current_block(MD_CTX* ctx, const MD_LINE_ANALYSIS* analysis)
     }
     ctx->current_block->n_lines++;
 
+    /* Blank lines inside indented code are trimmed when rendering, so they do
+     * not extend the block's source range. */
+    if(analysis->syntax_end > analysis->syntax_beg)
+        ctx->current_block->end = analysis->syntax_end;
+
     return 0;
 }
 
 static int
 md_push_container_bytes(MD_CTX* ctx, MD_BLOCKTYPE type, unsigned start,
-                        unsigned data, unsigned flags)
+                        unsigned data, unsigned flags, OFF source_off)
 {
     MD_BLOCK* block;
     int ret = 0;
@@ -5357,6 +6073,10 @@ md_push_container_bytes(MD_CTX* ctx, MD_BLOCKTYPE type, unsigned start,
     block->flags = flags;
     block->data = data;
     block->n_lines = start;
+    block->beg = (flags & MD_BLOCK_CONTAINER_OPENER) ? source_off : 0;
+    block->end = (flags & MD_BLOCK_CONTAINER_CLOSER) ? source_off : 0;
+    if(type == MD_BLOCK_LI  &&  (flags & MD_BLOCK_CONTAINER_OPENER))
+        ctx->li_opener_block_bytes = ctx->n_block_bytes;
 
 abort:
     return ret;
@@ -5793,7 +6513,7 @@ md_push_container(MD_CTX* ctx, const MD_CONTAINER* container)
         ctx->alloc_containers = (ctx->alloc_containers > 0
                 ? ctx->alloc_containers + ctx->alloc_containers / 2
                 : 16);
-        new_containers = realloc(ctx->containers, ctx->alloc_containers * sizeof(MD_CONTAINER));
+        new_containers = md_realloc(ctx, ctx->containers, ctx->alloc_containers * sizeof(MD_CONTAINER));
         if(new_containers == NULL) {
             MD_LOG("realloc() failed.");
             return -1;
@@ -5832,15 +6552,15 @@ md_enter_child_containers(MD_CTX* ctx, int n_children)
 
                 MD_CHECK(md_push_container_bytes(ctx,
                                 (is_ordered_list ? MD_BLOCK_OL : MD_BLOCK_UL),
-                                c->start, c->ch, MD_BLOCK_CONTAINER_OPENER));
+                                c->start, c->ch, MD_BLOCK_CONTAINER_OPENER, c->mark_beg));
                 MD_CHECK(md_push_container_bytes(ctx, MD_BLOCK_LI,
                                 c->task_mark_off,
                                 (c->is_task ? CH(c->task_mark_off) : 0),
-                                MD_BLOCK_CONTAINER_OPENER));
+                                MD_BLOCK_CONTAINER_OPENER, c->mark_beg));
                 break;
 
             case _T('>'):
-                MD_CHECK(md_push_container_bytes(ctx, MD_BLOCK_QUOTE, 0, 0, MD_BLOCK_CONTAINER_OPENER));
+                MD_CHECK(md_push_container_bytes(ctx, MD_BLOCK_QUOTE, 0, 0, MD_BLOCK_CONTAINER_OPENER, c->mark_beg));
                 break;
 
             default:
@@ -5860,6 +6580,7 @@ md_leave_child_containers(MD_CTX* ctx, int n_keep)
 
     while(ctx->n_containers > n_keep) {
         MD_CONTAINER* c = &ctx->containers[ctx->n_containers-1];
+        OFF end = MAX(ctx->last_content_end, c->mark_beg);
         int is_ordered_list = FALSE;
 
         switch(c->ch) {
@@ -5873,15 +6594,15 @@ md_leave_child_containers(MD_CTX* ctx, int n_keep)
             case _T('*'):
                 MD_CHECK(md_push_container_bytes(ctx, MD_BLOCK_LI,
                                 c->task_mark_off, (c->is_task ? CH(c->task_mark_off) : 0),
-                                MD_BLOCK_CONTAINER_CLOSER));
+                                MD_BLOCK_CONTAINER_CLOSER, end));
                 MD_CHECK(md_push_container_bytes(ctx,
                                 (is_ordered_list ? MD_BLOCK_OL : MD_BLOCK_UL), 0,
-                                c->ch, MD_BLOCK_CONTAINER_CLOSER));
+                                c->ch, MD_BLOCK_CONTAINER_CLOSER, end));
                 break;
 
             case _T('>'):
                 MD_CHECK(md_push_container_bytes(ctx, MD_BLOCK_QUOTE, 0,
-                                0, MD_BLOCK_CONTAINER_CLOSER));
+                                0, MD_BLOCK_CONTAINER_CLOSER, end));
                 break;
 
             default:
@@ -5913,17 +6634,19 @@ md_is_container_mark(MD_CTX* ctx, unsigned indent, OFF beg, OFF* p_end, MD_CONTA
         p_container->is_task = FALSE;
         p_container->mark_indent = indent;
         p_container->contents_indent = indent + 1;
+        p_container->mark_beg = beg;
         *p_end = off;
         return TRUE;
     }
 
     /* Check for list item bullet mark. */
-    if(ISANYOF(off, _T("-+*"))  &&  (off+1 >= ctx->size || ISBLANK(off+1) || ISNEWLINE(off+1))) {
+    if(ISCLASS(off, MD_CHAR_LIST_BULLET)  &&  (off+1 >= ctx->size || ISBLANK(off+1) || ISNEWLINE(off+1))) {
         p_container->ch = CH(off);
         p_container->is_loose = FALSE;
         p_container->is_task = FALSE;
         p_container->mark_indent = indent;
         p_container->contents_indent = indent + 1;
+        p_container->mark_beg = beg;
         *p_end = off+1;
         return TRUE;
     }
@@ -5947,6 +6670,7 @@ md_is_container_mark(MD_CTX* ctx, unsigned indent, OFF beg, OFF* p_end, MD_CONTA
         p_container->is_task = FALSE;
         p_container->mark_indent = indent;
         p_container->contents_indent = indent + off - beg + 1;
+        p_container->mark_beg = beg;
         *p_end = off+1;
         return TRUE;
     }
@@ -5954,12 +6678,94 @@ md_is_container_mark(MD_CTX* ctx, unsigned indent, OFF beg, OFF* p_end, MD_CONTA
     return FALSE;
 }
 
+/* Return the offset of the first new line character at or after off, or
+ * ctx->size if there is none. */
+static MD_FORCE_INLINE OFF
+md_skip_to_newline(MD_CTX* ctx, OFF off)
+{
+#ifdef MD_SIMD
+    const unsigned char* text = (const unsigned char*) ctx->text;
+
+  #if defined MD_SIMD_SSE2
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    #ifdef MD_SIMD_AVX2
+    const __m256i cr2 = _mm256_set1_epi8('\r');
+    const __m256i lf2 = _mm256_set1_epi8('\n');
+
+    while(off + 32 <= ctx->size) {
+        __m256i v = _mm256_loadu_si256((const __m256i*) (text + off));
+        uint32_t newlines = (uint32_t) _mm256_movemask_epi8(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(v, cr2), _mm256_cmpeq_epi8(v, lf2)));
+
+        if(newlines != 0)
+            return off + md_count_trailing_zeros(newlines);
+        off += 32;
+    }
+    #endif
+
+    while(off + 16 <= ctx->size) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (text + off));
+        uint32_t newlines = (uint32_t) _mm_movemask_epi8(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+
+        if(newlines != 0)
+            return off + md_count_trailing_zeros(newlines);
+        off += 16;
+    }
+  #elif defined MD_SIMD_NEON
+    const uint8x16_t cr = vdupq_n_u8('\r');
+    const uint8x16_t lf = vdupq_n_u8('\n');
+
+    while(off + 16 <= ctx->size) {
+        uint8x16_t v = vld1q_u8(text + off);
+        unsigned i = md_neon_first_set(vorrq_u8(vceqq_u8(v, cr), vceqq_u8(v, lf)));
+
+        if(i < 16)
+            return off + i;
+        off += 16;
+    }
+  #endif
+#endif  /* MD_SIMD */
+
+    /* Optimization: Use some loop unrolling. */
+    while(off + 3 < ctx->size  &&  !ISNEWLINE(off+0)  &&  !ISNEWLINE(off+1)
+                               &&  !ISNEWLINE(off+2)  &&  !ISNEWLINE(off+3))
+        off += 4;
+    while(off < ctx->size  &&  !ISNEWLINE(off))
+        off++;
+
+    return off;
+}
+
 static unsigned
 md_line_indentation(MD_CTX* ctx, unsigned total_indent, OFF beg, OFF* p_end)
 {
     OFF off = beg;
     unsigned indent = total_indent;
 
+#ifdef MD_SIMD
+    /* Deeply indented code is mostly runs of spaces; consume those a vector
+     * at a time and leave tabs (and the tail) to the loop below. */
+    {
+        const unsigned char* text = (const unsigned char*) ctx->text;
+        unsigned n;
+
+        do {
+            if(off + 16 > ctx->size)
+                break;
+  #if defined MD_SIMD_SSE2
+            n = md_count_trailing_zeros(~(uint32_t) _mm_movemask_epi8(
+                        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (text + off)), _mm_set1_epi8(' '))));
+  #elif defined MD_SIMD_NEON
+            n = md_neon_first_set(vmvnq_u8(vceqq_u8(vld1q_u8(text + off), vdupq_n_u8(' '))));
+  #endif
+            off += n;
+            indent += n;
+        } while(n == 16);
+    }
+#endif
+
     while(off < ctx->size  &&  ISBLANK(off)) {
         if(CH(off) == _T('\t'))
             indent = (indent + 4) & ~3;
@@ -5972,7 +6778,7 @@ md_line_indentation(MD_CTX* ctx, unsigned total_indent, OFF beg, OFF* p_end)
     return indent - total_indent;
 }
 
-static const MD_LINE_ANALYSIS md_dummy_blank_line = { MD_LINE_BLANK, 0, 0, 0, 0, 0 };
+static const MD_LINE_ANALYSIS md_dummy_blank_line = { MD_LINE_BLANK, 0, 0, 0, 0, 0, 0, 0 };
 
 /* Analyze type of the line and find some its properties. This serves as a
  * main input for determining type and boundaries of a block. */
@@ -5988,12 +6794,15 @@ md_analyze_line(MD_CTX* ctx, OFF beg, OFF* p_end,
     int prev_line_has_list_loosening_effect = ctx->last_line_has_list_loosening_effect;
     OFF off = beg;
     OFF hr_killer = 0;
+    int is_closing_fence = FALSE;
+    int has_content;
     int ret = 0;
 
     line->indent = md_line_indentation(ctx, total_indent, off, &off);
     total_indent += line->indent;
     line->beg = off;
     line->enforce_new_block = FALSE;
+    has_content = (off < ctx->size  &&  !ISNEWLINE(off));
 
     /* Given the indentation and block quote marks '>', determine how many of
      * the current containers are our parents. */
@@ -6035,6 +6844,9 @@ md_analyze_line(MD_CTX* ctx, OFF beg, OFF* p_end,
     }
 
     while(TRUE) {
+        /* Whatever the line turns out to be, its own syntax starts here. */
+        line->syntax_beg = off;
+
         /* Check whether we are fenced code continuation. */
         if(pivot_line->type == MD_LINE_FENCEDCODE) {
             line->beg = off;
@@ -6044,6 +6856,7 @@ md_analyze_line(MD_CTX* ctx, OFF beg, OFF* p_end,
             if(line->indent < ctx->code_indent_offset) {
                 if(md_is_closing_code_fence(ctx, CH(pivot_line->beg), off, &off)) {
                     line->type = MD_LINE_BLANK;
+                    is_closing_fence = TRUE;
                     ctx->last_line_has_list_loosening_effect = FALSE;
                     break;
                 }
@@ -6120,11 +6933,10 @@ md_analyze_line(MD_CTX* ctx, OFF beg, OFF* p_end,
                  */
                 if(n_parents > 0  &&  ctx->containers[n_parents-1].ch != _T('>')  &&
                    n_brothers + n_children == 0  &&  ctx->current_block == NULL  &&
-                   ctx->n_block_bytes > (int) sizeof(MD_BLOCK))
+                   ctx->n_block_bytes > (int) sizeof(MD_BLOCK)  &&
+                   ctx->n_block_bytes == ctx->li_opener_block_bytes)
                 {
-                    MD_BLOCK* top_block = (MD_BLOCK*) ((char*)ctx->block_bytes + ctx->n_block_bytes - sizeof(MD_BLOCK));
-                    if(top_block->type == MD_BLOCK_LI)
-                        ctx->last_list_item_starts_with_two_blank_lines = TRUE;
+                    ctx->last_list_item_starts_with_two_blank_lines = TRUE;
                 }
     #endif
             }
@@ -6139,16 +6951,14 @@ md_analyze_line(MD_CTX* ctx, OFF beg, OFF* p_end,
                 if(n_parents > 0  &&  n_parents == ctx->n_containers  &&
                    ctx->containers[n_parents-1].ch != _T('>')  &&
                    n_brothers + n_children == 0  &&  ctx->current_block == NULL  &&
-                   ctx->n_block_bytes > (int) sizeof(MD_BLOCK))
+                   ctx->n_block_bytes > (int) sizeof(MD_BLOCK)  &&
+                   ctx->n_block_bytes == ctx->li_opener_block_bytes)
                 {
-                    MD_BLOCK* top_block = (MD_BLOCK*) ((char*)ctx->block_bytes + ctx->n_block_bytes - sizeof(MD_BLOCK));
-                    if(top_block->type == MD_BLOCK_LI) {
-                        n_parents--;
+                    n_parents--;
 
-                        line->indent = total_indent;
-                        if(n_parents > 0)
-                            line->indent -= MIN(line->indent, ctx->containers[n_parents-1].contents_indent);
-                    }
+                    line->indent = total_indent;
+                    if(n_parents > 0)
+                        line->indent -= MIN(line->indent, ctx->containers[n_parents-1].contents_indent);
                 }
 
                 ctx->last_list_item_starts_with_two_blank_lines = FALSE;
@@ -6174,7 +6984,7 @@ md_analyze_line(MD_CTX* ctx, OFF beg, OFF* p_end,
         /* Check for thematic break line. */
         if(line->indent < ctx->code_indent_offset
             &&  off < ctx->size  &&  off >= hr_killer
-            &&  ISANYOF(off, _T("-_*")))
+            &&  ISCLASS(off, MD_CHAR_HR))
         {
             if(md_is_hr_line(ctx, off, &off, &hr_killer)) {
                 line->type = MD_LINE_HR;
@@ -6349,14 +7159,14 @@ md_analyze_line(MD_CTX* ctx, OFF beg, OFF* p_end,
 
         /* Check for task mark. */
         if((ctx->parser.flags & MD_FLAG_TASKLISTS)  &&  n_brothers + n_children > 0  &&
-           ISANYOF_(ctx->containers[ctx->n_containers-1].ch, _T("-+*.)")))
+           ISCLASS_(ctx->containers[ctx->n_containers-1].ch, MD_CHAR_LIST_MARK))
         {
             OFF tmp = off;
 
             while(tmp < ctx->size  &&  tmp < off + 3  &&  ISBLANK(tmp))
                 tmp++;
             if(tmp + 2 < ctx->size  &&  CH(tmp) == _T('[')  &&
-               ISANYOF(tmp+1, _T("xX "))  &&  CH(tmp+2) == _T(']')  &&
+               ISCLASS(tmp+1, MD_CHAR_TASK_CHECK)  &&  CH(tmp+2) == _T(']')  &&
                (tmp + 3 == ctx->size  ||  ISBLANK(tmp+3)  ||  ISNEWLINE(tmp+3)))
             {
                 MD_CONTAINER* task_container = (n_children > 0 ? &ctx->containers[ctx->n_containers-1] : &container);
@@ -6373,15 +7183,16 @@ md_analyze_line(MD_CTX* ctx, OFF beg, OFF* p_end,
     }
 
     /* Scan for end of the line. */
-    /* Optimization: Use some loop unrolling. */
-    while(off + 3 < ctx->size  &&  !ISNEWLINE(off+0)  &&  !ISNEWLINE(off+1)
-                               &&  !ISNEWLINE(off+2)  &&  !ISNEWLINE(off+3))
-        off += 4;
-    while(off < ctx->size  &&  !ISNEWLINE(off))
-        off++;
+    off = md_skip_to_newline(ctx, off);
 
     /* Set end of the line. */
     line->end = off;
+    line->syntax_end = off;
+
+    /* The closing fence is not a line of the code block but still part of its
+     * source range. */
+    if(is_closing_fence  &&  ctx->current_block != NULL)
+        ctx->current_block->end = off;
 
     /* But for ATX header, we should exclude the optional trailing mark. */
     if(line->type == MD_LINE_ATXHEADER) {
@@ -6427,11 +7238,11 @@ md_analyze_line(MD_CTX* ctx, OFF beg, OFF* p_end,
         MD_CHECK(md_push_container_bytes(ctx, MD_BLOCK_LI,
                     ctx->containers[n_parents].task_mark_off,
                     (ctx->containers[n_parents].is_task ? CH(ctx->containers[n_parents].task_mark_off) : 0),
-                    MD_BLOCK_CONTAINER_CLOSER));
+                    MD_BLOCK_CONTAINER_CLOSER, MAX(ctx->last_content_end, ctx->containers[n_parents].mark_beg)));
         MD_CHECK(md_push_container_bytes(ctx, MD_BLOCK_LI,
                     container.task_mark_off,
                     (container.is_task ? CH(container.task_mark_off) : 0),
-                    MD_BLOCK_CONTAINER_OPENER));
+                    MD_BLOCK_CONTAINER_OPENER, container.mark_beg));
         ctx->containers[n_parents].is_task = container.is_task;
         ctx->containers[n_parents].task_mark_off = container.task_mark_off;
     }
@@ -6439,6 +7250,10 @@ md_analyze_line(MD_CTX* ctx, OFF beg, OFF* p_end,
     if(n_children > 0)
         MD_CHECK(md_enter_child_containers(ctx, n_children));
 
+    /* Containers closed by any later line end with this one. */
+    if(has_content)
+        ctx->last_content_end = line->syntax_end;
+
 abort:
     return ret;
 }
@@ -6528,6 +7343,7 @@ md_process_doc(MD_CTX *ctx)
     OFF off = 0;
     int ret = 0;
 
+    MD_SOURCE_OFFSET(0);
     MD_ENTER_BLOCK(MD_BLOCK_DOC, NULL);
 
     while(off < ctx->size) {
@@ -6546,6 +7362,7 @@ md_process_doc(MD_CTX *ctx)
     MD_CHECK(md_leave_child_containers(ctx, 0));
     MD_CHECK(md_process_all_blocks(ctx));
 
+    MD_SOURCE_OFFSET(ctx->size);
     MD_LEAVE_BLOCK(MD_BLOCK_DOC, NULL);
 
 abort:
@@ -6601,8 +7418,11 @@ md_parse(const MD_CHAR* text, MD_SIZE size, const MD_PARSER* parser, void* userd
     ctx.userdata = userdata;
     ctx.code_indent_offset = (ctx.parser.flags & MD_FLAG_NOINDENTEDCODEBLOCKS) ? (OFF)(-1) : 4;
     md_build_mark_char_map(&ctx);
+    md_select_collect_marks(&ctx);
     ctx.doc_ends_with_newline = (size > 0  &&  ISNEWLINE_(text[size-1]));
     ctx.max_ref_def_output = 16 * MIN(size, (MD_SIZE)(1024 * 1024 / 16));
+    ctx.max_marks = (parser->max_inline_marks > 0  &&  parser->max_inline_marks < INT_MAX)
+                        ? (int) parser->max_inline_marks : INT_MAX;
 
     /* Reset all mark stacks and lists. */
     for(i = 0; i < (int) SIZEOF_ARRAY(ctx.opener_stacks); i++)
@@ -6619,10 +7439,10 @@ md_parse(const MD_CHAR* text, MD_SIZE size, const MD_PARSER* parser, void* userd
     /* Clean-up. */
     md_free_ref_defs(&ctx);
     md_free_ref_def_hashtable(&ctx);
-    free(ctx.buffer);
-    free(ctx.marks);
-    free(ctx.block_bytes);
-    free(ctx.containers);
+    md_free(&ctx, ctx.buffer);
+    md_free(&ctx, ctx.marks);
+    md_free(&ctx, ctx.block_bytes);
+    md_free(&ctx, ctx.containers);
 
     return ret;
 }
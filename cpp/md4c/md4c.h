@@ -26,6 +26,8 @@
 #ifndef MD4C_H
 #define MD4C_H
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -159,7 +161,17 @@ typedef enum MD_SPANTYPE {
   /* <sub>...</sub>
      * Syntax: ~subscript~
      * Note: Recognized only when MD_FLAG_SUBSCRIPTS is enabled. */
-  MD_SPAN_SUBSCRIPT
+  MD_SPAN_SUBSCRIPT,
+
+  /* Mentions (@name), hashtags (#name) and emoji shortcodes (:name:).
+     * Detail: Structure MD_SPAN_TOKEN_DETAIL.
+     * Note: Recognized only when MD_FLAG_MENTIONS, MD_FLAG_HASHTAGS or
+     * MD_FLAG_EMOJISHORTCODES respectively is enabled. The text of a mention
+     * or hashtag span is the token as written; the text of a shortcode span
+     * is the emoji MD_PARSER::emoji_shortcode() returned for it. */
+  MD_SPAN_MENTION,
+  MD_SPAN_HASHTAG,
+  MD_SPAN_EMOJI_SHORTCODE
 } MD_SPANTYPE;
 
 /* Text is the actual textual contents of span. */
@@ -309,6 +321,12 @@ typedef struct MD_SPAN_WIKILINK {
   MD_ATTRIBUTE target;
 } MD_SPAN_WIKILINK_DETAIL;
 
+/* Detailed info for MD_SPAN_MENTION, MD_SPAN_HASHTAG and MD_SPAN_EMOJI_SHORTCODE. */
+typedef struct MD_SPAN_TOKEN_DETAIL {
+  const MD_CHAR *name; /* Without the '@', '#' or colons. Not zero-terminated. */
+  MD_SIZE name_size;
+} MD_SPAN_TOKEN_DETAIL;
+
 /* Flags specifying extensions/deviations from CommonMark specification.
  *
  * By default (when MD_PARSER::flags == 0), we follow CommonMark specification.
@@ -333,6 +351,9 @@ typedef struct MD_SPAN_WIKILINK {
 #define MD_FLAG_SPOILERS 0x10000        /* Enable ||hidden text|| spoiler spans. */
 #define MD_FLAG_SUPERSCRIPTS 0x20000    /* Enable ^superscript^ spans. */
 #define MD_FLAG_SUBSCRIPTS 0x40000      /* Enable ~subscript~ spans. */
+#define MD_FLAG_MENTIONS 0x80000        /* Enable @mention spans. */
+#define MD_FLAG_HASHTAGS 0x100000       /* Enable #hashtag spans. */
+#define MD_FLAG_EMOJISHORTCODES 0x200000 /* Enable :shortcode: spans (needs MD_PARSER::emoji_shortcode). */
 
 #define MD_FLAG_PERMISSIVEAUTOLINKS                                                                                    \
   (MD_FLAG_PERMISSIVEEMAILAUTOLINKS | MD_FLAG_PERMISSIVEURLAUTOLINKS | MD_FLAG_PERMISSIVEWWWAUTOLINKS)
@@ -352,6 +373,18 @@ typedef struct MD_SPAN_WIKILINK {
 
 /* Parser structure.
  */
+/* Allocator callbacks for MD_PARSER::allocator.
+ *
+ * reallocate() has the semantics of realloc(): it allocates when 'ptr' is NULL
+ * and must return memory suitably aligned for any type, or NULL on failure
+ * (leaving 'ptr' untouched). release() must accept NULL.
+ */
+typedef struct MD_ALLOCATOR {
+  void *(*reallocate)(void * /*ptr*/, size_t /*size*/, void * /*userdata*/);
+  void (*release)(void * /*ptr*/, void * /*userdata*/);
+  void *userdata;
+} MD_ALLOCATOR;
+
 typedef struct MD_PARSER {
   /* Reserved. Set to zero.
      */
@@ -396,6 +429,47 @@ typedef struct MD_PARSER {
   /* Reserved. Set to NULL.
      */
   void (*syntax)(void);
+
+  /* Source offset callback. Optional (may be NULL).
+     *
+     * If provided, it is called immediately before every enter_block() and
+     * enter_span() callback with the offset of the first byte of the block or
+     * span in the input, and immediately before every leave_block() and
+     * leave_span() callback with the offset just past its last byte. The range
+     * includes the construct's own syntax (block quote and list item marks,
+     * ATX heading marks, code fences, setext and table underlines, emphasis
+     * delimiters, link destinations, ...) but not the trailing line break.
+     */
+  void (*source_offset)(MD_OFFSET /*offset*/, void * /*userdata*/);
+
+  /* Memory allocator. Optional (may be NULL).
+     *
+     * If provided, md4c obtains and releases all of its working memory through
+     * it instead of malloc(), realloc() and free(), so the application can keep
+     * buffers warm across md_parse() calls. All memory it hands out is released
+     * again before md_parse() returns.
+     */
+  const struct MD_ALLOCATOR *allocator;
+
+  /* Inline mark limit. Optional (may be 0 for no limit).
+     *
+     * The most emphasis delimiters, brackets, backticks and other inline
+     * marks collected for one paragraph (or other block with inline
+     * contents). The rest of the block is treated as plain text, which bounds
+     * the memory and the work spent resolving marks in hostile input.
+     */
+  unsigned max_inline_marks;
+
+  /* Emoji shortcode lookup. Optional (may be NULL).
+     *
+     * With MD_FLAG_EMOJISHORTCODES, called with the name between the colons
+     * of every ":name:" candidate. It returns the emoji the name stands for,
+     * storing its size in *p_size, or NULL if the name is unknown and the text
+     * stays as written. The returned string must outlive md_parse(). Without
+     * it, no shortcodes are recognized.
+     */
+  const MD_CHAR *(*emoji_shortcode)(const MD_CHAR * /*name*/, MD_SIZE /*size*/, MD_SIZE * /*p_size*/,
+                                    void * /*userdata*/);
 } MD_PARSER;
 
 /* For backward compatibility. Do not use in new code.
@@ -0,0 +1,245 @@
+#include "BlockScanner.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace Markdown {
+
+namespace {
+
+// Like md4c, only spaces and tabs count: a line holding a form feed or
+// vertical tab is not blank and continues a paragraph.
+bool isBlankLine(std::string_view line) {
+  return line.find_first_not_of(" \t") == std::string_view::npos;
+}
+
+size_t skipSpaces(std::string_view line, size_t pos) {
+  while (pos < line.size() && line[pos] == ' ') {
+    ++pos;
+  }
+  return pos;
+}
+
+// Returns the position after a `-`, `+`, `*` or `1.` / `1)` list marker and
+// the whitespace that must follow it, or `pos` if there is no marker there.
+size_t skipListMarker(std::string_view line, size_t pos) {
+  size_t end = pos;
+  if (end < line.size() && (line[end] == '-' || line[end] == '+' || line[end] == '*')) {
+    ++end;
+  } else {
+    while (end < line.size() && end - pos < 9 && line[end] >= '0' && line[end] <= '9') {
+      ++end;
+    }
+    if (end == pos || end >= line.size() || (line[end] != '.' && line[end] != ')')) {
+      return pos;
+    }
+    ++end;
+  }
+  if (end < line.size() && line[end] != ' ' && line[end] != '\t') {
+    return pos;
+  }
+  return end;
+}
+
+// True if a line that follows a blank line can only start a new top-level
+// block, i.e. it cannot continue a list item (indented) or the list itself
+// (another marker). Thematic breaks made of `-` or `*` are treated as list
+// markers, which only costs a missed boundary.
+bool startsTopLevelBlock(std::string_view line) {
+  char c = line[0];
+  if (c == ' ' || c == '\t' || c == '-' || c == '+' || c == '*') {
+    return false;
+  }
+  if (c >= '0' && c <= '9') {
+    size_t end = 0;
+    while (end < line.size() && end < 10 && line[end] >= '0' && line[end] <= '9') {
+      ++end;
+    }
+    return end < line.size() && line[end] != '.' && line[end] != ')';
+  }
+  return true;
+}
+
+// Skips the indentation and list markers a line may start with, which leave
+// it inside a list item.
+size_t skipListPrefix(std::string_view line) {
+  size_t pos = 0;
+  for (;;) {
+    size_t next = pos;
+    while (next < line.size() && (line[next] == ' ' || line[next] == '\t')) {
+      ++next;
+    }
+    next = skipListMarker(line, next);
+    if (next == pos) {
+      return pos;
+    }
+    pos = next;
+  }
+}
+
+// Recognizes an opening code fence at `pos`.
+bool opensFence(std::string_view line, size_t pos, char &fenceChar, uint32_t &fenceLength) {
+  if (pos >= line.size() || (line[pos] != '`' && line[pos] != '~')) {
+    return false;
+  }
+  char c = line[pos];
+  size_t end = pos;
+  while (end < line.size() && line[end] == c) {
+    ++end;
+  }
+  if (end - pos < 3) {
+    return false;
+  }
+  // Backtick fences may not have backticks in their info string.
+  if (c == '`' && line.find('`', end) != std::string_view::npos) {
+    return false;
+  }
+  fenceChar = c;
+  fenceLength = static_cast<uint32_t>(end - pos);
+  return true;
+}
+
+bool closesFence(std::string_view line, char fenceChar, uint32_t fenceLength) {
+  size_t pos = skipSpaces(line, 0);
+  if (pos > 3) {
+    return false;
+  }
+  size_t end = pos;
+  while (end < line.size() && line[end] == fenceChar) {
+    ++end;
+  }
+  return end - pos >= fenceLength && isBlankLine(line.substr(end));
+}
+
+} // anonymous namespace
+
+BlockScanner::Line BlockScanner::scanLine(std::string_view line) {
+  Line result;
+  bool blank = isBlankLine(line);
+  // A boundary needs md4c to be outside any fence under every reading.
+  bool certainlyOutside = openFences_.empty();
+  bool wasOutside = mayBeOutside_;
+
+  size_t open = openFences_.size();
+  openFences_.erase(std::remove_if(openFences_.begin(), openFences_.end(),
+                                   [&](const Fence &fence) { return closesFence(line, fence.c, fence.length); }),
+                    openFences_.end());
+  mayBeOutside_ = wasOutside || openFences_.size() < open;
+
+  if (wasOutside && !blank) {
+    result.boundary = certainlyOutside && previousLineBlank_ && startsTopLevelBlock(line);
+    result.mayDefineReference = mayDefineReference(line, true);
+
+    Fence fence;
+    size_t prefix = skipListPrefix(line);
+    if (opensFence(line, prefix, fence.c, fence.length)) {
+      // An unindented fence always starts a top-level code block, except as a
+      // row of a table (md4c keeps table rows going until a blank line). One
+      // behind indentation or list markers may instead be indented code or
+      // open a fence inside a list item. md4c keeps such a fence open across
+      // blank lines and takes an unindented closing fence after them to close
+      // it, so keep both readings then. Where such a fence may still be open,
+      // md4c skips the fence characters of a line that does not close it
+      // before looking for a new block, so that line need not open one either.
+      bool certain = prefix == 0 && !mayBeInTable_ && openFences_.empty();
+      if (certain) {
+        mayBeOutside_ = openFences_.size() < open;
+      }
+      if (std::find(openFences_.begin(), openFences_.end(), fence) == openFences_.end()) {
+        openFences_.push_back(fence);
+      }
+    }
+    if (line.find('|') != std::string_view::npos) {
+      mayBeInTable_ = true;
+    }
+  }
+  if (blank) {
+    mayBeInTable_ = false;
+  }
+  previousLineBlank_ = blank;
+  return result;
+}
+
+void BlockScanner::reset() {
+  previousLineBlank_ = false;
+  mayBeInTable_ = false;
+  mayBeOutside_ = true;
+  openFences_.clear();
+}
+
+void BlockScanner::resumeAtBoundary() {
+  reset();
+  previousLineBlank_ = true;
+}
+
+bool BlockScanner::mayDefineReference(std::string_view line, bool lineComplete) {
+  size_t pos = 0;
+  for (;;) {
+    size_t next = pos;
+    while (next < line.size() && (line[next] == ' ' || line[next] == '\t' || line[next] == '>')) {
+      ++next;
+    }
+    next = skipListMarker(line, next);
+    if (next == pos) {
+      break;
+    }
+    pos = next;
+  }
+  if (pos >= line.size() || line[pos] != '[') {
+    return false;
+  }
+  std::string_view rest = line.substr(pos + 1);
+  return rest.find("]:") != std::string_view::npos || (lineComplete && rest.find(']') == std::string_view::npos);
+}
+
+bool findLineEnd(std::string_view text, size_t begin, bool complete, size_t &lineEnd, size_t &nextLine) {
+  const char *data = text.data();
+  auto *newline = static_cast<const char *>(std::memchr(data + begin, '\n', text.size() - begin));
+  size_t end = newline ? static_cast<size_t>(newline - data) : text.size();
+  // Carriage returns are rare, so they are only looked for up to the next
+  // line feed.
+  auto *carriageReturn = static_cast<const char *>(std::memchr(data + begin, '\r', end - begin));
+  if (carriageReturn) {
+    lineEnd = static_cast<size_t>(carriageReturn - data);
+    nextLine = lineEnd + 1;
+    if (nextLine < text.size()) {
+      nextLine += text[nextLine] == '\n';
+      return true;
+    }
+    return complete;
+  }
+  lineEnd = end;
+  nextLine = newline ? end + 1 : end;
+  return newline != nullptr;
+}
+
+std::vector<SourceBlock> splitTopLevelBlocks(std::string_view markdown) {
+  std::vector<SourceBlock> blocks;
+  if (markdown.empty()) {
+    return blocks;
+  }
+
+  BlockScanner scanner;
+  SourceBlock current;
+  auto size = static_cast<uint32_t>(markdown.size());
+  uint32_t lineStart = 0;
+  while (lineStart < size) {
+    size_t lineEnd = 0;
+    size_t nextLine = 0;
+    findLineEnd(markdown, lineStart, true, lineEnd, nextLine);
+
+    BlockScanner::Line line = scanner.scanLine(markdown.substr(lineStart, lineEnd - lineStart));
+    if (line.boundary) {
+      current.end = lineStart;
+      blocks.push_back(current);
+      current = SourceBlock{lineStart, 0, false};
+    }
+    current.mayDefineReferences |= line.mayDefineReference;
+    lineStart = static_cast<uint32_t>(nextLine);
+  }
+
+  current.end = size;
+  blocks.push_back(current);
+  return blocks;
+}
+
+} // namespace Markdown
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace Markdown {
+
+// Finds top-level block boundaries line by line, without parsing. A boundary
+// is the start of a line that follows a blank line outside any code fence and
+// can only begin a new top-level block (it is not indented and not a list
+// marker). md4c parses the text on either side of a boundary exactly as it
+// would within the whole document, except that reference definitions apply
+// document-wide; lines that may hold one are reported so callers can account
+// for them.
+class BlockScanner {
+public:
+  struct Line {
+    // The line starts a new top-level block.
+    bool boundary = false;
+    // The line may hold (the start of) a link reference definition.
+    bool mayDefineReference = false;
+  };
+
+  // Feeds the next complete line, without its line terminator (see
+  // findLineEnd).
+  Line scanLine(std::string_view line);
+
+  // Starts over, as if at the beginning of a document.
+  void reset();
+
+  // Continues scanning at a known boundary, as if right after the blank line
+  // that precedes it.
+  void resumeAtBoundary();
+
+  // True if md4c is inside a top-level code fence under every reading of
+  // the lines so far.
+  bool inFence() const {
+    return !mayBeOutside_;
+  }
+
+  // Conservative check for a line that may hold (the start of) a link
+  // reference definition, inside any quote or list container. A complete line
+  // whose label is not closed counts too, since labels may span lines.
+  static bool mayDefineReference(std::string_view line, bool lineComplete);
+
+private:
+  struct Fence {
+    char c = 0;
+    uint32_t length = 0;
+
+    bool operator==(const Fence &other) const {
+      return c == other.c && length == other.length;
+    }
+  };
+
+  // Some fence-like lines only open a code block depending on context the
+  // scanner does not track, so it follows every possible reading: md4c may
+  // be outside any fence and/or inside any of `openFences_`.
+  bool mayBeOutside_ = true;
+  std::vector<Fence> openFences_;
+  bool previousLineBlank_ = false;
+  bool mayBeInTable_ = false;
+};
+
+// Finds where the line starting at `begin` ends, the way md4c does: at "\n",
+// "\r\n" or a lone "\r". Sets `lineEnd` to the end of the line's text and
+// `nextLine` to the start of the line after it. Returns false if the line has
+// no terminator yet; unless `complete`, a "\r" at the end of `text` does not
+// count as one, since a "\n" may still follow it.
+bool findLineEnd(std::string_view text, size_t begin, bool complete, size_t &lineEnd, size_t &nextLine);
+
+// A top-level block as found by BlockScanner: bytes [begin, end) of the
+// source, including the blank lines that end it.
+struct SourceBlock {
+  uint32_t begin = 0;
+  uint32_t end = 0;
+  bool mayDefineReferences = false;
+};
+
+// Splits `markdown` into consecutive top-level blocks covering all of it.
+std::vector<SourceBlock> splitTopLevelBlocks(std::string_view markdown);
+
+} // namespace Markdown
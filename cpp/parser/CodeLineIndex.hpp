@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Markdown {
+
+// Where each line of a code block starts in its text, so a renderer can lay
+// out only the lines on screen and copy a range of lines without the rest.
+// The text of a CodeBlock is the content of its one Text child, in which md4c
+// ends every line, the last one included, with a line feed.
+//
+// Offsets count bytes, or UTF-16 code units for the bridges, whose strings
+// are indexed by those. Building an index takes a memchr per line, plus a
+// count of UTF-16 units for text that is not ASCII.
+class CodeLineIndex {
+public:
+  enum class Unit { Bytes, Utf16 };
+
+  explicit CodeLineIndex(std::string_view text, Unit unit = Unit::Bytes) : unit_(unit) {
+    indexFrom(text, 0);
+  }
+
+  // Indexes `text`, which has to start with every line but the last of the
+  // text `previous` was built from, as a code block that is still streaming
+  // in does. Only the lines from that last one on are scanned; it is scanned
+  // again since it may have been cut short.
+  CodeLineIndex(std::string_view text, Unit unit, CodeLineIndex &&previous) : unit_(unit) {
+    if (previous.unit_ == unit && previous.lastLineBegin_ < text.size()) {
+      starts_ = std::move(previous.starts_);
+      if (!starts_.empty()) {
+        size_ = starts_.back();
+        starts_.pop_back();
+      }
+      indexFrom(text, previous.lastLineBegin_);
+    } else {
+      indexFrom(text, 0);
+    }
+  }
+
+  uint32_t lineCount() const {
+    return static_cast<uint32_t>(starts_.size());
+  }
+
+  const std::vector<uint32_t> &starts() const {
+    return starts_;
+  }
+
+  // The [begin, end) offsets of lines [first, first + count), clamped to the
+  // lines there are.
+  std::pair<uint32_t, uint32_t> range(uint32_t first, uint32_t count) const {
+    uint32_t last = count > lineCount() - std::min(first, lineCount()) ? lineCount() : first + count;
+    first = std::min(first, last);
+    return {first < lineCount() ? starts_[first] : size_, last < lineCount() ? starts_[last] : size_};
+  }
+
+  // Lines [first, first + count) of `text`, line feeds included. Only for an
+  // index in bytes of the same text.
+  std::string_view lines(std::string_view text, uint32_t first, uint32_t count) const {
+    auto [begin, end] = range(first, count);
+    return text.substr(begin, end - begin);
+  }
+
+private:
+  static constexpr uint64_t kHighBits = 0x8080808080808080ull;
+
+  // Adds the lines of `text` from byte `begin`, the start of a line, on.
+  void indexFrom(std::string_view text, size_t begin) {
+    std::string_view rest = text.substr(begin);
+    // In ASCII, which most code is, bytes are UTF-16 code units.
+    Unit unit = unit_ == Unit::Utf16 && isAscii(rest) ? Unit::Bytes : unit_;
+    const char *at = rest.data();
+    const char *end = at + rest.size();
+    uint32_t offset = size_;
+    while (at < end) {
+      starts_.push_back(offset);
+      lastLineBegin_ = static_cast<uint32_t>(at - text.data());
+      auto *lineFeed = static_cast<const char *>(std::memchr(at, '\n', static_cast<size_t>(end - at)));
+      const char *next = lineFeed ? lineFeed + 1 : end;
+      offset += unit == Unit::Bytes ? static_cast<uint32_t>(next - at) : utf16Length(at, next);
+      at = next;
+    }
+    size_ = offset;
+  }
+
+  // Both work on eight bytes at a time, with the byte-wise loops only for the
+  // rest.
+  static bool isAscii(std::string_view text) {
+    uint64_t bits = 0;
+    size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8) {
+      uint64_t word;
+      std::memcpy(&word, text.data() + i, 8);
+      bits |= word;
+    }
+    for (; i < text.size(); ++i) {
+      bits |= static_cast<unsigned char>(text[i]);
+    }
+    return (bits & kHighBits) == 0;
+  }
+
+  // Continuation bytes (10xxxxxx) add nothing and a 4-byte sequence (lead
+  // byte 11110xxx) becomes a surrogate pair.
+  static uint32_t utf16Length(const char *begin, const char *end) {
+    auto units = static_cast<uint32_t>(end - begin);
+    const char *at = begin;
+    for (; end - at >= 8; at += 8) {
+      uint64_t word;
+      std::memcpy(&word, at, 8);
+      uint64_t continuation = word & ~(word << 1) & kHighBits;
+      uint64_t fourByteLead = word & (word << 1) & (word << 2) & (word << 3) & kHighBits;
+      units -= static_cast<uint32_t>(__builtin_popcountll(continuation));
+      units += static_cast<uint32_t>(__builtin_popcountll(fourByteLead));
+    }
+    for (; at < end; ++at) {
+      auto c = static_cast<unsigned char>(*at);
+      units -= (c & 0xC0) == 0x80;
+      units += c >= 0xF0;
+    }
+    return units;
+  }
+
+  Unit unit_;
+  std::vector<uint32_t> starts_;
+  uint32_t size_ = 0;
+  // Byte offset of the last line, where indexing a longer text resumes.
+  uint32_t lastLineBegin_ = 0;
+};
+
+} // namespace Markdown
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace Markdown {
+
+// 64-bit non-cryptographic hash of a byte string (the XXH64 algorithm). Fast
+// enough to run over a whole document on every parse; callers that cannot
+// afford a collision compare the bytes on a match.
+inline uint64_t contentHash(std::string_view data, uint64_t seed = 0) {
+  constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+  constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+  constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+  constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+  constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+  auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+  auto read64 = [](const char *p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+  };
+  auto read32 = [](const char *p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+  };
+  auto round = [&](uint64_t acc, uint64_t input) { return rotl(acc + input * kPrime2, 31) * kPrime1; };
+  auto merge = [&](uint64_t acc, uint64_t value) { return (acc ^ round(0, value)) * kPrime1 + kPrime4; };
+
+  const char *p = data.data();
+  const char *end = p + data.size();
+  uint64_t h;
+
+  if (data.size() >= 32) {
+    uint64_t v1 = seed + kPrime1 + kPrime2;
+    uint64_t v2 = seed + kPrime2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - kPrime1;
+    for (; end - p >= 32; p += 32) {
+      v1 = round(v1, read64(p));
+      v2 = round(v2, read64(p + 8));
+      v3 = round(v3, read64(p + 16));
+      v4 = round(v4, read64(p + 24));
+    }
+    h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    h = merge(h, v1);
+    h = merge(h, v2);
+    h = merge(h, v3);
+    h = merge(h, v4);
+  } else {
+    h = seed + kPrime5;
+  }
+
+  h += static_cast<uint64_t>(data.size());
+  for (; end - p >= 8; p += 8) {
+    h = rotl(h ^ round(0, read64(p)), 27) * kPrime1 + kPrime4;
+  }
+  if (end - p >= 4) {
+    h = rotl(h ^ (static_cast<uint64_t>(read32(p)) * kPrime1), 23) * kPrime2 + kPrime3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    h = rotl(h ^ (static_cast<uint64_t>(static_cast<unsigned char>(*p)) * kPrime5), 11) * kPrime1;
+  }
+
+  h ^= h >> 33;
+  h *= kPrime2;
+  h ^= h >> 29;
+  h *= kPrime3;
+  h ^= h >> 32;
+  return h;
+}
+
+// Folds `value` into `hash`, order-sensitively, the way contentHash folds in
+// each 8-byte word of its input. Used to build hashes out of other hashes.
+inline uint64_t hashCombine(uint64_t hash, uint64_t value) {
+  constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+  constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+  constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+
+  auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+  uint64_t k = rotl(value * kPrime2, 31) * kPrime1;
+  hash = rotl(hash ^ k, 27) * kPrime1 + kPrime4;
+  hash ^= hash >> 29;
+  return hash;
+}
+
+} // namespace Markdown
@@ -0,0 +1,274 @@
+#include "DocumentIndex.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+namespace Markdown {
+
+namespace {
+
+bool isInlineNode(NodeType type) {
+  switch (type) {
+    case NodeType::Text:
+    case NodeType::Link:
+    case NodeType::LineBreak:
+    case NodeType::Strong:
+    case NodeType::Emphasis:
+    case NodeType::Strikethrough:
+    case NodeType::Underline:
+    case NodeType::Code:
+    case NodeType::Image:
+    case NodeType::LatexMathInline:
+    case NodeType::Spoiler:
+    case NodeType::Superscript:
+    case NodeType::Subscript:
+    case NodeType::Mention:
+    case NodeType::Hashtag:
+    case NodeType::EmojiShortcode:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool isWhitespace(unsigned char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Lowercases ASCII letters, turns spaces into hyphens and drops other ASCII
+// punctuation, like GitHub does for heading anchors. Bytes of multi-byte
+// characters are kept as they are.
+std::string slugify(std::string_view text) {
+  std::string slug;
+  slug.reserve(text.size());
+  for (unsigned char c : text) {
+    if (c >= 'A' && c <= 'Z') {
+      slug += static_cast<char>(c - 'A' + 'a');
+    } else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_' || c >= 0x80) {
+      slug += static_cast<char>(c);
+    } else if (c == ' ') {
+      slug += '-';
+    }
+  }
+  return slug;
+}
+
+NodeIndex nodeOf(const DocumentIndex::Heading &heading) {
+  return heading.node;
+}
+
+NodeIndex nodeOf(const DocumentIndex::Target &target) {
+  return target.node;
+}
+
+NodeIndex nodeOf(const DocumentIndex::Task &task) {
+  return task.node;
+}
+
+NodeIndex nodeOf(const TableModel &table) {
+  return table.table;
+}
+
+// Appends the entries of `from` for nodes [begin, end), which are in
+// document order, and lets `renumber` fix up their node indices.
+template <typename Entry, typename Renumber>
+void appendEntries(std::vector<Entry> &to, const std::vector<Entry> &from, NodeIndex begin, NodeIndex end,
+                   Renumber renumber) {
+  auto before = [](NodeIndex node) { return [node](const Entry &entry) { return nodeOf(entry) < node; }; };
+  auto first = std::partition_point(from.begin(), from.end(), before(begin));
+  auto last = std::partition_point(first, from.end(), before(end));
+  for (auto entry = first; entry != last; ++entry) {
+    to.push_back(*entry);
+    renumber(to.back());
+  }
+}
+
+} // anonymous namespace
+
+const TableModel *DocumentIndex::tableOf(NodeIndex table) const {
+  auto found =
+      std::find_if(tables.begin(), tables.end(), [table](const TableModel &model) { return model.table == table; });
+  return found == tables.end() ? nullptr : &*found;
+}
+
+DocumentIndex DocumentIndex::build(const FlatMarkdownAST &ast) {
+  DocumentIndexBuilder builder;
+  // Pre-order over the sibling links, iterative since limits may be disabled
+  // and leave the tree arbitrarily deep.
+  NodeIndex node = ast.nodes[FlatMarkdownAST::root()].firstChild;
+  while (node != kInvalidNodeIndex) {
+    builder.enter(ast, node);
+    const FlatNode &current = ast.nodes[node];
+    if (current.firstChild != kInvalidNodeIndex) {
+      node = current.firstChild;
+      continue;
+    }
+    // Leave nodes until one has a sibling to move on to.
+    while (node != kInvalidNodeIndex) {
+      builder.leave(ast, node);
+      const FlatNode &left = ast.nodes[node];
+      if (left.nextSibling != kInvalidNodeIndex) {
+        node = left.nextSibling;
+        break;
+      }
+      node = left.parent == FlatMarkdownAST::root() ? kInvalidNodeIndex : left.parent;
+    }
+  }
+  return builder.finish();
+}
+
+void DocumentIndexBuilder::enter(const FlatMarkdownAST &ast, NodeIndex node) {
+  const FlatNode &current = ast.nodes[node];
+  const NodeAttributes *attrs = ast.attributesOf(node);
+  if (!isInlineNode(current.type)) {
+    inWord_ = false;
+  }
+  switch (current.type) {
+    case NodeType::Text: {
+      std::string_view text = ast.content(node);
+      for (unsigned char c : text) {
+        if ((c & 0xC0) != 0x80) {
+          ++index_.characterCount;
+          ++cellLength_;
+        }
+        if (isWhitespace(c)) {
+          inWord_ = false;
+        } else if (!inWord_) {
+          ++index_.wordCount;
+          inWord_ = true;
+        }
+      }
+      if (heading_ != kInvalidNodeIndex) {
+        index_.headings.back().text.append(text);
+      }
+      break;
+    }
+    case NodeType::LineBreak:
+      inWord_ = false;
+      if (heading_ != kInvalidNodeIndex) {
+        index_.headings.back().text += ' ';
+      }
+      break;
+    case NodeType::Heading:
+      index_.headings.push_back({node, attrs ? attrs->level : uint8_t{0}, {}, {}});
+      heading_ = node;
+      break;
+    case NodeType::Link:
+    case NodeType::Image: {
+      DocumentIndex::Target target{
+          node, attrs && attrs->has(AttributeKey::Url) ? std::string(ast.text(attrs->url)) : std::string()};
+      (current.type == NodeType::Link ? index_.links : index_.images).push_back(std::move(target));
+      break;
+    }
+    case NodeType::Table: {
+      TableModel table;
+      table.table = node;
+      if (attrs) {
+        table.columnCount = attrs->colCount;
+        table.headRowCount = attrs->headRowCount;
+        table.rows.reserve(attrs->headRowCount + attrs->bodyRowCount);
+        table.cells.reserve(static_cast<size_t>(attrs->headRowCount + attrs->bodyRowCount) * attrs->colCount);
+      }
+      table.alignments.assign(table.columnCount, CellAlign::Default);
+      table.columnMaxLength.assign(table.columnCount, 0);
+      index_.tables.push_back(std::move(table));
+      break;
+    }
+    case NodeType::TableRow:
+      if (!index_.tables.empty()) {
+        index_.tables.back().rows.push_back(node);
+        column_ = 0;
+      }
+      break;
+    case NodeType::TableHeaderCell:
+    case NodeType::TableCell:
+      // Cells past the table's column count are left out, as md4c does.
+      if (!index_.tables.empty() && column_ < index_.tables.back().columnCount) {
+        TableModel &table = index_.tables.back();
+        if (table.rows.size() == 1 && attrs) {
+          table.alignments[column_] = attrs->align;
+        }
+        table.cells.push_back(node);
+        cell_ = node;
+        cellLength_ = 0;
+      }
+      ++column_;
+      break;
+    case NodeType::ListItem:
+      if (attrs && attrs->isTask) {
+        index_.tasks.push_back({node, attrs->taskChecked});
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void DocumentIndexBuilder::leave(const FlatMarkdownAST &ast, NodeIndex node) {
+  const FlatNode &left = ast.nodes[node];
+  if (node == heading_) {
+    heading_ = kInvalidNodeIndex;
+  }
+  if (node == cell_) {
+    TableModel &table = index_.tables.back();
+    uint32_t &longest = table.columnMaxLength[(table.cells.size() - 1) % table.columnCount];
+    longest = std::max(longest, cellLength_);
+    cell_ = kInvalidNodeIndex;
+  } else if (left.type == NodeType::TableRow && !index_.tables.empty()) {
+    TableModel &table = index_.tables.back();
+    table.cells.resize(table.rows.size() * table.columnCount, kInvalidNodeIndex);
+  }
+  if (left.parent == FlatMarkdownAST::root()) {
+    blockEnds_.push_back({node, index_.wordCount, index_.characterCount});
+  }
+}
+
+void DocumentIndexBuilder::appendNodes(const DocumentIndexBuilder &other, NodeIndex begin, NodeIndex end,
+                                       NodeIndex base) {
+  auto renumbered = [&](NodeIndex node) { return node == kInvalidNodeIndex ? node : node - begin + base; };
+  auto renumberNode = [&](auto &entry) { entry.node = renumbered(entry.node); };
+  appendEntries(index_.headings, other.index_.headings, begin, end, renumberNode);
+  appendEntries(index_.links, other.index_.links, begin, end, renumberNode);
+  appendEntries(index_.images, other.index_.images, begin, end, renumberNode);
+  appendEntries(index_.tasks, other.index_.tasks, begin, end, renumberNode);
+  appendEntries(index_.tables, other.index_.tables, begin, end, [&](TableModel &table) {
+    table.table = renumbered(table.table);
+    std::transform(table.rows.begin(), table.rows.end(), table.rows.begin(), renumbered);
+    std::transform(table.cells.begin(), table.cells.end(), table.cells.begin(), renumbered);
+  });
+
+  // Counts only grow, so those of the run are the difference between the
+  // totals at the ends of the blocks around it.
+  auto blockEndsFrom = [&](NodeIndex node) {
+    return std::partition_point(other.blockEnds_.begin(), other.blockEnds_.end(),
+                                [node](const BlockEnd &blockEnd) { return blockEnd.block < node; });
+  };
+  auto totalsBefore = [&](NodeIndex node) {
+    auto after = blockEndsFrom(node);
+    return after == other.blockEnds_.begin() ? BlockEnd{} : *(after - 1);
+  };
+  BlockEnd before = totalsBefore(begin);
+  BlockEnd last = totalsBefore(end);
+  // Unsigned wrap-around gives the right totals whether ours are above or
+  // below those of `other`.
+  uint32_t wordShift = index_.wordCount - before.wordCount;
+  uint32_t characterShift = index_.characterCount - before.characterCount;
+  for (auto blockEnd = blockEndsFrom(begin); blockEnd != other.blockEnds_.end() && blockEnd->block < end; ++blockEnd) {
+    blockEnds_.push_back(
+        {renumbered(blockEnd->block), blockEnd->wordCount + wordShift, blockEnd->characterCount + characterShift});
+  }
+  index_.wordCount = last.wordCount + wordShift;
+  index_.characterCount = last.characterCount + characterShift;
+}
+
+DocumentIndex DocumentIndexBuilder::finish() const {
+  DocumentIndex index = index_;
+  std::unordered_map<std::string, uint32_t> slugUses;
+  for (DocumentIndex::Heading &heading : index.headings) {
+    std::string base = slugify(heading.text);
+    uint32_t uses = slugUses[base]++;
+    heading.slug = uses == 0 ? base : base + '-' + std::to_string(uses);
+  }
+  return index;
+}
+
+} // namespace Markdown
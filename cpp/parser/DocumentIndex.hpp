@@ -0,0 +1,92 @@
+#pragma once
+
+#include "FlatMarkdownAST.hpp"
+#include "TableModel.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Markdown {
+
+// Facts about a document that a table of contents, link and image
+// prefetching, task toggling, reading-time estimates and table layout each
+// used to collect with a walk of their own. A parser asked to collect it (see
+// MD4CParser::setDocumentIndexEnabled) does so in the post-parse pass;
+// otherwise FlatMarkdownAST::index() builds it in a single walk on first use.
+// Either way it is kept with the AST, so an AST shared through ParseCache is
+// only indexed once.
+struct DocumentIndex {
+  struct Heading {
+    NodeIndex node = kInvalidNodeIndex;
+    uint8_t level = 0;
+    // The heading's text without formatting, and a GitHub-style anchor for it
+    // that is unique within the document ("intro", "intro-1", ...).
+    std::string text;
+    std::string slug;
+  };
+
+  struct Target {
+    NodeIndex node = kInvalidNodeIndex;
+    std::string url;
+  };
+
+  struct Task {
+    NodeIndex node = kInvalidNodeIndex;
+    bool checked = false;
+  };
+
+  std::vector<Heading> headings;
+  std::vector<Target> links;
+  std::vector<Target> images;
+  // In document order, so tasks[i] is the item with AttributeKey::TaskIndex i.
+  std::vector<Task> tasks;
+  // In document order.
+  std::vector<TableModel> tables;
+  // Over all text, code and image descriptions included. Words are runs of
+  // non-whitespace, also across formatting; characters are code points.
+  uint32_t wordCount = 0;
+  uint32_t characterCount = 0;
+
+  // The model of the Table node `table`, or nullptr if it is not one.
+  const TableModel *tableOf(NodeIndex table) const;
+
+  static DocumentIndex build(const FlatMarkdownAST &ast);
+};
+
+// Collects a DocumentIndex from the nodes of an AST as a pre-order walk
+// enters and leaves them, so the index can be gathered by a walk that is
+// done anyway. Entries refer to nodes by index, which grows in document
+// order, so what was collected for a run of nodes can be carried over when
+// those nodes are copied to another AST.
+class DocumentIndexBuilder {
+public:
+  void enter(const FlatMarkdownAST &ast, NodeIndex node);
+  void leave(const FlatMarkdownAST &ast, NodeIndex node);
+
+  // Appends what `other` collected for its nodes [begin, end), which must hold
+  // whole top-level blocks and are now nodes [base, base + end - begin) of
+  // the AST this builder collects for, after its last top-level block.
+  void appendNodes(const DocumentIndexBuilder &other, NodeIndex begin, NodeIndex end, NodeIndex base);
+
+  // The index of every block entered and left so far, with heading slugs.
+  DocumentIndex finish() const;
+
+private:
+  // Word and character counts up to the end of a top-level block.
+  struct BlockEnd {
+    NodeIndex block = kInvalidNodeIndex;
+    uint32_t wordCount = 0;
+    uint32_t characterCount = 0;
+  };
+
+  DocumentIndex index_;
+  std::vector<BlockEnd> blockEnds_;
+  NodeIndex heading_ = kInvalidNodeIndex;
+  bool inWord_ = false;
+  // The table cell being walked, its column and the length of its text so far.
+  NodeIndex cell_ = kInvalidNodeIndex;
+  uint32_t column_ = 0;
+  uint32_t cellLength_ = 0;
+};
+
+} // namespace Markdown
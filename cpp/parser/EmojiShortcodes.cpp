@@ -0,0 +1,766 @@
+#include "EmojiShortcodes.hpp"
+#include "PerfectHash.hpp"
+#include <iterator>
+
+namespace Markdown {
+
+namespace {
+
+struct Shortcode {
+  std::string_view name;
+  std::string_view emoji;
+};
+
+// The shortcodes of gemoji (https://github.com/github/gemoji) that chat
+// messages actually use, aliases included, sorted by name.
+constexpr Shortcode kShortcodes[] = {
+    {"+1", "\xF0\x9F\x91\x8D"},
+    {"-1", "\xF0\x9F\x91\x8E"},
+    {"100", "\xF0\x9F\x92\xAF"},
+    {"1st_place_medal", "\xF0\x9F\xA5\x87"},
+    {"2nd_place_medal", "\xF0\x9F\xA5\x88"},
+    {"3rd_place_medal", "\xF0\x9F\xA5\x89"},
+    {"8ball", "\xF0\x9F\x8E\xB1"},
+    {"abc", "\xF0\x9F\x94\xA4"},
+    {"adhesive_bandage", "\xF0\x9F\xA9\xB9"},
+    {"airplane", "\xE2\x9C\x88\xEF\xB8\x8F"},
+    {"alarm_clock", "\xE2\x8F\xB0"},
+    {"alien", "\xF0\x9F\x91\xBD"},
+    {"ambulance", "\xF0\x9F\x9A\x91"},
+    {"anchor", "\xE2\x9A\x93"},
+    {"angel", "\xF0\x9F\x91\xBC"},
+    {"anger", "\xF0\x9F\x92\xA2"},
+    {"angry", "\xF0\x9F\x98\xA0"},
+    {"anguished", "\xF0\x9F\x98\xA7"},
+    {"ant", "\xF0\x9F\x90\x9C"},
+    {"apple", "\xF0\x9F\x8D\x8E"},
+    {"arrow_down", "\xE2\xAC\x87\xEF\xB8\x8F"},
+    {"arrow_forward", "\xE2\x96\xB6\xEF\xB8\x8F"},
+    {"arrow_left", "\xE2\xAC\x85\xEF\xB8\x8F"},
+    {"arrow_lower_left", "\xE2\x86\x99\xEF\xB8\x8F"},
+    {"arrow_lower_right", "\xE2\x86\x98\xEF\xB8\x8F"},
+    {"arrow_right", "\xE2\x9E\xA1\xEF\xB8\x8F"},
+    {"arrow_right_hook", "\xE2\x86\xAA\xEF\xB8\x8F"},
+    {"arrow_up", "\xE2\xAC\x86\xEF\xB8\x8F"},
+    {"arrow_upper_left", "\xE2\x86\x96\xEF\xB8\x8F"},
+    {"arrow_upper_right", "\xE2\x86\x97\xEF\xB8\x8F"},
+    {"arrows_clockwise", "\xF0\x9F\x94\x83"},
+    {"arrows_counterclockwise", "\xF0\x9F\x94\x84"},
+    {"art", "\xF0\x9F\x8E\xA8"},
+    {"asterisk", "\x2A\xEF\xB8\x8F\xE2\x83\xA3"},
+    {"astonished", "\xF0\x9F\x98\xB2"},
+    {"athletic_shoe", "\xF0\x9F\x91\x9F"},
+    {"atm", "\xF0\x9F\x8F\xA7"},
+    {"atom_symbol", "\xE2\x9A\x9B\xEF\xB8\x8F"},
+    {"avocado", "\xF0\x9F\xA5\x91"},
+    {"baby", "\xF0\x9F\x91\xB6"},
+    {"baby_bottle", "\xF0\x9F\x8D\xBC"},
+    {"baby_chick", "\xF0\x9F\x90\xA4"},
+    {"back", "\xF0\x9F\x94\x99"},
+    {"bacon", "\xF0\x9F\xA5\x93"},
+    {"balloon", "\xF0\x9F\x8E\x88"},
+    {"ballot_box_with_check", "\xE2\x98\x91\xEF\xB8\x8F"},
+    {"banana", "\xF0\x9F\x8D\x8C"},
+    {"bangbang", "\xE2\x80\xBC\xEF\xB8\x8F"},
+    {"bar_chart", "\xF0\x9F\x93\x8A"},
+    {"baseball", "\xE2\x9A\xBE"},
+    {"basketball", "\xF0\x9F\x8F\x80"},
+    {"bat", "\xF0\x9F\xA6\x87"},
+    {"battery", "\xF0\x9F\x94\x8B"},
+    {"bear", "\xF0\x9F\x90\xBB"},
+    {"bed", "\xF0\x9F\x9B\x8F\xEF\xB8\x8F"},
+    {"bee", "\xF0\x9F\x90\x9D"},
+    {"beer", "\xF0\x9F\x8D\xBA"},
+    {"beers", "\xF0\x9F\x8D\xBB"},
+    {"beetle", "\xF0\x9F\xAA\xB2"},
+    {"beginner", "\xF0\x9F\x94\xB0"},
+    {"bell", "\xF0\x9F\x94\x94"},
+    {"bike", "\xF0\x9F\x9A\xB2"},
+    {"biohazard", "\xE2\x98\xA3\xEF\xB8\x8F"},
+    {"bird", "\xF0\x9F\x90\xA6"},
+    {"birthday", "\xF0\x9F\x8E\x82"},
+    {"black_circle", "\xE2\x9A\xAB"},
+    {"black_flag", "\xF0\x9F\x8F\xB4"},
+    {"black_heart", "\xF0\x9F\x96\xA4"},
+    {"black_large_square", "\xE2\xAC\x9B"},
+    {"blue_circle", "\xF0\x9F\x94\xB5"},
+    {"blue_heart", "\xF0\x9F\x92\x99"},
+    {"blush", "\xF0\x9F\x98\x8A"},
+    {"boat", "\xE2\x9B\xB5"},
+    {"book", "\xF0\x9F\x93\x96"},
+    {"bookmark", "\xF0\x9F\x94\x96"},
+    {"bookmark_tabs", "\xF0\x9F\x93\x91"},
+    {"books", "\xF0\x9F\x93\x9A"},
+    {"boom", "\xF0\x9F\x92\xA5"},
+    {"bouquet", "\xF0\x9F\x92\x90"},
+    {"bow", "\xF0\x9F\x99\x87"},
+    {"bow_and_arrow", "\xF0\x9F\x8F\xB9"},
+    {"boy", "\xF0\x9F\x91\xA6"},
+    {"brain", "\xF0\x9F\xA7\xA0"},
+    {"bread", "\xF0\x9F\x8D\x9E"},
+    {"bricks", "\xF0\x9F\xA7\xB1"},
+    {"briefcase", "\xF0\x9F\x92\xBC"},
+    {"broccoli", "\xF0\x9F\xA5\xA6"},
+    {"broken_heart", "\xF0\x9F\x92\x94"},
+    {"broom", "\xF0\x9F\xA7\xB9"},
+    {"brown_heart", "\xF0\x9F\xA4\x8E"},
+    {"bug", "\xF0\x9F\x90\x9B"},
+    {"bulb", "\xF0\x9F\x92\xA1"},
+    {"burrito", "\xF0\x9F\x8C\xAF"},
+    {"bus", "\xF0\x9F\x9A\x8C"},
+    {"butterfly", "\xF0\x9F\xA6\x8B"},
+    {"ca", "\xF0\x9F\x87\xA8\xF0\x9F\x87\xA6"},
+    {"cactus", "\xF0\x9F\x8C\xB5"},
+    {"cake", "\xF0\x9F\x8D\xB0"},
+    {"calendar", "\xF0\x9F\x93\x86"},
+    {"call_me_hand", "\xF0\x9F\xA4\x99"},
+    {"camera", "\xF0\x9F\x93\xB7"},
+    {"camera_flash", "\xF0\x9F\x93\xB8"},
+    {"candle", "\xF0\x9F\x95\xAF\xEF\xB8\x8F"},
+    {"candy", "\xF0\x9F\x8D\xAC"},
+    {"car", "\xF0\x9F\x9A\x97"},
+    {"card_index", "\xF0\x9F\x93\x87"},
+    {"carrot", "\xF0\x9F\xA5\x95"},
+    {"cat", "\xF0\x9F\x90\xB1"},
+    {"cd", "\xF0\x9F\x92\xBF"},
+    {"chains", "\xE2\x9B\x93\xEF\xB8\x8F"},
+    {"champagne", "\xF0\x9F\x8D\xBE"},
+    {"chart_with_downwards_trend", "\xF0\x9F\x93\x89"},
+    {"chart_with_upwards_trend", "\xF0\x9F\x93\x88"},
+    {"checkered_flag", "\xF0\x9F\x8F\x81"},
+    {"cheese", "\xF0\x9F\xA7\x80"},
+    {"cherries", "\xF0\x9F\x8D\x92"},
+    {"cherry_blossom", "\xF0\x9F\x8C\xB8"},
+    {"chess_pawn", "\xE2\x99\x9F\xEF\xB8\x8F"},
+    {"chicken", "\xF0\x9F\x90\x94"},
+    {"chocolate_bar", "\xF0\x9F\x8D\xAB"},
+    {"christmas_tree", "\xF0\x9F\x8E\x84"},
+    {"clap", "\xF0\x9F\x91\x8F"},
+    {"clapper", "\xF0\x9F\x8E\xAC"},
+    {"clinking_glasses", "\xF0\x9F\xA5\x82"},
+    {"clipboard", "\xF0\x9F\x93\x8B"},
+    {"clock1", "\xF0\x9F\x95\x90"},
+    {"clock10", "\xF0\x9F\x95\x99"},
+    {"clock11", "\xF0\x9F\x95\x9A"},
+    {"clock12", "\xF0\x9F\x95\x9B"},
+    {"clock2", "\xF0\x9F\x95\x91"},
+    {"clock3", "\xF0\x9F\x95\x92"},
+    {"clock4", "\xF0\x9F\x95\x93"},
+    {"clock5", "\xF0\x9F\x95\x94"},
+    {"clock6", "\xF0\x9F\x95\x95"},
+    {"clock7", "\xF0\x9F\x95\x96"},
+    {"clock8", "\xF0\x9F\x95\x97"},
+    {"clock9", "\xF0\x9F\x95\x98"},
+    {"closed_lock_with_key", "\xF0\x9F\x94\x90"},
+    {"cloud", "\xE2\x98\x81\xEF\xB8\x8F"},
+    {"cloud_with_rain", "\xF0\x9F\x8C\xA7\xEF\xB8\x8F"},
+    {"clown_face", "\xF0\x9F\xA4\xA1"},
+    {"cn", "\xF0\x9F\x87\xA8\xF0\x9F\x87\xB3"},
+    {"cocktail", "\xF0\x9F\x8D\xB8"},
+    {"coconut", "\xF0\x9F\xA5\xA5"},
+    {"coffee", "\xE2\x98\x95"},
+    {"coin", "\xF0\x9F\xAA\x99"},
+    {"cold_face", "\xF0\x9F\xA5\xB6"},
+    {"cold_sweat", "\xF0\x9F\x98\xB0"},
+    {"collision", "\xF0\x9F\x92\xA5"},
+    {"computer", "\xF0\x9F\x92\xBB"},
+    {"computer_mouse", "\xF0\x9F\x96\xB1\xEF\xB8\x8F"},
+    {"confetti_ball", "\xF0\x9F\x8E\x8A"},
+    {"confounded", "\xF0\x9F\x98\x96"},
+    {"confused", "\xF0\x9F\x98\x95"},
+    {"construction", "\xF0\x9F\x9A\xA7"},
+    {"construction_worker", "\xF0\x9F\x91\xB7"},
+    {"cookie", "\xF0\x9F\x8D\xAA"},
+    {"cool", "\xF0\x9F\x86\x92"},
+    {"copyright", "\xC2\xA9\xEF\xB8\x8F"},
+    {"corn", "\xF0\x9F\x8C\xBD"},
+    {"cow", "\xF0\x9F\x90\xAE"},
+    {"cowboy_hat_face", "\xF0\x9F\xA4\xA0"},
+    {"crab", "\xF0\x9F\xA6\x80"},
+    {"crayon", "\xF0\x9F\x96\x8D\xEF\xB8\x8F"},
+    {"credit_card", "\xF0\x9F\x92\xB3"},
+    {"crescent_moon", "\xF0\x9F\x8C\x99"},
+    {"crocodile", "\xF0\x9F\x90\x8A"},
+    {"croissant", "\xF0\x9F\xA5\x90"},
+    {"crossed_fingers", "\xF0\x9F\xA4\x9E"},
+    {"crown", "\xF0\x9F\x91\x91"},
+    {"cry", "\xF0\x9F\x98\xA2"},
+    {"crystal_ball", "\xF0\x9F\x94\xAE"},
+    {"cupid", "\xF0\x9F\x92\x98"},
+    {"cursing_face", "\xF0\x9F\xA4\xAC"},
+    {"dancer", "\xF0\x9F\x92\x83"},
+    {"dark_sunglasses", "\xF0\x9F\x95\xB6\xEF\xB8\x8F"},
+    {"dart", "\xF0\x9F\x8E\xAF"},
+    {"dash", "\xF0\x9F\x92\xA8"},
+    {"date", "\xF0\x9F\x93\x85"},
+    {"de", "\xF0\x9F\x87\xA9\xF0\x9F\x87\xAA"},
+    {"deciduous_tree", "\xF0\x9F\x8C\xB3"},
+    {"desktop_computer", "\xF0\x9F\x96\xA5\xEF\xB8\x8F"},
+    {"disappointed", "\xF0\x9F\x98\x9E"},
+    {"disappointed_relieved", "\xF0\x9F\x98\xA5"},
+    {"disguised_face", "\xF0\x9F\xA5\xB8"},
+    {"dizzy", "\xF0\x9F\x92\xAB"},
+    {"dizzy_face", "\xF0\x9F\x98\xB5"},
+    {"dna", "\xF0\x9F\xA7\xAC"},
+    {"dog", "\xF0\x9F\x90\xB6"},
+    {"dollar", "\xF0\x9F\x92\xB5"},
+    {"dolphin", "\xF0\x9F\x90\xAC"},
+    {"door", "\xF0\x9F\x9A\xAA"},
+    {"doughnut", "\xF0\x9F\x8D\xA9"},
+    {"dress", "\xF0\x9F\x91\x97"},
+    {"drooling_face", "\xF0\x9F\xA4\xA4"},
+    {"droplet", "\xF0\x9F\x92\xA7"},
+    {"drum", "\xF0\x9F\xA5\x81"},
+    {"duck", "\xF0\x9F\xA6\x86"},
+    {"dvd", "\xF0\x9F\x93\x80"},
+    {"eagle", "\xF0\x9F\xA6\x85"},
+    {"earth_africa", "\xF0\x9F\x8C\x8D"},
+    {"earth_americas", "\xF0\x9F\x8C\x8E"},
+    {"earth_asia", "\xF0\x9F\x8C\x8F"},
+    {"egg", "\xF0\x9F\xA5\x9A"},
+    {"eggplant", "\xF0\x9F\x8D\x86"},
+    {"eight", "\x38\xEF\xB8\x8F\xE2\x83\xA3"},
+    {"eight_spoked_asterisk", "\xE2\x9C\xB3\xEF\xB8\x8F"},
+    {"electric_plug", "\xF0\x9F\x94\x8C"},
+    {"elephant", "\xF0\x9F\x90\x98"},
+    {"email", "\xF0\x9F\x93\xA7"},
+    {"end", "\xF0\x9F\x94\x9A"},
+    {"envelope", "\xE2\x9C\x89\xEF\xB8\x8F"},
+    {"es", "\xF0\x9F\x87\xAA\xF0\x9F\x87\xB8"},
+    {"eu", "\xF0\x9F\x87\xAA\xF0\x9F\x87\xBA"},
+    {"euro", "\xF0\x9F\x92\xB6"},
+    {"evergreen_tree", "\xF0\x9F\x8C\xB2"},
+    {"exclamation", "\xE2\x9D\x97"},
+    {"exploding_head", "\xF0\x9F\xA4\xAF"},
+    {"expressionless", "\xF0\x9F\x98\x91"},
+    {"eye", "\xF0\x9F\x91\x81\xEF\xB8\x8F"},
+    {"eyeglasses", "\xF0\x9F\x91\x93"},
+    {"eyes", "\xF0\x9F\x91\x80"},
+    {"face_exhaling", "\xF0\x9F\x98\xAE\xE2\x80\x8D\xF0\x9F\x92\xA8"},
+    {"face_in_clouds", "\xF0\x9F\x98\xB6\xE2\x80\x8D\xF0\x9F\x8C\xAB\xEF\xB8\x8F"},
+    {"face_with_head_bandage", "\xF0\x9F\xA4\x95"},
+    {"face_with_spiral_eyes", "\xF0\x9F\x98\xB5\xE2\x80\x8D\xF0\x9F\x92\xAB"},
+    {"face_with_thermometer", "\xF0\x9F\xA4\x92"},
+    {"facepalm", "\xF0\x9F\xA4\xA6"},
+    {"facepunch", "\xF0\x9F\x91\x8A"},
+    {"fallen_leaf", "\xF0\x9F\x8D\x82"},
+    {"fast_forward", "\xE2\x8F\xA9"},
+    {"fearful", "\xF0\x9F\x98\xA8"},
+    {"file_folder", "\xF0\x9F\x93\x81"},
+    {"fire", "\xF0\x9F\x94\xA5"},
+    {"fire_engine", "\xF0\x9F\x9A\x92"},
+    {"fireworks", "\xF0\x9F\x8E\x86"},
+    {"fish", "\xF0\x9F\x90\x9F"},
+    {"fist", "\xE2\x9C\x8A"},
+    {"fist_left", "\xF0\x9F\xA4\x9B"},
+    {"fist_oncoming", "\xF0\x9F\x91\x8A"},
+    {"fist_raised", "\xE2\x9C\x8A"},
+    {"fist_right", "\xF0\x9F\xA4\x9C"},
+    {"five", "\x35\xEF\xB8\x8F\xE2\x83\xA3"},
+    {"flashlight", "\xF0\x9F\x94\xA6"},
+    {"fleur_de_lis", "\xE2\x9A\x9C\xEF\xB8\x8F"},
+    {"floppy_disk", "\xF0\x9F\x92\xBE"},
+    {"flushed", "\xF0\x9F\x98\xB3"},
+    {"football", "\xF0\x9F\x8F\x88"},
+    {"fork_and_knife", "\xF0\x9F\x8D\xB4"},
+    {"four", "\x34\xEF\xB8\x8F\xE2\x83\xA3"},
+    {"four_leaf_clover", "\xF0\x9F\x8D\x80"},
+    {"fox_face", "\xF0\x9F\xA6\x8A"},
+    {"fr", "\xF0\x9F\x87\xAB\xF0\x9F\x87\xB7"},
+    {"free", "\xF0\x9F\x86\x93"},
+    {"fries", "\xF0\x9F\x8D\x9F"},
+    {"frog", "\xF0\x9F\x90\xB8"},
+    {"frowning", "\xF0\x9F\x98\xA6"},
+    {"frowning_face", "\xE2\x98\xB9\xEF\xB8\x8F"},
+    {"fu", "\xF0\x9F\x96\x95"},
+    {"fuelpump", "\xE2\x9B\xBD"},
+    {"full_moon", "\xF0\x9F\x8C\x95"},
+    {"game_die", "\xF0\x9F\x8E\xB2"},
+    {"gb", "\xF0\x9F\x87\xAC\xF0\x9F\x87\xA7"},
+    {"gear", "\xE2\x9A\x99\xEF\xB8\x8F"},
+    {"gem", "\xF0\x9F\x92\x8E"},
+    {"ghost", "\xF0\x9F\x91\xBB"},
+    {"gift", "\xF0\x9F\x8E\x81"},
+    {"gift_heart", "\xF0\x9F\x92\x9D"},
+    {"girl", "\xF0\x9F\x91\xA7"},
+    {"globe_with_meridians", "\xF0\x9F\x8C\x90"},
+    {"golf", "\xE2\x9B\xB3"},
+    {"grapes", "\xF0\x9F\x8D\x87"},
+    {"green_apple", "\xF0\x9F\x8D\x8F"},
+    {"green_circle", "\xF0\x9F\x9F\xA2"},
+    {"green_heart", "\xF0\x9F\x92\x9A"},
+    {"grey_exclamation", "\xE2\x9D\x95"},
+    {"grey_question", "\xE2\x9D\x94"},
+    {"grimacing", "\xF0\x9F\x98\xAC"},
+    {"grin", "\xF0\x9F\x98\x81"},
+    {"grinning", "\xF0\x9F\x98\x80"},
+    {"guitar", "\xF0\x9F\x8E\xB8"},
+    {"hamburger", "\xF0\x9F\x8D\x94"},
+    {"hammer", "\xF0\x9F\x94\xA8"},
+    {"hammer_and_wrench", "\xF0\x9F\x9B\xA0\xEF\xB8\x8F"},
+    {"hamster", "\xF0\x9F\x90\xB9"},
+    {"hand", "\xE2\x9C\x8B"},
+    {"hand_over_mouth", "\xF0\x9F\xA4\xAD"},
+    {"handbag", "\xF0\x9F\x91\x9C"},
+    {"handshake", "\xF0\x9F\xA4\x9D"},
+    {"hankey", "\xF0\x9F\x92\xA9"},
+    {"hash", "\x23\xEF\xB8\x8F\xE2\x83\xA3"},
+    {"headphones", "\xF0\x9F\x8E\xA7"},
+    {"hear_no_evil", "\xF0\x9F\x99\x89"},
+    {"heart", "\xE2\x9D\xA4\xEF\xB8\x8F"},
+    {"heart_decoration", "\xF0\x9F\x92\x9F"},
+    {"heart_eyes", "\xF0\x9F\x98\x8D"},
+    {"heart_eyes_cat", "\xF0\x9F\x98\xBB"},
+    {"heart_on_fire", "\xE2\x9D\xA4\xEF\xB8\x8F\xE2\x80\x8D\xF0\x9F\x94\xA5"},
+    {"heartbeat", "\xF0\x9F\x92\x93"},
+    {"heartpulse", "\xF0\x9F\x92\x97"},
+    {"heavy_check_mark", "\xE2\x9C\x94\xEF\xB8\x8F"},
+    {"heavy_division_sign", "\xE2\x9E\x97"},
+    {"heavy_dollar_sign", "\xF0\x9F\x92\xB2"},
+    {"heavy_exclamation_mark", "\xE2\x9D\x97"},
+    {"heavy_heart_exclamation", "\xE2\x9D\xA3\xEF\xB8\x8F"},
+    {"heavy_minus_sign", "\xE2\x9E\x96"},
+    {"heavy_multiplication_x", "\xE2\x9C\x96\xEF\xB8\x8F"},
+    {"heavy_plus_sign", "\xE2\x9E\x95"},
+    {"helicopter", "\xF0\x9F\x9A\x81"},
+    {"herb", "\xF0\x9F\x8C\xBF"},
+    {"hibiscus", "\xF0\x9F\x8C\xBA"},
+    {"high_brightness", "\xF0\x9F\x94\x86"},
+    {"honeybee", "\xF0\x9F\x90\x9D"},
+    {"horse", "\xF0\x9F\x90\xB4"},
+    {"hospital", "\xF0\x9F\x8F\xA5"},
+    {"hot_face", "\xF0\x9F\xA5\xB5"},
+    {"hot_pepper", "\xF0\x9F\x8C\xB6\xEF\xB8\x8F"},
+    {"hotdog", "\xF0\x9F\x8C\xAD"},
+    {"hotsprings", "\xE2\x99\xA8\xEF\xB8\x8F"},
+    {"hourglass", "\xE2\x8C\x9B"},
+    {"hourglass_flowing_sand", "\xE2\x8F\xB3"},
+    {"house", "\xF0\x9F\x8F\xA0"},
+    {"house_with_garden", "\xF0\x9F\x8F\xA1"},
+    {"hugs", "\xF0\x9F\xA4\x97"},
+    {"hushed", "\xF0\x9F\x98\xAF"},
+    {"ice_cream", "\xF0\x9F\x8D\xA8"},
+    {"icecream", "\xF0\x9F\x8D\xA6"},
+    {"imp", "\xF0\x9F\x91\xBF"},
+    {"in", "\xF0\x9F\x87\xAE\xF0\x9F\x87\xB3"},
+    {"inbox_tray", "\xF0\x9F\x93\xA5"},
+    {"incoming_envelope", "\xF0\x9F\x93\xA8"},
+    {"infinity", "\xE2\x99\xBE\xEF\xB8\x8F"},
+    {"information_desk_person", "\xF0\x9F\x92\x81"},
+    {"information_source", "\xE2\x84\xB9\xEF\xB8\x8F"},
+    {"innocent", "\xF0\x9F\x98\x87"},
+    {"interrobang", "\xE2\x81\x89\xEF\xB8\x8F"},
+    {"iphone", "\xF0\x9F\x93\xB1"},
+    {"it", "\xF0\x9F\x87\xAE\xF0\x9F\x87\xB9"},
+    {"jack_o_lantern", "\xF0\x9F\x8E\x83"},
+    {"japanese_ogre", "\xF0\x9F\x91\xB9"},
+    {"jeans", "\xF0\x9F\x91\x96"},
+    {"jigsaw", "\xF0\x9F\xA7\xA9"},
+    {"joy", "\xF0\x9F\x98\x82"},
+    {"joy_cat", "\xF0\x9F\x98\xB9"},
+    {"jp", "\xF0\x9F\x87\xAF\xF0\x9F\x87\xB5"},
+    {"key", "\xF0\x9F\x94\x91"},
+    {"keyboard", "\xE2\x8C\xA8\xEF\xB8\x8F"},
+    {"keycap_ten", "\xF0\x9F\x94\x9F"},
+    {"kiss", "\xF0\x9F\x92\x8B"},
+    {"kissing", "\xF0\x9F\x98\x97"},
+    {"kissing_closed_eyes", "\xF0\x9F\x98\x9A"},
+    {"kissing_heart", "\xF0\x9F\x98\x98"},
+    {"kissing_smiling_eyes", "\xF0\x9F\x98\x99"},
+    {"kiwi_fruit", "\xF0\x9F\xA5\x9D"},
+    {"koala", "\xF0\x9F\x90\xA8"},
+    {"kr", "\xF0\x9F\x87\xB0\xF0\x9F\x87\xB7"},
+    {"label", "\xF0\x9F\x8F\xB7\xEF\xB8\x8F"},
+    {"lady_beetle", "\xF0\x9F\x90\x9E"},
+    {"large_blue_circle", "\xF0\x9F\x94\xB5"},
+    {"large_blue_diamond", "\xF0\x9F\x94\xB7"},
+    {"large_orange_diamond", "\xF0\x9F\x94\xB6"},
+    {"laughing", "\xF0\x9F\x98\x86"},
+    {"ledger", "\xF0\x9F\x93\x92"},
+    {"left_speech_bubble", "\xF0\x9F\x97\xA8\xEF\xB8\x8F"},
+    {"leftwards_arrow_with_hook", "\xE2\x86\xA9\xEF\xB8\x8F"},
+    {"lemon", "\xF0\x9F\x8D\x8B"},
+    {"link", "\xF0\x9F\x94\x97"},
+    {"lion", "\xF0\x9F\xA6\x81"},
+    {"lips", "\xF0\x9F\x91\x84"},
+    {"lipstick", "\xF0\x9F\x92\x84"},
+    {"lock", "\xF0\x9F\x94\x92"},
+    {"lock_with_ink_pen", "\xF0\x9F\x94\x8F"},
+    {"lollipop", "\xF0\x9F\x8D\xAD"},
+    {"loud_sound", "\xF0\x9F\x94\x8A"},
+    {"loudspeaker", "\xF0\x9F\x93\xA2"},
+    {"love_letter", "\xF0\x9F\x92\x8C"},
+    {"love_you_gesture", "\xF0\x9F\xA4\x9F"},
+    {"low_brightness", "\xF0\x9F\x94\x85"},
+    {"lying_face", "\xF0\x9F\xA4\xA5"},
+    {"mag", "\xF0\x9F\x94\x8D"},
+    {"mag_right", "\xF0\x9F\x94\x8E"},
+    {"mage", "\xF0\x9F\xA7\x99"},
+    {"magnet", "\xF0\x9F\xA7\xB2"},
+    {"mailbox", "\xF0\x9F\x93\xAB"},
+    {"man", "\xF0\x9F\x91\xA8"},
+    {"man_dancing", "\xF0\x9F\x95\xBA"},
+    {"man_technologist", "\xF0\x9F\x91\xA8\xE2\x80\x8D\xF0\x9F\x92\xBB"},
+    {"maple_leaf", "\xF0\x9F\x8D\x81"},
+    {"mask", "\xF0\x9F\x98\xB7"},
+    {"medal_sports", "\xF0\x9F\x8F\x85"},
+    {"mega", "\xF0\x9F\x93\xA3"},
+    {"melting_face", "\xF0\x9F\xAB\xA0"},
+    {"memo", "\xF0\x9F\x93\x9D"},
+    {"mending_heart", "\xE2\x9D\xA4\xEF\xB8\x8F\xE2\x80\x8D\xF0\x9F\xA9\xB9"},
+    {"metal", "\xF0\x9F\xA4\x98"},
+    {"microphone", "\xF0\x9F\x8E\xA4"},
+    {"microscope", "\xF0\x9F\x94\xAC"},
+    {"middle_finger", "\xF0\x9F\x96\x95"},
+    {"milk_glass", "\xF0\x9F\xA5\x9B"},
+    {"money_mouth_face", "\xF0\x9F\xA4\x91"},
+    {"money_with_wings", "\xF0\x9F\x92\xB8"},
+    {"moneybag", "\xF0\x9F\x92\xB0"},
+    {"monkey", "\xF0\x9F\x90\x92"},
+    {"monkey_face", "\xF0\x9F\x90\xB5"},
+    {"monocle_face", "\xF0\x9F\xA7\x90"},
+    {"mortar_board", "\xF0\x9F\x8E\x93"},
+    {"motorcycle", "\xF0\x9F\x8F\x8D\xEF\xB8\x8F"},
+    {"mountain", "\xE2\x9B\xB0\xEF\xB8\x8F"},
+    {"mouse", "\xF0\x9F\x90\xAD"},
+    {"movie_camera", "\xF0\x9F\x8E\xA5"},
+    {"moyai", "\xF0\x9F\x97\xBF"},
+    {"muscle", "\xF0\x9F\x92\xAA"},
+    {"mushroom", "\xF0\x9F\x8D\x84"},
+    {"musical_note", "\xF0\x9F\x8E\xB5"},
+    {"musical_score", "\xF0\x9F\x8E\xBC"},
+    {"mute", "\xF0\x9F\x94\x87"},
+    {"nail_care", "\xF0\x9F\x92\x85"},
+    {"nauseated_face", "\xF0\x9F\xA4\xA2"},
+    {"necktie", "\xF0\x9F\x91\x94"},
+    {"negative_squared_cross_mark", "\xE2\x9D\x8E"},
+    {"nerd_face", "\xF0\x9F\xA4\x93"},
+    {"neutral_face", "\xF0\x9F\x98\x90"},
+    {"new", "\xF0\x9F\x86\x95"},
+    {"new_moon", "\xF0\x9F\x8C\x91"},
+    {"newspaper", "\xF0\x9F\x93\xB0"},
+    {"nine", "\x39\xEF\xB8\x8F\xE2\x83\xA3"},
+    {"ninja", "\xF0\x9F\xA5\xB7"},
+    {"no_bell", "\xF0\x9F\x94\x95"},
+    {"no_entry", "\xE2\x9B\x94"},
+    {"no_entry_sign", "\xF0\x9F\x9A\xAB"},
+    {"no_good", "\xF0\x9F\x99\x85"},
+    {"no_mouth", "\xF0\x9F\x98\xB6"},
+    {"no_smoking", "\xF0\x9F\x9A\xAD"},
+    {"notebook", "\xF0\x9F\x93\x93"},
+    {"notes", "\xF0\x9F\x8E\xB6"},
+    {"nut_and_bolt", "\xF0\x9F\x94\xA9"},
+    {"o", "\xE2\xAD\x95"},
+    {"ocean", "\xF0\x9F\x8C\x8A"},
+    {"octopus", "\xF0\x9F\x90\x99"},
+    {"office", "\xF0\x9F\x8F\xA2"},
+    {"ok", "\xF0\x9F\x86\x97"},
+    {"ok_hand", "\xF0\x9F\x91\x8C"},
+    {"ok_woman", "\xF0\x9F\x99\x86"},
+    {"old_key", "\xF0\x9F\x97\x9D\xEF\xB8\x8F"},
+    {"older_man", "\xF0\x9F\x91\xB4"},
+    {"older_woman", "\xF0\x9F\x91\xB5"},
+    {"on", "\xF0\x9F\x94\x9B"},
+    {"one", "\x31\xEF\xB8\x8F\xE2\x83\xA3"},
+    {"open_book", "\xF0\x9F\x93\x96"},
+    {"open_file_folder", "\xF0\x9F\x93\x82"},
+    {"open_hands", "\xF0\x9F\x91\x90"},
+    {"open_mouth", "\xF0\x9F\x98\xAE"},
+    {"orange_circle", "\xF0\x9F\x9F\xA0"},
+    {"orange_heart", "\xF0\x9F\xA7\xA1"},
+    {"outbox_tray", "\xF0\x9F\x93\xA4"},
+    {"owl", "\xF0\x9F\xA6\x89"},
+    {"package", "\xF0\x9F\x93\xA6"},
+    {"paintbrush", "\xF0\x9F\x96\x8C\xEF\xB8\x8F"},
+    {"palm_tree", "\xF0\x9F\x8C\xB4"},
+    {"palms_up_together", "\xF0\x9F\xA4\xB2"},
+    {"pancakes", "\xF0\x9F\xA5\x9E"},
+    {"panda_face", "\xF0\x9F\x90\xBC"},
+    {"paperclip", "\xF0\x9F\x93\x8E"},
+    {"parking", "\xF0\x9F\x85\xBF\xEF\xB8\x8F"},
+    {"part_alternation_mark", "\xE3\x80\xBD\xEF\xB8\x8F"},
+    {"partly_sunny", "\xE2\x9B\x85"},
+    {"partying_face", "\xF0\x9F\xA5\xB3"},
+    {"pause_button", "\xE2\x8F\xB8\xEF\xB8\x8F"},
+    {"peace_symbol", "\xE2\x98\xAE\xEF\xB8\x8F"},
+    {"peach", "\xF0\x9F\x8D\x91"},
+    {"pear", "\xF0\x9F\x8D\x90"},
+    {"pen", "\xF0\x9F\x96\x8A\xEF\xB8\x8F"},
+    {"pencil", "\xF0\x9F\x93\x9D"},
+    {"pencil2", "\xE2\x9C\x8F\xEF\xB8\x8F"},
+    {"penguin", "\xF0\x9F\x90\xA7"},
+    {"pensive", "\xF0\x9F\x98\x94"},
+    {"performing_arts", "\xF0\x9F\x8E\xAD"},
+    {"persevere", "\xF0\x9F\x98\xA3"},
+    {"person_frowning", "\xF0\x9F\x99\x8D"},
+    {"phone", "\xE2\x98\x8E\xEF\xB8\x8F"},
+    {"pig", "\xF0\x9F\x90\xB7"},
+    {"pill", "\xF0\x9F\x92\x8A"},
+    {"pinching_hand", "\xF0\x9F\xA4\x8F"},
+    {"pineapple", "\xF0\x9F\x8D\x8D"},
+    {"pirate_flag", "\xF0\x9F\x8F\xB4\xE2\x80\x8D\xE2\x98\xA0\xEF\xB8\x8F"},
+    {"pizza", "\xF0\x9F\x8D\x95"},
+    {"pl", "\xF0\x9F\x87\xB5\xF0\x9F\x87\xB1"},
+    {"pleading_face", "\xF0\x9F\xA5\xBA"},
+    {"point_down", "\xF0\x9F\x91\x87"},
+    {"point_left", "\xF0\x9F\x91\x88"},
+    {"point_right", "\xF0\x9F\x91\x89"},
+    {"point_up", "\xE2\x98\x9D\xEF\xB8\x8F"},
+    {"point_up_2", "\xF0\x9F\x91\x86"},
+    {"police_car", "\xF0\x9F\x9A\x93"},
+    {"poop", "\xF0\x9F\x92\xA9"},
+    {"popcorn", "\xF0\x9F\x8D\xBF"},
+    {"potato", "\xF0\x9F\xA5\x94"},
+    {"pound", "\xF0\x9F\x92\xB7"},
+    {"pout", "\xF0\x9F\x98\xA1"},
+    {"pray", "\xF0\x9F\x99\x8F"},
+    {"printer", "\xF0\x9F\x96\xA8\xEF\xB8\x8F"},
+    {"punch", "\xF0\x9F\x91\x8A"},
+    {"purple_circle", "\xF0\x9F\x9F\xA3"},
+    {"purple_heart", "\xF0\x9F\x92\x9C"},
+    {"pushpin", "\xF0\x9F\x93\x8C"},
+    {"question", "\xE2\x9D\x93"},
+    {"rabbit", "\xF0\x9F\x90\xB0"},
+    {"radio", "\xF0\x9F\x93\xBB"},
+    {"radio_button", "\xF0\x9F\x94\x98"},
+    {"radioactive", "\xE2\x98\xA2\xEF\xB8\x8F"},
+    {"rage", "\xF0\x9F\x98\xA1"},
+    {"rainbow", "\xF0\x9F\x8C\x88"},
+    {"rainbow_flag", "\xF0\x9F\x8F\xB3\xEF\xB8\x8F\xE2\x80\x8D\xF0\x9F\x8C\x88"},
+    {"raised_back_of_hand", "\xF0\x9F\xA4\x9A"},
+    {"raised_eyebrow", "\xF0\x9F\xA4\xA8"},
+    {"raised_hand", "\xE2\x9C\x8B"},
+    {"raised_hands", "\xF0\x9F\x99\x8C"},
+    {"raising_hand", "\xF0\x9F\x99\x8B"},
+    {"ramen", "\xF0\x9F\x8D\x9C"},
+    {"record_button", "\xE2\x8F\xBA\xEF\xB8\x8F"},
+    {"recycle", "\xE2\x99\xBB\xEF\xB8\x8F"},
+    {"red_car", "\xF0\x9F\x9A\x97"},
+    {"red_circle", "\xF0\x9F\x94\xB4"},
+    {"red_square", "\xF0\x9F\x9F\xA5"},
+    {"registered", "\xC2\xAE\xEF\xB8\x8F"},
+    {"relaxed", "\xE2\x98\xBA\xEF\xB8\x8F"},
+    {"relieved", "\xF0\x9F\x98\x8C"},
+    {"repeat", "\xF0\x9F\x94\x81"},
+    {"revolving_hearts", "\xF0\x9F\x92\x9E"},
+    {"rewind", "\xE2\x8F\xAA"},
+    {"ribbon", "\xF0\x9F\x8E\x80"},
+    {"right_anger_bubble", "\xF0\x9F\x97\xAF\xEF\xB8\x8F"},
+    {"ring", "\xF0\x9F\x92\x8D"},
+    {"robot", "\xF0\x9F\xA4\x96"},
+    {"rocket", "\xF0\x9F\x9A\x80"},
+    {"rofl", "\xF0\x9F\xA4\xA3"},
+    {"roll_eyes", "\xF0\x9F\x99\x84"},
+    {"rose", "\xF0\x9F\x8C\xB9"},
+    {"rotating_light", "\xF0\x9F\x9A\xA8"},
+    {"round_pushpin", "\xF0\x9F\x93\x8D"},
+    {"ru", "\xF0\x9F\x87\xB7\xF0\x9F\x87\xBA"},
+    {"rugby_football", "\xF0\x9F\x8F\x89"},
+    {"runner", "\xF0\x9F\x8F\x83"},
+    {"running", "\xF0\x9F\x8F\x83"},
+    {"sailboat", "\xE2\x9B\xB5"},
+    {"saluting_face", "\xF0\x9F\xAB\xA1"},
+    {"santa", "\xF0\x9F\x8E\x85"},
+    {"satellite", "\xF0\x9F\x93\xA1"},
+    {"satisfied", "\xF0\x9F\x98\x86"},
+    {"school", "\xF0\x9F\x8F\xAB"},
+    {"school_satchel", "\xF0\x9F\x8E\x92"},
+    {"scissors", "\xE2\x9C\x82\xEF\xB8\x8F"},
+    {"scream", "\xF0\x9F\x98\xB1"},
+    {"see_no_evil", "\xF0\x9F\x99\x88"},
+    {"seedling", "\xF0\x9F\x8C\xB1"},
+    {"selfie", "\xF0\x9F\xA4\xB3"},
+    {"seven", "\x37\xEF\xB8\x8F\xE2\x83\xA3"},
+    {"shamrock", "\xE2\x98\x98\xEF\xB8\x8F"},
+    {"shark", "\xF0\x9F\xA6\x88"},
+    {"shield", "\xF0\x9F\x9B\xA1\xEF\xB8\x8F"},
+    {"ship", "\xF0\x9F\x9A\xA2"},
+    {"shirt", "\xF0\x9F\x91\x95"},
+    {"shit", "\xF0\x9F\x92\xA9"},
+    {"shower", "\xF0\x9F\x9A\xBF"},
+    {"shrug", "\xF0\x9F\xA4\xB7"},
+    {"shushing_face", "\xF0\x9F\xA4\xAB"},
+    {"six", "\x36\xEF\xB8\x8F\xE2\x83\xA3"},
+    {"skull", "\xF0\x9F\x92\x80"},
+    {"skull_and_crossbones", "\xE2\x98\xA0\xEF\xB8\x8F"},
+    {"sleeping", "\xF0\x9F\x98\xB4"},
+    {"sleepy", "\xF0\x9F\x98\xAA"},
+    {"slightly_frowning_face", "\xF0\x9F\x99\x81"},
+    {"slightly_smiling_face", "\xF0\x9F\x99\x82"},
+    {"sloth", "\xF0\x9F\xA6\xA5"},
+    {"small_blue_diamond", "\xF0\x9F\x94\xB9"},
+    {"small_orange_diamond", "\xF0\x9F\x94\xB8"},
+    {"small_red_triangle", "\xF0\x9F\x94\xBA"},
+    {"small_red_triangle_down", "\xF0\x9F\x94\xBB"},
+    {"smile", "\xF0\x9F\x98\x84"},
+    {"smile_cat", "\xF0\x9F\x98\xB8"},
+    {"smiley", "\xF0\x9F\x98\x83"},
+    {"smiley_cat", "\xF0\x9F\x98\xBA"},
+    {"smiling_face_with_tear", "\xF0\x9F\xA5\xB2"},
+    {"smiling_face_with_three_hearts", "\xF0\x9F\xA5\xB0"},
+    {"smiling_imp", "\xF0\x9F\x98\x88"},
+    {"smirk", "\xF0\x9F\x98\x8F"},
+    {"snail", "\xF0\x9F\x90\x8C"},
+    {"snake", "\xF0\x9F\x90\x8D"},
+    {"sneezing_face", "\xF0\x9F\xA4\xA7"},
+    {"snowflake", "\xE2\x9D\x84\xEF\xB8\x8F"},
+    {"snowman", "\xE2\x9B\x84"},
+    {"soap", "\xF0\x9F\xA7\xBC"},
+    {"sob", "\xF0\x9F\x98\xAD"},
+    {"soccer", "\xE2\x9A\xBD"},
+    {"soon", "\xF0\x9F\x94\x9C"},
+    {"sos", "\xF0\x9F\x86\x98"},
+    {"sound", "\xF0\x9F\x94\x89"},
+    {"space_invader", "\xF0\x9F\x91\xBE"},
+    {"spaghetti", "\xF0\x9F\x8D\x9D"},
+    {"sparkle", "\xE2\x9D\x87\xEF\xB8\x8F"},
+    {"sparkler", "\xF0\x9F\x8E\x87"},
+    {"sparkles", "\xE2\x9C\xA8"},
+    {"sparkling_heart", "\xF0\x9F\x92\x96"},
+    {"speak_no_evil", "\xF0\x9F\x99\x8A"},
+    {"speaker", "\xF0\x9F\x94\x88"},
+    {"speech_balloon", "\xF0\x9F\x92\xAC"},
+    {"spider", "\xF0\x9F\x95\xB7\xEF\xB8\x8F"},
+    {"sponge", "\xF0\x9F\xA7\xBD"},
+    {"star", "\xE2\xAD\x90"},
+    {"star2", "\xF0\x9F\x8C\x9F"},
+    {"star_struck", "\xF0\x9F\xA4\xA9"},
+    {"statue_of_liberty", "\xF0\x9F\x97\xBD"},
+    {"stethoscope", "\xF0\x9F\xA9\xBA"},
+    {"stop_button", "\xE2\x8F\xB9\xEF\xB8\x8F"},
+    {"stop_sign", "\xF0\x9F\x9B\x91"},
+    {"stopwatch", "\xE2\x8F\xB1\xEF\xB8\x8F"},
+    {"straight_ruler", "\xF0\x9F\x93\x8F"},
+    {"strawberry", "\xF0\x9F\x8D\x93"},
+    {"stuck_out_tongue", "\xF0\x9F\x98\x9B"},
+    {"stuck_out_tongue_closed_eyes", "\xF0\x9F\x98\x9D"},
+    {"stuck_out_tongue_winking_eye", "\xF0\x9F\x98\x9C"},
+    {"sun_with_face", "\xF0\x9F\x8C\x9E"},
+    {"sunflower", "\xF0\x9F\x8C\xBB"},
+    {"sunglasses", "\xF0\x9F\x98\x8E"},
+    {"sunny", "\xE2\x98\x80\xEF\xB8\x8F"},
+    {"superhero", "\xF0\x9F\xA6\xB8"},
+    {"sushi", "\xF0\x9F\x8D\xA3"},
+    {"sweat", "\xF0\x9F\x98\x93"},
+    {"sweat_drops", "\xF0\x9F\x92\xA6"},
+    {"sweat_smile", "\xF0\x9F\x98\x85"},
+    {"symbols", "\xF0\x9F\x94\xA3"},
+    {"syringe", "\xF0\x9F\x92\x89"},
+    {"taco", "\xF0\x9F\x8C\xAE"},
+    {"tada", "\xF0\x9F\x8E\x89"},
+    {"tangerine", "\xF0\x9F\x8D\x8A"},
+    {"taxi", "\xF0\x9F\x9A\x95"},
+    {"tea", "\xF0\x9F\x8D\xB5"},
+    {"technologist", "\xF0\x9F\xA7\x91\xE2\x80\x8D\xF0\x9F\x92\xBB"},
+    {"telephone", "\xE2\x98\x8E\xEF\xB8\x8F"},
+    {"telephone_receiver", "\xF0\x9F\x93\x9E"},
+    {"telescope", "\xF0\x9F\x94\xAD"},
+    {"tennis", "\xF0\x9F\x8E\xBE"},
+    {"tent", "\xE2\x9B\xBA"},
+    {"test_tube", "\xF0\x9F\xA7\xAA"},
+    {"thinking", "\xF0\x9F\xA4\x94"},
+    {"thought_balloon", "\xF0\x9F\x92\xAD"},
+    {"three", "\x33\xEF\xB8\x8F\xE2\x83\xA3"},
+    {"thumbsdown", "\xF0\x9F\x91\x8E"},
+    {"thumbsup", "\xF0\x9F\x91\x8D"},
+    {"ticket", "\xF0\x9F\x8E\xAB"},
+    {"tiger", "\xF0\x9F\x90\xAF"},
+    {"tipping_hand_person", "\xF0\x9F\x92\x81"},
+    {"tired_face", "\xF0\x9F\x98\xAB"},
+    {"tm", "\xE2\x84\xA2\xEF\xB8\x8F"},
+    {"toilet", "\xF0\x9F\x9A\xBD"},
+    {"tomato", "\xF0\x9F\x8D\x85"},
+    {"tongue", "\xF0\x9F\x91\x85"},
+    {"toolbox", "\xF0\x9F\xA7\xB0"},
+    {"top", "\xF0\x9F\x94\x9D"},
+    {"tophat", "\xF0\x9F\x8E\xA9"},
+    {"tornado", "\xF0\x9F\x8C\xAA\xEF\xB8\x8F"},
+    {"triangular_flag_on_post", "\xF0\x9F\x9A\xA9"},
+    {"triangular_ruler", "\xF0\x9F\x93\x90"},
+    {"trident", "\xF0\x9F\x94\xB1"},
+    {"triumph", "\xF0\x9F\x98\xA4"},
+    {"trophy", "\xF0\x9F\x8F\x86"},
+    {"tropical_drink", "\xF0\x9F\x8D\xB9"},
+    {"tropical_fish", "\xF0\x9F\x90\xA0"},
+    {"truck", "\xF0\x9F\x9A\x9A"},
+    {"trumpet", "\xF0\x9F\x8E\xBA"},
+    {"tshirt", "\xF0\x9F\x91\x95"},
+    {"tulip", "\xF0\x9F\x8C\xB7"},
+    {"turtle", "\xF0\x9F\x90\xA2"},
+    {"tv", "\xF0\x9F\x93\xBA"},
+    {"twisted_rightwards_arrows", "\xF0\x9F\x94\x80"},
+    {"two", "\x32\xEF\xB8\x8F\xE2\x83\xA3"},
+    {"two_hearts", "\xF0\x9F\x92\x95"},
+    {"uk", "\xF0\x9F\x87\xAC\xF0\x9F\x87\xA7"},
+    {"umbrella", "\xE2\x98\x94"},
+    {"unamused", "\xF0\x9F\x98\x92"},
+    {"underage", "\xF0\x9F\x94\x9E"},
+    {"unicorn", "\xF0\x9F\xA6\x84"},
+    {"unlock", "\xF0\x9F\x94\x93"},
+    {"up", "\xF0\x9F\x86\x99"},
+    {"upside_down_face", "\xF0\x9F\x99\x83"},
+    {"us", "\xF0\x9F\x87\xBA\xF0\x9F\x87\xB8"},
+    {"v", "\xE2\x9C\x8C\xEF\xB8\x8F"},
+    {"vertical_traffic_light", "\xF0\x9F\x9A\xA6"},
+    {"video_camera", "\xF0\x9F\x93\xB9"},
+    {"video_game", "\xF0\x9F\x8E\xAE"},
+    {"violin", "\xF0\x9F\x8E\xBB"},
+    {"volcano", "\xF0\x9F\x8C\x8B"},
+    {"volleyball", "\xF0\x9F\x8F\x90"},
+    {"vomiting_face", "\xF0\x9F\xA4\xAE"},
+    {"vs", "\xF0\x9F\x86\x9A"},
+    {"vulcan_salute", "\xF0\x9F\x96\x96"},
+    {"warning", "\xE2\x9A\xA0\xEF\xB8\x8F"},
+    {"wastebasket", "\xF0\x9F\x97\x91\xEF\xB8\x8F"},
+    {"watch", "\xE2\x8C\x9A"},
+    {"watermelon", "\xF0\x9F\x8D\x89"},
+    {"wave", "\xF0\x9F\x91\x8B"},
+    {"wc", "\xF0\x9F\x9A\xBE"},
+    {"weary", "\xF0\x9F\x98\xA9"},
+    {"whale", "\xF0\x9F\x90\xB3"},
+    {"wheelchair", "\xE2\x99\xBF"},
+    {"white_check_mark", "\xE2\x9C\x85"},
+    {"white_circle", "\xE2\x9A\xAA"},
+    {"white_flag", "\xF0\x9F\x8F\xB3\xEF\xB8\x8F"},
+    {"white_heart", "\xF0\x9F\xA4\x8D"},
+    {"white_large_square", "\xE2\xAC\x9C"},
+    {"wine_glass", "\xF0\x9F\x8D\xB7"},
+    {"wink", "\xF0\x9F\x98\x89"},
+    {"wolf", "\xF0\x9F\x90\xBA"},
+    {"woman", "\xF0\x9F\x91\xA9"},
+    {"woman_technologist", "\xF0\x9F\x91\xA9\xE2\x80\x8D\xF0\x9F\x92\xBB"},
+    {"woozy_face", "\xF0\x9F\xA5\xB4"},
+    {"world_map", "\xF0\x9F\x97\xBA\xEF\xB8\x8F"},
+    {"worried", "\xF0\x9F\x98\x9F"},
+    {"wrench", "\xF0\x9F\x94\xA7"},
+    {"writing_hand", "\xE2\x9C\x8D\xEF\xB8\x8F"},
+    {"x", "\xE2\x9D\x8C"},
+    {"yawning_face", "\xF0\x9F\xA5\xB1"},
+    {"yellow_circle", "\xF0\x9F\x9F\xA1"},
+    {"yellow_heart", "\xF0\x9F\x92\x9B"},
+    {"yen", "\xF0\x9F\x92\xB4"},
+    {"yin_yang", "\xE2\x98\xAF\xEF\xB8\x8F"},
+    {"yum", "\xF0\x9F\x98\x8B"},
+    {"zany_face", "\xF0\x9F\xA4\xAA"},
+    {"zap", "\xE2\x9A\xA1"},
+    {"zero", "\x30\xEF\xB8\x8F\xE2\x83\xA3"},
+    {"zipper_mouth_face", "\xF0\x9F\xA4\x90"},
+    {"zombie", "\xF0\x9F\xA7\x9F"},
+    {"zzz", "\xF0\x9F\x92\xA4"},
+};
+
+constexpr size_t kShortcodeCount = std::size(kShortcodes);
+constexpr auto kPerfectHash = PerfectHash<kShortcodeCount, 11, 512>::build(kShortcodes);
+static_assert(kPerfectHash.complete(), "no perfect hash for the shortcode names; change the table size or hash");
+
+} // anonymous namespace
+
+std::string_view emojiForShortcode(std::string_view name) {
+  size_t entry = kPerfectHash.find(name);
+  if (entry == kShortcodeCount || kShortcodes[entry].name != name) {
+    return {};
+  }
+  return kShortcodes[entry].emoji;
+}
+
+} // namespace Markdown
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string_view>
+
+namespace Markdown {
+
+// Looks up an emoji shortcode as md4c reports it for MD_SPAN_EMOJI_SHORTCODE,
+// without the colons: "smile", "+1", "white_check_mark". Returns the emoji's
+// UTF-8 text from a static table, or an empty view for an unknown name.
+//
+// The table holds the common GitHub and Slack names, and is searched with one
+// hash and one comparison through a perfect hash built at compile time.
+std::string_view emojiForShortcode(std::string_view name);
+
+} // namespace Markdown
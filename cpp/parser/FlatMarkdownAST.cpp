@@ -0,0 +1,245 @@
+#include "FlatMarkdownAST.hpp"
+#include "ContentHash.hpp"
+#include "DocumentIndex.hpp"
+
+namespace Markdown {
+
+std::string FlatMarkdownAST::attribute(NodeIndex index, std::string_view key) const {
+  const NodeAttributes *attrs = attributesOf(index);
+  AttributeKey typedKey;
+  if (!attrs || !attributeKeyFromName(key, typedKey) || !attrs->has(typedKey)) {
+    return {};
+  }
+  char buffer[12];
+  return std::string(attrs->format(typedKey, strings, buffer));
+}
+
+NodeIndex FlatMarkdownAST::appendChild(NodeIndex parent, NodeType type) {
+  auto index = static_cast<NodeIndex>(nodes.size());
+  nodes.emplace_back(type);
+
+  FlatNode &child = nodes[index];
+  child.parent = parent;
+
+  FlatNode &p = nodes[parent];
+  if (p.lastChild == kInvalidNodeIndex) {
+    p.firstChild = index;
+  } else {
+    nodes[p.lastChild].nextSibling = index;
+  }
+  p.lastChild = index;
+  p.childCount++;
+
+  return index;
+}
+
+void FlatMarkdownAST::truncateChildrenAfter(NodeIndex parent, NodeIndex last) {
+  FlatNode &p = nodes[parent];
+  if (last == kInvalidNodeIndex) {
+    p.firstChild = kInvalidNodeIndex;
+    p.lastChild = kInvalidNodeIndex;
+    p.childCount = 0;
+    return;
+  }
+
+  uint32_t count = 0;
+  for (NodeIndex child = p.firstChild; child != kInvalidNodeIndex; child = nodes[child].nextSibling) {
+    ++count;
+    if (child == last)
+      break;
+  }
+  nodes[last].nextSibling = kInvalidNodeIndex;
+  p.lastChild = last;
+  p.childCount = count;
+}
+
+void FlatMarkdownAST::insertAfter(NodeIndex after, NodeIndex node) {
+  NodeIndex parent = nodes[after].parent;
+  FlatNode &n = nodes[node];
+  n.parent = parent;
+  n.nextSibling = nodes[after].nextSibling;
+  nodes[after].nextSibling = node;
+
+  FlatNode &p = nodes[parent];
+  if (p.lastChild == after) {
+    p.lastChild = node;
+  }
+  p.childCount++;
+}
+
+void FlatMarkdownAST::unlink(NodeIndex node, NodeIndex previous) {
+  FlatNode &n = nodes[node];
+  FlatNode &p = nodes[n.parent];
+
+  if (previous == kInvalidNodeIndex) {
+    p.firstChild = n.nextSibling;
+  } else {
+    nodes[previous].nextSibling = n.nextSibling;
+  }
+  if (p.lastChild == node) {
+    p.lastChild = previous;
+  }
+  p.childCount--;
+
+  n.parent = kInvalidNodeIndex;
+  n.nextSibling = kInvalidNodeIndex;
+}
+
+std::shared_ptr<const DocumentIndex> FlatMarkdownAST::index() const {
+  std::shared_ptr<const DocumentIndex> index = std::atomic_load(&index_);
+  if (!index) {
+    // Threads racing here build equal indices; whichever is stored last wins.
+    index = std::make_shared<const DocumentIndex>(indexBuilder ? indexBuilder->finish() : DocumentIndex::build(*this));
+    std::atomic_store(&index_, index);
+  }
+  return index;
+}
+
+void FlatMarkdownAST::appendBlocksOf(const FlatMarkdownAST &other) {
+  index_.reset();
+  // Node 0 of `other` is its Document root, which maps onto ours.
+  auto nodeShift = static_cast<NodeIndex>(nodes.size() - 1);
+  if (indexBuilder && other.indexBuilder) {
+    indexBuilder->appendNodes(*other.indexBuilder, 1, static_cast<NodeIndex>(other.nodes.size()), nodeShift + 1);
+  } else {
+    indexBuilder.reset();
+  }
+  auto attributeShift = static_cast<uint32_t>(attributeBlocks.size());
+  auto stringShift = static_cast<uint32_t>(strings.size());
+  auto remap = [&](NodeIndex index) {
+    return index == root() || index == kInvalidNodeIndex ? index : index + nodeShift;
+  };
+  auto shiftText = [&](TextRange &range) {
+    if (range.length > 0 && !range.inSource()) {
+      range.offset += stringShift;
+    }
+  };
+
+  strings.append(other.strings);
+  attributeBlocks.insert(attributeBlocks.end(), other.attributeBlocks.begin(), other.attributeBlocks.end());
+  for (auto attrs = attributeBlocks.begin() + attributeShift; attrs != attributeBlocks.end(); ++attrs) {
+    shiftText(attrs->url);
+    shiftText(attrs->title);
+    shiftText(attrs->language);
+    if (attrs->has(AttributeKey::TaskIndex)) {
+      attrs->taskIndex += taskCount;
+    }
+  }
+
+  nodes.insert(nodes.end(), other.nodes.begin() + 1, other.nodes.end());
+  for (auto node = nodes.begin() + nodeShift + 1; node != nodes.end(); ++node) {
+    node->parent = remap(node->parent);
+    node->firstChild = remap(node->firstChild);
+    node->lastChild = remap(node->lastChild);
+    node->nextSibling = remap(node->nextSibling);
+    shiftText(node->content);
+    if (node->attributeIndex != kNoAttributes) {
+      node->attributeIndex += attributeShift;
+    }
+  }
+
+  // Task indices are part of the hashes, so renumbered subtrees are rehashed.
+  if (taskCount > 0 && other.taskCount > 0) {
+    updateHashes(nodeShift + 1, static_cast<NodeIndex>(nodes.size()));
+  }
+  taskCount += other.taskCount;
+
+  const FlatNode &otherDocument = other.nodes[root()];
+  if (otherDocument.firstChild == kInvalidNodeIndex) {
+    return;
+  }
+  FlatNode &document = nodes[root()];
+  if (document.lastChild == kInvalidNodeIndex) {
+    document.firstChild = remap(otherDocument.firstChild);
+  } else {
+    nodes[document.lastChild].nextSibling = remap(otherDocument.firstChild);
+  }
+  document.lastChild = remap(otherDocument.lastChild);
+  document.childCount += otherDocument.childCount;
+}
+
+void FlatMarkdownAST::updateHash(NodeIndex index) {
+  FlatNode &node = nodes[index];
+  uint64_t hash = hashCombine(0, static_cast<uint64_t>(node.type));
+  if (node.content.length > 0) {
+    hash = contentHash(text(node.content), hash);
+  }
+  if (const NodeAttributes *attrs = attributesOf(index)) {
+    hash = hashCombine(hash, attrs->presentMask | static_cast<uint64_t>(attrs->level) << 16 |
+                                 static_cast<uint64_t>(static_cast<unsigned char>(attrs->fenceChar)) << 24 |
+                                 static_cast<uint64_t>(attrs->isTask) << 32 |
+                                 static_cast<uint64_t>(attrs->taskChecked) << 33 |
+                                 static_cast<uint64_t>(attrs->align) << 40 |
+                                 static_cast<uint64_t>(attrs->isInline) << 48);
+    hash = hashCombine(hash, attrs->colCount | static_cast<uint64_t>(attrs->headRowCount) << 32);
+    hash = hashCombine(hash, attrs->bodyRowCount | static_cast<uint64_t>(attrs->taskIndex) << 32);
+    // The lengths keep a url from running into the title after it.
+    for (TextRange range : {attrs->url, attrs->title, attrs->language}) {
+      hash = contentHash(text(range), hashCombine(hash, range.length));
+    }
+  }
+  for (NodeIndex child = node.firstChild; child != kInvalidNodeIndex; child = nodes[child].nextSibling) {
+    hash = hashCombine(hash, nodes[child].hash);
+  }
+  node.hash = hash;
+}
+
+void FlatMarkdownAST::rollback(const Checkpoint &checkpoint) {
+  index_.reset();
+  indexBuilder.reset();
+  nodes.erase(nodes.begin() + static_cast<std::ptrdiff_t>(checkpoint.nodeCount), nodes.end());
+  attributeBlocks.resize(checkpoint.attributeCount);
+  strings.resize(checkpoint.stringsSize);
+  taskCount = checkpoint.taskCount;
+
+  FlatNode &document = nodes[root()];
+  document.lastChild = checkpoint.lastTopLevel;
+  document.childCount = checkpoint.topLevelCount;
+  if (checkpoint.lastTopLevel == kInvalidNodeIndex) {
+    document.firstChild = kInvalidNodeIndex;
+  } else {
+    nodes[checkpoint.lastTopLevel].nextSibling = kInvalidNodeIndex;
+  }
+}
+
+namespace {
+
+std::shared_ptr<MarkdownASTNode> buildTreeNode(const FlatMarkdownAST &ast, NodeIndex index) {
+  const FlatNode &flat = ast.nodes[index];
+  auto node = std::make_shared<MarkdownASTNode>(flat.type);
+  node->sourceRange = flat.sourceRange;
+  node->hash = flat.hash;
+
+  if (flat.content.length > 0) {
+    node->content.assign(ast.text(flat.content));
+  }
+
+  if (const NodeAttributes *attrs = ast.attributesOf(index)) {
+    // Re-home string values into the node's own storage; native values copy as is.
+    node->attributes = *attrs;
+    auto rehome = [&](TextRange &range) {
+      if (range.length > 0) {
+        node->attributeText.append(ast.strings, range.offset, range.length);
+        range.offset = static_cast<uint32_t>(node->attributeText.size() - range.length);
+      }
+    };
+    rehome(node->attributes.url);
+    rehome(node->attributes.title);
+    rehome(node->attributes.language);
+  }
+
+  node->children.reserve(flat.childCount);
+  for (NodeIndex child = flat.firstChild; child != kInvalidNodeIndex; child = ast.nodes[child].nextSibling) {
+    node->addChild(buildTreeNode(ast, child));
+  }
+
+  return node;
+}
+
+} // anonymous namespace
+
+std::shared_ptr<MarkdownASTNode> FlatMarkdownAST::toTree() const {
+  return buildTreeNode(*this, root());
+}
+
+} // namespace Markdown
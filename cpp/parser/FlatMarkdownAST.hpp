@@ -0,0 +1,180 @@
+#pragma once
+
+#include "MarkdownASTNode.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Markdown {
+
+using NodeIndex = uint32_t;
+
+struct DocumentIndex;
+class DocumentIndexBuilder;
+
+constexpr NodeIndex kInvalidNodeIndex = UINT32_MAX;
+constexpr uint32_t kNoAttributes = UINT32_MAX;
+
+// A node of the flat AST. Tree structure is expressed with indices into
+// FlatMarkdownAST::nodes instead of pointers, so a whole document lives in a
+// handful of contiguous buffers and can be walked without refcounting.
+struct FlatNode {
+  NodeType type;
+  NodeIndex parent = kInvalidNodeIndex;
+  NodeIndex firstChild = kInvalidNodeIndex;
+  NodeIndex lastChild = kInvalidNodeIndex;
+  NodeIndex nextSibling = kInvalidNodeIndex;
+  uint32_t childCount = 0;
+  TextRange content;
+  SourceRange sourceRange;
+  // Index into FlatMarkdownAST::attributeBlocks, or kNoAttributes. Most nodes
+  // (text runs, emphasis, line breaks) carry no attributes and pay nothing.
+  uint32_t attributeIndex = kNoAttributes;
+  // Structural hash of the subtree: type, text, attributes and the children's
+  // hashes in order, but not source positions, so equal markdown anywhere in
+  // any document hashes the same. Set by the post-parse pass (see
+  // PostParsePipeline.hpp); the Document root is not hashed and keeps 0.
+  uint64_t hash = 0;
+
+  explicit FlatNode(NodeType t) : type(t) {}
+};
+
+// Arena-backed AST produced by MD4CParser::parseFlat. Node payloads (text
+// content and string attribute values) are referenced by TextRange, either into
+// the single owned string pool or, for text that md4c hands back as a
+// contiguous slice of the input, directly into `source`. Node 0 is always the
+// Document root.
+struct FlatMarkdownAST {
+  // Arena sizes and the root's child list at some point in time. Rolling back
+  // to a checkpoint drops every top-level block appended after it while leaving
+  // the earlier nodes, and their indices, untouched.
+  struct Checkpoint {
+    size_t nodeCount = 1;
+    size_t attributeCount = 0;
+    size_t stringsSize = 0;
+    NodeIndex lastTopLevel = kInvalidNodeIndex;
+    uint32_t topLevelCount = 0;
+    uint32_t taskCount = 0;
+  };
+
+  std::vector<FlatNode> nodes;
+  std::vector<NodeAttributes> attributeBlocks;
+  std::string strings;
+  // The parsed input, kept alive for as long as the AST when text is stored as
+  // views into it. Null when every payload lives in `strings`.
+  std::shared_ptr<const std::string> source;
+  // Task list items numbered so far; the next one gets this TaskIndex.
+  uint32_t taskCount = 0;
+  // Set when the parse stopped early at Md4cFlags::maxBlocks or
+  // maxSourceBytes. The blocks from byte `truncatedAt` of the source on were
+  // left out.
+  bool truncated = false;
+  uint32_t truncatedAt = 0;
+  // Set by a parser that collects the DocumentIndex while parsing (see
+  // MD4CParser::setDocumentIndexEnabled); the post-parse pass feeds it every
+  // block it finishes. It always covers every top-level block: rollback,
+  // truncation and appending blocks it did not see drop it, and index() then
+  // falls back to a walk of its own.
+  std::shared_ptr<DocumentIndexBuilder> indexBuilder;
+
+  FlatMarkdownAST() {
+    nodes.emplace_back(NodeType::Document);
+  }
+
+  static constexpr NodeIndex root() {
+    return 0;
+  }
+
+  size_t size() const {
+    return nodes.size();
+  }
+
+  const FlatNode &node(NodeIndex index) const {
+    return nodes[index];
+  }
+
+  std::string_view text(TextRange range) const {
+    const char *base = range.inSource() ? source->data() : strings.data();
+    return std::string_view(base + range.position(), range.length);
+  }
+
+  std::string_view content(NodeIndex index) const {
+    return text(nodes[index].content);
+  }
+
+  // Returns nullptr if the node has no attributes.
+  const NodeAttributes *attributesOf(NodeIndex index) const {
+    uint32_t attributeIndex = nodes[index].attributeIndex;
+    return attributeIndex == kNoAttributes ? nullptr : &attributeBlocks[attributeIndex];
+  }
+
+  // String-keyed compatibility accessor. Returns an empty string if the node
+  // has no attribute with this key.
+  std::string attribute(NodeIndex index, std::string_view key) const;
+
+  // Approximate heap footprint of the arena, in bytes. The shared source buffer
+  // is not included.
+  size_t memoryUsage() const {
+    return nodes.capacity() * sizeof(FlatNode) + attributeBlocks.capacity() * sizeof(NodeAttributes) +
+           strings.capacity();
+  }
+
+  Checkpoint checkpoint() const {
+    const FlatNode &document = nodes[root()];
+    return {nodes.size(), attributeBlocks.size(), strings.size(), document.lastChild, document.childCount, taskCount};
+  }
+
+  // Only valid while nodes added since `checkpoint` are the last top-level
+  // blocks and their descendants.
+  void rollback(const Checkpoint &checkpoint);
+
+  // Computes nodes[index].hash from the node itself and the hashes its
+  // children already have.
+  void updateHash(NodeIndex index);
+
+  // Recomputes the hashes of nodes [begin, end), which must hold whole
+  // subtrees. Children always come after their parent in the arena, so going
+  // backwards reaches every child first.
+  void updateHashes(NodeIndex begin, NodeIndex end) {
+    for (NodeIndex index = end; index-- > begin;) {
+      updateHash(index);
+    }
+  }
+
+  // Materializes the pointer-based tree for callers that still consume
+  // MarkdownASTNode.
+  std::shared_ptr<MarkdownASTNode> toTree() const;
+
+  // The DocumentIndex of the finished AST, taken from indexBuilder or built on
+  // the first call, and kept. May be called from several threads; rollback and
+  // appendBlocksOf drop it.
+  std::shared_ptr<const DocumentIndex> index() const;
+
+  // Appends a new node as the last child of `parent` and returns its index.
+  NodeIndex appendChild(NodeIndex parent, NodeType type);
+
+  // Drops every child of `parent` that follows `last`. Passing
+  // kInvalidNodeIndex removes all children.
+  void truncateChildrenAfter(NodeIndex parent, NodeIndex last);
+
+  // Appends the top-level blocks of `other`, which must have been parsed from
+  // the same source, after the last top-level block of this AST. Nodes,
+  // attribute blocks and the string pool are appended as a whole, so the result
+  // is laid out as if both had been parsed into one AST in order. Task indices
+  // of `other` continue from ours.
+  void appendBlocksOf(const FlatMarkdownAST &other);
+
+  // Links `node` (currently detached) as the next sibling of `after`.
+  void insertAfter(NodeIndex after, NodeIndex node);
+
+  // Unlinks `node` from its parent. `previous` must be its preceding sibling,
+  // or kInvalidNodeIndex if it is the first child.
+  void unlink(NodeIndex node, NodeIndex previous);
+
+private:
+  mutable std::shared_ptr<const DocumentIndex> index_;
+};
+
+} // namespace Markdown
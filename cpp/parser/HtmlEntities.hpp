@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string_view>
+
+namespace Markdown {
+
+// Decodes an HTML character reference as md4c reports it in MD_TEXT_ENTITY
+// runs: "&amp;", "&#233;" or "&#x1F600;". Returns its UTF-8 text, which lives
+// in a static table for named references and in `buffer` for numeric ones, or
+// an empty view for a name HTML does not define. As in CommonMark, numeric
+// references to U+0000, surrogates or past U+10FFFF decode to U+FFFD.
+//
+// Named references are found with one hash and one comparison, through a
+// perfect hash table built at compile time.
+std::string_view decodeHtmlEntity(std::string_view entity, char (&buffer)[4]);
+
+} // namespace Markdown
@@ -0,0 +1,127 @@
+#include "LazyParseSession.hpp"
+#include <algorithm>
+
+namespace Markdown {
+
+LazyParseSession::LazyParseSession(std::shared_ptr<const std::string> markdown, const Md4cFlags &flags)
+    : markdown_(markdown ? std::move(markdown) : std::make_shared<const std::string>()), flags_(flags),
+      blocks_(splitTopLevelBlocks(*markdown_)), parsed_(blocks_.size()), unparsedCount_(blocks_.size()) {}
+
+size_t LazyParseSession::blockAt(uint32_t offset) const {
+  auto it = std::upper_bound(blocks_.begin(), blocks_.end(), offset,
+                             [](uint32_t value, const SourceBlock &block) { return value < block.end; });
+  return static_cast<size_t>(it - blocks_.begin());
+}
+
+bool LazyParseSession::isParsed(size_t index) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return index < parsed_.size() && parsed_[index].ast != nullptr;
+}
+
+LazyParseSession::ParsedBlock LazyParseSession::block(size_t index) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return index < parsed_.size() ? parsed_[index] : ParsedBlock{};
+}
+
+bool LazyParseSession::parse(size_t first, size_t last) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ParseStatus status = ParseStatus::Completed;
+  return parseLocked(first, last, nullptr, status);
+}
+
+bool LazyParseSession::parse(size_t first, size_t last, const ParseControl &control, ParseStatus &status) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  status = ParseStatus::Completed;
+  return parseLocked(first, last, &control, status);
+}
+
+size_t LazyParseSession::parseNext(size_t maxBlocks) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ParseStatus status = ParseStatus::Completed;
+  size_t first = firstUnparsed_;
+  // Blocks the renderer already asked for do not count against the batch.
+  size_t last = first;
+  for (size_t count = 0; last < parsed_.size() && count < maxBlocks; ++last) {
+    count += parsed_[last].ast == nullptr ? 1 : 0;
+  }
+  parseLocked(first, last, nullptr, status);
+  return unparsedCount_;
+}
+
+std::optional<uint32_t> LazyParseSession::tasksBefore(size_t index) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  index = std::min(index, parsed_.size());
+  if (index > firstUnparsed_) {
+    return std::nullopt;
+  }
+  uint32_t count = 0;
+  for (size_t i = 0; i < index; ++i) {
+    count += parsed_[i].taskCount;
+  }
+  return count;
+}
+
+bool LazyParseSession::parseLocked(size_t first, size_t last, const ParseControl *control, ParseStatus &status) {
+  last = std::min(last, parsed_.size());
+  while (first < last) {
+    if (parsed_[first].ast) {
+      ++first;
+      continue;
+    }
+    size_t runEnd = first + 1;
+    while (runEnd < last && !parsed_[runEnd].ast) {
+      ++runEnd;
+    }
+    if (!parseRun(first, runEnd, control, status)) {
+      return false;
+    }
+    first = runEnd;
+  }
+  return true;
+}
+
+bool LazyParseSession::parseRun(size_t first, size_t last, const ParseControl *control, ParseStatus &status) {
+  auto ast = std::make_shared<FlatMarkdownAST>();
+  ast->source = markdown_;
+  ast->nodes[FlatMarkdownAST::root()].sourceRange = {blocks_[first].begin, blocks_[last - 1].end};
+  bool parsed = control ? parser_.parseBlockRange(*ast, blocks_, first, last, flags_, *control, status)
+                        : parser_.parseBlockRange(*ast, blocks_, first, last, flags_);
+  if (!parsed) {
+    return false;
+  }
+
+  // Same assignment as the block cache: a block gets the top-level nodes that
+  // start in it, and the arena from its first one up to the next block's.
+  NodeIndex topLevel = ast->nodes[FlatMarkdownAST::root()].firstChild;
+  for (size_t i = first; i < last; ++i) {
+    ParsedBlock &block = parsed_[i];
+    block.ast = ast;
+    for (; topLevel != kInvalidNodeIndex && ast->nodes[topLevel].sourceRange.begin < blocks_[i].end;
+         topLevel = ast->nodes[topLevel].nextSibling) {
+      if (block.topLevelCount++ == 0) {
+        block.firstTopLevel = topLevel;
+      }
+    }
+  }
+  auto nodeEnd = static_cast<NodeIndex>(ast->nodes.size());
+  for (size_t i = last; i-- > first;) {
+    ParsedBlock &block = parsed_[i];
+    NodeIndex nodeBegin = block.topLevelCount > 0 ? block.firstTopLevel : nodeEnd;
+    for (NodeIndex node = nodeBegin; node < nodeEnd; ++node) {
+      const NodeAttributes *attrs = ast->attributesOf(node);
+      if (attrs && attrs->has(AttributeKey::TaskIndex)) {
+        block.firstTaskIndex = block.taskCount++ == 0 ? attrs->taskIndex
+                                                      : std::min(block.firstTaskIndex, attrs->taskIndex);
+      }
+    }
+    nodeEnd = nodeBegin;
+  }
+
+  unparsedCount_ -= last - first;
+  while (firstUnparsed_ < parsed_.size() && parsed_[firstUnparsed_].ast) {
+    ++firstUnparsed_;
+  }
+  return true;
+}
+
+} // namespace Markdown
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "BlockScanner.hpp"
+#include "FlatMarkdownAST.hpp"
+#include "MD4CParser.hpp"
+#include "ParseControl.hpp"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Markdown {
+
+// Two-phase parser for documents too large to parse before the first frame.
+// Construction only splits the text into top-level blocks with BlockScanner,
+// which costs a line scan; md4c runs later, for the blocks a renderer asks for
+// (typically the visible ones) or for a batch parsed in the background. A
+// block comes out exactly as it would from parsing the whole document,
+// reference definitions included.
+//
+// Every parse call puts the runs of blocks it parses into a FlatMarkdownAST of
+// their own. ParsedBlock says where a block's top-level nodes are in it.
+//
+// Thread-safe: a background thread may work through the document with
+// parseNext while the UI thread parses what it is about to show. Calls are
+// serialized, so background batches should be small.
+class LazyParseSession {
+public:
+  struct ParsedBlock {
+    // The AST holding the block, or nullptr while it is not parsed. Shared with
+    // the other blocks parsed in the same run.
+    std::shared_ptr<const FlatMarkdownAST> ast;
+    // The block's top-level nodes, linked by nextSibling. A block holding only
+    // reference definitions has none.
+    NodeIndex firstTopLevel = kInvalidNodeIndex;
+    uint32_t topLevelCount = 0;
+    // Task items in the block. Their AttributeKey::TaskIndex values count from
+    // the start of `ast`, with `firstTaskIndex` for the first of them; add
+    // tasksBefore() - firstTaskIndex to get their index in the document.
+    uint32_t taskCount = 0;
+    uint32_t firstTaskIndex = 0;
+  };
+
+  explicit LazyParseSession(std::shared_ptr<const std::string> markdown, const Md4cFlags &flags = Md4cFlags{});
+
+  size_t blockCount() const {
+    return blocks_.size();
+  }
+
+  // Source bytes of block `index`, known without parsing it.
+  const SourceBlock &sourceBlock(size_t index) const {
+    return blocks_[index];
+  }
+
+  // Index of the block holding byte `offset`, or blockCount() past the end.
+  size_t blockAt(uint32_t offset) const;
+
+  bool isParsed(size_t index) const;
+  ParsedBlock block(size_t index) const;
+
+  // Parses the blocks in [first, last) that are not parsed yet. Returns false
+  // if md4c fails or `control` stops it; blocks parsed by then stay parsed.
+  bool parse(size_t first, size_t last);
+  bool parse(size_t first, size_t last, const ParseControl &control, ParseStatus &status);
+
+  // Parses up to `maxBlocks` of the first blocks not parsed yet and returns how
+  // many are left, for working through the document in the background.
+  size_t parseNext(size_t maxBlocks);
+
+  // Task items in the blocks before `index`, once all of them are parsed.
+  std::optional<uint32_t> tasksBefore(size_t index) const;
+
+  const std::shared_ptr<const std::string> &source() const {
+    return markdown_;
+  }
+
+private:
+  bool parseLocked(size_t first, size_t last, const ParseControl *control, ParseStatus &status);
+  bool parseRun(size_t first, size_t last, const ParseControl *control, ParseStatus &status);
+
+  std::shared_ptr<const std::string> markdown_;
+  Md4cFlags flags_;
+  std::vector<SourceBlock> blocks_;
+
+  mutable std::mutex mutex_;
+  MD4CParser parser_;
+  std::vector<ParsedBlock> parsed_;
+  size_t unparsedCount_ = 0;
+  // Every block before it is parsed.
+  size_t firstUnparsed_ = 0;
+};
+
+} // namespace Markdown
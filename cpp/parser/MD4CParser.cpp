@@ -1,216 +1,625 @@
 #include "MD4CParser.hpp"
 #include "../md4c/md4c.h"
+#include "BlockScanner.hpp"
+#include "ContentHash.hpp"
+#include "DocumentIndex.hpp"
+#include "EmojiShortcodes.hpp"
+#include "HtmlEntities.hpp"
+#include "ParserMemoryPool.hpp"
+#include "PostParsePipeline.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstring>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace Markdown {
 
 class MD4CParser::Impl {
 public:
-  std::shared_ptr<MarkdownASTNode> root;
-  std::vector<std::shared_ptr<MarkdownASTNode>> nodeStack;
-  std::string currentText;
-  const char *inputText = nullptr;
-
-  static const std::string ATTR_LEVEL;
-  static const std::string ATTR_URL;
-  static const std::string ATTR_TITLE;
-  static const std::string ATTR_FENCE_CHAR;
-  static const std::string ATTR_LANGUAGE;
-  static const std::string ATTR_IS_TASK;
-  static const std::string ATTR_TASK_CHECKED;
-
-  void reset(size_t estimatedDepth) {
-    root = std::make_shared<MarkdownASTNode>(NodeType::Document);
+  FlatMarkdownAST *ast = nullptr;
+  std::vector<NodeIndex> nodeStack;
+  // Offset in ast->strings where the not-yet-flushed text run begins. Text
+  // chunks are appended straight into the arena, so a Text node is just a
+  // range over bytes that are already in place.
+  uint32_t pendingTextStart = 0;
+  // The slice md4c is parsing, used to turn text pointers into offsets. It
+  // starts at source offset sourceBase and may be a copy of the source bytes
+  // (see contextBefore).
+  const char *inputBegin = nullptr;
+  const char *inputEnd = nullptr;
+  // Zero-copy mode: while the pending run is a single contiguous slice of the
+  // source, it is tracked here instead of being copied into the arena.
+  bool useViews = false;
+  const char *pendingView = nullptr;
+  uint32_t pendingViewLength = 0;
+  // Source offsets: md4c reports the offset right before each enter/leave
+  // callback; text runs are located from the chunk pointers. md4c offsets are
+  // relative to what it parses, in which the slice starts at contextBefore.
+  uint32_t sourceBase = 0;
+  uint32_t rawOffset = 0;
+  uint32_t reportedOffset = 0;
+  uint32_t pendingSourceBegin = 0;
+  uint32_t pendingSourceEnd = 0;
+  bool pendingHasSource = false;
+  uint32_t lastSourceEnd = 0;
+  // Context blocks parsed around the slice only contribute their reference
+  // definitions. Top-level blocks that start before contextBefore or at
+  // contextEnd and later are theirs; skipDepth counts the open callbacks of
+  // the one being skipped.
+  uint32_t contextBefore = 0;
+  uint32_t contextEnd = UINT32_MAX;
+  uint32_t skipDepth = 0;
+  // Set while a controlled parse runs. The cancel flag is read on every
+  // callback that starts new output, the clock only every
+  // kDeadlinePollInterval of them. status records why the last parse stopped.
+  static constexpr uint32_t kDeadlinePollInterval = 256;
+  const ParseControl *control = nullptr;
+  ParseStatus status = ParseStatus::Completed;
+  uint32_t deadlinePoll = 0;
+  // Set while a public call collects ParseStats; parseSlice adds its md4c and
+  // post-processing work to it.
+  ParseStats *stats = nullptr;
+
+  // What each open md4c enter callback produced, so the matching leave knows
+  // what to undo. Blocks and spans past a ParseLimits limit produce Nothing.
+  enum class Opened : uint8_t { Nothing, Node, Container, Span, Flattened };
+  enum class Separator : uint8_t { None, Cell, Line };
+  ParseLimits limits;
+  std::vector<Opened> opened;
+  uint32_t containerDepth = 0;
+  uint32_t spanDepth = 0;
+  // Paragraph that collects the text of a block flattened for exceeding a
+  // limit. Blocks inside it produce no nodes; `separator` goes between their
+  // texts. After the node budget runs out (`overflowed`), it is one last
+  // top-level paragraph that takes the rest of the document.
+  NodeIndex flatRoot = kInvalidNodeIndex;
+  Separator separator = Separator::None;
+  bool overflowed = false;
+  // Runs over the blocks of each slice once md4c is done with them.
+  PostParsePipeline postParse = PostParsePipeline::standard();
+
+  void reset(FlatMarkdownAST *target, const char *data, size_t size, uint32_t base, uint32_t before,
+             size_t estimatedDepth) {
+    ast = target;
     nodeStack.clear();
     // Reserve based on estimated depth, with reasonable bounds
     // Typical markdown has 5-15 levels, but can go deeper with nested structures
     // Cap at 128 to avoid excessive memory for extreme cases
     nodeStack.reserve(std::min(estimatedDepth, static_cast<size_t>(128)));
-    nodeStack.push_back(root);
-    currentText.clear();
-    currentText.reserve(256);
+    nodeStack.push_back(FlatMarkdownAST::root());
+
+    // Size the arena up front so a typical parse never has to grow it.
+    // Prose averages well above 16 bytes per node and text never exceeds the
+    // input, so these estimates are upper bounds for all but pathological input.
+    // Appending to an existing AST leaves growth to the vectors, which keeps
+    // repeated slice parses amortized.
+    if (ast->nodes.size() == 1) {
+      ast->nodes.reserve(size / 16 + 16);
+      ast->attributeBlocks.reserve(size / 256 + 8);
+      // With source views the pool only holds attributes and synthesized text.
+      ast->strings.reserve(ast->source ? size / 8 + 64 : size);
+    }
+    pendingTextStart = static_cast<uint32_t>(ast->strings.size());
+
+    // Offsets are always relative to the start of the whole buffer, so a slice
+    // parse produces the same ranges and views as parsing the full input.
+    sourceBase = base;
+    inputBegin = data;
+    inputEnd = data + size;
+    contextBefore = before;
+    contextEnd = before + static_cast<uint32_t>(size);
+    skipDepth = 0;
+    opened.clear();
+    containerDepth = 0;
+    spanDepth = 0;
+    flatRoot = kInvalidNodeIndex;
+    separator = Separator::None;
+    overflowed = false;
+    rawOffset = 0;
+    // Views use the top offset bit as a tag, so inputs that large keep copying.
+    useViews = ast->source && base + size < TextRange::kSourceBit;
+    pendingView = nullptr;
+    pendingViewLength = 0;
+    reportedOffset = base;
+    pendingHasSource = false;
+    lastSourceEnd = base;
+  }
+
+  // Returns true, recording the reason in status, if the parse should stop.
+  bool stopRequested(bool checkClock = true) {
+    if (!control)
+      return false;
+    if (control->isCancelled()) {
+      status = ParseStatus::Cancelled;
+      return true;
+    }
+    if (checkClock && control->deadlinePassed()) {
+      status = ParseStatus::DeadlineExceeded;
+      return true;
+    }
+    return false;
+  }
+
+  // Called from the callbacks; a non-zero return makes md_parse stop.
+  int pollStop() {
+    return stopRequested(++deadlinePoll % kDeadlinePollInterval == 0) ? 1 : 0;
+  }
+
+  bool isInInput(const char *text, size_t size) const {
+    return text >= inputBegin && text + size <= inputEnd;
+  }
+
+  uint32_t offsetOf(const char *text) const {
+    return sourceBase + static_cast<uint32_t>(text - inputBegin);
+  }
+
+  // Returns true if `text` repeats the input bytes at `offset` (md4c emits line
+  // feeds and indentation in verbatim blocks from static strings).
+  bool matchesInputAt(uint32_t offset, const char *text, MD_SIZE size) const {
+    if (offset < sourceBase)
+      return false;
+    const char *at = inputBegin + (offset - sourceBase);
+    return at <= inputEnd && static_cast<size_t>(inputEnd - at) >= size && std::memcmp(text, at, size) == 0;
+  }
+
+  void trackTextSource(const char *text, MD_SIZE size) {
+    if (!isInInput(text, size)) {
+      if (pendingHasSource && matchesInputAt(pendingSourceEnd, text, size))
+        pendingSourceEnd += size;
+      return;
+    }
+    uint32_t begin = offsetOf(text);
+    if (!pendingHasSource) {
+      pendingSourceBegin = begin;
+      pendingHasSource = true;
+    }
+    pendingSourceEnd = begin + size;
+  }
+
+  void appendText(const char *text, MD_SIZE size) {
+    trackTextSource(text, size);
+    if (pendingView) {
+      // Continue the view if the chunk is the next slice of the source, or if it
+      // is byte-identical to it.
+      const char *next = pendingView + pendingViewLength;
+      if (text == next || matchesInputAt(offsetOf(next), text, size)) {
+        pendingViewLength += size;
+        return;
+      }
+      // Not contiguous any more: materialize the run into the arena.
+      ast->strings.append(pendingView, pendingViewLength);
+      pendingView = nullptr;
+      pendingViewLength = 0;
+    } else if (useViews && ast->strings.size() == pendingTextStart && isInInput(text, size)) {
+      pendingView = text;
+      pendingViewLength = size;
+      return;
+    }
+    ast->strings.append(text, size);
+  }
+
+  // Appends the text `entity` stands for to the pending run, so it joins the
+  // Text node around it. Names HTML does not define stay as written.
+  void appendEntity(const char *entity, MD_SIZE size) {
+    char buffer[4];
+    std::string_view decoded = decodeHtmlEntity({entity, size}, buffer);
+    if (decoded.empty()) {
+      appendText(entity, size);
+      return;
+    }
+    trackTextSource(entity, size);
+    if (pendingView) {
+      ast->strings.append(pendingView, pendingViewLength);
+      pendingView = nullptr;
+      pendingViewLength = 0;
+    }
+    ast->strings.append(decoded);
   }
 
   void flushText() {
-    if (!currentText.empty() && !nodeStack.empty()) {
-      auto textNode = std::make_shared<MarkdownASTNode>(NodeType::Text);
-      textNode->content = std::move(currentText);
-      nodeStack.back()->addChild(std::move(textNode));
-      currentText.clear();
+    NodeIndex textNode = kInvalidNodeIndex;
+    if (pendingView) {
+      if (!nodeStack.empty()) {
+        textNode = ast->appendChild(nodeStack.back(), NodeType::Text);
+        ast->nodes[textNode].content = {offsetOf(pendingView) | TextRange::kSourceBit, pendingViewLength};
+      }
+      pendingView = nullptr;
+      pendingViewLength = 0;
+    } else {
+      auto end = static_cast<uint32_t>(ast->strings.size());
+      if (end > pendingTextStart && !nodeStack.empty()) {
+        textNode = ast->appendChild(nodeStack.back(), NodeType::Text);
+        ast->nodes[textNode].content = {pendingTextStart, end - pendingTextStart};
+      }
+      pendingTextStart = end;
+    }
+
+    if (pendingHasSource) {
+      if (textNode != kInvalidNodeIndex) {
+        ast->nodes[textNode].sourceRange = {pendingSourceBegin, pendingSourceEnd};
+      }
+      lastSourceEnd = pendingSourceEnd;
+      pendingHasSource = false;
     }
   }
 
-  void pushNode(std::shared_ptr<MarkdownASTNode> node) {
+  NodeIndex pushNode(NodeType type, Opened kind = Opened::Node) {
     flushText();
-    if (node && !nodeStack.empty()) {
-      nodeStack.back()->addChild(node);
-      nodeStack.push_back(std::move(node));
+    NodeIndex node = ast->appendChild(nodeStack.back(), type);
+    ast->nodes[node].sourceRange.begin = reportedOffset;
+    // A line break before any content of the node is anchored to its start,
+    // which does not depend on what was parsed before the node's block.
+    lastSourceEnd = reportedOffset;
+    nodeStack.push_back(node);
+    opened.push_back(kind);
+    if (kind == Opened::Container) {
+      ++containerDepth;
+    } else if (kind == Opened::Span) {
+      ++spanDepth;
     }
+    return node;
   }
 
   void popNode() {
     flushText();
     if (nodeStack.size() > 1) {
+      FlatNode &node = ast->nodes[nodeStack.back()];
+      node.sourceRange.end = reportedOffset;
+      // Verbatim text carries the final line feed, which block ranges leave out.
+      if (node.lastChild != kInvalidNodeIndex) {
+        SourceRange &last = ast->nodes[node.lastChild].sourceRange;
+        last.end = std::min(last.end, reportedOffset);
+      }
+      lastSourceEnd = reportedOffset;
       nodeStack.pop_back();
     }
   }
 
-  void addInlineNode(std::shared_ptr<MarkdownASTNode> node) {
+  // Undoes what the enter callback matching this leave did. `between` is what
+  // separates the text of a block inside a flattened one from what follows.
+  void leave(Separator between) {
+    Opened kind = opened.back();
+    opened.pop_back();
+    if (overflowed || kind == Opened::Nothing) {
+      if (flatRoot != kInvalidNodeIndex) {
+        separator = std::max(separator, between);
+      }
+      return;
+    }
+    if (kind == Opened::Container) {
+      --containerDepth;
+    } else if (kind == Opened::Span) {
+      --spanDepth;
+    } else if (kind == Opened::Flattened) {
+      flatRoot = kInvalidNodeIndex;
+      separator = Separator::None;
+    }
+    popNode();
+  }
+
+  // Returns true if a block of `type` has to be flattened into a paragraph.
+  bool exceedsLimits(MD_BLOCKTYPE type, const void *detail) const {
+    switch (type) {
+      case MD_BLOCK_QUOTE:
+      case MD_BLOCK_UL:
+      case MD_BLOCK_OL:
+        return limits.maxNestingDepth != 0 && containerDepth >= limits.maxNestingDepth;
+      case MD_BLOCK_TABLE:
+        return limits.maxTableColumns != 0 && detail &&
+               static_cast<const MD_BLOCK_TABLE_DETAIL *>(detail)->col_count > limits.maxTableColumns;
+      default:
+        return false;
+    }
+  }
+
+  void pushFlattened() {
+    flatRoot = pushNode(NodeType::Paragraph, Opened::Flattened);
+    separator = Separator::None;
+  }
+
+  // Called before an enter callback creates anything. Once the document holds
+  // limits.maxNodes nodes, the open ones are closed where they are and the
+  // rest goes into one trailing paragraph.
+  bool overBudget() {
+    if (overflowed)
+      return true;
+    if (limits.maxNodes == 0 || ast->nodes.size() < limits.maxNodes)
+      return false;
+    flushText();
+    for (size_t i = nodeStack.size(); i-- > 1;) {
+      ast->nodes[nodeStack[i]].sourceRange.end = reportedOffset;
+    }
+    nodeStack.resize(1);
+    flatRoot = ast->appendChild(FlatMarkdownAST::root(), NodeType::Paragraph);
+    ast->nodes[flatRoot].sourceRange.begin = reportedOffset;
+    nodeStack.push_back(flatRoot);
+    separator = Separator::None;
+    overflowed = true;
+    return true;
+  }
+
+  // Puts the pending separator between two texts of a flattened block.
+  void emitSeparator() {
+    Separator pending = separator;
+    separator = Separator::None;
+    const FlatNode &root = ast->nodes[flatRoot];
+    if (root.childCount == 0 && !pendingView && ast->strings.size() == pendingTextStart)
+      return;
+    if (pending == Separator::Cell) {
+      appendText(" | ", 3);
+    } else if (overflowed) {
+      appendText("\n", 1);
+    } else {
+      addInlineNode(NodeType::LineBreak);
+    }
+  }
+
+  // Called once md_parse is done.
+  void finish() {
+    flushText();
+    if (overflowed) {
+      FlatNode &paragraph = ast->nodes[flatRoot];
+      paragraph.sourceRange.end = std::max(paragraph.sourceRange.begin, lastSourceEnd);
+    }
+  }
+
+  void addInlineNode(NodeType type) {
     flushText();
-    if (node && !nodeStack.empty()) {
-      nodeStack.back()->addChild(node);
+    NodeIndex node = ast->appendChild(nodeStack.back(), type);
+    // md4c reports no position for line breaks; anchor them to the end of the
+    // preceding content, or to the start of their parent without any.
+    ast->nodes[node].sourceRange = {lastSourceEnd, lastSourceEnd};
+  }
+
+  static void sourceOffset(MD_OFFSET offset, void *userdata) {
+    auto *impl = static_cast<Impl *>(userdata);
+    impl->rawOffset = offset;
+    if (offset >= impl->contextBefore) {
+      impl->reportedOffset = impl->sourceBase + (offset - impl->contextBefore);
+    }
+  }
+
+  static const MD_CHAR *emojiShortcode(const MD_CHAR *name, MD_SIZE size, MD_SIZE *emojiSize, void *userdata) {
+    (void)userdata;
+    std::string_view emoji = emojiForShortcode(std::string_view(name, size));
+    *emojiSize = static_cast<MD_SIZE>(emoji.size());
+    return emoji.empty() ? nullptr : emoji.data();
+  }
+
+  // Called first thing in enterBlock/enterSpan. Returns true if the block or
+  // span belongs to a context block and must not produce nodes.
+  bool enterSkipped(bool isTopLevelBlock) {
+    if (skipDepth > 0) {
+      ++skipDepth;
+      return true;
+    }
+    if (isTopLevelBlock && opened.size() == 1 && (rawOffset < contextBefore || rawOffset >= contextEnd)) {
+      skipDepth = 1;
+      return true;
+    }
+    return false;
+  }
+
+  // Called first thing in leaveBlock/leaveSpan.
+  bool leaveSkipped() {
+    if (skipDepth == 0)
+      return false;
+    --skipDepth;
+    return true;
+  }
+
+  // Returns the node's typed attribute block, creating it on first use.
+  NodeAttributes &attributesFor(NodeIndex node) {
+    FlatNode &flatNode = ast->nodes[node];
+    if (flatNode.attributeIndex == kNoAttributes) {
+      flatNode.attributeIndex = static_cast<uint32_t>(ast->attributeBlocks.size());
+      ast->attributeBlocks.emplace_back();
+    }
+    return ast->attributeBlocks[flatNode.attributeIndex];
+  }
+
+  // Copies an md4c attribute string into the arena and marks it present.
+  // Absent or empty strings leave the attribute unset.
+  void setStringAttribute(NodeIndex node, AttributeKey key, const MD_ATTRIBUTE &attr) {
+    if (attr.size == 0 || !attr.text)
+      return;
+    auto begin = static_cast<uint32_t>(ast->strings.size());
+    char buffer[4];
+    for (int i = 0; attr.substr_offsets[i] < attr.size; ++i) {
+      std::string_view part(attr.text + attr.substr_offsets[i], attr.substr_offsets[i + 1] - attr.substr_offsets[i]);
+      if (attr.substr_types[i] == MD_TEXT_ENTITY) {
+        std::string_view decoded = decodeHtmlEntity(part, buffer);
+        part = decoded.empty() ? part : decoded;
+      }
+      ast->strings.append(part);
     }
+    setStringAttribute(node, key, begin);
+  }
+
+  // Sets a token's attribute to `prefix`, its name and `suffix`, e.g. the Url
+  // "mention:alice" of "@alice".
+  void setTokenAttribute(NodeIndex node, AttributeKey key, std::string_view prefix, const MD_SPAN_TOKEN_DETAIL &token,
+                         std::string_view suffix) {
+    auto begin = static_cast<uint32_t>(ast->strings.size());
+    ast->strings.append(prefix);
+    ast->strings.append(token.name, token.name_size);
+    ast->strings.append(suffix);
+    setStringAttribute(node, key, begin);
   }
 
-  std::string getAttributeText(const MD_ATTRIBUTE *attr) {
-    if (!attr || attr->size == 0 || !attr->text)
-      return {};
+  // Sets the attribute to the strings appended since `begin`.
+  void setStringAttribute(NodeIndex node, AttributeKey key, uint32_t begin) {
+    TextRange range{begin, static_cast<uint32_t>(ast->strings.size()) - begin};
+    pendingTextStart = static_cast<uint32_t>(ast->strings.size());
 
-    // Use string constructor directly - let SSO handle small strings efficiently
-    // Empty return {} avoids allocating empty string object
-    return std::string(attr->text, attr->size);
+    NodeAttributes &attrs = attributesFor(node);
+    switch (key) {
+      case AttributeKey::Url:
+        attrs.url = range;
+        break;
+      case AttributeKey::Title:
+        attrs.title = range;
+        break;
+      case AttributeKey::Language:
+        attrs.language = range;
+        break;
+      default:
+        return;
+    }
+    attrs.markPresent(key);
   }
 
   static int enterBlock(MD_BLOCKTYPE type, void *detail, void *userdata) {
     if (!userdata)
       return 1;
     auto *impl = static_cast<Impl *>(userdata);
+    if (impl->pollStop())
+      return 1;
+    if (impl->enterSkipped(type != MD_BLOCK_DOC))
+      return 0;
+    // The Document node is created in reset().
+    if (type == MD_BLOCK_DOC || impl->overBudget() || impl->flatRoot != kInvalidNodeIndex) {
+      impl->opened.push_back(Opened::Nothing);
+      return 0;
+    }
+    if (impl->exceedsLimits(type, detail)) {
+      impl->pushFlattened();
+      return 0;
+    }
 
     switch (type) {
-      case MD_BLOCK_DOC:
-        // Document node already created in reset()
-        break;
-
       case MD_BLOCK_P: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::Paragraph));
+        impl->pushNode(NodeType::Paragraph);
         break;
       }
 
       case MD_BLOCK_H: {
-        auto node = std::make_shared<MarkdownASTNode>(NodeType::Heading);
+        NodeIndex node = impl->pushNode(NodeType::Heading);
         if (detail) {
           auto *h = static_cast<MD_BLOCK_H_DETAIL *>(detail);
           int level = static_cast<int>(h->level);
           // Clamp level to valid range (1-6)
           level = (level < 1) ? 1 : (level > 6) ? 6 : level;
-          // Use char conversion for small integers (1-6)
-          // Avoids std::to_string() allocation overhead
-          char levelStr[2] = {static_cast<char>('0' + level), '\0'};
-          node->setAttribute(ATTR_LEVEL, levelStr);
+          NodeAttributes &attrs = impl->attributesFor(node);
+          attrs.level = static_cast<uint8_t>(level);
+          attrs.markPresent(AttributeKey::Level);
         }
-        impl->pushNode(node);
         break;
       }
 
       case MD_BLOCK_QUOTE: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::Blockquote));
+        impl->pushNode(NodeType::Blockquote, Opened::Container);
         break;
       }
 
       case MD_BLOCK_UL: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::UnorderedList));
+        impl->pushNode(NodeType::UnorderedList, Opened::Container);
         break;
       }
 
       case MD_BLOCK_OL: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::OrderedList));
+        impl->pushNode(NodeType::OrderedList, Opened::Container);
         break;
       }
 
       case MD_BLOCK_LI: {
-        auto node = std::make_shared<MarkdownASTNode>(NodeType::ListItem);
+        NodeIndex node = impl->pushNode(NodeType::ListItem);
         if (detail) {
           auto *li = static_cast<MD_BLOCK_LI_DETAIL *>(detail);
           if (li->is_task) {
-            node->setAttribute(ATTR_IS_TASK, "true");
-            node->setAttribute(ATTR_TASK_CHECKED, (li->task_mark == 'x' || li->task_mark == 'X') ? "true" : "false");
+            NodeAttributes &attrs = impl->attributesFor(node);
+            attrs.isTask = true;
+            attrs.taskChecked = (li->task_mark == 'x' || li->task_mark == 'X');
+            attrs.markPresent(AttributeKey::IsTask);
+            attrs.markPresent(AttributeKey::TaskChecked);
           }
         }
-        impl->pushNode(node);
         break;
       }
 
       case MD_BLOCK_CODE: {
-        auto node = std::make_shared<MarkdownASTNode>(NodeType::CodeBlock);
+        NodeIndex node = impl->pushNode(NodeType::CodeBlock);
         if (detail) {
           auto *codeDetail = static_cast<MD_BLOCK_CODE_DETAIL *>(detail);
           // Extract fence character (if fenced code block)
           if (codeDetail->fence_char != 0) {
-            char fenceStr[2] = {static_cast<char>(codeDetail->fence_char), '\0'};
-            node->setAttribute(ATTR_FENCE_CHAR, fenceStr);
+            NodeAttributes &attrs = impl->attributesFor(node);
+            attrs.fenceChar = static_cast<char>(codeDetail->fence_char);
+            attrs.markPresent(AttributeKey::FenceChar);
           }
           // Extract language from lang attribute
-          std::string lang = impl->getAttributeText(&codeDetail->lang);
-          if (!lang.empty()) {
-            node->setAttribute(ATTR_LANGUAGE, lang);
-          }
+          impl->setStringAttribute(node, AttributeKey::Language, codeDetail->lang);
         }
-        impl->pushNode(node);
         break;
       }
 
       case MD_BLOCK_HR: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::ThematicBreak));
+        impl->pushNode(NodeType::ThematicBreak);
         break;
       }
 
       case MD_BLOCK_TABLE: {
-        auto node = std::make_shared<MarkdownASTNode>(NodeType::Table);
+        NodeIndex node = impl->pushNode(NodeType::Table);
         if (detail) {
           auto *tableDetail = static_cast<MD_BLOCK_TABLE_DETAIL *>(detail);
-          node->setAttribute("colCount", std::to_string(tableDetail->col_count));
-          node->setAttribute("headRowCount", std::to_string(tableDetail->head_row_count));
-          node->setAttribute("bodyRowCount", std::to_string(tableDetail->body_row_count));
+          NodeAttributes &attrs = impl->attributesFor(node);
+          attrs.colCount = tableDetail->col_count;
+          attrs.headRowCount = tableDetail->head_row_count;
+          attrs.bodyRowCount = tableDetail->body_row_count;
+          attrs.markPresent(AttributeKey::ColCount);
+          attrs.markPresent(AttributeKey::HeadRowCount);
+          attrs.markPresent(AttributeKey::BodyRowCount);
         }
-        impl->pushNode(node);
         break;
       }
 
       case MD_BLOCK_THEAD: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::TableHead));
+        impl->pushNode(NodeType::TableHead);
         break;
       }
 
       case MD_BLOCK_TBODY: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::TableBody));
+        impl->pushNode(NodeType::TableBody);
         break;
       }
 
       case MD_BLOCK_TR: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::TableRow));
+        impl->pushNode(NodeType::TableRow);
         break;
       }
 
       case MD_BLOCK_TH:
       case MD_BLOCK_TD: {
-        auto node =
-            std::make_shared<MarkdownASTNode>(type == MD_BLOCK_TH ? NodeType::TableHeaderCell : NodeType::TableCell);
+        NodeIndex node = impl->pushNode(type == MD_BLOCK_TH ? NodeType::TableHeaderCell : NodeType::TableCell);
         if (detail) {
           auto *tdDetail = static_cast<MD_BLOCK_TD_DETAIL *>(detail);
-          const char *alignStr;
+          NodeAttributes &attrs = impl->attributesFor(node);
           switch (tdDetail->align) {
             case MD_ALIGN_LEFT:
-              alignStr = "left";
+              attrs.align = CellAlign::Left;
               break;
             case MD_ALIGN_CENTER:
-              alignStr = "center";
+              attrs.align = CellAlign::Center;
               break;
             case MD_ALIGN_RIGHT:
-              alignStr = "right";
+              attrs.align = CellAlign::Right;
               break;
             default:
-              alignStr = "default";
+              attrs.align = CellAlign::Default;
               break;
           }
-          node->setAttribute("align", alignStr);
+          attrs.markPresent(AttributeKey::Align);
         }
-        impl->pushNode(node);
         break;
       }
 
       default:
         // Other block types not yet implemented
+        impl->opened.push_back(Opened::Nothing);
         break;
     }
 
@@ -222,11 +631,10 @@ public:
     if (!userdata)
       return 1;
     auto *impl = static_cast<Impl *>(userdata);
+    if (impl->leaveSkipped())
+      return 0;
 
-    if (type != MD_BLOCK_DOC && !impl->nodeStack.empty()) {
-      impl->popNode();
-    }
-
+    impl->leave(type == MD_BLOCK_TD || type == MD_BLOCK_TH ? Separator::Cell : Separator::Line);
     return 0;
   }
 
@@ -234,89 +642,109 @@ public:
     if (!userdata)
       return 1;
     auto *impl = static_cast<Impl *>(userdata);
+    if (impl->pollStop())
+      return 1;
+    if (impl->enterSkipped(false))
+      return 0;
+    if (impl->overBudget() ||
+        (impl->limits.maxNestingDepth != 0 && impl->spanDepth >= impl->limits.maxNestingDepth)) {
+      impl->opened.push_back(Opened::Nothing);
+      return 0;
+    }
+    if (impl->separator != Separator::None)
+      impl->emitSeparator();
 
     switch (type) {
       case MD_SPAN_A: {
-        auto node = std::make_shared<MarkdownASTNode>(NodeType::Link);
+        NodeIndex node = impl->pushNode(NodeType::Link, Opened::Span);
         if (detail) {
           auto *linkDetail = static_cast<MD_SPAN_A_DETAIL *>(detail);
-          std::string url = impl->getAttributeText(&linkDetail->href);
-          if (!url.empty()) {
-            node->setAttribute(ATTR_URL, url);
-          }
+          impl->setStringAttribute(node, AttributeKey::Url, linkDetail->href);
         }
-        impl->pushNode(node);
         break;
       }
 
       case MD_SPAN_STRONG: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::Strong));
+        impl->pushNode(NodeType::Strong, Opened::Span);
         break;
       }
 
       case MD_SPAN_EM: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::Emphasis));
+        impl->pushNode(NodeType::Emphasis, Opened::Span);
         break;
       }
 
       case MD_SPAN_U: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::Underline));
+        impl->pushNode(NodeType::Underline, Opened::Span);
         break;
       }
 
       case MD_SPAN_CODE: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::Code));
+        impl->pushNode(NodeType::Code, Opened::Span);
         break;
       }
 
       case MD_SPAN_DEL: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::Strikethrough));
+        impl->pushNode(NodeType::Strikethrough, Opened::Span);
         break;
       }
 
       case MD_SPAN_IMG: {
-        auto node = std::make_shared<MarkdownASTNode>(NodeType::Image);
+        NodeIndex node = impl->pushNode(NodeType::Image, Opened::Span);
         if (detail) {
           auto *imgDetail = static_cast<MD_SPAN_IMG_DETAIL *>(detail);
-          std::string url = impl->getAttributeText(&imgDetail->src);
-          if (!url.empty()) {
-            node->setAttribute(ATTR_URL, url);
-          }
-          std::string title = impl->getAttributeText(&imgDetail->title);
-          if (!title.empty()) {
-            node->setAttribute(ATTR_TITLE, title);
-          }
+          impl->setStringAttribute(node, AttributeKey::Url, imgDetail->src);
+          impl->setStringAttribute(node, AttributeKey::Title, imgDetail->title);
         }
-        impl->pushNode(node);
         break;
       }
 
       case MD_SPAN_LATEXMATH: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::LatexMathInline));
+        impl->pushNode(NodeType::LatexMathInline, Opened::Span);
         break;
       }
 
       case MD_SPAN_LATEXMATH_DISPLAY: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::LatexMathDisplay));
+        impl->pushNode(NodeType::LatexMathDisplay, Opened::Span);
         break;
       }
 
       case MD_SPAN_SPOILER: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::Spoiler));
+        impl->pushNode(NodeType::Spoiler, Opened::Span);
         break;
       }
 
       case MD_SPAN_SUPERSCRIPT: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::Superscript));
+        impl->pushNode(NodeType::Superscript, Opened::Span);
         break;
       }
 
       case MD_SPAN_SUBSCRIPT: {
-        impl->pushNode(std::make_shared<MarkdownASTNode>(NodeType::Subscript));
+        impl->pushNode(NodeType::Subscript, Opened::Span);
+        break;
+      }
+
+      case MD_SPAN_MENTION:
+      case MD_SPAN_HASHTAG: {
+        bool mention = type == MD_SPAN_MENTION;
+        NodeIndex node = impl->pushNode(mention ? NodeType::Mention : NodeType::Hashtag, Opened::Span);
+        if (detail) {
+          impl->setTokenAttribute(node, AttributeKey::Url, mention ? "mention:" : "hashtag:",
+                                  *static_cast<MD_SPAN_TOKEN_DETAIL *>(detail), {});
+        }
+        break;
+      }
+
+      case MD_SPAN_EMOJI_SHORTCODE: {
+        NodeIndex node = impl->pushNode(NodeType::EmojiShortcode, Opened::Span);
+        if (detail) {
+          impl->setTokenAttribute(node, AttributeKey::Title, ":", *static_cast<MD_SPAN_TOKEN_DETAIL *>(detail), ":");
+        }
         break;
       }
 
       default:
+        impl->opened.push_back(Opened::Nothing);
         break;
     }
 
@@ -328,11 +756,10 @@ public:
     if (!userdata)
       return 1;
     auto *impl = static_cast<Impl *>(userdata);
+    if (impl->leaveSkipped())
+      return 0;
 
-    if (!impl->nodeStack.empty()) {
-      impl->popNode();
-    }
-
+    impl->leave(Separator::None);
     return 0;
   }
 
@@ -340,192 +767,821 @@ public:
     if (!userdata || !text || size == 0)
       return 0;
     auto *impl = static_cast<Impl *>(userdata);
+    if (impl->pollStop())
+      return 1;
+    if (impl->skipDepth > 0)
+      return 0;
+    if (impl->separator != Separator::None)
+      impl->emitSeparator();
 
     // Handle soft/hard line breaks
     if (type == MD_TEXT_SOFTBR || type == MD_TEXT_BR) {
-      auto brNode = std::make_shared<MarkdownASTNode>(NodeType::LineBreak);
-      impl->addInlineNode(brNode);
+      if (impl->overBudget()) {
+        impl->appendText("\n", 1);
+      } else {
+        impl->addInlineNode(NodeType::LineBreak);
+      }
       return 0;
     }
 
     // Handle text content (normal text, code text, LaTeX math, etc.)
     if (type == MD_TEXT_NORMAL || type == MD_TEXT_CODE || type == MD_TEXT_LATEXMATH) {
-      impl->currentText.append(text, size);
+      impl->appendText(text, size);
+    } else if (type == MD_TEXT_ENTITY) {
+      impl->appendEntity(text, size);
     }
 
     return 0;
   }
 };
 
+// The top-level blocks of the previous document parsed with the block cache
+// on. md4c emits blocks in order, so the nodes of one block are contiguous in
+// `ast` and can be copied over as a unit.
+struct MD4CParser::BlockCache {
+  struct Entry {
+    uint32_t sourceBegin = 0;
+    uint32_t sourceLength = 0;
+    NodeIndex nodeBegin = 0;
+    NodeIndex nodeEnd = 0;
+    NodeIndex firstTopLevel = kInvalidNodeIndex;
+    uint32_t topLevelCount = 0;
+  };
+
+  std::shared_ptr<const FlatMarkdownAST> ast;
+  Md4cFlags flags;
+  // Hash of every block that may define a link reference. Those apply to the
+  // whole document, so cached blocks are only valid while it stays the same.
+  uint64_t definitionsHash = 0;
+  std::vector<Entry> entries;
+  std::unordered_map<uint64_t, uint32_t> entryByHash;
+
+  // Returns the entry holding exactly `bytes`, or nullptr. The entry at
+  // `expected` is tried first: repeated blocks hash to their first copy, and
+  // following on from the previous hit instead keeps unchanged stretches
+  // contiguous.
+  const Entry *find(uint64_t hash, std::string_view bytes, size_t expected) const {
+    if (expected < entries.size() && holds(entries[expected], bytes)) {
+      return &entries[expected];
+    }
+    auto it = entryByHash.find(hash);
+    if (it == entryByHash.end()) {
+      return nullptr;
+    }
+    const Entry &entry = entries[it->second];
+    return holds(entry, bytes) ? &entry : nullptr;
+  }
+
+  bool holds(const Entry &entry, std::string_view bytes) const {
+    return std::string_view(*ast->source).substr(entry.sourceBegin, entry.sourceLength) == bytes;
+  }
+
+  // Appends a copy of the nodes of `entry` to `target` as if its block had been
+  // parsed at `sourceBegin`, and returns the entry describing the copy.
+  Entry copyInto(FlatMarkdownAST &target, const Entry &entry, uint32_t sourceBegin) const {
+    const FlatMarkdownAST &cached = *ast;
+    auto base = static_cast<NodeIndex>(target.nodes.size());
+    // Offsets only move by whole-document edits before the block, so unsigned
+    // wrap-around gives the right result in both directions.
+    uint32_t shift = sourceBegin - entry.sourceBegin;
+    auto remap = [&](NodeIndex index) {
+      if (index == FlatMarkdownAST::root()) {
+        return index;
+      }
+      return index >= entry.nodeBegin && index < entry.nodeEnd ? base + (index - entry.nodeBegin) : kInvalidNodeIndex;
+    };
+    auto copyText = [&](TextRange range) {
+      if (range.length == 0) {
+        return range;
+      }
+      if (range.inSource()) {
+        return TextRange{(range.position() + shift) | TextRange::kSourceBit, range.length};
+      }
+      TextRange copied{static_cast<uint32_t>(target.strings.size()), range.length};
+      target.strings.append(cached.text(range));
+      return copied;
+    };
+
+    // Copy the nodes in one go, then fix up their links and payloads in place.
+    bool renumbered = false;
+    target.nodes.insert(target.nodes.end(), cached.nodes.begin() + entry.nodeBegin,
+                        cached.nodes.begin() + entry.nodeEnd);
+    for (auto node = target.nodes.begin() + base; node != target.nodes.end(); ++node) {
+      node->parent = remap(node->parent);
+      node->firstChild = remap(node->firstChild);
+      node->lastChild = remap(node->lastChild);
+      node->nextSibling = remap(node->nextSibling);
+      // Text that md4c synthesizes has no source range and keeps {0, 0}.
+      if (node->sourceRange.end != 0) {
+        node->sourceRange.begin += shift;
+        node->sourceRange.end += shift;
+      }
+      node->content = copyText(node->content);
+      if (node->attributeIndex != kNoAttributes) {
+        NodeAttributes attrs = cached.attributeBlocks[node->attributeIndex];
+        attrs.url = copyText(attrs.url);
+        attrs.title = copyText(attrs.title);
+        attrs.language = copyText(attrs.language);
+        if (attrs.has(AttributeKey::TaskIndex)) {
+          renumbered |= attrs.taskIndex != target.taskCount;
+          attrs.taskIndex = target.taskCount++;
+        }
+        node->attributeIndex = static_cast<uint32_t>(target.attributeBlocks.size());
+        target.attributeBlocks.push_back(attrs);
+      }
+    }
+    // Task items come in document order in the arena. Their index is part of
+    // the hashes, so a block whose tasks moved is rehashed.
+    if (renumbered) {
+      target.updateHashes(base, static_cast<NodeIndex>(target.nodes.size()));
+    }
+
+    FlatNode &document = target.nodes[FlatMarkdownAST::root()];
+    NodeIndex topLevel = entry.firstTopLevel;
+    for (uint32_t i = 0; i < entry.topLevelCount; ++i, topLevel = cached.nodes[topLevel].nextSibling) {
+      NodeIndex copied = remap(topLevel);
+      target.nodes[copied].nextSibling = kInvalidNodeIndex;
+      if (document.lastChild == kInvalidNodeIndex) {
+        document.firstChild = copied;
+      } else {
+        target.nodes[document.lastChild].nextSibling = copied;
+      }
+      document.lastChild = copied;
+      document.childCount++;
+    }
+
+    Entry copy = entry;
+    copy.sourceBegin = sourceBegin;
+    copy.nodeBegin = base;
+    copy.nodeEnd = static_cast<NodeIndex>(target.nodes.size());
+    copy.firstTopLevel = entry.topLevelCount > 0 ? remap(entry.firstTopLevel) : kInvalidNodeIndex;
+    return copy;
+  }
+};
+
 namespace {
 
-bool isDisplayMathNode(const MarkdownASTNode &node) {
-  return node.type == NodeType::LatexMathDisplay;
+unsigned md4cParserFlags(const Md4cFlags &md4cFlags) {
+  unsigned flags = MD_FLAG_NOHTML | MD_FLAG_STRIKETHROUGH | MD_FLAG_TABLES | MD_FLAG_TASKLISTS | MD_FLAG_SPOILERS;
+  if (md4cFlags.permissiveAutolinks) {
+    flags |= MD_FLAG_PERMISSIVEAUTOLINKS;
+  }
+  if (md4cFlags.latexMath) {
+    flags |= MD_FLAG_LATEXMATHSPANS;
+  }
+  if (md4cFlags.underline) {
+    flags |= MD_FLAG_UNDERLINE;
+  }
+  if (md4cFlags.superscript) {
+    flags |= MD_FLAG_SUPERSCRIPTS;
+  }
+  if (md4cFlags.subscript) {
+    flags |= MD_FLAG_SUBSCRIPTS;
+  }
+  if (md4cFlags.mentions) {
+    flags |= MD_FLAG_MENTIONS;
+  }
+  if (md4cFlags.hashtags) {
+    flags |= MD_FLAG_HASHTAGS;
+  }
+  if (md4cFlags.emojiShortcodes) {
+    flags |= MD_FLAG_EMOJISHORTCODES;
+  }
+  return flags;
 }
 
-bool isSeparatorNode(const MarkdownASTNode &node) {
-  return node.type == NodeType::LineBreak ||
-         (node.type == NodeType::Text && node.content.find_first_not_of(" \t\n\r") == std::string::npos);
+// Estimate stack depth based on markdown size
+// Heuristic: ~1 nesting level per 500-1000 characters for typical markdown
+// This is a rough estimate - actual depth depends on structure, not just size
+// Base depth of 12 covers typical nested structures (blockquotes, future lists)
+size_t estimateDepth(size_t size) {
+  size_t estimatedDepth = 12; // Base depth for small documents
+  if (size > 1000) {
+    // Scale up for larger documents, but cap the growth
+    estimatedDepth = std::min(static_cast<size_t>(12 + (size / 1000)), static_cast<size_t>(64));
+  }
+  return estimatedDepth;
 }
 
-// md4c treats $$...$$ as an inline span, so when display math appears on a line
-// directly after text (no blank line), md4c merges them into a single Paragraph.
-// This function finds the trailing run of LatexMathDisplay nodes (possibly
-// interspersed with LineBreak / whitespace separators) at the end of a paragraph's
-// children. Returns the index where the trailing run starts, or children.size()
-// if there is nothing to promote.
-size_t findTrailingDisplayMathRun(const std::vector<std::shared_ptr<MarkdownASTNode>> &children) {
-  size_t trailingRunStart = children.size();
-  bool hasDisplayMath = false;
-
-  for (size_t j = children.size(); j > 0; --j) {
-    auto &node = children[j - 1];
-    if (isDisplayMathNode(*node)) {
-      trailingRunStart = j - 1;
-      hasDisplayMath = true;
-    } else if (isSeparatorNode(*node) && hasDisplayMath) {
-      trailingRunStart = j - 1;
-    } else {
-      break;
+} // anonymous namespace
+
+// Points impl_ at the caller's ParseControl for the duration of one public
+// call, so the internal parse paths need no extra parameter.
+class MD4CParser::ControlScope {
+public:
+  ControlScope(Impl &impl, const ParseControl &control) : impl_(impl) {
+    impl_.control = &control;
+    impl_.status = ParseStatus::Completed;
+  }
+  ~ControlScope() {
+    impl_.control = nullptr;
+  }
+
+private:
+  Impl &impl_;
+};
+
+// Resets and times the caller's ParseStats for the outermost public call.
+// Public calls made from another one leave the stats to it.
+class MD4CParser::StatsScope {
+public:
+  StatsScope(Impl &impl, ParseStats *stats, size_t inputBytes)
+      : impl_(impl), stats_(impl.stats ? nullptr : stats), start_(Clock::now()) {
+    if (stats_) {
+      *stats_ = ParseStats{};
+      stats_->inputBytes = inputBytes;
+      impl_.stats = stats_;
     }
   }
+  ~StatsScope() {
+    if (stats_) {
+      if (stats_->totalTime == ParseStats::Duration::zero()) {
+        stats_->totalTime = Clock::now() - start_;
+      }
+      impl_.stats = nullptr;
+    }
+  }
+
+  // Records the total time and the shape of the result. The walk over the
+  // result is not counted in the total.
+  template <typename Result> void finish(const Result &result) {
+    if (stats_) {
+      stats_->totalTime = Clock::now() - start_;
+      stats_->measure(result);
+    }
+  }
+
+  std::shared_ptr<MarkdownASTNode> toTree(const FlatMarkdownAST &ast) {
+    if (!stats_) {
+      return ast.toTree();
+    }
+    auto start = Clock::now();
+    auto tree = ast.toTree();
+    stats_->treeBuildTime = Clock::now() - start;
+    finish(*tree);
+    return tree;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
 
-  return hasDisplayMath ? trailingRunStart : children.size();
+  Impl &impl_;
+  ParseStats *stats_;
+  Clock::time_point start_;
+};
+
+MD4CParser::MD4CParser() : impl_(std::make_unique<Impl>()) {}
+
+MD4CParser::~MD4CParser() = default;
+
+std::shared_ptr<MarkdownASTNode> MD4CParser::parse(const std::string &markdown, const Md4cFlags &md4cFlags) {
+  StatsScope stats(*impl_, stats_, markdown.size());
+  return stats.toTree(*parseFlat(markdown, md4cFlags));
 }
 
-// Collect only the LatexMathDisplay nodes from a range, skipping separators.
-std::vector<std::shared_ptr<MarkdownASTNode>>
-collectDisplayMathNodes(const std::vector<std::shared_ptr<MarkdownASTNode>> &children, size_t from) {
-  std::vector<std::shared_ptr<MarkdownASTNode>> result;
-  for (size_t j = from; j < children.size(); ++j) {
-    if (isDisplayMathNode(*children[j]))
-      result.push_back(children[j]);
+std::shared_ptr<const FlatMarkdownAST> MD4CParser::parseFlat(const std::string &markdown,
+                                                             const Md4cFlags &md4cFlags) {
+  StatsScope stats(*impl_, stats_, markdown.size());
+  auto ast = parseInto(std::make_shared<FlatMarkdownAST>(), markdown, md4cFlags);
+  stats.finish(*ast);
+  return ast;
+}
+
+std::shared_ptr<const FlatMarkdownAST> MD4CParser::parseFlat(std::shared_ptr<const std::string> markdown,
+                                                             const Md4cFlags &md4cFlags) {
+  StatsScope stats(*impl_, stats_, markdown ? markdown->size() : 0);
+  auto ast = std::make_shared<FlatMarkdownAST>();
+  if (!markdown) {
+    stats.finish(*ast);
+    return ast;
+  }
+  ast->source = std::move(markdown);
+  if (documentIndexEnabled_) {
+    ast->indexBuilder = std::make_shared<DocumentIndexBuilder>();
   }
+  std::shared_ptr<const FlatMarkdownAST> result;
+  // A truncated parse only looks at a prefix, which says little about the next
+  // document; it leaves the block cache alone.
+  if (blockCache_ && !md4cFlags.truncates()) {
+    result = parseWithBlockCache(std::move(ast), md4cFlags);
+  } else {
+    const std::string &input = *ast->source;
+    result = parseInto(std::move(ast), input, md4cFlags);
+  }
+  stats.finish(*result);
   return result;
 }
 
-// md4c wraps $$...$$ (display math) as inline spans inside a Paragraph. When they
-// appear on consecutive lines without a blank separator, md4c merges them — along
-// with any preceding text — into a single Paragraph with LineBreak nodes between them.
-//
-// This post-processing step walks the document's top-level children and promotes
-// trailing LatexMathDisplay nodes out of their parent Paragraph so that the
-// rendering layer sees them as top-level block elements.
-//
-// Two cases:
-//  (a) Pure: every child is display math or a separator → replace paragraph entirely.
-//  (b) Mixed: leading text followed by display math → keep text in the paragraph,
-//      splice the display math nodes as siblings after it.
-void promoteDisplayMathFromParagraphs(MarkdownASTNode &root) {
-  auto &children = root.children;
-
-  for (size_t i = 0; i < children.size();) {
-    auto &paragraph = children[i];
-    if (paragraph->type != NodeType::Paragraph || paragraph->children.empty()) {
-      ++i;
-      continue;
+std::shared_ptr<MarkdownASTNode> MD4CParser::parse(const std::string &markdown, const Md4cFlags &md4cFlags,
+                                                   const ParseControl &control, ParseStatus &status) {
+  StatsScope stats(*impl_, stats_, markdown.size());
+  std::shared_ptr<const FlatMarkdownAST> ast;
+  {
+    ControlScope scope(*impl_, control);
+    if (!impl_->stopRequested()) {
+      ast = parseInto(std::make_shared<FlatMarkdownAST>(), markdown, md4cFlags);
+    }
+    status = impl_->status;
+  }
+  return status == ParseStatus::Completed ? stats.toTree(*ast) : nullptr;
+}
+
+std::shared_ptr<const FlatMarkdownAST> MD4CParser::parseFlat(std::shared_ptr<const std::string> markdown,
+                                                             const Md4cFlags &md4cFlags, const ParseControl &control,
+                                                             ParseStatus &status) {
+  StatsScope stats(*impl_, stats_, markdown ? markdown->size() : 0);
+  ControlScope scope(*impl_, control);
+  // A parse that was queued behind others may be stale before it starts.
+  std::shared_ptr<const FlatMarkdownAST> ast;
+  if (!impl_->stopRequested()) {
+    ast = parseFlat(std::move(markdown), md4cFlags);
+  }
+  status = impl_->status;
+  if (status != ParseStatus::Completed) {
+    return nullptr;
+  }
+  stats.finish(*ast);
+  return ast;
+}
+
+bool MD4CParser::parseRange(FlatMarkdownAST &ast, uint32_t begin, uint32_t end, const Md4cFlags &md4cFlags) {
+  if (!ast.source || begin > end || end > ast.source->size()) {
+    return false;
+  }
+  return parseSlice(*impl_, ast, ast.source->data() + begin, end - begin, begin, md4cFlags);
+}
+
+bool MD4CParser::parseBlockRange(FlatMarkdownAST &ast, const std::vector<SourceBlock> &blocks, size_t first,
+                                 size_t last, const Md4cFlags &md4cFlags) {
+  if (!ast.source || first >= last || last > blocks.size() || blocks.back().end > ast.source->size()) {
+    return false;
+  }
+  return parseBlocks(*impl_, ast, *ast.source, blocks, first, last, md4cFlags);
+}
+
+bool MD4CParser::parseBlockRange(FlatMarkdownAST &ast, const std::vector<SourceBlock> &blocks, size_t first,
+                                 size_t last, const Md4cFlags &md4cFlags, const ParseControl &control,
+                                 ParseStatus &status) {
+  ControlScope scope(*impl_, control);
+  bool parsed = !impl_->stopRequested() && parseBlockRange(ast, blocks, first, last, md4cFlags);
+  status = !parsed && impl_->status == ParseStatus::Completed ? ParseStatus::Failed : impl_->status;
+  return parsed;
+}
+
+std::shared_ptr<const FlatMarkdownAST> MD4CParser::parseInto(std::shared_ptr<FlatMarkdownAST> ast,
+                                                             const std::string &markdown, const Md4cFlags &md4cFlags) {
+  if (markdown.empty()) {
+    return ast;
+  }
+
+  if (md4cFlags.truncates()) {
+    return parseTruncated(std::move(ast), markdown, md4cFlags);
+  }
+
+  if (parallelThreads_ > 1 && markdown.size() >= parallelMinimumSize_) {
+    return parseParallel(std::move(ast), markdown, md4cFlags);
+  }
+
+  ast->nodes[FlatMarkdownAST::root()].sourceRange = {0, static_cast<uint32_t>(markdown.size())};
+  if (!parseSlice(*impl_, *ast, markdown.data(), markdown.size(), 0, md4cFlags)) {
+    // Parsing failed, return empty document
+    return std::make_shared<FlatMarkdownAST>();
+  }
+
+  return ast;
+}
+
+std::shared_ptr<const FlatMarkdownAST> MD4CParser::parseTruncated(std::shared_ptr<FlatMarkdownAST> ast,
+                                                                  std::string_view input, const Md4cFlags &md4cFlags) {
+  // md4c looks at every line before it reports the first block, so rather than
+  // stopping it midway the input is cut at a BlockScanner boundary first. The
+  // scan is cheap next to md4c, and it also finds the reference definitions the
+  // kept blocks may use.
+  std::vector<SourceBlock> blocks = splitTopLevelBlocks(input);
+  size_t last = blocks.size();
+  if (md4cFlags.maxSourceBytes != 0) {
+    last = 1;
+    while (last < blocks.size() && blocks[last].begin < md4cFlags.maxSourceBytes) {
+      ++last;
+    }
+  }
+
+  // A source block holds at least one top-level node unless it only defines
+  // references, so asking for the missing count of blocks rarely needs a
+  // second round.
+  auto topLevelCount = [&] { return ast->nodes[FlatMarkdownAST::root()].childCount; };
+  size_t parsed = 0;
+  while (parsed < last && (md4cFlags.maxBlocks == 0 || topLevelCount() < md4cFlags.maxBlocks)) {
+    size_t next = md4cFlags.maxBlocks == 0 ? last : std::min(last, parsed + md4cFlags.maxBlocks - topLevelCount());
+    if (!parseBlocks(*impl_, *ast, input, blocks, parsed, next, md4cFlags)) {
+      return std::make_shared<FlatMarkdownAST>();
+    }
+    parsed = next;
+  }
+
+  auto end = static_cast<uint32_t>(parsed < blocks.size() ? blocks[parsed].begin : input.size());
+  if (md4cFlags.maxBlocks != 0 && topLevelCount() > md4cFlags.maxBlocks) {
+    NodeIndex lastKept = ast->nodes[FlatMarkdownAST::root()].firstChild;
+    for (uint32_t i = 1; i < md4cFlags.maxBlocks; ++i) {
+      lastKept = ast->nodes[lastKept].nextSibling;
+    }
+    end = ast->nodes[ast->nodes[lastKept].nextSibling].sourceRange.begin;
+    ast->truncateChildrenAfter(FlatMarkdownAST::root(), lastKept);
+    ast->indexBuilder.reset();
+  }
+  ast->nodes[FlatMarkdownAST::root()].sourceRange = {0, end};
+  ast->truncated = end < input.size();
+  ast->truncatedAt = end;
+  return ast;
+}
+
+void MD4CParser::setBlockCacheEnabled(bool enabled) {
+  if (!enabled) {
+    blockCache_.reset();
+  } else if (!blockCache_) {
+    blockCache_ = std::make_unique<BlockCache>();
+  }
+}
+
+std::shared_ptr<const FlatMarkdownAST> MD4CParser::parseWithBlockCache(std::shared_ptr<FlatMarkdownAST> ast,
+                                                                       const Md4cFlags &md4cFlags) {
+  std::string_view input = *ast->source;
+  if (input.empty()) {
+    return ast;
+  }
+  ast->nodes[FlatMarkdownAST::root()].sourceRange = {0, static_cast<uint32_t>(input.size())};
+
+  std::vector<SourceBlock> blocks = splitTopLevelBlocks(input);
+  auto bytesOf = [&](const SourceBlock &block) { return input.substr(block.begin, block.end - block.begin); };
+
+  uint64_t definitionsHash = 0;
+  for (const SourceBlock &block : blocks) {
+    if (block.mayDefineReferences) {
+      definitionsHash = contentHash(bytesOf(block), definitionsHash);
+    }
+  }
+
+  const BlockCache &cache = *blockCache_;
+  bool reusable = cache.ast && cache.flags == md4cFlags && cache.definitionsHash == definitionsHash;
+  std::vector<uint64_t> hashes(blocks.size());
+  std::vector<const BlockCache::Entry *> hits(blocks.size(), nullptr);
+  // Offset from a block to its entry in the cache. A single block found
+  // elsewhere is usually an edit that matches some other block, so the offset
+  // only moves once two blocks in a row were not where it predicted.
+  size_t shift = 0;
+  bool predicted = true;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    hashes[i] = contentHash(bytesOf(blocks[i]));
+    if (reusable) {
+      hits[i] = cache.find(hashes[i], bytesOf(blocks[i]), i + shift);
+      bool wasPredicted = predicted;
+      predicted = hits[i] == cache.entries.data() + i + shift;
+      if (hits[i] && !predicted && !wasPredicted) {
+        shift = static_cast<size_t>(hits[i] - cache.entries.data()) - i;
+      }
     }
+  }
+
+  // An edit rarely changes the size of the document much, so the previous
+  // arena is a good estimate for this one.
+  if (reusable) {
+    ast->nodes.reserve(cache.ast->nodes.size());
+    ast->attributeBlocks.reserve(cache.ast->attributeBlocks.size());
+    ast->strings.reserve(cache.ast->strings.size());
+  }
 
-    auto &paragraphChildren = paragraph->children;
-    size_t trailingRunStart = findTrailingDisplayMathRun(paragraphChildren);
+  // Copied blocks bring along what the cached parse collected for the
+  // DocumentIndex. Runs of blocks that were adjacent there too are handed
+  // over in one go, as the lookups it takes are per run.
+  struct {
+    NodeIndex begin = 0;
+    NodeIndex end = 0;
+    NodeIndex base = 0;
+  } copiedRun;
+  auto appendCopiedRun = [&] {
+    if (copiedRun.end > copiedRun.begin && ast->indexBuilder) {
+      if (cache.ast->indexBuilder) {
+        ast->indexBuilder->appendNodes(*cache.ast->indexBuilder, copiedRun.begin, copiedRun.end, copiedRun.base);
+      } else {
+        ast->indexBuilder.reset();
+      }
+    }
+    copiedRun = {};
+  };
 
-    if (trailingRunStart >= paragraphChildren.size()) {
-      ++i;
+  BlockCache next;
+  next.entries.resize(blocks.size());
+  for (size_t first = 0; first < blocks.size();) {
+    // Copying a large document out of the cache takes a while as well.
+    if (hits[first] && impl_->stopRequested()) {
+      return std::make_shared<FlatMarkdownAST>();
+    }
+    if (hits[first]) {
+      const BlockCache::Entry &hit = *hits[first];
+      const BlockCache::Entry &copy = next.entries[first] = cache.copyInto(*ast, hit, blocks[first].begin);
+      if (hit.nodeBegin != copiedRun.end || copy.nodeBegin != copiedRun.base + (copiedRun.end - copiedRun.begin)) {
+        appendCopiedRun();
+        copiedRun = {hit.nodeBegin, hit.nodeBegin, copy.nodeBegin};
+      }
+      copiedRun.end = hit.nodeEnd;
+      ++first;
       continue;
     }
+    appendCopiedRun();
 
-    auto promoted = collectDisplayMathNodes(paragraphChildren, trailingRunStart);
+    size_t last = first + 1;
+    while (last < blocks.size() && !hits[last]) {
+      ++last;
+    }
+    NodeIndex previous = ast->nodes[FlatMarkdownAST::root()].lastChild;
+    bool parsed = parallelThreads_ > 1 && blocks[last - 1].end - blocks[first].begin >= parallelMinimumSize_
+                      ? parseBlocksInParallel(*ast, input, blocks, first, last, md4cFlags)
+                      : parseBlocks(*impl_, *ast, input, blocks, first, last, md4cFlags);
+    if (!parsed) {
+      // A stopped parse says nothing about the cached document; keep it for the
+      // next attempt.
+      if (!impl_->control || impl_->status == ParseStatus::Failed) {
+        blockCache_ = std::make_unique<BlockCache>();
+      }
+      return std::make_shared<FlatMarkdownAST>();
+    }
 
-    if (trailingRunStart == 0) {
-      auto position = children.erase(children.begin() + static_cast<ptrdiff_t>(i));
-      children.insert(position, promoted.begin(), promoted.end());
-      i += promoted.size();
-    } else {
-      paragraphChildren.erase(paragraphChildren.begin() + static_cast<ptrdiff_t>(trailingRunStart),
-                              paragraphChildren.end());
-      while (!paragraphChildren.empty() && isSeparatorNode(*paragraphChildren.back())) {
-        paragraphChildren.pop_back();
+    // Hand the new top-level nodes out to the blocks they start in, then give
+    // each block the nodes from its first top-level node up to the next one's.
+    NodeIndex topLevel = previous == kInvalidNodeIndex ? ast->nodes[FlatMarkdownAST::root()].firstChild
+                                                       : ast->nodes[previous].nextSibling;
+    for (size_t i = first; i < last; ++i) {
+      BlockCache::Entry &entry = next.entries[i];
+      entry.sourceBegin = blocks[i].begin;
+      entry.sourceLength = blocks[i].end - blocks[i].begin;
+      for (; topLevel != kInvalidNodeIndex && ast->nodes[topLevel].sourceRange.begin < blocks[i].end;
+           topLevel = ast->nodes[topLevel].nextSibling) {
+        if (entry.topLevelCount++ == 0) {
+          entry.firstTopLevel = topLevel;
+        }
       }
-      auto position = children.begin() + static_cast<ptrdiff_t>(i) + 1;
-      children.insert(position, promoted.begin(), promoted.end());
-      i += 1 + promoted.size();
     }
+    auto nodeEnd = static_cast<NodeIndex>(ast->nodes.size());
+    for (size_t i = last; i-- > first;) {
+      BlockCache::Entry &entry = next.entries[i];
+      entry.nodeEnd = nodeEnd;
+      entry.nodeBegin = entry.topLevelCount > 0 ? entry.firstTopLevel : nodeEnd;
+      nodeEnd = entry.nodeBegin;
+    }
+    first = last;
+  }
+  appendCopiedRun();
+
+  // Past the node budget the tail of the document hangs off whichever block it
+  // ran out in, so the blocks no longer own their nodes.
+  if (impl_->limits.maxNodes != 0 && ast->nodes.size() >= impl_->limits.maxNodes) {
+    blockCache_ = std::make_unique<BlockCache>();
+    return ast;
+  }
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    next.entryByHash.emplace(hashes[i], static_cast<uint32_t>(i));
   }
+  next.ast = ast;
+  next.flags = md4cFlags;
+  next.definitionsHash = definitionsHash;
+  *blockCache_ = std::move(next);
+  return ast;
 }
 
-} // anonymous namespace
+void MD4CParser::setParallelParsing(unsigned threadCount, size_t minimumSize) {
+  parallelThreads_ = std::max(threadCount, 1u);
+  parallelMinimumSize_ = minimumSize;
+}
 
-MD4CParser::MD4CParser() : impl_(std::make_unique<Impl>()) {}
+void MD4CParser::setLimits(const ParseLimits &limits) {
+  impl_->limits = limits;
+  if (blockCache_) {
+    blockCache_ = std::make_unique<BlockCache>();
+  }
+}
 
-MD4CParser::~MD4CParser() = default;
+const ParseLimits &MD4CParser::limits() const {
+  return impl_->limits;
+}
 
-std::shared_ptr<MarkdownASTNode> MD4CParser::parse(const std::string &markdown, const Md4cFlags &md4cFlags) {
-  if (markdown.empty()) {
-    return std::make_shared<MarkdownASTNode>(NodeType::Document);
+void MD4CParser::setStats(ParseStats *stats) {
+  stats_ = stats;
+}
+
+ParseStats *MD4CParser::stats() const {
+  return stats_;
+}
+
+void MD4CParser::setDocumentIndexEnabled(bool enabled) {
+  documentIndexEnabled_ = enabled;
+}
+
+std::shared_ptr<const FlatMarkdownAST> MD4CParser::parseParallel(std::shared_ptr<FlatMarkdownAST> ast,
+                                                                 const std::string &markdown,
+                                                                 const Md4cFlags &md4cFlags) {
+  std::vector<SourceBlock> blocks = splitTopLevelBlocks(markdown);
+  ast->nodes[FlatMarkdownAST::root()].sourceRange = {0, static_cast<uint32_t>(markdown.size())};
+  if (!parseBlocksInParallel(*ast, markdown, blocks, 0, blocks.size(), md4cFlags)) {
+    return std::make_shared<FlatMarkdownAST>();
   }
+  return ast;
+}
 
-  // Estimate stack depth based on markdown size
-  // Heuristic: ~1 nesting level per 500-1000 characters for typical markdown
-  // This is a rough estimate - actual depth depends on structure, not just size
-  // Base depth of 12 covers typical nested structures (blockquotes, future lists)
-  size_t estimatedDepth = 12; // Base depth for small documents
-  if (markdown.size() > 1000) {
-    // Scale up for larger documents, but cap the growth
-    estimatedDepth = std::min(static_cast<size_t>(12 + (markdown.size() / 1000)), static_cast<size_t>(64));
+bool MD4CParser::parseBlocksInParallel(FlatMarkdownAST &ast, std::string_view input,
+                                       const std::vector<SourceBlock> &blocks, size_t first, size_t last,
+                                       const Md4cFlags &md4cFlags) {
+  // A few pieces per thread, so a thread that drew cheap blocks can pick up
+  // another piece while the others finish.
+  struct Piece {
+    size_t first;
+    size_t last;
+  };
+  std::vector<Piece> pieces;
+  size_t runSize = blocks[last - 1].end - blocks[first].begin;
+  size_t targetSize = runSize / (static_cast<size_t>(parallelThreads_) * 4) + 1;
+  for (size_t begin = first; begin < last;) {
+    size_t end = begin + 1;
+    while (end < last && blocks[end].begin - blocks[begin].begin < targetSize) {
+      ++end;
+    }
+    pieces.push_back({begin, end});
+    begin = end;
+  }
+  if (pieces.size() < 2) {
+    return parseBlocks(*impl_, ast, input, blocks, first, last, md4cFlags);
+  }
+
+  std::vector<FlatMarkdownAST> parts(pieces.size());
+  for (FlatMarkdownAST &part : parts) {
+    part.source = ast.source;
+    if (ast.indexBuilder) {
+      part.indexBuilder = std::make_shared<DocumentIndexBuilder>();
+    }
   }
 
-  impl_->reset(estimatedDepth);
-  impl_->inputText = markdown.c_str();
+  // The first piece that does not complete decides the status of the run and
+  // makes the other threads stop picking up pieces.
+  std::atomic<size_t> nextPiece{0};
+  std::atomic<ParseStatus> outcome{ParseStatus::Completed};
+  auto fail = [&](ParseStatus status) {
+    ParseStatus expected = ParseStatus::Completed;
+    outcome.compare_exchange_strong(expected, status == ParseStatus::Completed ? ParseStatus::Failed : status);
+  };
+  auto work = [&](Impl &impl) {
+    try {
+      for (size_t i = nextPiece++; i < pieces.size() && outcome == ParseStatus::Completed; i = nextPiece++) {
+        if (!parseBlocks(impl, parts[i], input, blocks, pieces[i].first, pieces[i].last, md4cFlags)) {
+          fail(impl.status);
+        }
+      }
+    } catch (...) {
+      fail(ParseStatus::Failed);
+    }
+  };
 
-  unsigned flags = MD_FLAG_NOHTML | MD_FLAG_STRIKETHROUGH | MD_FLAG_TABLES | MD_FLAG_TASKLISTS | MD_FLAG_SPOILERS;
-  if (md4cFlags.permissiveAutolinks) {
-    flags |= MD_FLAG_PERMISSIVEAUTOLINKS;
+  size_t threadCount = std::min(static_cast<size_t>(parallelThreads_), pieces.size());
+  std::vector<std::thread> workers;
+  workers.reserve(threadCount - 1);
+  std::vector<ParseStats> workerStats(impl_->stats ? threadCount - 1 : 0);
+  try {
+    for (size_t i = 1; i < threadCount; ++i) {
+      ParseStats *stats = impl_->stats ? &workerStats[i - 1] : nullptr;
+      workers.emplace_back([&work, control = impl_->control, &limits = impl_->limits, stats] {
+        Impl impl;
+        impl.control = control;
+        impl.limits = limits;
+        impl.stats = stats;
+        work(impl);
+      });
+    }
+  } catch (const std::system_error &) {
+    // Out of threads: the ones that did start and this one share the work.
   }
-  if (md4cFlags.latexMath) {
-    flags |= MD_FLAG_LATEXMATHSPANS;
+  work(*impl_);
+  for (std::thread &worker : workers) {
+    worker.join();
   }
-  if (md4cFlags.underline) {
-    flags |= MD_FLAG_UNDERLINE;
+  for (const ParseStats &stats : workerStats) {
+    impl_->stats->addWork(stats);
   }
-  if (md4cFlags.superscript) {
-    flags |= MD_FLAG_SUPERSCRIPTS;
+  if (outcome != ParseStatus::Completed) {
+    impl_->status = outcome;
+    return false;
   }
-  if (md4cFlags.subscript) {
-    flags |= MD_FLAG_SUBSCRIPTS;
+
+  size_t nodeCount = ast.nodes.size();
+  size_t attributeCount = ast.attributeBlocks.size();
+  size_t stringsSize = ast.strings.size();
+  for (const FlatMarkdownAST &part : parts) {
+    nodeCount += part.nodes.size() - 1;
+    attributeCount += part.attributeBlocks.size();
+    stringsSize += part.strings.size();
+  }
+  ast.nodes.reserve(nodeCount);
+  ast.attributeBlocks.reserve(attributeCount);
+  ast.strings.reserve(stringsSize);
+  for (const FlatMarkdownAST &part : parts) {
+    ast.appendBlocksOf(part);
   }
+  return true;
+}
+
+bool MD4CParser::parseBlocks(Impl &impl, FlatMarkdownAST &ast, std::string_view input,
+                             const std::vector<SourceBlock> &blocks, size_t first, size_t last,
+                             const Md4cFlags &md4cFlags) {
+  // Reference definitions outside the run still have to be visible to it, so
+  // the candidate blocks around it are parsed along with it as context.
+  // Without any, the run is parsed in place.
+  auto bytesOf = [&](const SourceBlock &block) { return input.substr(block.begin, block.end - block.begin); };
+  uint32_t begin = blocks[first].begin;
+  uint32_t size = blocks[last - 1].end - begin;
+  std::string context;
+  for (size_t i = 0; i < first; ++i) {
+    if (blocks[i].mayDefineReferences) {
+      context.append(bytesOf(blocks[i]));
+    }
+  }
+  auto contextBefore = static_cast<uint32_t>(context.size());
+  context.append(input.substr(begin, size));
+  for (size_t i = last; i < blocks.size(); ++i) {
+    if (blocks[i].mayDefineReferences) {
+      context.append(bytesOf(blocks[i]));
+    }
+  }
+  if (context.size() == size) {
+    return parseSlice(impl, ast, input.data() + begin, size, begin, md4cFlags);
+  }
+  auto contextAfter = static_cast<uint32_t>(context.size() - contextBefore - size);
+  return parseSlice(impl, ast, context.data() + contextBefore, size, begin, md4cFlags, contextBefore, contextAfter);
+}
+
+bool MD4CParser::parseSlice(Impl &impl, FlatMarkdownAST &ast, const char *data, size_t size, uint32_t base,
+                            const Md4cFlags &md4cFlags, uint32_t contextBefore, uint32_t contextAfter) {
+  if (size == 0) {
+    return true;
+  }
+  if (impl.stopRequested()) {
+    return false;
+  }
+
+  impl.reset(&ast, data, size, base, contextBefore, estimateDepth(size));
+  NodeIndex previous = ast.nodes[FlatMarkdownAST::root()].lastChild;
 
   // Configure MD4C parser with callbacks
   MD_PARSER parser = {
       0, // abi_version
-      flags,   &Impl::enterBlock, &Impl::leaveBlock, &Impl::enterSpan, &Impl::leaveSpan, &Impl::text,
+      md4cParserFlags(md4cFlags),
+      &Impl::enterBlock,
+      &Impl::leaveBlock,
+      &Impl::enterSpan,
+      &Impl::leaveSpan,
+      &Impl::text,
       nullptr, // debug_log
-      nullptr  // syntax
+      nullptr, // syntax
+      &Impl::sourceOffset,
+      // md4c's working buffers are kept per thread and reused by the next parse.
+      ParserMemoryPool::forCurrentThread().allocator(),
+      impl.limits.maxInlineMarksPerBlock,
+      &Impl::emojiShortcode,
   };
 
+  using Clock = std::chrono::steady_clock;
+  ParserMemoryPool::Stats poolBefore;
+  Clock::time_point start;
+  if (impl.stats) {
+    poolBefore = ParserMemoryPool::forCurrentThread().stats();
+    start = Clock::now();
+  }
+
   // Parse the markdown
-  int result = md_parse(markdown.c_str(), static_cast<MD_SIZE>(markdown.size()), &parser, impl_.get());
+  int result =
+      md_parse(data - contextBefore, static_cast<MD_SIZE>(contextBefore + size + contextAfter), &parser, &impl);
+
+  if (impl.stats) {
+    ParserMemoryPool::Stats poolAfter = ParserMemoryPool::forCurrentThread().stats();
+    impl.stats->allocations += poolAfter.systemAllocations - poolBefore.systemAllocations;
+    impl.stats->allocatedBytes += poolAfter.systemBytes - poolBefore.systemBytes;
+    impl.stats->md4cTime += Clock::now() - start;
+    start = Clock::now();
+  }
 
   if (result != 0) {
-    // Parsing failed, return empty document
-    return std::make_shared<MarkdownASTNode>(NodeType::Document);
+    if (impl.status == ParseStatus::Completed) {
+      impl.status = ParseStatus::Failed;
+    }
+    return false;
   }
 
-  impl_->flushText();
+  impl.finish();
 
-  if (impl_->root) {
-    promoteDisplayMathFromParagraphs(*impl_->root);
-  }
+  NodeIndex first =
+      previous == kInvalidNodeIndex ? ast.nodes[FlatMarkdownAST::root()].firstChild : ast.nodes[previous].nextSibling;
+  impl.postParse.run(ast, first, previous);
 
-  return impl_->root ? impl_->root : std::make_shared<MarkdownASTNode>(NodeType::Document);
+  if (impl.stats) {
+    impl.stats->postProcessTime += Clock::now() - start;
+  }
+  return true;
 }
 
-// Static member definitions
-const std::string MD4CParser::Impl::ATTR_LEVEL = "level";
-const std::string MD4CParser::Impl::ATTR_URL = "url";
-const std::string MD4CParser::Impl::ATTR_TITLE = "title";
-const std::string MD4CParser::Impl::ATTR_FENCE_CHAR = "fenceChar";
-const std::string MD4CParser::Impl::ATTR_LANGUAGE = "language";
-const std::string MD4CParser::Impl::ATTR_IS_TASK = "isTask";
-const std::string MD4CParser::Impl::ATTR_TASK_CHECKED = "taskChecked";
-
-} // namespace Markdown
\ No newline at end of file
+} // namespace Markdown
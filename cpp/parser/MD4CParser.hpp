@@ -1,17 +1,74 @@
 #pragma once
 
+#include "FlatMarkdownAST.hpp"
 #include "MarkdownASTNode.hpp"
+#include "ParseControl.hpp"
+#include "ParseStats.hpp"
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <memory>
+#include <string_view>
+#include <vector>
 
 namespace Markdown {
 
+struct SourceBlock;
+
 struct Md4cFlags {
     bool underline = false;
     bool latexMath = true;
     bool superscript = false;
     bool subscript = false;
     bool permissiveAutolinks = true;
+    // Chat tokens: "@name" mentions, "#name" hashtags and ":name:" emoji
+    // shortcodes. Recognized by md4c itself, so never inside code, links or
+    // URLs, and unknown shortcodes stay plain text.
+    bool mentions = false;
+    bool hashtags = false;
+    bool emojiShortcodes = false;
+    // Not md4c options: stop at the first top-level block boundary once this
+    // many top-level blocks, or blocks reaching past this many bytes, have been
+    // parsed, for messages shown collapsed. Reference definitions further on
+    // still apply. 0 disables a limit; StreamingParseSession ignores both.
+    uint32_t maxBlocks = 0;
+    uint32_t maxSourceBytes = 0;
+
+    bool truncates() const {
+        return maxBlocks != 0 || maxSourceBytes != 0;
+    }
+
+    bool operator==(const Md4cFlags& other) const {
+        return underline == other.underline && latexMath == other.latexMath && superscript == other.superscript &&
+               subscript == other.subscript && permissiveAutolinks == other.permissiveAutolinks &&
+               mentions == other.mentions && hashtags == other.hashtags && emojiShortcodes == other.emojiShortcodes &&
+               maxBlocks == other.maxBlocks && maxSourceBytes == other.maxSourceBytes;
+    }
+
+    bool operator!=(const Md4cFlags& other) const {
+        return !(*this == other);
+    }
+};
+
+// Caps on how much structure one document may make the parser and the
+// renderers build, for untrusted input. Content past a limit is kept as plain
+// text rather than dropped. 0 disables a limit.
+struct ParseLimits {
+    // Blockquotes and lists nested deeper than this are rendered as one
+    // paragraph of their text, and inline spans nested deeper than this within
+    // a block lose their formatting. Keeps trees shallow enough for the
+    // recursive converters on both platforms.
+    uint32_t maxNestingDepth = 32;
+    // Once a document holds this many nodes, the rest of it is collected into
+    // one trailing paragraph of plain text. With parallel parsing the budget
+    // applies to each piece on its own.
+    uint32_t maxNodes = 4u * 1024 * 1024;
+    // Tables with more columns are rendered as a paragraph, one line per row.
+    // md4c itself does not recognize tables wider than 128 columns.
+    uint32_t maxTableColumns = 128;
+    // Emphasis delimiters, brackets, backticks and other inline marks md4c
+    // looks at per paragraph; the rest of the paragraph is taken literally.
+    uint32_t maxInlineMarksPerBlock = 64 * 1024;
 };
 
 class MD4CParser {
@@ -22,9 +79,120 @@ public:
     // Parse markdown string and return AST root node
     std::shared_ptr<MarkdownASTNode> parse(const std::string& markdown, const Md4cFlags& flags = Md4cFlags{});
 
+    // Parse markdown string into an arena-backed flat AST. The whole document is
+    // stored in a few contiguous buffers instead of one heap node per element,
+    // which is what the platform bridges walk.
+    std::shared_ptr<const FlatMarkdownAST> parseFlat(const std::string& markdown, const Md4cFlags& flags = Md4cFlags{});
+
+    // Zero-copy variant of parseFlat. Text that md4c reports as a contiguous
+    // slice of the input is stored as a view into `markdown` rather than copied;
+    // only synthesized text (escapes, replaced characters) goes to the owned pool.
+    // The returned AST shares ownership of the buffer, so it stays valid after
+    // the caller releases its own reference.
+    std::shared_ptr<const FlatMarkdownAST> parseFlat(std::shared_ptr<const std::string> markdown,
+                                                     const Md4cFlags& flags = Md4cFlags{});
+
+    // Variants of parse and the zero-copy parseFlat that stop early once
+    // `control` is cancelled or its deadline passes. `status` tells a stopped
+    // parse apart from a failed one; either way nullptr is returned. A stopped
+    // parse leaves the block cache as it was.
+    std::shared_ptr<MarkdownASTNode> parse(const std::string& markdown, const Md4cFlags& flags,
+                                           const ParseControl& control, ParseStatus& status);
+    std::shared_ptr<const FlatMarkdownAST> parseFlat(std::shared_ptr<const std::string> markdown,
+                                                     const Md4cFlags& flags, const ParseControl& control,
+                                                     ParseStatus& status);
+
+    // Parses bytes [begin, end) of `ast.source` and appends the resulting
+    // top-level blocks to the document root of `ast`. Source ranges and text
+    // views are offsets into the whole source, as if it had been parsed in one
+    // go, so the slice must start at a block boundary. The root's own source
+    // range is left to the caller. Returns false if md4c fails, in which case
+    // `ast` may hold a partial result.
+    bool parseRange(FlatMarkdownAST& ast, uint32_t begin, uint32_t end, const Md4cFlags& flags = Md4cFlags{});
+
+    // Parses blocks [first, last) of `blocks`, as returned by
+    // splitTopLevelBlocks(*ast.source), and appends them like parseRange.
+    // Reference definitions in the other blocks apply to the run, so its nodes
+    // match those of a whole-document parse; only task numbering starts from
+    // `ast.taskCount`. The variant with `control` reports why it returned false.
+    bool parseBlockRange(FlatMarkdownAST& ast, const std::vector<SourceBlock>& blocks, size_t first, size_t last,
+                         const Md4cFlags& flags = Md4cFlags{});
+    bool parseBlockRange(FlatMarkdownAST& ast, const std::vector<SourceBlock>& blocks, size_t first, size_t last,
+                         const Md4cFlags& flags, const ParseControl& control, ParseStatus& status);
+
+    // Makes the zero-copy parseFlat remember the top-level blocks of the last
+    // document it parsed. The next document is split at the same kind of block
+    // boundaries and every block whose bytes are unchanged is copied over from
+    // the previous result instead of being parsed again, so an edit costs
+    // roughly the size of the blocks it touches. An edit that may add, remove or
+    // change a link reference definition re-parses the whole document. Off by
+    // default; disabling it drops the cached document.
+    void setBlockCacheEnabled(bool enabled);
+
+    static constexpr size_t kDefaultParallelMinimumSize = 512 * 1024;
+
+    // Lets parseFlat spread documents of at least `minimumSize` bytes over
+    // `threadCount` threads (the calling one included). The input is split at
+    // top-level block boundaries, the pieces are parsed concurrently and then
+    // joined under one Document node; the result is the same as a serial
+    // parse. 1, the default, keeps every parse on the calling thread. With the
+    // block cache on, the same applies to each run of blocks it re-parses.
+    void setParallelParsing(unsigned threadCount, size_t minimumSize = kDefaultParallelMinimumSize);
+
+    // Replaces the default ParseLimits and drops the block cache. ParseCache
+    // does not key entries on limits, so parsers sharing it should use the
+    // same ones.
+    void setLimits(const ParseLimits& limits);
+    const ParseLimits& limits() const;
+
+    // While set, every parse and parseFlat call resets `*stats` and fills it
+    // in; pass nullptr to stop. Collecting costs one extra walk over the result
+    // and a few clock reads per call, so it is off by default.
+    void setStats(ParseStats* stats);
+    ParseStats* stats() const;
+
+    // Makes parseFlat collect the DocumentIndex of each document in the
+    // post-parse pass over its blocks, so FlatMarkdownAST::index() has nothing
+    // left to walk. With the block cache on, copied blocks bring along what was
+    // collected for them. Off by default, as it reads every byte of text again
+    // to count words; turn it on only for callers that use the index.
+    void setDocumentIndexEnabled(bool enabled);
+
 private:
+    std::shared_ptr<const FlatMarkdownAST> parseInto(std::shared_ptr<FlatMarkdownAST> ast, const std::string& markdown,
+                                                     const Md4cFlags& flags);
+    std::shared_ptr<const FlatMarkdownAST> parseWithBlockCache(std::shared_ptr<FlatMarkdownAST> ast,
+                                                               const Md4cFlags& flags);
+    std::shared_ptr<const FlatMarkdownAST> parseTruncated(std::shared_ptr<FlatMarkdownAST> ast, std::string_view input,
+                                                          const Md4cFlags& flags);
+    std::shared_ptr<const FlatMarkdownAST> parseParallel(std::shared_ptr<FlatMarkdownAST> ast,
+                                                         const std::string& markdown, const Md4cFlags& flags);
+
     class Impl;
+    class ControlScope;
+    class StatsScope;
+
+    // `contextBefore` bytes before `data` and `contextAfter` bytes after the
+    // slice are parsed along with it for their reference definitions only.
+    static bool parseSlice(Impl& impl, FlatMarkdownAST& ast, const char* data, size_t size, uint32_t base,
+                           const Md4cFlags& flags, uint32_t contextBefore = 0, uint32_t contextAfter = 0);
+    // Parses blocks [first, last) of `input`, with every other block that may
+    // define a link reference as context.
+    static bool parseBlocks(Impl& impl, FlatMarkdownAST& ast, std::string_view input,
+                            const std::vector<SourceBlock>& blocks, size_t first, size_t last,
+                            const Md4cFlags& flags);
+    // Same as parseBlocks, spread over parallelThreads_ threads.
+    bool parseBlocksInParallel(FlatMarkdownAST& ast, std::string_view input, const std::vector<SourceBlock>& blocks,
+                               size_t first, size_t last, const Md4cFlags& flags);
+
     std::unique_ptr<Impl> impl_;
+    unsigned parallelThreads_ = 1;
+    size_t parallelMinimumSize_ = kDefaultParallelMinimumSize;
+    ParseStats* stats_ = nullptr;
+    bool documentIndexEnabled_ = false;
+
+    struct BlockCache;
+    std::unique_ptr<BlockCache> blockCache_;
 };
 
 } // namespace Markdown
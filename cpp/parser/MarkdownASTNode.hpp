@@ -1,9 +1,11 @@
 #pragma once
 
+#include "NodeAttributes.hpp"
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <vector>
-#include <unordered_map>
 
 namespace Markdown {
 
@@ -36,14 +38,37 @@ enum class NodeType {
     LatexMathDisplay,
     Spoiler,
     Superscript,
-    Subscript
+    Subscript,
+    // Chat tokens, with Md4cFlags::mentions, hashtags and emojiShortcodes.
+    // Mentions and hashtags have a "mention:<name>" or "hashtag:<name>" Url, so
+    // they render as links; an emoji shortcode has its emoji as child text and
+    // its ":name:" as Title.
+    Mention,
+    Hashtag,
+    EmojiShortcode
+};
+
+// Byte range [begin, end) of a node in the parsed input. It includes the
+// node's own syntax (list and quote marks, heading marks, fences, emphasis
+// delimiters, link destinations) but not trailing line breaks.
+struct SourceRange {
+    uint32_t begin = 0;
+    uint32_t end = 0;
+
+    uint32_t length() const { return end - begin; }
 };
 
 struct MarkdownASTNode {
     NodeType type;
     std::string content;
-    std::unordered_map<std::string, std::string> attributes;
+    SourceRange sourceRange;
+    NodeAttributes attributes;
+    // Backing storage for the string-valued attributes (url, title, language).
+    std::string attributeText;
     std::vector<std::shared_ptr<MarkdownASTNode>> children;
+    // FlatNode::hash of the node this one was built from, or 0 if it was not
+    // built by the parser. Not updated when the node is modified.
+    uint64_t hash = 0;
 
     explicit MarkdownASTNode(NodeType t) : type(t) {}
 
@@ -53,8 +78,27 @@ struct MarkdownASTNode {
         }
     }
 
-    void setAttribute(const std::string& key, const std::string& value) {
-        attributes[key] = value;
+    // String-keyed compatibility accessors. Unknown keys are ignored on write
+    // and read back as empty strings.
+    void setAttribute(std::string_view key, std::string_view value) {
+        AttributeKey typedKey;
+        if (attributeKeyFromName(key, typedKey)) {
+            attributes.assign(typedKey, value, attributeText);
+        }
+    }
+
+    bool hasAttribute(std::string_view key) const {
+        AttributeKey typedKey;
+        return attributeKeyFromName(key, typedKey) && attributes.has(typedKey);
+    }
+
+    std::string getAttribute(std::string_view key) const {
+        AttributeKey typedKey;
+        if (!attributeKeyFromName(key, typedKey) || !attributes.has(typedKey)) {
+            return {};
+        }
+        char buffer[12];
+        return std::string(attributes.format(typedKey, attributeText, buffer));
     }
 };
 
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace Markdown {
+
+// Byte range inside the string storage that owns a node's text payloads. When
+// kSourceBit is set in `offset`, the range is a view into the parsed source
+// buffer instead (see FlatMarkdownAST::source).
+struct TextRange {
+  static constexpr uint32_t kSourceBit = 1u << 31;
+
+  uint32_t offset = 0;
+  uint32_t length = 0;
+
+  bool inSource() const {
+    return (offset & kSourceBit) != 0;
+  }
+
+  uint32_t position() const {
+    return offset & ~kSourceBit;
+  }
+};
+
+// The fixed set of attributes the parser can attach to a node. The order is
+// part of the bridge contract: the Kotlin NodeAttributes class decodes the
+// presence mask with the same bit positions.
+enum class AttributeKey : uint8_t {
+  Level,
+  Url,
+  Title,
+  FenceChar,
+  Language,
+  IsTask,
+  TaskChecked,
+  Align,
+  ColCount,
+  HeadRowCount,
+  BodyRowCount,
+  // Set by the post-parse pass (see PostParsePipeline.hpp), not by md4c.
+  TaskIndex,
+  IsInline,
+  Count
+};
+
+enum class CellAlign : uint8_t { Default, Left, Center, Right };
+
+inline const char *attributeKeyName(AttributeKey key) {
+  switch (key) {
+    case AttributeKey::Level:
+      return "level";
+    case AttributeKey::Url:
+      return "url";
+    case AttributeKey::Title:
+      return "title";
+    case AttributeKey::FenceChar:
+      return "fenceChar";
+    case AttributeKey::Language:
+      return "language";
+    case AttributeKey::IsTask:
+      return "isTask";
+    case AttributeKey::TaskChecked:
+      return "taskChecked";
+    case AttributeKey::Align:
+      return "align";
+    case AttributeKey::ColCount:
+      return "colCount";
+    case AttributeKey::HeadRowCount:
+      return "headRowCount";
+    case AttributeKey::BodyRowCount:
+      return "bodyRowCount";
+    case AttributeKey::TaskIndex:
+      return "taskIndex";
+    case AttributeKey::IsInline:
+      return "isInline";
+    default:
+      return "";
+  }
+}
+
+inline bool attributeKeyFromName(std::string_view name, AttributeKey &out) {
+  for (uint8_t i = 0; i < static_cast<uint8_t>(AttributeKey::Count); ++i) {
+    auto key = static_cast<AttributeKey>(i);
+    if (name == attributeKeyName(key)) {
+      out = key;
+      return true;
+    }
+  }
+  return false;
+}
+
+inline const char *cellAlignName(CellAlign align) {
+  switch (align) {
+    case CellAlign::Left:
+      return "left";
+    case CellAlign::Center:
+      return "center";
+    case CellAlign::Right:
+      return "right";
+    default:
+      return "default";
+  }
+}
+
+inline CellAlign cellAlignFromName(std::string_view name) {
+  if (name == "left")
+    return CellAlign::Left;
+  if (name == "center")
+    return CellAlign::Center;
+  if (name == "right")
+    return CellAlign::Right;
+  return CellAlign::Default;
+}
+
+// Typed attribute block. Small integers and enums are stored natively; string
+// values (URLs, titles, code languages) are ranges into the owning AST's string
+// storage, so a node with attributes costs no extra heap allocation.
+struct NodeAttributes {
+  uint16_t presentMask = 0;
+  uint8_t level = 0;
+  char fenceChar = 0;
+  bool isTask = false;
+  bool taskChecked = false;
+  CellAlign align = CellAlign::Default;
+  uint32_t colCount = 0;
+  uint32_t headRowCount = 0;
+  uint32_t bodyRowCount = 0;
+  // Position of a task list item among all task items of the document.
+  uint32_t taskIndex = 0;
+  // An image that shares its paragraph with other content.
+  bool isInline = false;
+  TextRange url;
+  TextRange title;
+  TextRange language;
+
+  bool has(AttributeKey key) const {
+    return (presentMask & (1u << static_cast<unsigned>(key))) != 0;
+  }
+
+  void markPresent(AttributeKey key) {
+    presentMask |= static_cast<uint16_t>(1u << static_cast<unsigned>(key));
+  }
+
+  bool empty() const {
+    return presentMask == 0;
+  }
+
+  // Calls fn(AttributeKey, const char *name, std::string_view value) for every
+  // present attribute in key order, formatting native values the way the
+  // string-keyed API always exposed them. `strings` is the storage that the
+  // TextRange values point into.
+  template <typename Fn> void forEach(std::string_view strings, Fn &&fn) const {
+    char buffer[12];
+    for (uint8_t i = 0; i < static_cast<uint8_t>(AttributeKey::Count); ++i) {
+      auto key = static_cast<AttributeKey>(i);
+      if (has(key)) {
+        fn(key, attributeKeyName(key), format(key, strings, buffer));
+      }
+    }
+  }
+
+  // Parses a legacy string value into typed storage. String values are
+  // appended to `strings`, which must be the storage later passed to format().
+  void assign(AttributeKey key, std::string_view value, std::string &strings) {
+    switch (key) {
+      case AttributeKey::Level:
+        level = static_cast<uint8_t>(parseNumber(value));
+        break;
+      case AttributeKey::Url:
+        url = appendString(value, strings);
+        break;
+      case AttributeKey::Title:
+        title = appendString(value, strings);
+        break;
+      case AttributeKey::FenceChar:
+        fenceChar = value.empty() ? 0 : value[0];
+        break;
+      case AttributeKey::Language:
+        language = appendString(value, strings);
+        break;
+      case AttributeKey::IsTask:
+        isTask = value == "true";
+        break;
+      case AttributeKey::TaskChecked:
+        taskChecked = value == "true";
+        break;
+      case AttributeKey::Align:
+        align = cellAlignFromName(value);
+        break;
+      case AttributeKey::ColCount:
+        colCount = parseNumber(value);
+        break;
+      case AttributeKey::HeadRowCount:
+        headRowCount = parseNumber(value);
+        break;
+      case AttributeKey::BodyRowCount:
+        bodyRowCount = parseNumber(value);
+        break;
+      case AttributeKey::TaskIndex:
+        taskIndex = parseNumber(value);
+        break;
+      case AttributeKey::IsInline:
+        isInline = value == "true";
+        break;
+      default:
+        return;
+    }
+    markPresent(key);
+  }
+
+  // Returns the legacy string value for `key`. Integer values are rendered
+  // into `buffer`, so the returned view is only valid as long as it is.
+  std::string_view format(AttributeKey key, std::string_view strings, char (&buffer)[12]) const {
+    switch (key) {
+      case AttributeKey::Level:
+        return formatNumber(level, buffer);
+      case AttributeKey::Url:
+        return strings.substr(url.offset, url.length);
+      case AttributeKey::Title:
+        return strings.substr(title.offset, title.length);
+      case AttributeKey::FenceChar:
+        buffer[0] = fenceChar;
+        return std::string_view(buffer, 1);
+      case AttributeKey::Language:
+        return strings.substr(language.offset, language.length);
+      case AttributeKey::IsTask:
+        return isTask ? "true" : "false";
+      case AttributeKey::TaskChecked:
+        return taskChecked ? "true" : "false";
+      case AttributeKey::Align:
+        return cellAlignName(align);
+      case AttributeKey::ColCount:
+        return formatNumber(colCount, buffer);
+      case AttributeKey::HeadRowCount:
+        return formatNumber(headRowCount, buffer);
+      case AttributeKey::BodyRowCount:
+        return formatNumber(bodyRowCount, buffer);
+      case AttributeKey::TaskIndex:
+        return formatNumber(taskIndex, buffer);
+      case AttributeKey::IsInline:
+        return isInline ? "true" : "false";
+      default:
+        return {};
+    }
+  }
+
+private:
+  static uint32_t parseNumber(std::string_view value) {
+    uint32_t result = 0;
+    for (char c : value) {
+      if (c < '0' || c > '9')
+        break;
+      result = result * 10 + static_cast<uint32_t>(c - '0');
+    }
+    return result;
+  }
+
+  static TextRange appendString(std::string_view value, std::string &strings) {
+    TextRange range{static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(value.size())};
+    strings.append(value.data(), value.size());
+    return range;
+  }
+
+  static std::string_view formatNumber(uint32_t value, char (&buffer)[12]) {
+    int length = std::snprintf(buffer, sizeof(buffer), "%u", value);
+    return std::string_view(buffer, length > 0 ? static_cast<size_t>(length) : 0);
+  }
+};
+
+} // namespace Markdown
@@ -0,0 +1,127 @@
+#include "ParseCache.hpp"
+#include "ContentHash.hpp"
+
+namespace Markdown {
+
+ParseCache::ParseCache(size_t byteBudget) : byteBudget_(byteBudget) {}
+
+ParseCache &ParseCache::shared() {
+  // Never destroyed, so bridges may still use it while the process exits.
+  static auto *cache = new ParseCache();
+  return *cache;
+}
+
+uint64_t ParseCache::keyOf(std::string_view markdown, const Md4cFlags &flags) {
+  uint64_t flagBits = (flags.underline ? 1u : 0u) | (flags.latexMath ? 2u : 0u) | (flags.superscript ? 4u : 0u) |
+                      (flags.subscript ? 8u : 0u) | (flags.permissiveAutolinks ? 16u : 0u) |
+                      (flags.mentions ? 32u : 0u) | (flags.hashtags ? 64u : 0u) | (flags.emojiShortcodes ? 128u : 0u);
+  flagBits ^= (static_cast<uint64_t>(flags.maxBlocks) << 8) ^ (static_cast<uint64_t>(flags.maxSourceBytes) << 32);
+  return contentHash(markdown, flagBits);
+}
+
+std::shared_ptr<const FlatMarkdownAST> ParseCache::find(std::string_view markdown, const Md4cFlags &flags) {
+  uint64_t key = keyOf(markdown, flags);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  // The hash only narrows the search; a hit needs the same bytes and flags.
+  if (it == index_.end() || it->second->flags != flags || *it->second->markdown != markdown) {
+    ++misses_;
+    return nullptr;
+  }
+  ++hits_;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->ast;
+}
+
+void ParseCache::insert(std::shared_ptr<const std::string> markdown, const Md4cFlags &flags,
+                        std::shared_ptr<const FlatMarkdownAST> ast) {
+  if (!markdown || !ast || ast->source != markdown) {
+    return;
+  }
+  uint64_t key = keyOf(*markdown, flags);
+  size_t byteSize = sizeof(Entry) + ast->memoryUsage() + markdown->capacity();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (byteSize > byteBudget_) {
+    return;
+  }
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    // Either the same document inserted twice or a hash collision; the newer
+    // one wins.
+    byteSize_ -= it->second->byteSize;
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  entries_.push_front(Entry{key, flags, std::move(markdown), std::move(ast), byteSize});
+  index_.emplace(key, entries_.begin());
+  byteSize_ += byteSize;
+  evictToBudget();
+}
+
+std::shared_ptr<const FlatMarkdownAST> ParseCache::parse(MD4CParser &parser,
+                                                         std::shared_ptr<const std::string> markdown,
+                                                         const Md4cFlags &flags) {
+  if (!markdown) {
+    return parser.parseFlat(std::move(markdown), flags);
+  }
+  if (auto cached = find(*markdown, flags)) {
+    if (ParseStats *stats = parser.stats()) {
+      stats->recordCacheHit(*cached);
+    }
+    return cached;
+  }
+  auto ast = parser.parseFlat(markdown, flags);
+  insert(std::move(markdown), flags, ast);
+  return ast;
+}
+
+std::shared_ptr<const FlatMarkdownAST> ParseCache::parse(MD4CParser &parser,
+                                                         std::shared_ptr<const std::string> markdown,
+                                                         const Md4cFlags &flags, const ParseControl &control,
+                                                         ParseStatus &status) {
+  if (markdown) {
+    if (auto cached = find(*markdown, flags)) {
+      if (ParseStats *stats = parser.stats()) {
+        stats->recordCacheHit(*cached);
+      }
+      status = ParseStatus::Completed;
+      return cached;
+    }
+  }
+  auto ast = parser.parseFlat(markdown, flags, control, status);
+  if (markdown && status == ParseStatus::Completed) {
+    insert(std::move(markdown), flags, ast);
+  }
+  return ast;
+}
+
+void ParseCache::setByteBudget(size_t byteBudget) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  byteBudget_ = byteBudget;
+  evictToBudget();
+}
+
+void ParseCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  byteSize_ = 0;
+}
+
+ParseCache::Stats ParseCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return {hits_, misses_, evictions_, entries_.size(), byteSize_};
+}
+
+void ParseCache::evictToBudget() {
+  while (byteSize_ > byteBudget_ && !entries_.empty()) {
+    const Entry &oldest = entries_.back();
+    byteSize_ -= oldest.byteSize;
+    index_.erase(oldest.key);
+    entries_.pop_back();
+    ++evictions_;
+  }
+}
+
+} // namespace Markdown
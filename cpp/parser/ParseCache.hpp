@@ -0,0 +1,93 @@
+#pragma once
+
+#include "FlatMarkdownAST.hpp"
+#include "MD4CParser.hpp"
+#include "ParseControl.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Markdown {
+
+// Thread-safe cache of parsed documents keyed by their bytes and Md4cFlags, so
+// the same markdown parsed by several views (measurement, the mounted view,
+// re-mounted list cells) runs through md4c once. Entries are immutable shared
+// ASTs and are evicted least recently used first once their estimated size
+// exceeds the byte budget.
+class ParseCache {
+public:
+  static constexpr size_t kDefaultByteBudget = 8 * 1024 * 1024;
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entryCount = 0;
+    size_t byteSize = 0;
+  };
+
+  explicit ParseCache(size_t byteBudget = kDefaultByteBudget);
+
+  // The cache the platform bridges share.
+  static ParseCache &shared();
+
+  // Returns the cached AST for `markdown` parsed with `flags`, or nullptr.
+  std::shared_ptr<const FlatMarkdownAST> find(std::string_view markdown, const Md4cFlags &flags);
+
+  // Adds the result of parsing `markdown` with `flags`, as returned by the
+  // zero-copy parseFlat. Failed parses (whose AST does not hold `markdown` as
+  // its source) and documents larger than the whole budget are not kept, so a
+  // cached AST always carries its source.
+  void insert(std::shared_ptr<const std::string> markdown, const Md4cFlags &flags,
+              std::shared_ptr<const FlatMarkdownAST> ast);
+
+  // Returns the cached AST or parses `markdown` with `parser` and caches the
+  // result. The parse runs outside the lock, so two threads that miss on the
+  // same document at once both parse it. A hit still fills the parser's
+  // ParseStats, if it collects them.
+  std::shared_ptr<const FlatMarkdownAST> parse(MD4CParser &parser, std::shared_ptr<const std::string> markdown,
+                                               const Md4cFlags &flags);
+
+  // Same with a parse that `control` can stop. Only completed parses are
+  // cached; a stopped one returns nullptr with the reason in `status`.
+  std::shared_ptr<const FlatMarkdownAST> parse(MD4CParser &parser, std::shared_ptr<const std::string> markdown,
+                                               const Md4cFlags &flags, const ParseControl &control,
+                                               ParseStatus &status);
+
+  // Evicts entries right away if the new budget is smaller. 0 disables caching.
+  void setByteBudget(size_t byteBudget);
+
+  void clear();
+
+  Stats stats() const;
+
+private:
+  struct Entry {
+    uint64_t key;
+    Md4cFlags flags;
+    std::shared_ptr<const std::string> markdown;
+    std::shared_ptr<const FlatMarkdownAST> ast;
+    size_t byteSize;
+  };
+  using EntryList = std::list<Entry>;
+
+  static uint64_t keyOf(std::string_view markdown, const Md4cFlags &flags);
+  void evictToBudget();
+
+  mutable std::mutex mutex_;
+  size_t byteBudget_;
+  size_t byteSize_ = 0;
+  // Most recently used first.
+  EntryList entries_;
+  std::unordered_map<uint64_t, EntryList::iterator> index_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t evictions_ = 0;
+};
+
+} // namespace Markdown
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Markdown {
+
+// How a controlled parse ended. Cancelled and DeadlineExceeded mean the caller
+// stopped it on purpose; Failed means md4c itself gave up (it only does so when
+// it runs out of memory).
+enum class ParseStatus : uint8_t {
+  Completed,
+  Cancelled,
+  DeadlineExceeded,
+  Failed,
+};
+
+// Lets a caller stop a parse whose result it no longer needs. The parser polls
+// it from the md4c callbacks, so a stop takes effect within a few hundred
+// callbacks rather than at the end of the document. cancel() may be called from
+// any thread at any time; the deadline has to be set before the parse starts.
+class ParseControl {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  ParseControl() = default;
+  explicit ParseControl(Clock::time_point deadline) : deadline_(deadline) {}
+
+  ParseControl(const ParseControl &) = delete;
+  ParseControl &operator=(const ParseControl &) = delete;
+
+  void cancel() {
+    cancelled_.store(true, std::memory_order_relaxed);
+  }
+
+  bool isCancelled() const {
+    return cancelled_.load(std::memory_order_relaxed);
+  }
+
+  void setDeadline(Clock::time_point deadline) {
+    deadline_ = deadline;
+  }
+
+  void setTimeout(Clock::duration timeout) {
+    deadline_ = Clock::now() + timeout;
+  }
+
+  bool hasDeadline() const {
+    return deadline_ != Clock::time_point::max();
+  }
+
+  bool deadlinePassed() const {
+    return hasDeadline() && Clock::now() >= deadline_;
+  }
+
+private:
+  std::atomic<bool> cancelled_{false};
+  Clock::time_point deadline_ = Clock::time_point::max();
+};
+
+} // namespace Markdown
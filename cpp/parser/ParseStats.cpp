@@ -0,0 +1,99 @@
+#include "ParseStats.hpp"
+#include <utility>
+#include <vector>
+
+namespace Markdown {
+
+namespace {
+
+// Heap bytes of a string, or 0 while it fits in the small-string buffer.
+size_t heapBytes(const std::string &string) {
+  const char *data = string.data();
+  const auto *inlineBuffer = reinterpret_cast<const char *>(&string);
+  bool onHeap = data < inlineBuffer || data >= inlineBuffer + sizeof(std::string);
+  return onHeap ? string.capacity() + 1 : 0;
+}
+
+} // anonymous namespace
+
+void ParseStats::measure(const FlatMarkdownAST &ast) {
+  nodeCounts.fill(0);
+  nodeCount = 0;
+  maxDepth = 0;
+
+  // Pre-order walk over the sibling links; detached nodes left in the arena
+  // by post-processing are not part of the document and are skipped.
+  NodeIndex index = FlatMarkdownAST::root();
+  uint32_t depth = 0;
+  while (index != kInvalidNodeIndex) {
+    const FlatNode &node = ast.nodes[index];
+    ++nodeCounts[static_cast<size_t>(node.type)];
+    ++nodeCount;
+    if (depth > maxDepth) {
+      maxDepth = depth;
+    }
+    if (node.firstChild != kInvalidNodeIndex) {
+      index = node.firstChild;
+      ++depth;
+      continue;
+    }
+    while (index != FlatMarkdownAST::root() && ast.nodes[index].nextSibling == kInvalidNodeIndex) {
+      index = ast.nodes[index].parent;
+      --depth;
+    }
+    index = index == FlatMarkdownAST::root() ? kInvalidNodeIndex : ast.nodes[index].nextSibling;
+  }
+
+  textBytes = ast.strings.size();
+  residentBytes = ast.memoryUsage();
+  residentBlocks = (ast.nodes.capacity() > 0) + (ast.attributeBlocks.capacity() > 0) + (heapBytes(ast.strings) > 0);
+}
+
+void ParseStats::measure(const MarkdownASTNode &tree) {
+  nodeCounts.fill(0);
+  nodeCount = 0;
+  maxDepth = 0;
+  textBytes = 0;
+  residentBytes = 0;
+  residentBlocks = 0;
+
+  // Iterative, since limits may be disabled and leave the tree arbitrarily deep.
+  std::vector<std::pair<const MarkdownASTNode *, uint32_t>> pending{{&tree, 0}};
+  while (!pending.empty()) {
+    auto [node, depth] = pending.back();
+    pending.pop_back();
+    ++nodeCounts[static_cast<size_t>(node->type)];
+    ++nodeCount;
+    if (depth > maxDepth) {
+      maxDepth = depth;
+    }
+    textBytes += node->content.size() + node->attributeText.size();
+
+    // make_shared puts the node and its control block in one allocation.
+    residentBytes += sizeof(MarkdownASTNode) + 2 * sizeof(long);
+    ++residentBlocks;
+    for (const std::string *string : {&node->content, &node->attributeText}) {
+      if (size_t bytes = heapBytes(*string)) {
+        residentBytes += bytes;
+        ++residentBlocks;
+      }
+    }
+    if (node->children.capacity() > 0) {
+      residentBytes += node->children.capacity() * sizeof(node->children[0]);
+      ++residentBlocks;
+    }
+
+    for (const auto &child : node->children) {
+      pending.emplace_back(child.get(), depth + 1);
+    }
+  }
+}
+
+void ParseStats::recordCacheHit(const FlatMarkdownAST &ast) {
+  *this = ParseStats{};
+  inputBytes = ast.source ? ast.source->size() : 0;
+  cacheHit = true;
+  measure(ast);
+}
+
+} // namespace Markdown
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "FlatMarkdownAST.hpp"
+#include "MarkdownASTNode.hpp"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace Markdown {
+
+constexpr size_t kNodeTypeCount = static_cast<size_t>(NodeType::EmojiShortcode) + 1;
+
+// What one parse cost and what it produced, for telling from telemetry where a
+// slow render spent its time. MD4CParser fills it for every call made while it
+// is set with setStats(); the platform bridges add the time they spend turning
+// the result into their own node objects.
+struct ParseStats {
+  using Duration = std::chrono::nanoseconds;
+
+  size_t inputBytes = 0;
+  // The AST came from ParseCache; nothing was parsed, so only the shape and
+  // the conversion time are filled in.
+  bool cacheHit = false;
+
+  // Shape of the resulting AST, counting every node reachable from the root.
+  std::array<uint32_t, kNodeTypeCount> nodeCounts{};
+  uint32_t nodeCount = 0;
+  // The Document root is at depth 0, its blocks at 1.
+  uint32_t maxDepth = 0;
+  // Text copied out of the input: the flat AST's string pool, or every text
+  // and attribute string of a MarkdownASTNode tree. Zero-copy views into the
+  // source are not counted.
+  size_t textBytes = 0;
+  // Heap memory the result holds, and how many blocks it is spread over.
+  // The shared source buffer is not included.
+  size_t residentBytes = 0;
+  uint64_t residentBlocks = 0;
+
+  // Working memory md4c had to take from the system allocator because the
+  // per-thread ParserMemoryPool could not serve it from its cache.
+  uint64_t allocations = 0;
+  uint64_t allocatedBytes = 0;
+
+  // md_parse, including the callbacks that append flat nodes. With parallel
+  // parsing this, like postProcessTime, is summed over the threads.
+  Duration md4cTime{0};
+  // Converting the flat AST into the caller's tree: toTree() for
+  // MD4CParser::parse, Java or Objective-C nodes in the bridges, JSON on the
+  // web.
+  Duration treeBuildTime{0};
+  // Work on the AST after md4c is done with it, such as moving display math
+  // out of paragraphs.
+  Duration postProcessTime{0};
+  // Wall time of the whole call, including block cache lookups and merging
+  // the pieces of a parallel parse.
+  Duration totalTime{0};
+
+  uint32_t count(NodeType type) const {
+    return nodeCounts[static_cast<size_t>(type)];
+  }
+
+  // Fills the shape fields, nodeCounts through residentBlocks, from a result.
+  void measure(const FlatMarkdownAST &ast);
+  void measure(const MarkdownASTNode &tree);
+
+  // Resets the stats to describe `ast` served from a cache, without a parse.
+  void recordCacheHit(const FlatMarkdownAST &ast);
+
+  // Adds the md4c and post-processing work of a parse that ran on another
+  // thread.
+  void addWork(const ParseStats &other) {
+    allocations += other.allocations;
+    allocatedBytes += other.allocatedBytes;
+    md4cTime += other.md4cTime;
+    postProcessTime += other.postProcessTime;
+  }
+};
+
+} // namespace Markdown
@@ -0,0 +1,110 @@
+#include "ParserMemoryPool.hpp"
+#include <cstdlib>
+#include <cstring>
+
+namespace Markdown {
+
+namespace {
+
+size_t roundUpToPowerOfTwo(size_t size) {
+  size_t capacity = 64;
+  while (capacity < size) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+} // anonymous namespace
+
+ParserMemoryPool::ParserMemoryPool() {
+  allocator_.reallocate = [](void *ptr, size_t size, void *userdata) {
+    return static_cast<ParserMemoryPool *>(userdata)->reallocate(ptr, size);
+  };
+  allocator_.release = [](void *ptr, void *userdata) { static_cast<ParserMemoryPool *>(userdata)->release(ptr); };
+  allocator_.userdata = this;
+  freeBlocks_.reserve(kMaxCachedBlocks);
+}
+
+ParserMemoryPool::~ParserMemoryPool() {
+  trim();
+}
+
+ParserMemoryPool &ParserMemoryPool::forCurrentThread() {
+  thread_local ParserMemoryPool pool;
+  return pool;
+}
+
+void ParserMemoryPool::trim() {
+  for (BlockHeader *block : freeBlocks_) {
+    std::free(block);
+  }
+  freeBlocks_.clear();
+  cachedBytes_ = 0;
+}
+
+ParserMemoryPool::Stats ParserMemoryPool::stats() const {
+  return {systemAllocations_, systemBytes_, reusedAllocations_, cachedBytes_};
+}
+
+ParserMemoryPool::BlockHeader *ParserMemoryPool::acquire(size_t size) {
+  // Best fit among the cached blocks.
+  size_t best = freeBlocks_.size();
+  for (size_t i = 0; i < freeBlocks_.size(); ++i) {
+    size_t capacity = freeBlocks_[i]->capacity;
+    if (capacity >= size && (best == freeBlocks_.size() || capacity < freeBlocks_[best]->capacity)) {
+      best = i;
+    }
+  }
+  if (best < freeBlocks_.size()) {
+    BlockHeader *block = freeBlocks_[best];
+    freeBlocks_[best] = freeBlocks_.back();
+    freeBlocks_.pop_back();
+    cachedBytes_ -= block->capacity;
+    ++reusedAllocations_;
+    return block;
+  }
+
+  size_t capacity = roundUpToPowerOfTwo(size);
+  auto *block = static_cast<BlockHeader *>(std::malloc(sizeof(BlockHeader) + capacity));
+  if (!block) {
+    return nullptr;
+  }
+  block->capacity = capacity;
+  ++systemAllocations_;
+  systemBytes_ += sizeof(BlockHeader) + capacity;
+  return block;
+}
+
+void *ParserMemoryPool::reallocate(void *ptr, size_t size) {
+  BlockHeader *old = ptr ? static_cast<BlockHeader *>(ptr) - 1 : nullptr;
+  if (old && old->capacity >= size) {
+    ++reusedAllocations_;
+    return ptr;
+  }
+
+  BlockHeader *block = acquire(size);
+  if (!block) {
+    // Like realloc(), leave the old block alone on failure.
+    return nullptr;
+  }
+  if (old) {
+    std::memcpy(block + 1, ptr, old->capacity);
+    release(ptr);
+  }
+  return block + 1;
+}
+
+void ParserMemoryPool::release(void *ptr) {
+  if (!ptr) {
+    return;
+  }
+  BlockHeader *block = static_cast<BlockHeader *>(ptr) - 1;
+  if (freeBlocks_.size() < kMaxCachedBlocks && cachedBytes_ + block->capacity <= kMaxCachedBytes) {
+    freeBlocks_.push_back(block);
+    cachedBytes_ += block->capacity;
+  } else {
+    std::free(block);
+  }
+}
+
+} // namespace Markdown
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../md4c/md4c.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Markdown {
+
+// Keeps the working buffers md4c allocates during md_parse (line and mark
+// arrays, block bytes, attribute and reference definition storage) for the
+// next parse on the same thread instead of returning them to the system
+// allocator. Blocks are rounded up to powers of two, so most of md4c's
+// growing reallocs stay in place once a pool has warmed up.
+class ParserMemoryPool {
+public:
+  struct Stats {
+    // Blocks obtained from the system allocator.
+    uint64_t systemAllocations = 0;
+    uint64_t systemBytes = 0;
+    // Requests served in place or from a cached block.
+    uint64_t reusedAllocations = 0;
+    size_t cachedBytes = 0;
+  };
+
+  // Blocks are only kept while the pool holds fewer than this many bytes and
+  // blocks, so one huge document does not pin its buffers for good.
+  static constexpr size_t kMaxCachedBytes = 4 * 1024 * 1024;
+  static constexpr size_t kMaxCachedBlocks = 64;
+
+  ParserMemoryPool();
+  ~ParserMemoryPool();
+  ParserMemoryPool(const ParserMemoryPool &) = delete;
+  ParserMemoryPool &operator=(const ParserMemoryPool &) = delete;
+
+  // The pool of the calling thread, created on first use.
+  static ParserMemoryPool &forCurrentThread();
+
+  // Callback table to put in MD_PARSER::allocator.
+  const MD_ALLOCATOR *allocator() const {
+    return &allocator_;
+  }
+
+  // Returns every cached block to the system allocator.
+  void trim();
+
+  Stats stats() const;
+
+private:
+  struct alignas(std::max_align_t) BlockHeader {
+    size_t capacity;
+  };
+
+  void *reallocate(void *ptr, size_t size);
+  void release(void *ptr);
+  BlockHeader *acquire(size_t size);
+
+  MD_ALLOCATOR allocator_;
+  std::vector<BlockHeader *> freeBlocks_;
+  size_t cachedBytes_ = 0;
+  uint64_t systemAllocations_ = 0;
+  uint64_t systemBytes_ = 0;
+  uint64_t reusedAllocations_ = 0;
+};
+
+} // namespace Markdown
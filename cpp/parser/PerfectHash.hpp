@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Markdown {
+
+// A perfect hash over the names of a fixed table, built at compile time:
+//
+//   constexpr auto kHash = PerfectHash<std::size(kTable), 12, 1024>::build(kTable);
+//   static_assert(kHash.complete(), "...");
+//
+// where each table entry has a `name` member. Looking a name up takes one hash
+// and leads to the only entry it can be, which the caller still compares,
+// since names outside the table land on some entry too.
+//
+// Hash and displace: names are grouped into buckets by their hash, and each
+// bucket gets the first displacement that moves all of its names to free
+// slots.
+template <size_t KeyCount, uint32_t TableBits, size_t BucketCount> class PerfectHash {
+public:
+  static constexpr size_t kTableSize = size_t{1} << TableBits;
+  static_assert(KeyCount <= kTableSize * 3 / 4 && KeyCount < UINT16_MAX, "resize the perfect hash table");
+  static_assert((BucketCount & (BucketCount - 1)) == 0, "the bucket count must be a power of two");
+
+  // FNV-1a.
+  static constexpr uint32_t hashName(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+      hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return hash;
+  }
+
+  template <typename Entry> static constexpr PerfectHash build(const Entry (&entries)[KeyCount]) {
+    PerfectHash table;
+    std::array<uint32_t, KeyCount> hashes{};
+    std::array<uint16_t, BucketCount + 1> bucketBegin{};
+    for (size_t i = 0; i < KeyCount; ++i) {
+      hashes[i] = hashName(entries[i].name);
+      ++bucketBegin[(hashes[i] & (BucketCount - 1)) + 1];
+    }
+    size_t largest = 0;
+    for (size_t bucket = 0; bucket < BucketCount; ++bucket) {
+      largest = bucketBegin[bucket + 1] > largest ? bucketBegin[bucket + 1] : largest;
+      bucketBegin[bucket + 1] += bucketBegin[bucket];
+    }
+    std::array<uint16_t, KeyCount> byBucket{};
+    std::array<uint16_t, BucketCount> bucketFill{};
+    for (size_t i = 0; i < KeyCount; ++i) {
+      size_t bucket = hashes[i] & (BucketCount - 1);
+      byBucket[bucketBegin[bucket] + bucketFill[bucket]++] = static_cast<uint16_t>(i);
+    }
+
+    // Largest buckets first, while most slots are still free.
+    for (size_t size = largest; size > 0; --size) {
+      for (size_t bucket = 0; bucket < BucketCount; ++bucket) {
+        size_t begin = bucketBegin[bucket];
+        size_t end = bucketBegin[bucket + 1];
+        if (end - begin != size) {
+          continue;
+        }
+        bool placed = false;
+        for (uint32_t displacement = 0; displacement <= UINT16_MAX && !placed; ++displacement) {
+          size_t i = begin;
+          for (; i < end; ++i) {
+            uint32_t slot = slotOf(hashes[byBucket[i]], displacement);
+            if (table.slots_[slot] != 0) {
+              break;
+            }
+            table.slots_[slot] = static_cast<uint16_t>(byBucket[i] + 1);
+          }
+          if (i == end) {
+            table.displacements_[bucket] = static_cast<uint16_t>(displacement);
+            placed = true;
+          } else {
+            while (i-- > begin) {
+              table.slots_[slotOf(hashes[byBucket[i]], displacement)] = 0;
+            }
+          }
+        }
+        if (!placed) {
+          return table;
+        }
+      }
+    }
+    table.complete_ = true;
+    return table;
+  }
+
+  constexpr bool complete() const {
+    return complete_;
+  }
+
+  // Index of the only entry `name` can be, or KeyCount if its slot is free.
+  constexpr size_t find(std::string_view name) const {
+    uint32_t hash = hashName(name);
+    uint16_t entry = slots_[slotOf(hash, displacements_[hash & (BucketCount - 1)])];
+    return entry == 0 ? KeyCount : entry - 1u;
+  }
+
+private:
+  static constexpr uint32_t slotOf(uint32_t hash, uint32_t displacement) {
+    return ((hash ^ (displacement * 0x9E3779B9u)) * 0x85EBCA6Bu) >> (32 - TableBits);
+  }
+
+  std::array<uint16_t, BucketCount> displacements_{};
+  // Index into the table plus one; 0 marks a free slot.
+  std::array<uint16_t, kTableSize> slots_{};
+  bool complete_ = false;
+};
+
+} // namespace Markdown
@@ -0,0 +1,219 @@
+#include "PostParsePipeline.hpp"
+#include "DocumentIndex.hpp"
+#include <string>
+
+namespace Markdown {
+
+namespace {
+
+bool isDisplayMathNode(const FlatNode &node) {
+  return node.type == NodeType::LatexMathDisplay;
+}
+
+bool isSeparatorNode(const FlatMarkdownAST &ast, const FlatNode &node) {
+  return node.type == NodeType::LineBreak ||
+         (node.type == NodeType::Text && ast.text(node.content).find_first_not_of(" \t\n\r") == std::string::npos);
+}
+
+// Returns the node's attribute block, creating it on first use.
+NodeAttributes &attributesFor(FlatMarkdownAST &ast, NodeIndex index) {
+  FlatNode &node = ast.nodes[index];
+  if (node.attributeIndex == kNoAttributes) {
+    node.attributeIndex = static_cast<uint32_t>(ast.attributeBlocks.size());
+    ast.attributeBlocks.emplace_back();
+  }
+  return ast.attributeBlocks[node.attributeIndex];
+}
+
+// md4c treats $$...$$ as an inline span, so when display math appears on a line
+// directly after text (no blank line), md4c merges them into a single Paragraph
+// with LineBreak nodes between them. This promotes the trailing run of
+// LatexMathDisplay nodes (possibly interspersed with LineBreak / whitespace
+// separators) of a top-level paragraph out of it, so that the rendering layer
+// sees them as top-level block elements.
+//
+// Two cases:
+//  (a) Pure: every child is display math or a separator → replace paragraph entirely.
+//  (b) Mixed: leading text followed by display math → keep text in the paragraph,
+//      splice the display math nodes as siblings after it.
+//
+// Children are linked lists in the flat AST, so each splice is O(1) regardless
+// of how many top-level blocks the document has.
+class DisplayMathPromotion : public PostParseTransform {
+public:
+  void enter(FlatMarkdownAST &ast, NodeIndex paragraph, NodeIndex previous) override {
+    const FlatNode &node = ast.nodes[paragraph];
+    if (node.type != NodeType::Paragraph || node.parent != FlatMarkdownAST::root() ||
+        node.lastChild == kInvalidNodeIndex || !isDisplayMathNode(ast.nodes[node.lastChild])) {
+      return;
+    }
+
+    children_.clear();
+    for (NodeIndex child = node.firstChild; child != kInvalidNodeIndex; child = ast.nodes[child].nextSibling) {
+      children_.push_back(child);
+    }
+
+    size_t trailingRunStart = children_.size();
+    for (size_t j = children_.size(); j > 0; --j) {
+      const FlatNode &child = ast.nodes[children_[j - 1]];
+      if (!isDisplayMathNode(child) && !isSeparatorNode(ast, child)) {
+        break;
+      }
+      trailingRunStart = j - 1;
+    }
+
+    size_t keptCount = trailingRunStart;
+    while (keptCount > 0 && isSeparatorNode(ast, ast.nodes[children_[keptCount - 1]])) {
+      --keptCount;
+    }
+    ast.truncateChildrenAfter(paragraph, keptCount > 0 ? children_[keptCount - 1] : kInvalidNodeIndex);
+    if (keptCount > 0) {
+      ast.nodes[paragraph].sourceRange.end = ast.nodes[children_[keptCount - 1]].sourceRange.end;
+    }
+
+    // Move only the LatexMathDisplay nodes of the run, skipping separators.
+    NodeIndex insertionPoint = paragraph;
+    for (size_t j = trailingRunStart; j < children_.size(); ++j) {
+      if (isDisplayMathNode(ast.nodes[children_[j]])) {
+        ast.insertAfter(insertionPoint, children_[j]);
+        insertionPoint = children_[j];
+      }
+    }
+
+    if (trailingRunStart == 0) {
+      ast.unlink(paragraph, previous);
+    }
+  }
+
+private:
+  std::vector<NodeIndex> children_;
+};
+
+// Numbers task list items in document order, so a tap on one can be mapped
+// back to the markdown without counting them again while rendering.
+class TaskIndexing : public PostParseTransform {
+public:
+  void enter(FlatMarkdownAST &ast, NodeIndex item, NodeIndex previous) override {
+    (void)previous;
+    const FlatNode &node = ast.nodes[item];
+    if (node.type != NodeType::ListItem || node.attributeIndex == kNoAttributes) {
+      return;
+    }
+    NodeAttributes &attrs = ast.attributeBlocks[node.attributeIndex];
+    if (attrs.isTask) {
+      attrs.taskIndex = ast.taskCount++;
+      attrs.markPresent(AttributeKey::TaskIndex);
+    }
+  }
+};
+
+// An image alone in its paragraph is shown as a block; one next to text,
+// links or line breaks is inline. Runs after display math promotion, which
+// may take children out of the paragraph.
+class InlineImageMarking : public PostParseTransform {
+public:
+  void enter(FlatMarkdownAST &ast, NodeIndex paragraph, NodeIndex previous) override {
+    (void)previous;
+    const FlatNode &node = ast.nodes[paragraph];
+    if (node.type != NodeType::Paragraph) {
+      return;
+    }
+    bool hasImage = false;
+    bool hasOther = false;
+    for (NodeIndex child = node.firstChild; child != kInvalidNodeIndex; child = ast.nodes[child].nextSibling) {
+      (ast.nodes[child].type == NodeType::Image ? hasImage : hasOther) = true;
+    }
+    if (!hasImage || !hasOther) {
+      return;
+    }
+    for (NodeIndex child = node.firstChild; child != kInvalidNodeIndex; child = ast.nodes[child].nextSibling) {
+      if (ast.nodes[child].type == NodeType::Image) {
+        NodeAttributes &attrs = attributesFor(ast, child);
+        attrs.isInline = true;
+        attrs.markPresent(AttributeKey::IsInline);
+      }
+    }
+  }
+};
+
+// Feeds the AST's DocumentIndexBuilder, if it has one, with the tree as the
+// transforms above left it. A paragraph that display math promotion unlinked
+// is not part of it any more.
+class DocumentIndexing : public PostParseTransform {
+public:
+  void enter(FlatMarkdownAST &ast, NodeIndex node, NodeIndex previous) override {
+    (void)previous;
+    if (ast.indexBuilder && ast.nodes[node].parent != kInvalidNodeIndex) {
+      ast.indexBuilder->enter(ast, node);
+    }
+  }
+
+  void leave(FlatMarkdownAST &ast, NodeIndex node) override {
+    if (ast.indexBuilder) {
+      ast.indexBuilder->leave(ast, node);
+    }
+  }
+};
+
+// A node is left after its children, and after the transforms above changed
+// it on the way in.
+class SubtreeHashing : public PostParseTransform {
+public:
+  void leave(FlatMarkdownAST &ast, NodeIndex node) override {
+    ast.updateHash(node);
+  }
+};
+
+} // anonymous namespace
+
+PostParsePipeline PostParsePipeline::standard() {
+  PostParsePipeline pipeline;
+  pipeline.add(std::make_unique<DisplayMathPromotion>());
+  pipeline.add(std::make_unique<TaskIndexing>());
+  pipeline.add(std::make_unique<InlineImageMarking>());
+  pipeline.add(std::make_unique<DocumentIndexing>());
+  pipeline.add(std::make_unique<SubtreeHashing>());
+  return pipeline;
+}
+
+void PostParsePipeline::run(FlatMarkdownAST &ast, NodeIndex first, NodeIndex previous) const {
+  // Pre-order over the sibling links, iterative since limits may be disabled
+  // and leave the tree arbitrarily deep.
+  NodeIndex node = first;
+  while (node != kInvalidNodeIndex) {
+    bool topLevel = ast.nodes[node].parent == FlatMarkdownAST::root();
+    for (const auto &transform : transforms_) {
+      transform->enter(ast, node, topLevel ? previous : kInvalidNodeIndex);
+    }
+    if (topLevel && ast.nodes[node].parent == kInvalidNodeIndex) {
+      // Unlinked; go on with whatever was put in its place.
+      node = previous == kInvalidNodeIndex ? ast.nodes[FlatMarkdownAST::root()].firstChild
+                                           : ast.nodes[previous].nextSibling;
+      continue;
+    }
+    if (ast.nodes[node].firstChild != kInvalidNodeIndex) {
+      node = ast.nodes[node].firstChild;
+      continue;
+    }
+
+    // Leave nodes until one has a sibling to move on to.
+    while (true) {
+      for (const auto &transform : transforms_) {
+        transform->leave(ast, node);
+      }
+      const FlatNode &left = ast.nodes[node];
+      if (left.parent == FlatMarkdownAST::root()) {
+        previous = node;
+        node = left.nextSibling;
+        break;
+      }
+      if (left.nextSibling != kInvalidNodeIndex) {
+        node = left.nextSibling;
+        break;
+      }
+      node = left.parent;
+    }
+  }
+}
+
+} // namespace Markdown
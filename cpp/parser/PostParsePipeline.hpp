@@ -0,0 +1,62 @@
+#pragma once
+
+#include "FlatMarkdownAST.hpp"
+#include <memory>
+#include <vector>
+
+namespace Markdown {
+
+// One step of the work done on the AST after md4c is done with it. Every
+// registered transform sees every node of the new blocks during a single
+// depth-first walk, so adding a fact about the tree costs no extra traversal.
+class PostParseTransform {
+public:
+  virtual ~PostParseTransform() = default;
+
+  // Called before the children of `node` are visited. For a top-level block,
+  // transforms may relink its children, insert blocks after it (which are
+  // visited next) and unlink it; `previous` is the block before it, or
+  // kInvalidNodeIndex for the first block and for every node below the top
+  // level.
+  virtual void enter(FlatMarkdownAST &ast, NodeIndex node, NodeIndex previous) {
+    (void)ast;
+    (void)node;
+    (void)previous;
+  }
+
+  // Called once all children of `node` have been left.
+  virtual void leave(FlatMarkdownAST &ast, NodeIndex node) {
+    (void)ast;
+    (void)node;
+  }
+};
+
+// Runs registered transforms, in registration order, over top-level blocks in
+// one walk. Not thread-safe; each parsing thread has its own pipeline.
+class PostParsePipeline {
+public:
+  // The transforms every parse runs, in this order:
+  //  - moves display math that md4c left at the end of a paragraph out to the
+  //    top level;
+  //  - numbers task list items in document order (AttributeKey::TaskIndex),
+  //    continuing from FlatMarkdownAST::taskCount;
+  //  - marks images that share a paragraph with other content
+  //    (AttributeKey::IsInline);
+  //  - collects the DocumentIndex into FlatMarkdownAST::indexBuilder, for
+  //    ASTs that have one;
+  //  - computes FlatNode::hash, so it covers what the others changed.
+  static PostParsePipeline standard();
+
+  void add(std::unique_ptr<PostParseTransform> transform) {
+    transforms_.push_back(std::move(transform));
+  }
+
+  // Walks the top-level blocks from `first` to the last one. `previous` is the
+  // block right before `first`, or kInvalidNodeIndex.
+  void run(FlatMarkdownAST &ast, NodeIndex first, NodeIndex previous) const;
+
+private:
+  std::vector<std::unique_ptr<PostParseTransform>> transforms_;
+};
+
+} // namespace Markdown
@@ -0,0 +1,167 @@
+#include "StreamingParseSession.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace Markdown {
+
+StreamingParseSession::StreamingParseSession(const Md4cFlags &flags)
+    : flags_(flags), buffer_(std::make_shared<std::string>()) {
+  ast_.source = buffer_;
+}
+
+const FlatMarkdownAST &StreamingParseSession::append(std::string_view chunk) {
+  reusedBlockCount_ = stableBlockCount();
+  buffer_->append(chunk.data(), chunk.size());
+  return reparseTail();
+}
+
+const FlatMarkdownAST &StreamingParseSession::update(std::string_view markdown, const Md4cFlags &flags) {
+  if (flags != flags_) {
+    reset();
+    flags_ = flags;
+  }
+
+  std::string_view previous = *buffer_;
+  size_t common = std::min(previous.size(), markdown.size());
+  // Pure appends are the common case; memcmp confirms them much faster than
+  // the byte-wise search for the first difference.
+  if (std::memcmp(markdown.data(), previous.data(), common) != 0) {
+    common = static_cast<size_t>(std::mismatch(markdown.begin(), markdown.begin() + common, previous.begin()).first -
+                                 markdown.begin());
+  }
+  if (common < previous.size()) {
+    truncate(static_cast<uint32_t>(common));
+  }
+
+  reusedBlockCount_ = stableBlockCount();
+  buffer_->append(markdown.data() + common, markdown.size() - common);
+  return reparseTail();
+}
+
+void StreamingParseSession::reset() {
+  buffer_->clear();
+  // Roll back rather than reassign so the arena keeps its capacity for the
+  // next message.
+  ast_.rollback(FlatMarkdownAST::Checkpoint{});
+  ast_.nodes[FlatMarkdownAST::root()].sourceRange = {};
+  stableRegions_.clear();
+  reusedBlockCount_ = 0;
+  hasReferenceDefinitions_ = false;
+  tailCodeBegin_ = UINT32_MAX;
+  scanOffset_ = 0;
+  scanner_.reset();
+}
+
+const CodeLineIndex &StreamingParseSession::codeLines(NodeIndex codeBlock, CodeLineIndex::Unit unit) {
+  const FlatNode &node = ast_.nodes[codeBlock];
+  std::string_view code = node.firstChild == kInvalidNodeIndex ? std::string_view() : ast_.content(node.firstChild);
+  // With the text it was parsed from unchanged, a code block that starts at
+  // the same place has the same lines, bar the last one, which the text may
+  // have ended in the middle of.
+  bool continued = node.sourceRange.begin == tailCodeBegin_;
+  CodeLineIndex lines = continued ? CodeLineIndex(code, unit, std::move(tailCodeLines_)) : CodeLineIndex(code, unit);
+  if (continued) {
+    tailCodeBegin_ = UINT32_MAX;
+  }
+  if (node.sourceRange.end != buffer_->size()) {
+    codeLines_ = std::move(lines);
+    return codeLines_;
+  }
+  tailCodeLines_ = std::move(lines);
+  tailCodeBegin_ = node.sourceRange.begin;
+  tailCodeEnd_ = node.sourceRange.end;
+  return tailCodeLines_;
+}
+
+const FlatMarkdownAST &StreamingParseSession::reparseTail() {
+  uint32_t boundary = 0;
+  uint32_t decidedBy = 0;
+  scanCompleteLines(boundary, decidedBy);
+
+  auto size = static_cast<uint32_t>(buffer_->size());
+  if (!hasReferenceDefinitions_ && !scanner_.inFence() && scanOffset_ < size &&
+      BlockScanner::mayDefineReference(std::string_view(*buffer_).substr(scanOffset_), false)) {
+    hasReferenceDefinitions_ = true;
+  }
+  if (hasReferenceDefinitions_) {
+    dropStableRegions(0);
+    reusedBlockCount_ = 0;
+    boundary = 0;
+  }
+
+  ast_.rollback(stableRegions_.empty() ? FlatMarkdownAST::Checkpoint{} : stableRegions_.back().checkpoint);
+
+  // Blocks that became stable since the last update are parsed once more,
+  // on their own, and kept from now on.
+  uint32_t stableEnd = stableLength();
+  if (boundary > stableEnd) {
+    if (parser_.parseRange(ast_, stableEnd, boundary, flags_)) {
+      stableRegions_.push_back({boundary, decidedBy, ast_.checkpoint()});
+    } else {
+      ast_.rollback(stableRegions_.empty() ? FlatMarkdownAST::Checkpoint{} : stableRegions_.back().checkpoint);
+    }
+  }
+
+  FlatMarkdownAST::Checkpoint stable = ast_.checkpoint();
+  if (!parser_.parseRange(ast_, stableLength(), size, flags_)) {
+    ast_.rollback(stable);
+  }
+  ast_.nodes[FlatMarkdownAST::root()].sourceRange = {0, size};
+  return ast_;
+}
+
+void StreamingParseSession::scanCompleteLines(uint32_t &boundary, uint32_t &decidedBy) {
+  std::string_view text = *buffer_;
+
+  while (scanOffset_ < text.size()) {
+    size_t lineEnd = 0;
+    size_t nextLine = 0;
+    if (!findLineEnd(text, scanOffset_, false, lineEnd, nextLine)) {
+      break;
+    }
+    uint32_t lineStart = scanOffset_;
+    std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+    scanOffset_ = static_cast<uint32_t>(nextLine);
+
+    BlockScanner::Line scanned = scanner_.scanLine(line);
+    if (scanned.boundary) {
+      boundary = lineStart;
+      decidedBy = scanOffset_;
+    }
+    hasReferenceDefinitions_ |= scanned.mayDefineReference;
+  }
+}
+
+void StreamingParseSession::truncate(uint32_t length) {
+  buffer_->resize(length);
+  if (tailCodeEnd_ > length) {
+    tailCodeBegin_ = UINT32_MAX;
+  }
+
+  size_t keep = stableRegions_.size();
+  while (keep > 0 && stableRegions_[keep - 1].decidedBy > length) {
+    --keep;
+  }
+  dropStableRegions(keep);
+
+  // A line that ended at a "\r" now at the end of the text may turn out to
+  // end at a "\r\n", so it is scanned again too.
+  if (scanOffset_ > length || (scanOffset_ == length && length > 0 && (*buffer_)[length - 1] == '\r')) {
+    // The end of a kept region is the start of a block right after a blank
+    // line, outside any fence, so scanning can resume from there.
+    scanOffset_ = stableLength();
+    if (scanOffset_ > 0) {
+      scanner_.resumeAtBoundary();
+    } else {
+      scanner_.reset();
+    }
+  }
+}
+
+void StreamingParseSession::dropStableRegions(size_t keep) {
+  if (keep < stableRegions_.size()) {
+    stableRegions_.erase(stableRegions_.begin() + static_cast<std::ptrdiff_t>(keep), stableRegions_.end());
+  }
+}
+
+} // namespace Markdown
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "BlockScanner.hpp"
+#include "CodeLineIndex.hpp"
+#include "FlatMarkdownAST.hpp"
+#include "MD4CParser.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Markdown {
+
+// Incremental parser for text that grows at the end, such as an LLM response
+// arriving token by token. Top-level blocks that can no longer change (those
+// ended by a BlockScanner boundary) are parsed once and kept; each update only
+// runs md4c over the open tail. Kept blocks retain their node indices and contents
+// from one result to the next, so callers can skip reconciling them.
+//
+// Reference definitions let a block change the meaning of links anywhere in
+// the document, so once one shows up the session stops keeping blocks and
+// re-parses the whole text on every update.
+//
+// Not thread-safe; the returned AST is only valid until the next call.
+class StreamingParseSession {
+public:
+  explicit StreamingParseSession(const Md4cFlags &flags = Md4cFlags{});
+
+  // Appends `chunk` to the text and returns the updated AST.
+  const FlatMarkdownAST &append(std::string_view chunk);
+
+  // Replaces the text with `markdown`. Kept blocks that lie entirely within
+  // the prefix shared with the previous text are reused; this makes the
+  // session tolerant of a streaming filter rewriting the last few characters.
+  // Changing the flags starts over.
+  const FlatMarkdownAST &update(std::string_view markdown, const Md4cFlags &flags);
+
+  // Drops all text and state.
+  void reset();
+
+  const FlatMarkdownAST &ast() const {
+    return ast_;
+  }
+
+  std::string_view text() const {
+    return *buffer_;
+  }
+
+  const Md4cFlags &flags() const {
+    return flags_;
+  }
+
+  // Number of leading top-level nodes that will not change any more.
+  size_t stableBlockCount() const {
+    return stableRegions_.empty() ? 0 : stableRegions_.back().checkpoint.topLevelCount;
+  }
+
+  // Number of leading top-level nodes carried over unchanged from the
+  // previous result.
+  size_t reusedBlockCount() const {
+    return reusedBlockCount_;
+  }
+
+  // Byte offset where the re-parsed tail begins.
+  uint32_t stableLength() const {
+    return stableRegions_.empty() ? 0 : stableRegions_.back().end;
+  }
+
+  // The line index of `codeBlock`, a CodeBlock node of ast(). The index of the
+  // code block the text ends in is kept, so while that block streams in each
+  // call only scans the lines added since the last one. Valid until the next
+  // call.
+  const CodeLineIndex &codeLines(NodeIndex codeBlock, CodeLineIndex::Unit unit);
+
+private:
+  // A run of kept blocks ending at `end`. The boundary was decided by the line
+  // that starts there, so the region is only reusable while the text up to
+  // `decidedBy` is unchanged.
+  struct StableRegion {
+    uint32_t end;
+    uint32_t decidedBy;
+    FlatMarkdownAST::Checkpoint checkpoint;
+  };
+
+  const FlatMarkdownAST &reparseTail();
+  void scanCompleteLines(uint32_t &boundary, uint32_t &decidedBy);
+  void truncate(uint32_t length);
+  void dropStableRegions(size_t keep);
+
+  MD4CParser parser_;
+  Md4cFlags flags_;
+  std::shared_ptr<std::string> buffer_;
+  FlatMarkdownAST ast_;
+  std::vector<StableRegion> stableRegions_;
+  size_t reusedBlockCount_ = 0;
+  bool hasReferenceDefinitions_ = false;
+
+  // Index of the code block that started at `tailCodeBegin_` and reached the
+  // end of the text, as of the codeLines call that built it. Dropped once the
+  // text up to `tailCodeEnd_` changes.
+  CodeLineIndex tailCodeLines_{std::string_view()};
+  uint32_t tailCodeBegin_ = UINT32_MAX;
+  uint32_t tailCodeEnd_ = 0;
+  // What codeLines returned for any other block.
+  CodeLineIndex codeLines_{std::string_view()};
+
+  // Line scanner state. Only terminated lines (see findLineEnd) are scanned;
+  // the partial last line is looked at again once it is complete.
+  uint32_t scanOffset_ = 0;
+  BlockScanner scanner_;
+};
+
+} // namespace Markdown
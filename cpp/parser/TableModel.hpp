@@ -0,0 +1,41 @@
+#pragma once
+
+#include "FlatMarkdownAST.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace Markdown {
+
+// A table of the flat AST laid out by column, so a renderer can reach any
+// cell by (row, column) and size columns without walking the
+// Table > TableHead/TableBody > TableRow > cell tree. Built by
+// DocumentIndex::build along with the rest of the index.
+//
+// Each cell is the TableHeaderCell or TableCell node itself: its sourceRange
+// is the cell's markdown and its children are the inline content.
+struct TableModel {
+  NodeIndex table = kInvalidNodeIndex;
+  uint32_t columnCount = 0;
+  // Rows [0, headRowCount) are the head rows.
+  uint32_t headRowCount = 0;
+  // Alignment of each column, from its head cell.
+  std::vector<CellAlign> alignments;
+  // TableRow nodes, head rows first.
+  std::vector<NodeIndex> rows;
+  // Row-major, rows.size() * columnCount. kInvalidNodeIndex where a row has
+  // fewer cells than the table has columns.
+  std::vector<NodeIndex> cells;
+  // Longest plain text in each column, in characters (code points) of the
+  // cells' text without formatting.
+  std::vector<uint32_t> columnMaxLength;
+
+  uint32_t rowCount() const {
+    return static_cast<uint32_t>(rows.size());
+  }
+
+  NodeIndex cell(uint32_t row, uint32_t column) const {
+    return cells[static_cast<size_t>(row) * columnCount + column];
+  }
+};
+
+} // namespace Markdown
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace Markdown {
+
+// Converts UTF-8 byte offsets into a parsed source into UTF-16 code unit
+// offsets, the unit NSString, java.lang.String and JavaScript strings are
+// indexed by. Handles Java's modified UTF-8 as well, since surrogates encoded
+// as two 3-byte sequences count as one unit each. A checkpoint is kept every
+// kStride bytes, so a lookup scans at most that many bytes; pure ASCII sources
+// map to themselves without a table.
+class Utf16OffsetMap {
+public:
+  explicit Utf16OffsetMap(std::string_view source) : source_(source) {
+    uint32_t units = 0;
+    for (unsigned char c : source) {
+      units += unitsForByte(c);
+    }
+    total_ = units;
+    if (total_ == source.size()) {
+      return;
+    }
+
+    checkpoints_.reserve(source.size() / kStride + 1);
+    units = 0;
+    for (size_t i = 0; i < source.size(); ++i) {
+      if (i % kStride == 0) {
+        checkpoints_.push_back(units);
+      }
+      units += unitsForByte(static_cast<unsigned char>(source[i]));
+    }
+  }
+
+  uint32_t toUtf16(uint32_t byteOffset) const {
+    if (byteOffset >= source_.size()) {
+      return total_;
+    }
+    if (checkpoints_.empty()) {
+      return byteOffset;
+    }
+    size_t chunk = byteOffset / kStride;
+    uint32_t units = checkpoints_[chunk];
+    for (size_t i = chunk * kStride; i < byteOffset; ++i) {
+      units += unitsForByte(static_cast<unsigned char>(source_[i]));
+    }
+    return units;
+  }
+
+private:
+  static constexpr size_t kStride = 64;
+
+  // Continuation bytes add nothing; a 4-byte sequence becomes a surrogate pair.
+  static uint32_t unitsForByte(unsigned char c) {
+    if ((c & 0xC0) == 0x80) {
+      return 0;
+    }
+    return c >= 0xF0 ? 2 : 1;
+  }
+
+  std::string_view source_;
+  std::vector<uint32_t> checkpoints_;
+  uint32_t total_ = 0;
+};
+
+} // namespace Markdown
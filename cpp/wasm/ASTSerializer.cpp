@@ -1,5 +1,6 @@
 #include "ASTSerializer.hpp"
 #include <cassert>
+#include <chrono>
 #include <cstdio>
 
 namespace Markdown {
@@ -64,13 +65,19 @@ static const char *nodeTypeToString(NodeType type) {
       return "Superscript";
     case NodeType::Subscript:
       return "Subscript";
+    case NodeType::Mention:
+      return "Mention";
+    case NodeType::Hashtag:
+      return "Hashtag";
+    case NodeType::EmojiShortcode:
+      return "EmojiShortcode";
     default:
       assert(false && "unhandled NodeType in nodeTypeToString");
       return "";
   }
 }
 
-void ASTSerializer::appendEscaped(const std::string &str, std::string &out) {
+void ASTSerializer::appendEscaped(std::string_view str, std::string &out) {
   out += '"';
   for (unsigned char c : str) {
     switch (c) {
@@ -109,28 +116,42 @@ void ASTSerializer::appendEscaped(const std::string &str, std::string &out) {
   out += '"';
 }
 
-void ASTSerializer::serializeNode(const MarkdownASTNode &node, std::string &out) {
+void ASTSerializer::appendAttributes(const NodeAttributes &attributes, std::string_view strings, std::string &out) {
+  out += ",\"attributes\":{";
+  bool first = true;
+  attributes.forEach(strings, [&](AttributeKey, const char *name, std::string_view value) {
+    if (!first)
+      out += ',';
+    first = false;
+    appendEscaped(name, out);
+    out += ':';
+    appendEscaped(value, out);
+  });
+  out += '}';
+}
+
+void ASTSerializer::appendSourceRange(uint32_t begin, uint32_t end, std::string &out) {
+  char buf[32];
+  int length = std::snprintf(buf, sizeof(buf), ",\"sourceRange\":[%u,%u]", begin, end);
+  out.append(buf, length > 0 ? static_cast<size_t>(length) : 0);
+}
+
+void ASTSerializer::serializeNode(const MarkdownASTNode &node, const SerializeOptions &options, std::string &out) {
   out += "{\"type\":\"";
   out += nodeTypeToString(node.type);
   out += '"';
 
+  if (options.includeSourceRanges) {
+    appendSourceRange(node.sourceRange.begin, node.sourceRange.end, out);
+  }
+
   if (!node.content.empty()) {
     out += ",\"content\":";
     appendEscaped(node.content, out);
   }
 
   if (!node.attributes.empty()) {
-    out += ",\"attributes\":{";
-    bool first = true;
-    for (const auto &kv : node.attributes) {
-      if (!first)
-        out += ',';
-      first = false;
-      appendEscaped(kv.first, out);
-      out += ':';
-      appendEscaped(kv.second, out);
-    }
-    out += '}';
+    appendAttributes(node.attributes, node.attributeText, out);
   }
 
   if (!node.children.empty()) {
@@ -138,7 +159,7 @@ void ASTSerializer::serializeNode(const MarkdownASTNode &node, std::string &out)
     for (size_t i = 0; i < node.children.size(); ++i) {
       if (i > 0)
         out += ',';
-      serializeNode(*node.children[i], out);
+      serializeNode(*node.children[i], options, out);
     }
     out += ']';
   }
@@ -146,10 +167,159 @@ void ASTSerializer::serializeNode(const MarkdownASTNode &node, std::string &out)
   out += '}';
 }
 
-std::string ASTSerializer::serialize(const MarkdownASTNode &node) {
+void ASTSerializer::serializeNode(const FlatMarkdownAST &ast, NodeIndex index, const SerializeOptions &options,
+                                  const Utf16OffsetMap *offsets, std::string &out) {
+  const FlatNode &node = ast.nodes[index];
+  out += "{\"type\":\"";
+  out += nodeTypeToString(node.type);
+  out += '"';
+
+  if (options.includeSourceRanges) {
+    SourceRange range = node.sourceRange;
+    if (offsets) {
+      range = {offsets->toUtf16(range.begin), offsets->toUtf16(range.end)};
+    }
+    appendSourceRange(range.begin, range.end, out);
+  }
+
+  if (node.content.length > 0) {
+    out += ",\"content\":";
+    appendEscaped(ast.text(node.content), out);
+  }
+
+  if (const NodeAttributes *attrs = ast.attributesOf(index)) {
+    appendAttributes(*attrs, ast.strings, out);
+  }
+
+  if (node.firstChild != kInvalidNodeIndex) {
+    out += ",\"children\":[";
+    for (NodeIndex child = node.firstChild; child != kInvalidNodeIndex; child = ast.nodes[child].nextSibling) {
+      if (child != node.firstChild)
+        out += ',';
+      serializeNode(ast, child, options, offsets, out);
+    }
+    out += ']';
+  }
+
+  out += '}';
+}
+
+std::string ASTSerializer::serialize(const MarkdownASTNode &node, const SerializeOptions &options) {
   std::string out;
   out.reserve(1024);
-  serializeNode(node, out);
+  serializeNode(node, options, out);
+  return out;
+}
+
+std::string ASTSerializer::serialize(const FlatMarkdownAST &ast, const SerializeOptions &options) {
+  std::string out;
+  // JSON adds type tags and punctuation around every node; twice the payload
+  // size is a good first guess that avoids most regrowth.
+  out.reserve(1024 + (ast.strings.size() + (ast.source ? ast.source->size() : 0)) * 2);
+  if (options.includeSourceRanges && options.utf16SourceRanges && ast.source) {
+    Utf16OffsetMap offsets(*ast.source);
+    serializeNode(ast, FlatMarkdownAST::root(), options, &offsets, out);
+  } else {
+    serializeNode(ast, FlatMarkdownAST::root(), options, nullptr, out);
+  }
+  return out;
+}
+
+std::string ASTSerializer::serialize(const ParseStats &stats) {
+  std::string out;
+  out.reserve(512);
+  char buf[64];
+  auto appendField = [&](const char *name, const char *format, auto value) {
+    out += out.empty() ? '{' : ',';
+    int length = std::snprintf(buf, sizeof(buf), format, value);
+    out += '"';
+    out += name;
+    out += "\":";
+    out.append(buf, length > 0 ? static_cast<size_t>(length) : 0);
+  };
+  auto milliseconds = [](ParseStats::Duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  };
+
+  appendField("inputBytes", "%zu", stats.inputBytes);
+  appendField("cacheHit", "%s", stats.cacheHit ? "true" : "false");
+  appendField("nodeCount", "%u", stats.nodeCount);
+  appendField("maxDepth", "%u", stats.maxDepth);
+  appendField("textBytes", "%zu", stats.textBytes);
+  appendField("residentBytes", "%zu", stats.residentBytes);
+  appendField("residentBlocks", "%llu", static_cast<unsigned long long>(stats.residentBlocks));
+  appendField("allocations", "%llu", static_cast<unsigned long long>(stats.allocations));
+  appendField("allocatedBytes", "%llu", static_cast<unsigned long long>(stats.allocatedBytes));
+  appendField("md4cTime", "%.3f", milliseconds(stats.md4cTime));
+  appendField("treeBuildTime", "%.3f", milliseconds(stats.treeBuildTime));
+  appendField("postProcessTime", "%.3f", milliseconds(stats.postProcessTime));
+  appendField("totalTime", "%.3f", milliseconds(stats.totalTime));
+
+  // Only the node types that occur.
+  out += ",\"nodeCounts\":{";
+  bool first = true;
+  for (size_t i = 0; i < kNodeTypeCount; ++i) {
+    auto type = static_cast<NodeType>(i);
+    if (stats.count(type) == 0)
+      continue;
+    if (!first)
+      out += ',';
+    first = false;
+    int length = std::snprintf(buf, sizeof(buf), "\"%s\":%u", nodeTypeToString(type), stats.count(type));
+    out.append(buf, length > 0 ? static_cast<size_t>(length) : 0);
+  }
+  out += "}}";
+  return out;
+}
+
+std::string ASTSerializer::serialize(const FlatMarkdownAST &ast, const DocumentIndex &index) {
+  std::string out;
+  out.reserve(256);
+  std::string_view source = ast.source ? std::string_view(*ast.source) : std::string_view();
+  Utf16OffsetMap offsets(source);
+  auto appendRange = [&](NodeIndex node) {
+    const SourceRange &range = ast.nodes[node].sourceRange;
+    appendSourceRange(offsets.toUtf16(range.begin), offsets.toUtf16(range.end), out);
+  };
+  auto appendUrls = [&](const char *name, const std::vector<DocumentIndex::Target> &targets) {
+    out += ",\"";
+    out += name;
+    out += "\":[";
+    for (size_t i = 0; i < targets.size(); ++i) {
+      if (i > 0)
+        out += ',';
+      appendEscaped(targets[i].url, out);
+    }
+    out += ']';
+  };
+
+  out += "{\"headings\":[";
+  for (size_t i = 0; i < index.headings.size(); ++i) {
+    const DocumentIndex::Heading &heading = index.headings[i];
+    out += i > 0 ? ",{\"level\":" : "{\"level\":";
+    out += std::to_string(heading.level);
+    out += ",\"text\":";
+    appendEscaped(heading.text, out);
+    out += ",\"slug\":";
+    appendEscaped(heading.slug, out);
+    appendRange(heading.node);
+    out += '}';
+  }
+  out += ']';
+  appendUrls("links", index.links);
+  appendUrls("images", index.images);
+  out += ",\"tasks\":[";
+  for (size_t i = 0; i < index.tasks.size(); ++i) {
+    out += i > 0 ? ",{\"checked\":" : "{\"checked\":";
+    out += index.tasks[i].checked ? "true" : "false";
+    appendRange(index.tasks[i].node);
+    out += '}';
+  }
+  out += "],\"wordCount\":";
+  out += std::to_string(index.wordCount);
+  out += ",\"characterCount\":";
+  out += std::to_string(index.characterCount);
+  out += '}';
   return out;
 }
 
@@ -1,17 +1,41 @@
 #pragma once
 
+#include "../parser/DocumentIndex.hpp"
+#include "../parser/FlatMarkdownAST.hpp"
 #include "../parser/MarkdownASTNode.hpp"
+#include "../parser/ParseStats.hpp"
+#include "../parser/Utf16OffsetMap.hpp"
 #include <string>
 
 namespace Markdown {
 
+struct SerializeOptions {
+  // Adds "sourceRange":[begin,end] to every node.
+  bool includeSourceRanges = false;
+  // Reports source ranges in UTF-16 code units (JavaScript string indices)
+  // instead of UTF-8 bytes. Only honoured for a FlatMarkdownAST that holds its
+  // source.
+  bool utf16SourceRanges = false;
+};
+
 class ASTSerializer {
 public:
-  static std::string serialize(const MarkdownASTNode &node);
+  static std::string serialize(const MarkdownASTNode &node, const SerializeOptions &options = {});
+  static std::string serialize(const FlatMarkdownAST &ast, const SerializeOptions &options = {});
+  // One JSON object with a field per ParseStats member, times in milliseconds
+  // and nodeCounts keyed by node type name.
+  static std::string serialize(const ParseStats &stats);
+  // The DocumentIndex of `ast`, with node indices replaced by the nodes'
+  // "sourceRange" in UTF-16 code units and links and images as URL lists.
+  static std::string serialize(const FlatMarkdownAST &ast, const DocumentIndex &index);
 
 private:
-  static void serializeNode(const MarkdownASTNode &node, std::string &out);
-  static void appendEscaped(const std::string &str, std::string &out);
+  static void serializeNode(const MarkdownASTNode &node, const SerializeOptions &options, std::string &out);
+  static void serializeNode(const FlatMarkdownAST &ast, NodeIndex index, const SerializeOptions &options,
+                            const Utf16OffsetMap *offsets, std::string &out);
+  static void appendSourceRange(uint32_t begin, uint32_t end, std::string &out);
+  static void appendAttributes(const NodeAttributes &attributes, std::string_view strings, std::string &out);
+  static void appendEscaped(std::string_view str, std::string &out);
 };
 
 } // namespace Markdown
@@ -34,6 +34,14 @@ emcc \
   "$SCRIPT_DIR/md4c_wasm.cpp" \
   "$SCRIPT_DIR/ASTSerializer.cpp" \
   "$REPO_ROOT/cpp/parser/MD4CParser.cpp" \
+  "$REPO_ROOT/cpp/parser/FlatMarkdownAST.cpp" \
+  "$REPO_ROOT/cpp/parser/BlockScanner.cpp" \
+  "$REPO_ROOT/cpp/parser/DocumentIndex.cpp" \
+  "$REPO_ROOT/cpp/parser/EmojiShortcodes.cpp" \
+  "$REPO_ROOT/cpp/parser/HtmlEntities.cpp" \
+  "$REPO_ROOT/cpp/parser/ParserMemoryPool.cpp" \
+  "$REPO_ROOT/cpp/parser/ParseStats.cpp" \
+  "$REPO_ROOT/cpp/parser/PostParsePipeline.cpp" \
   "$OUT_DIR/md4c.o" \
   -I "$REPO_ROOT/cpp" \
   -I "$SCRIPT_DIR" \
@@ -42,7 +50,7 @@ emcc \
   -Wswitch \
   -s WASM=1 \
   -s SINGLE_FILE=1 \
-  -s EXPORTED_FUNCTIONS='["_parseMarkdown"]' \
+  -s EXPORTED_FUNCTIONS='["_parseMarkdown","_lastParseStats","_lastDocumentIndex"]' \
   -s EXPORTED_RUNTIME_METHODS='["ccall","cwrap","UTF8ToString"]' \
   -s ENVIRONMENT='web' \
   -s MODULARIZE=1 \
@@ -1,11 +1,17 @@
 #include "../parser/MD4CParser.hpp"
 #include "ASTSerializer.hpp"
+#include <algorithm>
+#include <chrono>
 #include <string>
 
 // Static buffer for the JSON result.
 // Safe for single-threaded WASM execution — the caller must consume (copy)
 // the returned string before calling parseMarkdown again.
 static std::string g_resultBuffer;
+// Stats of the last parseMarkdown call that asked for them, as JSON.
+static std::string g_statsBuffer = "null";
+// DocumentIndex of the last parseMarkdown call that asked for it, as JSON.
+static std::string g_indexBuffer = "null";
 
 extern "C" {
 
@@ -17,10 +23,29 @@ extern "C" {
  * @param latexMath  1 → enable $…$ / $$…$$ LaTeX math spans; 0 → disable.
  * @param superscript 1 → enable ^superscript^ spans; 0 → disable.
  * @param subscript  1 → enable ~subscript~ spans; 0 → disable.
+ * @param sourceRanges 1 → add "sourceRange":[begin,end] to every node, in
+ *                   UTF-16 code units (JavaScript string indices); 0 → omit.
+ * @param collectStats 1 → record ParseStats for lastParseStats(); 0 → skip.
+ * @param maxBlocks  Stop after this many top-level blocks; 0 → no limit.
+ * @param maxSourceBytes Stop at the first block boundary past this many
+ *                   UTF-8 bytes; 0 → no limit.
+ * @param collectIndex 1 → keep the DocumentIndex for lastDocumentIndex(); 0 → skip.
+ * @param mentions   1 → enable @mention spans; 0 → disable.
+ * @param hashtags   1 → enable #hashtag spans; 0 → disable.
+ * @param emojiShortcodes 1 → enable :shortcode: emoji spans; 0 → disable.
  * @return           Null-terminated UTF-8 JSON string, valid until the next call.
  */
-const char *parseMarkdown(const char *markdown, int underline, int latexMath, int superscript, int subscript) {
+const char *parseMarkdown(const char *markdown, int underline, int latexMath, int superscript, int subscript,
+                          int sourceRanges, int collectStats, int maxBlocks, int maxSourceBytes, int collectIndex,
+                          int mentions, int hashtags, int emojiShortcodes) {
+  auto start = std::chrono::steady_clock::now();
   if (!markdown) {
+    if (collectStats) {
+      g_statsBuffer = "null";
+    }
+    if (collectIndex) {
+      g_indexBuffer = "null";
+    }
     g_resultBuffer = "{\"type\":\"Document\"}";
     return g_resultBuffer.c_str();
   }
@@ -30,11 +55,53 @@ const char *parseMarkdown(const char *markdown, int underline, int latexMath, in
   flags.latexMath = (latexMath != 0);
   flags.superscript = (superscript != 0);
   flags.subscript = (subscript != 0);
+  flags.mentions = (mentions != 0);
+  flags.hashtags = (hashtags != 0);
+  flags.emojiShortcodes = (emojiShortcodes != 0);
+  flags.maxBlocks = static_cast<uint32_t>(std::max(maxBlocks, 0));
+  flags.maxSourceBytes = static_cast<uint32_t>(std::max(maxSourceBytes, 0));
 
+  Markdown::ParseStats stats;
   Markdown::MD4CParser parser;
-  auto root = parser.parse(std::string(markdown), flags);
-  g_resultBuffer = Markdown::ASTSerializer::serialize(*root);
+  if (collectStats) {
+    parser.setStats(&stats);
+  }
+  parser.setDocumentIndexEnabled(collectIndex != 0);
+  auto ast = parser.parseFlat(std::make_shared<const std::string>(markdown), flags);
+
+  // Serializing to JSON is what building the tree amounts to on the web.
+  auto serializeStart = std::chrono::steady_clock::now();
+  Markdown::SerializeOptions options;
+  options.includeSourceRanges = (sourceRanges != 0);
+  options.utf16SourceRanges = true;
+  g_resultBuffer = Markdown::ASTSerializer::serialize(*ast, options);
+  if (collectStats) {
+    auto end = std::chrono::steady_clock::now();
+    stats.treeBuildTime = end - serializeStart;
+    stats.totalTime = end - start;
+    g_statsBuffer = Markdown::ASTSerializer::serialize(stats);
+  }
+  if (collectIndex) {
+    g_indexBuffer = Markdown::ASTSerializer::serialize(*ast, *ast->index());
+  }
   return g_resultBuffer.c_str();
 }
 
+/**
+ * @return The ParseStats of the last parseMarkdown call made with
+ *         collectStats, as a JSON object (times in milliseconds), or "null".
+ */
+const char *lastParseStats() {
+  return g_statsBuffer.c_str();
+}
+
+/**
+ * @return The DocumentIndex of the last parseMarkdown call made with
+ *         collectIndex, as a JSON object (source ranges in UTF-16 code
+ *         units), or "null".
+ */
+const char *lastDocumentIndex() {
+  return g_indexBuffer.c_str();
+}
+
 } // extern "C"
@@ -357,7 +357,7 @@ static char kENRMSegmentFadeAnimatorKey;
   __block NSString *renderableMarkdown = nil;
 
   [_renderCoordinator
-      scheduleRender:^BOOL {
+      scheduleRender:^BOOL(ENRMParseCancellationToken *token) {
         renderableMarkdown = streamingAnimation ? ENRMRenderableMarkdownForStreaming(markdownString, tableStreamingMode)
                                                 : markdownString;
 
@@ -366,8 +366,10 @@ static char kENRMSegmentFadeAnimatorKey;
           return YES;
         }
 
-        MarkdownASTNode *ast = [parser parseMarkdown:renderableMarkdown flags:md4cFlags];
-        if (!ast)
+        MarkdownASTNode *ast =
+            streamingAnimation ? [parser parseStreamingMarkdown:renderableMarkdown flags:md4cFlags]
+                               : [parser parseMarkdown:renderableMarkdown flags:md4cFlags cancellationToken:token];
+        if (!ast || token.isCancelled)
           return NO;
 
         renderedSegments =
@@ -673,11 +675,36 @@ static char kENRMSegmentFadeAnimatorKey;
     md4cFlagsChanged = YES;
     _dirtyFlags |= ENRMDirtyForceHeight;
   }
+  if (newViewProps.md4cFlags.mentions != oldViewProps.md4cFlags.mentions) {
+    _md4cFlags.mentions = newViewProps.md4cFlags.mentions;
+    md4cFlagsChanged = YES;
+    _dirtyFlags |= ENRMDirtyForceHeight;
+  }
+  if (newViewProps.md4cFlags.hashtags != oldViewProps.md4cFlags.hashtags) {
+    _md4cFlags.hashtags = newViewProps.md4cFlags.hashtags;
+    md4cFlagsChanged = YES;
+    _dirtyFlags |= ENRMDirtyForceHeight;
+  }
+  if (newViewProps.md4cFlags.emojiShortcodes != oldViewProps.md4cFlags.emojiShortcodes) {
+    _md4cFlags.emojiShortcodes = newViewProps.md4cFlags.emojiShortcodes;
+    md4cFlagsChanged = YES;
+    _dirtyFlags |= ENRMDirtyForceHeight;
+  }
   if (newViewProps.md4cFlags.latexMath != oldViewProps.md4cFlags.latexMath) {
     _md4cFlags.latexMath = newViewProps.md4cFlags.latexMath;
     md4cFlagsChanged = YES;
     _dirtyFlags |= ENRMDirtyForceHeight;
   }
+  if (newViewProps.md4cFlags.maxBlocks != oldViewProps.md4cFlags.maxBlocks) {
+    _md4cFlags.maxBlocks = static_cast<NSUInteger>(MAX(newViewProps.md4cFlags.maxBlocks, 0));
+    md4cFlagsChanged = YES;
+    _dirtyFlags |= ENRMDirtyForceHeight;
+  }
+  if (newViewProps.md4cFlags.maxSourceBytes != oldViewProps.md4cFlags.maxSourceBytes) {
+    _md4cFlags.maxSourceBytes = static_cast<NSUInteger>(MAX(newViewProps.md4cFlags.maxSourceBytes, 0));
+    md4cFlagsChanged = YES;
+    _dirtyFlags |= ENRMDirtyForceHeight;
+  }
   BOOL allowTrailingMarginChanged = newViewProps.allowTrailingMargin != oldViewProps.allowTrailingMargin;
 
   _enableLinkPreview = newViewProps.enableLinkPreview;
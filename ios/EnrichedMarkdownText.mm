@@ -247,15 +247,18 @@ using namespace facebook::react;
   BOOL allowFontScaling = _fontScaleObserver.allowFontScaling;
   CGFloat maxFontSizeMultiplier = _maxFontSizeMultiplier;
   BOOL allowTrailingMargin = _allowTrailingMargin;
+  BOOL streamingAnimation = _streamingAnimation;
 
   NSWritingDirection writingDirection = currentWritingDirection();
 
   __block ENRMRenderResult *result = nil;
 
   [_renderCoordinator
-      scheduleRender:^BOOL {
-        MarkdownASTNode *ast = [parser parseMarkdown:markdownString flags:md4cFlags];
-        if (!ast)
+      scheduleRender:^BOOL(ENRMParseCancellationToken *token) {
+        MarkdownASTNode *ast = streamingAnimation
+                                   ? [parser parseStreamingMarkdown:markdownString flags:md4cFlags]
+                                   : [parser parseMarkdown:markdownString flags:md4cFlags cancellationToken:token];
+        if (!ast || token.isCancelled)
           return NO;
 
         result = ENRMRenderASTNodes(ast.children, config, allowTrailingMargin, allowFontScaling, maxFontSizeMultiplier,
@@ -460,11 +463,36 @@ using namespace facebook::react;
     md4cFlagsChanged = YES;
     _forceHeightUpdateOnNextRender = YES;
   }
+  if (newViewProps.md4cFlags.mentions != oldViewProps.md4cFlags.mentions) {
+    _md4cFlags.mentions = newViewProps.md4cFlags.mentions;
+    md4cFlagsChanged = YES;
+    _forceHeightUpdateOnNextRender = YES;
+  }
+  if (newViewProps.md4cFlags.hashtags != oldViewProps.md4cFlags.hashtags) {
+    _md4cFlags.hashtags = newViewProps.md4cFlags.hashtags;
+    md4cFlagsChanged = YES;
+    _forceHeightUpdateOnNextRender = YES;
+  }
+  if (newViewProps.md4cFlags.emojiShortcodes != oldViewProps.md4cFlags.emojiShortcodes) {
+    _md4cFlags.emojiShortcodes = newViewProps.md4cFlags.emojiShortcodes;
+    md4cFlagsChanged = YES;
+    _forceHeightUpdateOnNextRender = YES;
+  }
   if (newViewProps.md4cFlags.latexMath != oldViewProps.md4cFlags.latexMath) {
     _md4cFlags.latexMath = newViewProps.md4cFlags.latexMath;
     md4cFlagsChanged = YES;
     _forceHeightUpdateOnNextRender = YES;
   }
+  if (newViewProps.md4cFlags.maxBlocks != oldViewProps.md4cFlags.maxBlocks) {
+    _md4cFlags.maxBlocks = static_cast<NSUInteger>(MAX(newViewProps.md4cFlags.maxBlocks, 0));
+    md4cFlagsChanged = YES;
+    _forceHeightUpdateOnNextRender = YES;
+  }
+  if (newViewProps.md4cFlags.maxSourceBytes != oldViewProps.md4cFlags.maxSourceBytes) {
+    _md4cFlags.maxSourceBytes = static_cast<NSUInteger>(MAX(newViewProps.md4cFlags.maxSourceBytes, 0));
+    md4cFlagsChanged = YES;
+    _forceHeightUpdateOnNextRender = YES;
+  }
   BOOL markdownChanged = oldViewProps.markdown != newViewProps.markdown;
   BOOL allowTrailingMarginChanged = newViewProps.allowTrailingMargin != oldViewProps.allowTrailingMargin;
 
@@ -230,6 +230,10 @@ static bool runMd4cParse(NSString *markdown, ParseContext &context)
       .text = onText,
       .debug_log = nullptr,
       .syntax = nullptr,
+      .source_offset = nullptr,
+      .allocator = nullptr,
+      .max_inline_marks = 0,
+      .emoji_shortcode = nullptr,
   };
 
   return md_parse(completedUTF8, (MD_SIZE)completedLength, &parser, &context) == 0;
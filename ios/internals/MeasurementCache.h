@@ -38,7 +38,12 @@ struct MeasurementCacheKey {
   bool md4cFlagsUnderline;
   bool md4cFlagsSuperscript;
   bool md4cFlagsSubscript;
+  bool md4cFlagsMentions;
+  bool md4cFlagsHashtags;
+  bool md4cFlagsEmojiShortcodes;
   bool md4cFlagsLatexMath;
+  int md4cFlagsMaxBlocks;
+  int md4cFlagsMaxSourceBytes;
   size_t styleFingerprint;
   CGFloat fontScale;
   MarkdownFlavor flavor;
@@ -46,12 +51,16 @@ struct MeasurementCacheKey {
   bool operator==(const MeasurementCacheKey &other) const
   {
     return std::tie(markdown, maxWidth, allowTrailingMargin, allowFontScaling, maxFontSizeMultiplier,
-                    md4cFlagsUnderline, md4cFlagsSuperscript, md4cFlagsSubscript, md4cFlagsLatexMath, styleFingerprint,
-                    fontScale, flavor) == std::tie(other.markdown, other.maxWidth, other.allowTrailingMargin,
-                                                   other.allowFontScaling, other.maxFontSizeMultiplier,
-                                                   other.md4cFlagsUnderline, other.md4cFlagsSuperscript,
-                                                   other.md4cFlagsSubscript, other.md4cFlagsLatexMath,
-                                                   other.styleFingerprint, other.fontScale, other.flavor);
+                    md4cFlagsUnderline, md4cFlagsSuperscript, md4cFlagsSubscript, md4cFlagsMentions,
+                    md4cFlagsHashtags, md4cFlagsEmojiShortcodes, md4cFlagsLatexMath, md4cFlagsMaxBlocks,
+                    md4cFlagsMaxSourceBytes, styleFingerprint, fontScale,
+                    flavor) == std::tie(other.markdown, other.maxWidth, other.allowTrailingMargin,
+                                        other.allowFontScaling, other.maxFontSizeMultiplier, other.md4cFlagsUnderline,
+                                        other.md4cFlagsSuperscript, other.md4cFlagsSubscript,
+                                        other.md4cFlagsMentions, other.md4cFlagsHashtags,
+                                        other.md4cFlagsEmojiShortcodes, other.md4cFlagsLatexMath,
+                                        other.md4cFlagsMaxBlocks, other.md4cFlagsMaxSourceBytes,
+                                        other.styleFingerprint, other.fontScale, other.flavor);
   }
 };
 
@@ -67,7 +76,12 @@ struct MeasurementCacheKeyHash {
     HashUtils::hash_one(h, key.md4cFlagsUnderline);
     HashUtils::hash_one(h, key.md4cFlagsSuperscript);
     HashUtils::hash_one(h, key.md4cFlagsSubscript);
+    HashUtils::hash_one(h, key.md4cFlagsMentions);
+    HashUtils::hash_one(h, key.md4cFlagsHashtags);
+    HashUtils::hash_one(h, key.md4cFlagsEmojiShortcodes);
     HashUtils::hash_one(h, key.md4cFlagsLatexMath);
+    HashUtils::hash_one(h, key.md4cFlagsMaxBlocks);
+    HashUtils::hash_one(h, key.md4cFlagsMaxSourceBytes);
     HashUtils::hash_one(h, key.styleFingerprint);
     HashUtils::hash_one(h, key.fontScale);
     HashUtils::hash_one(h, static_cast<uint8_t>(key.flavor));
@@ -146,7 +160,12 @@ inline MeasurementCacheKey buildMeasurementCacheKey(const PropsType &props, CGFl
       .md4cFlagsUnderline = props.md4cFlags.underline,
       .md4cFlagsSuperscript = props.md4cFlags.superscript,
       .md4cFlagsSubscript = props.md4cFlags.subscript,
+      .md4cFlagsMentions = props.md4cFlags.mentions,
+      .md4cFlagsHashtags = props.md4cFlags.hashtags,
+      .md4cFlagsEmojiShortcodes = props.md4cFlags.emojiShortcodes,
       .md4cFlagsLatexMath = props.md4cFlags.latexMath,
+      .md4cFlagsMaxBlocks = props.md4cFlags.maxBlocks,
+      .md4cFlagsMaxSourceBytes = props.md4cFlags.maxSourceBytes,
       .styleFingerprint = computeStyleFingerprint(props.markdownStyle),
       .fontScale = fontScale,
       .flavor = flavor,
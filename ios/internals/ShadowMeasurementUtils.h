@@ -54,7 +54,12 @@ static inline bool ENRMPropsNeedExactStreamingMeasurement(const PropsT &oldProps
          oldProps.md4cFlags.underline != newProps.md4cFlags.underline ||
          oldProps.md4cFlags.superscript != newProps.md4cFlags.superscript ||
          oldProps.md4cFlags.subscript != newProps.md4cFlags.subscript ||
+         oldProps.md4cFlags.mentions != newProps.md4cFlags.mentions ||
+         oldProps.md4cFlags.hashtags != newProps.md4cFlags.hashtags ||
+         oldProps.md4cFlags.emojiShortcodes != newProps.md4cFlags.emojiShortcodes ||
          oldProps.md4cFlags.latexMath != newProps.md4cFlags.latexMath ||
+         oldProps.md4cFlags.maxBlocks != newProps.md4cFlags.maxBlocks ||
+         oldProps.md4cFlags.maxSourceBytes != newProps.md4cFlags.maxSourceBytes ||
          computeStyleFingerprint(oldProps.markdownStyle) != computeStyleFingerprint(newProps.markdownStyle);
 }
 
@@ -0,0 +1,51 @@
+#pragma once
+#import <Foundation/Foundation.h>
+
+@interface ENRMDocumentHeading : NSObject
+
+@property (nonatomic, readonly) NSUInteger level;
+/// The heading's text without formatting.
+@property (nonatomic, readonly, copy) NSString *text;
+/// GitHub-style anchor for the heading, unique within the document ("intro", "intro-1", ...).
+@property (nonatomic, readonly, copy) NSString *slug;
+/// In UTF-16 code units of the parsed markdown, like MarkdownASTNode.sourceRange.
+@property (nonatomic, readonly) NSRange sourceRange;
+
+@end
+
+@interface ENRMDocumentTask : NSObject
+
+@property (nonatomic, readonly) BOOL checked;
+@property (nonatomic, readonly) NSRange sourceRange;
+
+@end
+
+/// Outline, link and image URLs, task items and counts of a parsed document, collected by the native parser in one
+/// walk and shared by every parse of the same markdown.
+@interface ENRMDocumentIndex : NSObject
+
+@property (nonatomic, readonly, copy) NSArray<ENRMDocumentHeading *> *headings;
+@property (nonatomic, readonly, copy) NSArray<NSString *> *linkURLs;
+@property (nonatomic, readonly, copy) NSArray<NSString *> *imageURLs;
+/// In document order, so tasks[i] is the item with task index i.
+@property (nonatomic, readonly, copy) NSArray<ENRMDocumentTask *> *tasks;
+/// Words are runs of non-whitespace in the document's text, also across formatting.
+@property (nonatomic, readonly) NSUInteger wordCount;
+/// In code points.
+@property (nonatomic, readonly) NSUInteger characterCount;
+
+@end
+
+#ifdef __cplusplus
+namespace Markdown {
+struct FlatMarkdownAST;
+class Utf16OffsetMap;
+}
+
+@interface ENRMDocumentIndex ()
+
+/// `offsets` maps into the source of `ast`.
+- (instancetype)initWithAST:(const Markdown::FlatMarkdownAST &)ast offsets:(const Markdown::Utf16OffsetMap &)offsets;
+
+@end
+#endif
@@ -0,0 +1,112 @@
+#import "ENRMDocumentIndex.h"
+#include "DocumentIndex.hpp"
+#include "Utf16OffsetMap.hpp"
+
+static NSString *stringFromUTF8(const std::string &text)
+{
+  return [[NSString alloc] initWithBytes:text.data() length:text.size() encoding:NSUTF8StringEncoding] ?: @"";
+}
+
+static NSRange sourceRangeOf(const Markdown::FlatMarkdownAST &ast, Markdown::NodeIndex node,
+                             const Markdown::Utf16OffsetMap &offsets)
+{
+  const Markdown::SourceRange &range = ast.nodes[node].sourceRange;
+  NSUInteger begin = offsets.toUtf16(range.begin);
+  return NSMakeRange(begin, offsets.toUtf16(range.end) - begin);
+}
+
+static NSArray<NSString *> *urlsOf(const std::vector<Markdown::DocumentIndex::Target> &targets)
+{
+  NSMutableArray<NSString *> *urls = [NSMutableArray arrayWithCapacity:targets.size()];
+  for (const Markdown::DocumentIndex::Target &target : targets) {
+    [urls addObject:stringFromUTF8(target.url)];
+  }
+  return urls;
+}
+
+@interface ENRMDocumentHeading ()
+
+- (instancetype)initWithLevel:(NSUInteger)level text:(NSString *)text slug:(NSString *)slug range:(NSRange)range;
+
+@end
+
+@implementation ENRMDocumentHeading
+
+- (instancetype)initWithLevel:(NSUInteger)level text:(NSString *)text slug:(NSString *)slug range:(NSRange)range
+{
+  if (self = [super init]) {
+    _level = level;
+    _text = [text copy];
+    _slug = [slug copy];
+    _sourceRange = range;
+  }
+  return self;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"ENRMDocumentHeading(level=%lu, text=%@, slug=%@)", (unsigned long)self.level,
+                                    self.text, self.slug];
+}
+
+@end
+
+@interface ENRMDocumentTask ()
+
+- (instancetype)initWithChecked:(BOOL)checked range:(NSRange)range;
+
+@end
+
+@implementation ENRMDocumentTask
+
+- (instancetype)initWithChecked:(BOOL)checked range:(NSRange)range
+{
+  if (self = [super init]) {
+    _checked = checked;
+    _sourceRange = range;
+  }
+  return self;
+}
+
+@end
+
+@implementation ENRMDocumentIndex
+
+- (instancetype)initWithAST:(const Markdown::FlatMarkdownAST &)ast offsets:(const Markdown::Utf16OffsetMap &)offsets
+{
+  if (self = [super init]) {
+    std::shared_ptr<const Markdown::DocumentIndex> index = ast.index();
+
+    NSMutableArray<ENRMDocumentHeading *> *headings = [NSMutableArray arrayWithCapacity:index->headings.size()];
+    for (const Markdown::DocumentIndex::Heading &heading : index->headings) {
+      [headings addObject:[[ENRMDocumentHeading alloc] initWithLevel:heading.level
+                                                                text:stringFromUTF8(heading.text)
+                                                                slug:stringFromUTF8(heading.slug)
+                                                               range:sourceRangeOf(ast, heading.node, offsets)]];
+    }
+    NSMutableArray<ENRMDocumentTask *> *tasks = [NSMutableArray arrayWithCapacity:index->tasks.size()];
+    for (const Markdown::DocumentIndex::Task &task : index->tasks) {
+      [tasks addObject:[[ENRMDocumentTask alloc] initWithChecked:task.checked
+                                                           range:sourceRangeOf(ast, task.node, offsets)]];
+    }
+
+    _headings = headings;
+    _linkURLs = urlsOf(index->links);
+    _imageURLs = urlsOf(index->images);
+    _tasks = tasks;
+    _wordCount = index->wordCount;
+    _characterCount = index->characterCount;
+  }
+  return self;
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"ENRMDocumentIndex(headings=%lu, links=%lu, images=%lu, tasks=%lu, words=%lu, "
+                                    @"characters=%lu)",
+                                    (unsigned long)self.headings.count, (unsigned long)self.linkURLs.count,
+                                    (unsigned long)self.imageURLs.count, (unsigned long)self.tasks.count,
+                                    (unsigned long)self.wordCount, (unsigned long)self.characterCount];
+}
+
+@end
@@ -1,3 +1,6 @@
+#import "ENRMDocumentIndex.h"
+#import "ENRMParseCancellationToken.h"
+#import "ENRMParseStats.h"
 #import "MarkdownASTNode.h"
 #import <Foundation/Foundation.h>
 
@@ -7,6 +10,14 @@
 @property (nonatomic, assign) BOOL latexMath;
 @property (nonatomic, assign) BOOL superscript;
 @property (nonatomic, assign) BOOL subscript;
+/// @name mentions, #name hashtags and :name: emoji shortcodes, recognized by md4c.
+@property (nonatomic, assign) BOOL mentions;
+@property (nonatomic, assign) BOOL hashtags;
+@property (nonatomic, assign) BOOL emojiShortcodes;
+/// Parse only the first maxBlocks top-level blocks, or the blocks that start within the first maxSourceBytes UTF-8
+/// bytes, for collapsed messages. 0 disables a limit. parseStreamingMarkdown:flags: ignores both.
+@property (nonatomic, assign) NSUInteger maxBlocks;
+@property (nonatomic, assign) NSUInteger maxSourceBytes;
 
 + (instancetype)defaultFlags;
 
@@ -14,7 +25,29 @@
 
 @interface ENRMMarkdownParser : NSObject
 
+/// When YES, parseMarkdown: calls record what they cost in lastParseStats. Off by default.
+@property (atomic, assign) BOOL collectsParseStats;
+/// Stats of the last parseMarkdown: call made while collectsParseStats was on, or nil.
+@property (atomic, strong, readonly) ENRMParseStats *lastParseStats;
+/// When YES, parseMarkdown: calls keep the document's outline, links, images, tasks and counts in lastDocumentIndex.
+/// Off by default.
+@property (atomic, assign) BOOL collectsDocumentIndex;
+/// Index of the last parseMarkdown: call made while collectsDocumentIndex was on; nil for empty markdown.
+@property (atomic, strong, readonly) ENRMDocumentIndex *lastDocumentIndex;
+
+/// Calls from the main thread never wait for a parse on another thread to finish; they parse without the block cache
+/// that makes re-parsing an edited document cheap.
 - (MarkdownASTNode *)parseMarkdown:(NSString *)markdown;
 - (MarkdownASTNode *)parseMarkdown:(NSString *)markdown flags:(ENRMMd4cFlags *)flags;
 
+/// Same as parseMarkdown:flags:, but returns nil without finishing once cancellationToken is cancelled.
+- (MarkdownASTNode *)parseMarkdown:(NSString *)markdown
+                             flags:(ENRMMd4cFlags *)flags
+                 cancellationToken:(ENRMParseCancellationToken *)cancellationToken;
+
+/// Parses markdown that is expected to grow at the end between calls, such as a streamed response. Top-level blocks
+/// that can no longer change are parsed once and returned as the same node objects on later calls; only the open tail
+/// is re-parsed. Any other change to the text falls back to parsing it from the first affected block.
+- (MarkdownASTNode *)parseStreamingMarkdown:(NSString *)markdown flags:(ENRMMd4cFlags *)flags;
+
 @end
@@ -1,7 +1,18 @@
 #import "ENRMMarkdownParser.h"
 #import "MarkdownASTNode.h"
+#include "MD4CParser.hpp"
+#include "ParseControl.hpp"
+#include "ParseStats.hpp"
+#include "StreamingParseSession.hpp"
+#include <memory>
 
-extern MarkdownASTNode *parseMarkdownWithCppParser(NSString *markdown, ENRMMd4cFlags *flags);
+extern MarkdownASTNode *parseMarkdownWithCppParser(Markdown::MD4CParser &parser, NSString *markdown,
+                                                   ENRMMd4cFlags *flags, const Markdown::ParseControl *control,
+                                                   Markdown::ParseStats *stats,
+                                                   ENRMDocumentIndex *__autoreleasing *index);
+extern MarkdownASTNode *parseMarkdownWithStreamingSession(Markdown::StreamingParseSession &session,
+                                                          NSMutableArray<MarkdownASTNode *> *stableBlocks,
+                                                          NSString *markdown, ENRMMd4cFlags *flags);
 
 @implementation ENRMMd4cFlags
 
@@ -12,6 +23,11 @@ extern MarkdownASTNode *parseMarkdownWithCppParser(NSString *markdown, ENRMMd4cF
     _latexMath = YES;
     _superscript = NO;
     _subscript = NO;
+    _mentions = NO;
+    _hashtags = NO;
+    _emojiShortcodes = NO;
+    _maxBlocks = 0;
+    _maxSourceBytes = 0;
   }
   return self;
 }
@@ -28,12 +44,31 @@ extern MarkdownASTNode *parseMarkdownWithCppParser(NSString *markdown, ENRMMd4cF
   copy.latexMath = self.latexMath;
   copy.superscript = self.superscript;
   copy.subscript = self.subscript;
+  copy.mentions = self.mentions;
+  copy.hashtags = self.hashtags;
+  copy.emojiShortcodes = self.emojiShortcodes;
+  copy.maxBlocks = self.maxBlocks;
+  copy.maxSourceBytes = self.maxSourceBytes;
   return copy;
 }
 
 @end
 
-@implementation ENRMMarkdownParser
+@interface ENRMMarkdownParser ()
+
+@property (atomic, strong, readwrite) ENRMParseStats *lastParseStats;
+@property (atomic, strong, readwrite) ENRMDocumentIndex *lastDocumentIndex;
+
+@end
+
+@implementation ENRMMarkdownParser {
+  // Keeps the blocks of the last document parsed off the main thread, so re-parsing it after a small edit only runs
+  // md4c over the blocks the edit touched.
+  std::unique_ptr<Markdown::MD4CParser> _parser;
+  // Created on the first streaming parse; plain parses never pay for it.
+  std::unique_ptr<Markdown::StreamingParseSession> _streamingSession;
+  NSMutableArray<MarkdownASTNode *> *_stableBlocks;
+}
 
 - (MarkdownASTNode *)parseMarkdown:(NSString *)markdown
 {
@@ -42,7 +77,62 @@ extern MarkdownASTNode *parseMarkdownWithCppParser(NSString *markdown, ENRMMd4cF
 
 - (MarkdownASTNode *)parseMarkdown:(NSString *)markdown flags:(ENRMMd4cFlags *)flags
 {
-  return parseMarkdownWithCppParser(markdown, flags);
+  return [self parseMarkdown:markdown flags:flags cancellationToken:nil];
+}
+
+- (MarkdownASTNode *)parseMarkdown:(NSString *)markdown
+                             flags:(ENRMMd4cFlags *)flags
+                 cancellationToken:(ENRMParseCancellationToken *)cancellationToken
+{
+  unsigned threadCount = static_cast<unsigned>([NSProcessInfo processInfo].activeProcessorCount);
+  // Views parse synchronously on the main thread to measure and render, and that must never wait for a background
+  // parse to release the lock. Such a parse gets a parser of its own, without the block cache.
+  if ([NSThread isMainThread]) {
+    Markdown::MD4CParser parser;
+    parser.setParallelParsing(threadCount);
+    return [self parseMarkdown:markdown flags:flags cancellationToken:cancellationToken parser:parser];
+  }
+  @synchronized(self) {
+    if (!_parser) {
+      _parser = std::make_unique<Markdown::MD4CParser>();
+      _parser->setBlockCacheEnabled(true);
+      _parser->setParallelParsing(threadCount);
+    }
+    return [self parseMarkdown:markdown flags:flags cancellationToken:cancellationToken parser:*_parser];
+  }
+}
+
+- (MarkdownASTNode *)parseMarkdown:(NSString *)markdown
+                             flags:(ENRMMd4cFlags *)flags
+                 cancellationToken:(ENRMParseCancellationToken *)cancellationToken
+                            parser:(Markdown::MD4CParser &)parser
+{
+  BOOL collectsStats = self.collectsParseStats;
+  BOOL collectsIndex = self.collectsDocumentIndex;
+  Markdown::ParseStats stats;
+  ENRMDocumentIndex *index = nil;
+  MarkdownASTNode *document =
+      parseMarkdownWithCppParser(parser, markdown, flags,
+                                 cancellationToken ? &[cancellationToken parseControl] : nullptr,
+                                 collectsStats ? &stats : nullptr, collectsIndex ? &index : nullptr);
+  if (collectsStats && document) {
+    self.lastParseStats = [[ENRMParseStats alloc] initWithParseStats:stats];
+  }
+  if (collectsIndex && document) {
+    self.lastDocumentIndex = index;
+  }
+  return document;
+}
+
+- (MarkdownASTNode *)parseStreamingMarkdown:(NSString *)markdown flags:(ENRMMd4cFlags *)flags
+{
+  @synchronized(self) {
+    if (!_streamingSession) {
+      _streamingSession = std::make_unique<Markdown::StreamingParseSession>();
+      _stableBlocks = [[NSMutableArray alloc] init];
+    }
+    return parseMarkdownWithStreamingSession(*_streamingSession, _stableBlocks, markdown, flags);
+  }
 }
 
 @end
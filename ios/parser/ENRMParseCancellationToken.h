@@ -0,0 +1,26 @@
+#pragma once
+#import <Foundation/Foundation.h>
+
+/// Lets the caller of a parse stop it once its result is no longer wanted, such as when a newer render was scheduled
+/// or the view was recycled. -cancel may be called from any thread; the parse notices within a few hundred md4c
+/// callbacks and returns nil.
+@interface ENRMParseCancellationToken : NSObject
+
+@property (nonatomic, readonly, getter=isCancelled) BOOL cancelled;
+
+- (void)cancel;
+
+@end
+
+#ifdef __cplusplus
+namespace Markdown {
+class ParseControl;
+}
+
+@interface ENRMParseCancellationToken ()
+
+/// The control the C++ parser polls. Valid for as long as the token is alive.
+- (const Markdown::ParseControl &)parseControl;
+
+@end
+#endif
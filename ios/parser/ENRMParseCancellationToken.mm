@@ -0,0 +1,23 @@
+#import "ENRMParseCancellationToken.h"
+#include "ParseControl.hpp"
+
+@implementation ENRMParseCancellationToken {
+  Markdown::ParseControl _control;
+}
+
+- (BOOL)isCancelled
+{
+  return _control.isCancelled();
+}
+
+- (void)cancel
+{
+  _control.cancel();
+}
+
+- (const Markdown::ParseControl &)parseControl
+{
+  return _control;
+}
+
+@end
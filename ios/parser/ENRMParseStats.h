@@ -0,0 +1,43 @@
+#pragma once
+#import "MarkdownASTNode.h"
+#import <Foundation/Foundation.h>
+
+/// What one parse cost and what it produced, for logging slow renders. Times are in seconds and split the parse into
+/// md4c itself, post-processing of the native AST and building the MarkdownASTNode tree from it.
+@interface ENRMParseStats : NSObject
+
+@property (nonatomic, readonly) NSUInteger inputBytes;
+/// The AST came from the native parse cache, so nothing was parsed.
+@property (nonatomic, readonly) BOOL cacheHit;
+@property (nonatomic, readonly) NSUInteger nodeCount;
+/// Nesting depth of the deepest node; top-level blocks are at depth 1.
+@property (nonatomic, readonly) NSUInteger maxDepth;
+/// Text the native AST had to copy rather than reference in the input.
+@property (nonatomic, readonly) NSUInteger textBytes;
+/// Native heap memory held by the parsed AST, and the number of blocks it is spread over.
+@property (nonatomic, readonly) NSUInteger residentBytes;
+@property (nonatomic, readonly) NSUInteger residentBlocks;
+/// Working memory md4c took from the system allocator instead of its per-thread pool.
+@property (nonatomic, readonly) NSUInteger allocations;
+@property (nonatomic, readonly) NSUInteger allocatedBytes;
+@property (nonatomic, readonly) NSTimeInterval md4cTime;
+@property (nonatomic, readonly) NSTimeInterval treeBuildTime;
+@property (nonatomic, readonly) NSTimeInterval postProcessTime;
+/// The whole parse call, including cache lookups and anything not covered by the other times.
+@property (nonatomic, readonly) NSTimeInterval totalTime;
+
+- (NSUInteger)nodeCountForType:(MarkdownNodeType)type;
+
+@end
+
+#ifdef __cplusplus
+namespace Markdown {
+struct ParseStats;
+}
+
+@interface ENRMParseStats ()
+
+- (instancetype)initWithParseStats:(const Markdown::ParseStats &)stats;
+
+@end
+#endif
@@ -0,0 +1,106 @@
+#import "ENRMParseStats.h"
+#include "ParseStats.hpp"
+
+static NSTimeInterval secondsFromDuration(Markdown::ParseStats::Duration duration)
+{
+  return std::chrono::duration<double>(duration).count();
+}
+
+@implementation ENRMParseStats {
+  Markdown::ParseStats _stats;
+}
+
+- (instancetype)initWithParseStats:(const Markdown::ParseStats &)stats
+{
+  if (self = [super init]) {
+    _stats = stats;
+  }
+  return self;
+}
+
+- (NSUInteger)inputBytes
+{
+  return _stats.inputBytes;
+}
+
+- (BOOL)cacheHit
+{
+  return _stats.cacheHit;
+}
+
+- (NSUInteger)nodeCount
+{
+  return _stats.nodeCount;
+}
+
+- (NSUInteger)maxDepth
+{
+  return _stats.maxDepth;
+}
+
+- (NSUInteger)textBytes
+{
+  return _stats.textBytes;
+}
+
+- (NSUInteger)residentBytes
+{
+  return _stats.residentBytes;
+}
+
+- (NSUInteger)residentBlocks
+{
+  return static_cast<NSUInteger>(_stats.residentBlocks);
+}
+
+- (NSUInteger)allocations
+{
+  return static_cast<NSUInteger>(_stats.allocations);
+}
+
+- (NSUInteger)allocatedBytes
+{
+  return static_cast<NSUInteger>(_stats.allocatedBytes);
+}
+
+- (NSTimeInterval)md4cTime
+{
+  return secondsFromDuration(_stats.md4cTime);
+}
+
+- (NSTimeInterval)treeBuildTime
+{
+  return secondsFromDuration(_stats.treeBuildTime);
+}
+
+- (NSTimeInterval)postProcessTime
+{
+  return secondsFromDuration(_stats.postProcessTime);
+}
+
+- (NSTimeInterval)totalTime
+{
+  return secondsFromDuration(_stats.totalTime);
+}
+
+// MarkdownNodeType lists the node types in the same order as Markdown::NodeType.
+- (NSUInteger)nodeCountForType:(MarkdownNodeType)type
+{
+  if (type < 0 || static_cast<size_t>(type) >= Markdown::kNodeTypeCount) {
+    return 0;
+  }
+  return _stats.nodeCounts[static_cast<size_t>(type)];
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"ENRMParseStats(inputBytes=%lu, cacheHit=%d, nodeCount=%lu, maxDepth=%lu, "
+                                    @"residentBytes=%lu, md4c=%.3fms, treeBuild=%.3fms, postProcess=%.3fms, "
+                                    @"total=%.3fms)",
+                                    (unsigned long)self.inputBytes, self.cacheHit, (unsigned long)self.nodeCount,
+                                    (unsigned long)self.maxDepth, (unsigned long)self.residentBytes,
+                                    self.md4cTime * 1000, self.treeBuildTime * 1000, self.postProcessTime * 1000,
+                                    self.totalTime * 1000];
+}
+
+@end
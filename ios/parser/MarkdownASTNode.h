@@ -29,18 +29,36 @@ typedef NS_ENUM(NSInteger, MarkdownNodeType) {
   MarkdownNodeTypeLatexMathDisplay,
   MarkdownNodeTypeSpoiler,
   MarkdownNodeTypeSuperscript,
-  MarkdownNodeTypeSubscript
+  MarkdownNodeTypeSubscript,
+  MarkdownNodeTypeMention,
+  MarkdownNodeTypeHashtag,
+  MarkdownNodeTypeEmojiShortcode
 };
 
 @interface MarkdownASTNode : NSObject
 
 @property (nonatomic, assign) MarkdownNodeType type;
 @property (nonatomic, strong) NSString *content;
+// nil until the first setAttribute:value: call.
 @property (nonatomic, strong) NSMutableDictionary *attributes;
 @property (nonatomic, strong) NSMutableArray<MarkdownASTNode *> *children;
+// Range of this node in the parsed markdown NSString, including its syntax delimiters.
+// location is NSNotFound for nodes that were not produced by the parser.
+@property (nonatomic, assign) NSRange sourceRange;
+// Structural hash of this node and its subtree, computed by the parser while parsing, or 0 if unknown.
+// Code that changes the subtree of a parsed node must reset it to 0.
+@property (nonatomic, assign) uint64_t subtreeHash;
+// For a code block from the parser, the uint32_t index in its code text at which each line starts, so a renderer can
+// lay out or copy only some of the lines; nil otherwise.
+@property (nonatomic, strong) NSData *lineStarts;
 
 - (instancetype)initWithType:(MarkdownNodeType)type;
 - (void)addChild:(MarkdownASTNode *)child;
 - (void)setAttribute:(NSString *)key value:(NSString *)value;
+// The text of a code block, every line ending with a line feed.
+- (NSString *)codeText;
+- (NSUInteger)lineCount;
+// Lines [range.location, NSMaxRange(range)) of a code block, line feeds included, or @"" without lineStarts.
+- (NSString *)codeLinesInRange:(NSRange)range;
 
 @end
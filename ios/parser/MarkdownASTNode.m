@@ -7,8 +7,10 @@
   if (self = [super init]) {
     _type = type;
     _content = nil;
-    _attributes = [[NSMutableDictionary alloc] init];
+    // Allocated on first setAttribute:; most nodes (text runs, emphasis) never have attributes.
+    _attributes = nil;
     _children = [[NSMutableArray alloc] init];
+    _sourceRange = NSMakeRange(NSNotFound, 0);
   }
   return self;
 }
@@ -20,9 +22,35 @@
 
 - (void)setAttribute:(NSString *)key value:(NSString *)value
 {
+  if (!_attributes) {
+    _attributes = [[NSMutableDictionary alloc] initWithCapacity:2];
+  }
   _attributes[key] = value;
 }
 
+- (NSString *)codeText
+{
+  return _children.firstObject.content ?: @"";
+}
+
+- (NSUInteger)lineCount
+{
+  return _lineStarts.length / sizeof(uint32_t);
+}
+
+- (NSString *)codeLinesInRange:(NSRange)range
+{
+  NSUInteger lineCount = self.lineCount;
+  if (range.location >= lineCount || range.length == 0) {
+    return @"";
+  }
+  NSString *text = self.codeText;
+  const uint32_t *starts = (const uint32_t *)_lineStarts.bytes;
+  NSUInteger end = range.length >= lineCount - range.location ? lineCount : NSMaxRange(range);
+  NSUInteger endOffset = end < lineCount ? starts[end] : text.length;
+  return [text substringWithRange:NSMakeRange(starts[range.location], endOffset - starts[range.location])];
+}
+
 - (NSString *)description
 {
   return [NSString stringWithFormat:@"MarkdownASTNode(type=%ld, content=%@, children=%lu)", (long)_type, _content,
@@ -1,19 +1,126 @@
+#include "CodeLineIndex.hpp"
 #import "ENRMMarkdownParser.h"
 #include "MD4CParser.hpp"
 #import "MarkdownASTNode.h"
 #include "MarkdownASTNode.hpp"
+#include "ParseCache.hpp"
+#include "ParseControl.hpp"
+#include "ParseStats.hpp"
+#include "StreamingParseSession.hpp"
+#include "Utf16OffsetMap.hpp"
 #import <React/RCTLog.h>
+#include <chrono>
 
-// Convert C++ AST node to Objective-C AST node
-static MarkdownASTNode *convertCppASTToObjC(std::shared_ptr<Markdown::MarkdownASTNode> cppNode)
+static NSString *stringFromTextView(std::string_view text)
 {
-  if (!cppNode) {
-    return [[MarkdownASTNode alloc] initWithType:MarkdownNodeTypeDocument];
+  return [[NSString alloc] initWithBytes:text.data() length:text.size() encoding:NSUTF8StringEncoding];
+}
+
+static NSString *keyForAttribute(Markdown::AttributeKey key)
+{
+  static NSString *const keys[] = {@"level",        @"url",          @"title",     @"fenceChar", @"language",
+                                   @"isTask",       @"taskChecked",  @"align",     @"colCount",  @"headRowCount",
+                                   @"bodyRowCount", @"taskIndex",    @"isInline"};
+  static_assert(sizeof(keys) / sizeof(keys[0]) == static_cast<size_t>(Markdown::AttributeKey::Count),
+                "Attribute key table out of sync with Markdown::AttributeKey");
+  return keys[static_cast<size_t>(key)];
+}
+
+static NSString *stringForNumber(uint32_t value)
+{
+  // Heading levels and most table counts are tiny; share constant strings for them.
+  static NSString *const small[] = {@"0", @"1", @"2", @"3", @"4", @"5", @"6", @"7", @"8", @"9"};
+  if (value < 10) {
+    return small[value];
   }
+  return [NSString stringWithFormat:@"%u", value];
+}
+
+// Only url/title/language allocate; every other value is a constant string.
+static void setObjCAttributes(MarkdownASTNode *objcNode, const Markdown::NodeAttributes &attrs,
+                              const Markdown::FlatMarkdownAST &ast)
+{
+  using Markdown::AttributeKey;
+  for (uint8_t i = 0; i < static_cast<uint8_t>(AttributeKey::Count); ++i) {
+    auto key = static_cast<AttributeKey>(i);
+    if (!attrs.has(key)) {
+      continue;
+    }
+
+    NSString *value = nil;
+    switch (key) {
+      case AttributeKey::Level:
+        value = stringForNumber(attrs.level);
+        break;
+      case AttributeKey::Url:
+        value = stringFromTextView(ast.text(attrs.url));
+        break;
+      case AttributeKey::Title:
+        value = stringFromTextView(ast.text(attrs.title));
+        break;
+      case AttributeKey::Language:
+        value = stringFromTextView(ast.text(attrs.language));
+        break;
+      case AttributeKey::FenceChar:
+        value = attrs.fenceChar == '~' ? @"~" : @"`";
+        break;
+      case AttributeKey::IsTask:
+        value = attrs.isTask ? @"true" : @"false";
+        break;
+      case AttributeKey::TaskChecked:
+        value = attrs.taskChecked ? @"true" : @"false";
+        break;
+      case AttributeKey::Align:
+        switch (attrs.align) {
+          case Markdown::CellAlign::Left:
+            value = @"left";
+            break;
+          case Markdown::CellAlign::Center:
+            value = @"center";
+            break;
+          case Markdown::CellAlign::Right:
+            value = @"right";
+            break;
+          default:
+            value = @"default";
+            break;
+        }
+        break;
+      case AttributeKey::ColCount:
+        value = stringForNumber(attrs.colCount);
+        break;
+      case AttributeKey::HeadRowCount:
+        value = stringForNumber(attrs.headRowCount);
+        break;
+      case AttributeKey::BodyRowCount:
+        value = stringForNumber(attrs.bodyRowCount);
+        break;
+      case AttributeKey::TaskIndex:
+        value = stringForNumber(attrs.taskIndex);
+        break;
+      case AttributeKey::IsInline:
+        value = attrs.isInline ? @"true" : @"false";
+        break;
+      default:
+        break;
+    }
+    if (value) {
+      [objcNode setAttribute:keyForAttribute(key) value:value];
+    }
+  }
+}
+
+// Convert flat C++ AST node to Objective-C AST node. `session`, if not null, is the streaming session `ast` belongs
+// to; it keeps the line index of a code block that is still streaming in from one update to the next.
+static MarkdownASTNode *convertCppASTToObjC(const Markdown::FlatMarkdownAST &ast, Markdown::NodeIndex index,
+                                             const Markdown::Utf16OffsetMap &offsets,
+                                             Markdown::StreamingParseSession *session = nullptr)
+{
+  const Markdown::FlatNode &cppNode = ast.nodes[index];
 
   // Convert C++ NodeType enum to Objective-C MarkdownNodeType
   MarkdownNodeType objcType;
-  switch (cppNode->type) {
+  switch (cppNode.type) {
     case Markdown::NodeType::Document:
       objcType = MarkdownNodeTypeDocument;
       break;
@@ -101,34 +208,85 @@ static MarkdownASTNode *convertCppASTToObjC(std::shared_ptr<Markdown::MarkdownAS
     case Markdown::NodeType::Subscript:
       objcType = MarkdownNodeTypeSubscript;
       break;
+    case Markdown::NodeType::Mention:
+      objcType = MarkdownNodeTypeMention;
+      break;
+    case Markdown::NodeType::Hashtag:
+      objcType = MarkdownNodeTypeHashtag;
+      break;
+    case Markdown::NodeType::EmojiShortcode:
+      objcType = MarkdownNodeTypeEmojiShortcode;
+      break;
   }
 
   MarkdownASTNode *objcNode = [[MarkdownASTNode alloc] initWithType:objcType];
 
+  // Source range, in UTF-16 units to match NSString indexing
+  NSUInteger sourceBegin = offsets.toUtf16(cppNode.sourceRange.begin);
+  objcNode.sourceRange = NSMakeRange(sourceBegin, offsets.toUtf16(cppNode.sourceRange.end) - sourceBegin);
+  objcNode.subtreeHash = cppNode.hash;
+
   // Convert content
-  if (!cppNode->content.empty()) {
-    objcNode.content = [NSString stringWithUTF8String:cppNode->content.c_str()];
+  if (cppNode.content.length > 0) {
+    objcNode.content = stringFromTextView(ast.text(cppNode.content));
   }
 
   // Convert attributes
-  for (const auto &[key, value] : cppNode->attributes) {
-    NSString *objcKey = [NSString stringWithUTF8String:key.c_str()];
-    NSString *objcValue = [NSString stringWithUTF8String:value.c_str()];
-    [objcNode setAttribute:objcKey value:objcValue];
+  if (const Markdown::NodeAttributes *attrs = ast.attributesOf(index)) {
+    setObjCAttributes(objcNode, *attrs, ast);
+  }
+
+  if (cppNode.type == Markdown::NodeType::CodeBlock) {
+    std::string_view code = session || cppNode.firstChild == Markdown::kInvalidNodeIndex
+                                ? std::string_view()
+                                : ast.content(cppNode.firstChild);
+    Markdown::CodeLineIndex built(code, Markdown::CodeLineIndex::Unit::Utf16);
+    const Markdown::CodeLineIndex &lines =
+        session ? session->codeLines(index, Markdown::CodeLineIndex::Unit::Utf16) : built;
+    objcNode.lineStarts = [NSData dataWithBytes:lines.starts().data() length:lines.lineCount() * sizeof(uint32_t)];
   }
 
   // Convert children recursively
-  for (const auto &child : cppNode->children) {
-    MarkdownASTNode *objcChild = convertCppASTToObjC(child);
+  for (Markdown::NodeIndex child = cppNode.firstChild; child != Markdown::kInvalidNodeIndex;
+       child = ast.nodes[child].nextSibling) {
+    MarkdownASTNode *objcChild = convertCppASTToObjC(ast, child, offsets, session);
     [objcNode addChild:objcChild];
   }
 
   return objcNode;
 }
 
-// Public function to parse markdown using C++ parser and convert to Objective-C AST
-MarkdownASTNode *parseMarkdownWithCppParser(NSString *markdown, ENRMMd4cFlags *flags)
+// Convert Objective-C flags to C++ flags
+static Markdown::Md4cFlags cppFlagsFromObjC(ENRMMd4cFlags *flags)
+{
+  Markdown::Md4cFlags cppFlags;
+  cppFlags.underline = flags.underline;
+  cppFlags.latexMath = flags.latexMath;
+  cppFlags.superscript = flags.superscript;
+  cppFlags.subscript = flags.subscript;
+  cppFlags.mentions = flags.mentions;
+  cppFlags.hashtags = flags.hashtags;
+  cppFlags.emojiShortcodes = flags.emojiShortcodes;
+  cppFlags.maxBlocks = static_cast<uint32_t>(MIN(flags.maxBlocks, (NSUInteger)UINT32_MAX));
+  cppFlags.maxSourceBytes = static_cast<uint32_t>(MIN(flags.maxSourceBytes, (NSUInteger)UINT32_MAX));
+  return cppFlags;
+}
+
+// Public function to parse markdown using C++ parser and convert to Objective-C AST. `parser` may keep state between
+// calls (such as its block cache), so callers must not use it from several threads at once. Returns nil if `control`
+// stopped the parse. `stats`, if not null, is filled in with what the call cost; it is left alone for empty markdown.
+// `index`, if not null, is set to the document's index, or to nil for empty markdown.
+MarkdownASTNode *parseMarkdownWithCppParser(Markdown::MD4CParser &parser, NSString *markdown, ENRMMd4cFlags *flags,
+                                            const Markdown::ParseControl *control, Markdown::ParseStats *stats,
+                                            ENRMDocumentIndex *__autoreleasing *index)
 {
+  if (index) {
+    *index = nil;
+  }
+
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+
   if (markdown.length == 0) {
     return [[MarkdownASTNode alloc] initWithType:MarkdownNodeTypeDocument];
   }
@@ -140,18 +298,78 @@ MarkdownASTNode *parseMarkdownWithCppParser(NSString *markdown, ENRMMd4cFlags *f
     return [[MarkdownASTNode alloc] initWithType:MarkdownNodeTypeDocument];
   }
 
-  std::string cppMarkdown(utf8String);
-
-  // Convert Objective-C flags to C++ flags
-  Markdown::Md4cFlags cppFlags;
-  cppFlags.underline = flags.underline;
-  cppFlags.latexMath = flags.latexMath;
-  cppFlags.superscript = flags.superscript;
-  cppFlags.subscript = flags.subscript;
+  // Shared so the flat AST can reference text in place instead of copying it.
+  auto cppMarkdown = std::make_shared<const std::string>(utf8String);
 
-  Markdown::MD4CParser parser;
-  auto cppAST = parser.parse(cppMarkdown, cppFlags);
+  // The mock view used for measuring and the mounted view usually parse the same markdown back to back.
+  std::shared_ptr<const Markdown::FlatMarkdownAST> cppAST;
+  Markdown::ParseStatus status = Markdown::ParseStatus::Completed;
+  parser.setStats(stats);
+  parser.setDocumentIndexEnabled(index != nullptr);
+  if (control) {
+    cppAST = Markdown::ParseCache::shared().parse(parser, cppMarkdown, cppFlagsFromObjC(flags), *control, status);
+  } else {
+    cppAST = Markdown::ParseCache::shared().parse(parser, cppMarkdown, cppFlagsFromObjC(flags));
+  }
+  parser.setStats(nullptr);
+  if (status == Markdown::ParseStatus::Cancelled || status == Markdown::ParseStatus::DeadlineExceeded) {
+    return nil;
+  }
+  if (!cppAST) {
+    return [[MarkdownASTNode alloc] initWithType:MarkdownNodeTypeDocument];
+  }
 
   // Convert C++ AST to Objective-C AST
-  return convertCppASTToObjC(cppAST);
+  Clock::time_point conversionStart = Clock::now();
+  Markdown::Utf16OffsetMap offsets(*cppMarkdown);
+  MarkdownASTNode *document = convertCppASTToObjC(*cppAST, Markdown::FlatMarkdownAST::root(), offsets);
+  if (index) {
+    *index = [[ENRMDocumentIndex alloc] initWithAST:*cppAST offsets:offsets];
+  }
+  if (stats) {
+    Clock::time_point end = Clock::now();
+    stats->treeBuildTime = end - conversionStart;
+    stats->totalTime = end - start;
+  }
+  return document;
+}
+
+// Parses the next version of a streamed document through `session`. `stableBlocks` holds the Objective-C nodes of the
+// top-level blocks the session has kept so far; they are returned as the same objects for as long as the session
+// keeps them, and only the blocks after them are converted again.
+MarkdownASTNode *parseMarkdownWithStreamingSession(Markdown::StreamingParseSession &session,
+                                                   NSMutableArray<MarkdownASTNode *> *stableBlocks, NSString *markdown,
+                                                   ENRMMd4cFlags *flags)
+{
+  const char *utf8String = markdown.length > 0 ? [markdown UTF8String] : "";
+  if (!utf8String) {
+    RCTLogError(@"MarkdownParserBridge: Failed to convert markdown to UTF-8");
+    return [[MarkdownASTNode alloc] initWithType:MarkdownNodeTypeDocument];
+  }
+
+  const Markdown::FlatMarkdownAST &cppAST = session.update(utf8String, cppFlagsFromObjC(flags));
+
+  NSUInteger reused = MIN(static_cast<NSUInteger>(session.reusedBlockCount()), stableBlocks.count);
+  [stableBlocks removeObjectsInRange:NSMakeRange(reused, stableBlocks.count - reused)];
+  NSUInteger stableCount = session.stableBlockCount();
+
+  Markdown::Utf16OffsetMap offsets(session.text());
+  MarkdownASTNode *document = [[MarkdownASTNode alloc] initWithType:MarkdownNodeTypeDocument];
+  document.sourceRange = NSMakeRange(0, offsets.toUtf16(static_cast<uint32_t>(session.text().size())));
+
+  NSUInteger index = 0;
+  for (Markdown::NodeIndex child = cppAST.nodes[Markdown::FlatMarkdownAST::root()].firstChild;
+       child != Markdown::kInvalidNodeIndex; child = cppAST.nodes[child].nextSibling, ++index) {
+    if (index < stableBlocks.count) {
+      [document addChild:stableBlocks[index]];
+      continue;
+    }
+    MarkdownASTNode *block = convertCppASTToObjC(cppAST, child, offsets, &session);
+    if (index < stableCount) {
+      [stableBlocks addObject:block];
+    }
+    [document addChild:block];
+  }
+
+  return document;
 }
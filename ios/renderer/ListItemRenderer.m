@@ -35,8 +35,9 @@ NSString *const TaskIndexAttribute = @"TaskIndex";
   const BOOL isChecked = isTask && [node.attributes[@"taskChecked"] isEqualToString:@"true"];
   NSInteger taskIndex = -1;
   if (isTask) {
-    taskIndex = context.taskItemCount;
-    context.taskItemCount++;
+    // The parser numbers task items across the whole document; count them here only for nodes built without it.
+    NSString *parsedTaskIndex = node.attributes[@"taskIndex"];
+    taskIndex = parsedTaskIndex ? parsedTaskIndex.integerValue : context.taskItemCount++;
   }
 
   const NSUInteger startLocation = output.length;
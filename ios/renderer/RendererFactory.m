@@ -86,6 +86,9 @@
       return [[SubscriptRenderer alloc] initWithRendererFactory:self config:_config];
     case MarkdownNodeTypeParagraph:
       return [[ParagraphRenderer alloc] initWithRendererFactory:self config:_config];
+    // Tapping a mention or hashtag reports its "mention:" or "hashtag:" url like any link.
+    case MarkdownNodeTypeMention:
+    case MarkdownNodeTypeHashtag:
     case MarkdownNodeTypeLink:
       return [[LinkRenderer alloc] initWithRendererFactory:self config:_config];
     case MarkdownNodeTypeHeading:
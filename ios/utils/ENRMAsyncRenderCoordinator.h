@@ -1,4 +1,5 @@
 #pragma once
+#import "ENRMParseCancellationToken.h"
 #import <Foundation/Foundation.h>
 
 /// Owns the serial render queue and render-ID counter used by async render pipelines.
@@ -14,10 +15,14 @@
 /// Dispatches renderBlock on the serial queue.
 /// If renderBlock returns YES, applyBlock is dispatched on the main queue,
 /// provided the render ID has not been superseded by a newer call.
-- (void)scheduleRender:(BOOL (^)(void))renderBlock apply:(dispatch_block_t)applyBlock;
+/// renderBlock gets a token that is cancelled as soon as a newer render is
+/// scheduled; pass it to the parser so a stale parse stops early. A render
+/// still waiting in the queue when that happens is skipped.
+- (void)scheduleRender:(BOOL (^)(ENRMParseCancellationToken *token))renderBlock apply:(dispatch_block_t)applyBlock;
 
 /// Advances the render ID so any in-flight render's apply block is discarded
-/// by the renderId == currentRenderId check when it lands on the main queue.
+/// by the renderId == currentRenderId check when it lands on the main queue,
+/// and cancels that render's parse.
 /// Use before recycling or otherwise resetting a host that owns this coordinator.
 - (void)invalidate;
 
@@ -3,6 +3,7 @@
 @implementation ENRMAsyncRenderCoordinator {
   dispatch_queue_t _queue;
   NSUInteger _currentRenderId;
+  ENRMParseCancellationToken *_currentToken;
 }
 
 - (instancetype)initWithQueueLabel:(const char *)label
@@ -13,13 +14,16 @@
   return self;
 }
 
-- (void)scheduleRender:(BOOL (^)(void))renderBlock apply:(dispatch_block_t)applyBlock
+- (void)scheduleRender:(BOOL (^)(ENRMParseCancellationToken *token))renderBlock apply:(dispatch_block_t)applyBlock
 {
   if (_blockAsyncRender)
     return;
   NSUInteger renderId = ++_currentRenderId;
+  [_currentToken cancel];
+  ENRMParseCancellationToken *token = [[ENRMParseCancellationToken alloc] init];
+  _currentToken = token;
   dispatch_async(_queue, ^{
-    if (!renderBlock())
+    if (token.isCancelled || !renderBlock(token))
       return;
     dispatch_async(dispatch_get_main_queue(), ^{
       if (renderId == self->_currentRenderId) {
@@ -32,6 +36,8 @@
 - (void)invalidate
 {
   ++_currentRenderId;
+  [_currentToken cancel];
+  _currentToken = nil;
 }
 
 @end
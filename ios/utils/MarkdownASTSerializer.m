@@ -75,6 +75,16 @@ static void serializeNode(MarkdownASTNode *node, NSMutableString *buffer)
       break;
     }
 
+    case MarkdownNodeTypeEmojiShortcode: {
+      NSString *shortcode = node.attributes[@"title"];
+      if (shortcode) {
+        [buffer appendString:shortcode];
+      } else {
+        serializeChildren(node, buffer);
+      }
+      break;
+    }
+
     case MarkdownNodeTypeImage: {
       NSString *alt = node.attributes[@"alt"] ?: @"";
       NSString *url = node.attributes[@"url"] ?: @"";
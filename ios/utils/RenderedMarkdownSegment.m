@@ -102,6 +102,9 @@ uint64_t ENRMSignatureForNode(MarkdownASTNode *node)
 {
   if (!node)
     return kFNVOffsetBasis;
+  // The parser hashed the subtree already; only nodes built in Objective-C are walked.
+  if (node.subtreeHash != 0)
+    return node.subtreeHash;
 
   uint64_t hash = kFNVOffsetBasis;
   hash = fnvMixUInt64(hash, (uint64_t)node.type);
@@ -255,12 +255,37 @@ export interface Md4cFlagsInternal {
    * @default false
    */
   subscript: boolean;
+  /**
+   * Enable @mention span parsing.
+   * @default false
+   */
+  mentions: boolean;
+  /**
+   * Enable #hashtag span parsing.
+   * @default false
+   */
+  hashtags: boolean;
+  /**
+   * Enable :shortcode: emoji span parsing.
+   * @default false
+   */
+  emojiShortcodes: boolean;
   /**
    * Enable LaTeX math span parsing ($..$ and $$..$$).
    * When disabled, dollar signs are treated as plain text.
    * @default true
    */
   latexMath: boolean;
+  /**
+   * Stop parsing after this many top-level blocks; 0 disables.
+   * @default 0
+   */
+  maxBlocks: CodegenTypes.Int32;
+  /**
+   * Stop parsing at the first block boundary past this many bytes; 0 disables.
+   * @default 0
+   */
+  maxSourceBytes: CodegenTypes.Int32;
 }
 
 interface StreamingConfigInternal {
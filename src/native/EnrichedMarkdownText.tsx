@@ -31,6 +31,9 @@ const defaultMd4cFlags: Md4cFlags = {
   underline: false,
   superscript: false,
   subscript: false,
+  mentions: false,
+  hashtags: false,
+  emojiShortcodes: false,
   latexMath: true,
 };
 
@@ -71,7 +74,12 @@ export const EnrichedMarkdownText = ({
       underline: md4cFlags.underline ?? false,
       superscript: md4cFlags.superscript ?? false,
       subscript: md4cFlags.subscript ?? false,
+      mentions: md4cFlags.mentions ?? false,
+      hashtags: md4cFlags.hashtags ?? false,
+      emojiShortcodes: md4cFlags.emojiShortcodes ?? false,
       latexMath: md4cFlags.latexMath ?? true,
+      maxBlocks: md4cFlags.maxBlocks ?? 0,
+      maxSourceBytes: md4cFlags.maxSourceBytes ?? 0,
     }),
     [md4cFlags]
   );
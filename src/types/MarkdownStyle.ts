@@ -294,6 +294,27 @@ export interface Md4cFlags {
    * @default false
    */
   subscript?: boolean;
+  /**
+   * Enable @mention spans, such as `@alice` or `@john.doe`.
+   * A mention renders as a link to `mention:<name>`, so `onLinkPress`
+   * reports taps on it and a `'^mention:'` entry in `linkVariants` styles it.
+   * Not recognized inside code, links, or e-mail addresses.
+   * @default false
+   */
+  mentions?: boolean;
+  /**
+   * Enable #hashtag spans, such as `#general`. Like mentions, they render as
+   * links, to `hashtag:<name>`. Names of only digits (`#1`) and ATX headings
+   * are left alone.
+   * @default false
+   */
+  hashtags?: boolean;
+  /**
+   * Replace emoji shortcodes, such as `:smile:` or `:+1:`, with their emoji.
+   * Covers the common GitHub and Slack names; unknown names stay as written.
+   * @default false
+   */
+  emojiShortcodes?: boolean;
   /**
    * Enable LaTeX math span parsing ($..$ and $$..$$).
    * When enabled, the parser recognizes LaTeX math delimiters.
@@ -302,4 +323,19 @@ export interface Md4cFlags {
    * @default true
    */
   latexMath?: boolean;
+  /**
+   * Render only the first this many top-level blocks, for messages shown
+   * collapsed. The rest is neither parsed nor rendered nor measured.
+   * 0 renders every block.
+   * @default 0
+   */
+  maxBlocks?: number;
+  /**
+   * Render only the top-level blocks that start within the first this many
+   * UTF-8 bytes of `markdown`. Like `maxBlocks`, the cut falls between
+   * blocks; both may be set. Ignored while `streamingAnimation` is on.
+   * 0 renders every block.
+   * @default 0
+   */
+  maxSourceBytes?: number;
 }
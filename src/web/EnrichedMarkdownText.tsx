@@ -9,7 +9,6 @@ import {
 import { parseMarkdown } from './parseMarkdown';
 import { RenderNode } from './renderers';
 import type { ASTNode, RendererCallbacks, RenderCapabilities } from './types';
-import { indexTaskItems, markInlineImages } from './utils';
 import { loadKaTeX } from './katex';
 import type { KaTeXInstance } from './katex';
 import { ENRM_TEXT_CLASS, ENRM_SELECTION_BG_VAR } from './globalStyles';
@@ -42,6 +41,11 @@ export const EnrichedMarkdownText = ({
     latexMath = true,
     superscript = false,
     subscript = false,
+    mentions = false,
+    hashtags = false,
+    emojiShortcodes = false,
+    maxBlocks = 0,
+    maxSourceBytes = 0,
   } = md4cFlags;
 
   useEffect(() => {
@@ -50,14 +54,21 @@ export const EnrichedMarkdownText = ({
     const katexPromise = latexMath ? loadKaTeX() : Promise.resolve(null);
 
     Promise.all([
-      parseMarkdown(markdown, { underline, latexMath, superscript, subscript }),
+      parseMarkdown(markdown, {
+        underline,
+        latexMath,
+        superscript,
+        subscript,
+        mentions,
+        hashtags,
+        emojiShortcodes,
+        maxBlocks,
+        maxSourceBytes,
+      }),
       katexPromise,
     ])
       .then(([result, katexInstance]) => {
         if (!cancelled) {
-          indexTaskItems(result);
-          markInlineImages(result);
-
           setParseError(false);
           setKatex(katexInstance);
           setAst(result);
@@ -78,7 +89,18 @@ export const EnrichedMarkdownText = ({
     return () => {
       cancelled = true;
     };
-  }, [markdown, underline, latexMath, superscript, subscript]);
+  }, [
+    markdown,
+    underline,
+    latexMath,
+    superscript,
+    subscript,
+    mentions,
+    hashtags,
+    emojiShortcodes,
+    maxBlocks,
+    maxSourceBytes,
+  ]);
 
   const callbacks = useMemo<RendererCallbacks>(
     () => ({ onLinkPress, onLinkLongPress, onTaskListItemPress }),
@@ -1,4 +1,4 @@
-import type { ASTNode } from './types';
+import type { ASTNode, DocumentIndex, ParseStats } from './types';
 import type { Md4cFlags } from '../types/MarkdownStyle';
 
 type ParseFn = (
@@ -6,32 +6,73 @@ type ParseFn = (
   underline: number,
   latexMath: number,
   superscript: number,
-  subscript: number
+  subscript: number,
+  sourceRanges: number,
+  collectStats: number,
+  maxBlocks: number,
+  maxSourceBytes: number,
+  collectIndex: number,
+  mentions: number,
+  hashtags: number,
+  emojiShortcodes: number
 ) => string;
 
+interface Parser {
+  parse: ParseFn;
+  lastParseStats: () => string;
+  lastDocumentIndex: () => string;
+}
+
+export interface ParseOptions {
+  /** Record each node's `sourceRange` (string indices into `markdown`). */
+  sourceRanges?: boolean;
+  /** Called with what the parse cost, for logging slow renders. */
+  onStats?: (stats: ParseStats) => void;
+  /** Called with the document's outline, links, images, tasks and counts. */
+  onIndex?: (index: DocumentIndex) => void;
+}
+
 // Caching the Promise (not the resolved value) means concurrent callers share
 // a single WASM initialization — no duplicate loading.
-let parserPromise: Promise<ParseFn> | null = null;
+let parserPromise: Promise<Parser> | null = null;
 
 // SINGLE_FILE=1 inlines the WASM binary as base64 inside md4c.js, so no
 // network fetch is needed — only a one-time decode + compile on first call.
-function initializeParser(): Promise<ParseFn> {
+function initializeParser(): Promise<Parser> {
   if (!parserPromise) {
     parserPromise = import('./wasm/md4c')
       .then((module) => module.default())
-      .then((wasmModule) =>
-        wasmModule.cwrap('parseMarkdown', 'string', [
+      .then((wasmModule) => ({
+        parse: wasmModule.cwrap('parseMarkdown', 'string', [
           'string',
           'number',
           'number',
           'number',
           'number',
-        ])
-      )
+          'number',
+          'number',
+          'number',
+          'number',
+          'number',
+          'number',
+          'number',
+          'number',
+        ]) as ParseFn,
+        lastParseStats: wasmModule.cwrap(
+          'lastParseStats',
+          'string',
+          []
+        ) as () => string,
+        lastDocumentIndex: wasmModule.cwrap(
+          'lastDocumentIndex',
+          'string',
+          []
+        ) as () => string,
+      }))
       .catch((error) => {
         parserPromise = null;
         throw error;
-      }) as Promise<ParseFn>;
+      });
   }
   return parserPromise;
 }
@@ -52,9 +93,16 @@ export async function parseMarkdown(
     latexMath = true,
     superscript = false,
     subscript = false,
-  }: Md4cFlags = {}
+    mentions = false,
+    hashtags = false,
+    emojiShortcodes = false,
+    maxBlocks = 0,
+    maxSourceBytes = 0,
+  }: Md4cFlags = {},
+  { sourceRanges = false, onStats, onIndex }: ParseOptions = {}
 ): Promise<ASTNode> {
-  const parse = await initializeParser();
+  const { parse, lastParseStats, lastDocumentIndex } =
+    await initializeParser();
 
   const result: unknown = JSON.parse(
     parse(
@@ -62,7 +110,15 @@ export async function parseMarkdown(
       underline ? 1 : 0,
       latexMath ? 1 : 0,
       superscript ? 1 : 0,
-      subscript ? 1 : 0
+      subscript ? 1 : 0,
+      sourceRanges ? 1 : 0,
+      onStats ? 1 : 0,
+      maxBlocks,
+      maxSourceBytes,
+      onIndex ? 1 : 0,
+      mentions ? 1 : 0,
+      hashtags ? 1 : 0,
+      emojiShortcodes ? 1 : 0
     )
   );
 
@@ -70,5 +126,19 @@ export async function parseMarkdown(
     throw new Error('WASM parser returned invalid AST');
   }
 
+  if (onStats) {
+    const stats: ParseStats | null = JSON.parse(lastParseStats());
+    if (stats) {
+      onStats(stats);
+    }
+  }
+
+  if (onIndex) {
+    const index: DocumentIndex | null = JSON.parse(lastDocumentIndex());
+    if (index) {
+      onIndex(index);
+    }
+  }
+
   return result;
 }
@@ -56,9 +56,8 @@ function ImageRenderer({ node, styles }: RendererProps) {
 
   const title = node.attributes?.title;
   const alt = extractNodeText(node) || title || filenameFromUrl(url) || 'Image';
-  const imgStyle = node.attributes?.isInline
-    ? styles.inlineImage
-    : styles.image;
+  const imgStyle =
+    node.attributes?.isInline === 'true' ? styles.inlineImage : styles.image;
   return <img src={url} alt={alt} title={title} style={imgStyle} />;
 }
 
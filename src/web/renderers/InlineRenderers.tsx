@@ -101,6 +101,11 @@ function LatexMathInlineRenderer({
   );
 }
 
+// The emoji is the child text; the shortcode is in the title attribute.
+function EmojiShortcodeRenderer({ node, renderChildren }: RendererProps) {
+  return <span title={node.attributes?.title}>{renderChildren(node)}</span>;
+}
+
 export const inlineRenderers: RendererMap = {
   Text: TextRenderer,
   LineBreak: LineBreakRenderer,
@@ -112,5 +117,9 @@ export const inlineRenderers: RendererMap = {
   Subscript: SubscriptRenderer,
   Code: CodeRenderer,
   Link: LinkRenderer,
+  // Links to "mention:<name>" and "hashtag:<name>".
+  Mention: LinkRenderer,
+  Hashtag: LinkRenderer,
+  EmojiShortcode: EmojiShortcodeRenderer,
   LatexMathInline: LatexMathInlineRenderer,
 };
@@ -64,7 +64,7 @@ function ListItemRenderer({
     setIsChecked(newChecked);
 
     callbacks.onTaskListItemPress?.({
-      index: taskIndex,
+      index: Number(taskIndex),
       checked: newChecked,
       text: taskText,
     });
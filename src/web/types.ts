@@ -36,7 +36,10 @@ export type NodeType =
   | 'TableHeaderCell'
   | 'TableCell'
   | 'LatexMathInline'
-  | 'LatexMathDisplay';
+  | 'LatexMathDisplay'
+  | 'Mention'
+  | 'Hashtag'
+  | 'EmojiShortcode';
 
 export interface NodeAttributes {
   level?: string;
@@ -46,10 +49,10 @@ export interface NodeAttributes {
   fenceChar?: string;
   isTask?: string;
   taskChecked?: string;
-  /** Stamped by indexTaskItems() — not present in the raw WASM output. */
-  taskIndex?: number;
-  /** Stamped by markInlineImages() — not present in the raw WASM output. */
-  isInline?: boolean;
+  /** Position of a task item among all task items of the document. */
+  taskIndex?: string;
+  /** `'true'` on an image that shares its paragraph with other content. */
+  isInline?: string;
   colCount?: string;
   headRowCount?: string;
   bodyRowCount?: string;
@@ -62,10 +65,71 @@ export interface ASTNode {
   content?: string;
   /** Present on nodes that carry structural metadata (Heading, Link, etc.). */
   attributes?: NodeAttributes;
+  /**
+   * `[start, end)` of the node in the markdown string, including its syntax
+   * delimiters. Present only when parsed with `sourceRanges: true`.
+   */
+  sourceRange?: [number, number];
   /** Child nodes; absent on leaf nodes (Text, LineBreak, ThematicBreak). */
   children?: ASTNode[];
 }
 
+/**
+ * What one parse cost and what it produced, as reported through
+ * `ParseOptions.onStats`. Times are in milliseconds.
+ */
+export interface ParseStats {
+  inputBytes: number;
+  cacheHit: boolean;
+  nodeCount: number;
+  /** Only the node types that occur in the document. */
+  nodeCounts: Record<string, number>;
+  /** Nesting depth of the deepest node; top-level blocks are at depth 1. */
+  maxDepth: number;
+  /** Text the parser had to copy rather than reference in the input. */
+  textBytes: number;
+  /** WASM heap memory held by the parsed AST, and its number of blocks. */
+  residentBytes: number;
+  residentBlocks: number;
+  /** Working memory md4c took from the allocator instead of its pool. */
+  allocations: number;
+  allocatedBytes: number;
+  md4cTime: number;
+  /** Serializing the AST to JSON for JavaScript. */
+  treeBuildTime: number;
+  postProcessTime: number;
+  totalTime: number;
+}
+
+export interface DocumentHeading {
+  level: number;
+  /** The heading's text without formatting. */
+  text: string;
+  /** GitHub-style anchor, unique within the document. */
+  slug: string;
+  sourceRange: [number, number];
+}
+
+export interface DocumentTask {
+  checked: boolean;
+  sourceRange: [number, number];
+}
+
+/**
+ * Outline, link and image URLs, task items and counts of a parsed document.
+ * Source ranges are string indices into the markdown.
+ */
+export interface DocumentIndex {
+  headings: DocumentHeading[];
+  links: string[];
+  images: string[];
+  /** In document order, so `tasks[i]` is the item with task index `i`. */
+  tasks: DocumentTask[];
+  wordCount: number;
+  /** In code points. */
+  characterCount: number;
+}
+
 export interface RendererCallbacks {
   onLinkPress?: (event: LinkPressEvent) => void;
   onLinkLongPress?: (event: LinkLongPressEvent) => void;